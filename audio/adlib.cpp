@@ -937,6 +937,7 @@ public:
 	void close();
 	void send(uint32 b);
 	void send(byte channel, uint32 b); // Supports higher than channel 15
+	void sendDelayed(uint32 b, uint32 delay);
 	uint32 property(int prop, uint32 param);
 	bool isOpen() const { return _isOpen; }
 	uint32 getBaseTempo() { return 1000000 / OPL::OPL::kDefaultCallbackFrequency; }
@@ -964,6 +965,11 @@ private:
 	Common::TimerManager::TimerProc _adlibTimerProc;
 	void *_adlibTimerParam;
 
+	// Once sendDelayed() was used, all register writes go through the
+	// ordered write queue of the OPL, with this delay in microseconds.
+	bool _delayedWrites;
+	uint32 _writeDelay;
+
 	int _timerCounter;
 
 	uint16 _channelTable2[9];
@@ -1406,6 +1412,8 @@ MidiDriver_ADLIB::MidiDriver_ADLIB() {
 	_opl = 0;
 	_adlibTimerProc = 0;
         _adlibTimerParam = 0;
+	_delayedWrites = false;
+	_writeDelay = 0;
 	_isOpen = false;
 }
 
@@ -1488,6 +1496,13 @@ void MidiDriver_ADLIB::send(uint32 b) {
 	send(b & 0xF, b & 0xFFFFFFF0);
 }
 
+void MidiDriver_ADLIB::sendDelayed(uint32 b, uint32 delay) {
+	_delayedWrites = true;
+	_writeDelay = delay;
+	send(b);
+	_writeDelay = 0;
+}
+
 void MidiDriver_ADLIB::send(byte chan, uint32 b) {
 	//byte param3 = (byte) ((b >> 24) & 0xFF);
 	byte param2 = (byte)((b >> 16) & 0xFF);
@@ -1601,7 +1616,10 @@ void MidiDriver_ADLIB::adlibWrite(byte reg, byte value) {
 #endif
 	_regCache[reg] = value;
 
-	_opl->writeReg(reg, value);
+	if (_delayedWrites)
+		_opl->writeRegDelayed(reg, value, _writeDelay);
+	else
+		_opl->writeReg(reg, value);
 }
 
 #ifdef ENABLE_OPL3
@@ -1616,7 +1634,10 @@ void MidiDriver_ADLIB::adlibWriteSecondary(byte reg, byte value) {
 #endif
 	_regCacheSecondary[reg] = value;
 
-	_opl->writeReg(reg | 0x100, value);
+	if (_delayedWrites)
+		_opl->writeRegDelayed(reg | 0x100, value, _writeDelay);
+	else
+		_opl->writeReg(reg | 0x100, value);
 }
 #endif
 
@@ -57,7 +57,8 @@ enum OplEmulator {
 	kDOSBox = 2,
 	kALSA = 3,
 	kNuked = 4,
-	kOPL2LPT = 5
+	kOPL2LPT = 5,
+	kNukedVector = 6
 };
 
 OPL::OPL() {
@@ -74,6 +75,7 @@ const Config::EmulatorDescription Config::_drivers[] = {
 #endif
 #ifndef DISABLE_NUKED_OPL
 	{ "nuked", _s("Nuked OPL emulator"), kNuked, kFlagOpl2 | kFlagDualOpl2 | kFlagOpl3 },
+	{ "nuked_vector", _s("Nuked OPL emulator (vectorized)"), kNukedVector, kFlagOpl2 | kFlagDualOpl2 | kFlagOpl3 },
 #endif
 #ifdef USE_ALSA
 	{ "alsa", _s("ALSA Direct FM"), kALSA, kFlagOpl2 | kFlagDualOpl2 | kFlagOpl3 },
@@ -196,6 +198,9 @@ OPL *Config::create(DriverId driver, OplType type) {
 #ifndef DISABLE_NUKED_OPL
 	case kNuked:
 		return new NUKED::OPL(type);
+
+	case kNukedVector:
+		return new NUKED::VectorOPL(type);
 #endif
 
 #ifdef USE_ALSA
@@ -293,6 +298,9 @@ EmulatedOPL::EmulatedOPL() :
 	_nextTick(0),
 	_samplesPerTick(0),
 	_baseFreq(0),
+	_samplePosition(0),
+	_writeQueueHead(0),
+	_writeQueueCount(0),
 	_handle(new Audio::SoundHandle()) {
 }
 
@@ -316,7 +324,11 @@ int EmulatedOPL::readBuffer(int16 *buffer, const int numSamples) {
 		if (step > (_nextTick >> FIXP_SHIFT))
 			step = (_nextTick >> FIXP_SHIFT);
 
+		// Split the block at the next queued register write
+		step = processWriteQueue(step);
+
 		generateSamples(buffer, step * stereoFactor);
+		_samplePosition += step;
 
 		_nextTick -= step << FIXP_SHIFT;
 		if (!(_nextTick >> FIXP_SHIFT)) {
@@ -333,6 +345,61 @@ int EmulatedOPL::readBuffer(int16 *buffer, const int numSamples) {
 	return numSamples;
 }
 
+void EmulatedOPL::writeRegAt(uint32 samplePos, int r, int v) {
+	Common::StackLock lock(_writeQueueMutex);
+
+	if (_writeQueueCount == _writeQueue.size())
+		growWriteQueue();
+
+	const uint mask = _writeQueue.size() - 1;
+
+	// Keep the queue ordered, a write must never overtake an earlier one
+	if (_writeQueueCount) {
+		const uint32 last = _writeQueue[(_writeQueueHead + _writeQueueCount - 1) & mask].samplePos;
+		if ((int32)(samplePos - last) < 0)
+			samplePos = last;
+	}
+
+	RegisterWrite &write = _writeQueue[(_writeQueueHead + _writeQueueCount) & mask];
+	write.samplePos = samplePos;
+	write.reg = r;
+	write.value = v;
+	++_writeQueueCount;
+}
+
+void EmulatedOPL::growWriteQueue() {
+	Common::Array<RegisterWrite> queue;
+	queue.resize(MAX<uint>(_writeQueue.size() * 2, kMinWriteQueueSize));
+
+	for (uint i = 0; i < _writeQueueCount; ++i)
+		queue[i] = _writeQueue[(_writeQueueHead + i) & (_writeQueue.size() - 1)];
+
+	_writeQueue = queue;
+	_writeQueueHead = 0;
+}
+
+void EmulatedOPL::writeRegDelayed(int r, int v, uint32 delay) {
+	writeRegAt(_samplePosition + (uint32)(((uint64)delay * getRate()) / 1000000), r, v);
+}
+
+int EmulatedOPL::processWriteQueue(int maxStep) {
+	Common::StackLock lock(_writeQueueMutex);
+
+	while (_writeQueueCount) {
+		const RegisterWrite &write = _writeQueue[_writeQueueHead];
+		const int32 delta = (int32)(write.samplePos - _samplePosition);
+
+		if (delta > 0)
+			return MIN<int>(maxStep, delta);
+
+		writeReg(write.reg, write.value);
+		_writeQueueHead = (_writeQueueHead + 1) & (_writeQueue.size() - 1);
+		--_writeQueueCount;
+	}
+
+	return maxStep;
+}
+
 int EmulatedOPL::getRate() const {
 	return g_system->getMixer()->getOutputRate();
 }
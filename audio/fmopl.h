@@ -25,7 +25,9 @@
 
 #include "audio/audiostream.h"
 
+#include "common/array.h"
 #include "common/func.h"
+#include "common/mutex.h"
 #include "common/ptr.h"
 #include "common/scummsys.h"
 
@@ -160,6 +162,18 @@ public:
 	 */
 	virtual void writeReg(int r, int v) = 0;
 
+	/**
+	 * Write to a specific OPL register the given time after the start of
+	 * the current timer callback. Emulators apply the write at the exact
+	 * sample, after all writes queued before it. The default is to write
+	 * right away.
+	 *
+	 * @param r		hardware register number to write to
+	 * @param v		value, which will be written
+	 * @param delay	delay in microseconds
+	 */
+	virtual void writeRegDelayed(int r, int v, uint32 delay) { writeReg(r, v); }
+
 	/**
 	 * Start the OPL with callbacks.
 	 */
@@ -245,6 +259,29 @@ public:
 	// OPL API
 	void setCallbackFrequency(int timerFrequency);
 
+	/**
+	 * Returns the number of sample frames the emulator has rendered so far.
+	 * This is the time base for writeRegAt().
+	 */
+	uint32 getSamplePosition() const { return _samplePosition; }
+
+	/**
+	 * Queues a register write, which is applied exactly when the output
+	 * reaches the given sample frame. Writes for positions which have
+	 * already been rendered are applied at the start of the next block.
+	 * Writes are always applied in the order they were queued.
+	 *
+	 * Unlike writeReg(), this is safe to call from any thread, and it
+	 * lets the emulator render whole blocks between the queued writes.
+	 *
+	 * @param samplePos	sample frame at which the write takes effect
+	 * @param r		hardware register number to write to
+	 * @param v		value, which will be written
+	 */
+	void writeRegAt(uint32 samplePos, int r, int v);
+
+	void writeRegDelayed(int r, int v, uint32 delay);
+
 	// AudioStream API
 	int readBuffer(int16 *buffer, const int numSamples);
 	int getRate() const;
@@ -271,12 +308,44 @@ private:
 	int _baseFreq;
 
 	enum {
-		FIXP_SHIFT = 16
+		FIXP_SHIFT = 16,
+		/** Initial size of the write queue, must be a power of two */
+		kMinWriteQueueSize = 64
 	};
 
 	int _nextTick;
 	int _samplesPerTick;
 
+	struct RegisterWrite {
+		uint32 samplePos;
+		uint16 reg;
+		uint8 value;
+	};
+
+	/**
+	 * Applies all queued writes which are due at the current sample
+	 * position.
+	 *
+	 * @return number of sample frames until the next queued write, but at
+	 *         most maxStep
+	 */
+	int processWriteQueue(int maxStep);
+
+	/** Doubles the size of the full write queue. */
+	void growWriteQueue();
+
+	uint32 _samplePosition;
+
+	/**
+	 * Pending timed writes, a ring buffer of _writeQueueCount entries
+	 * starting at _writeQueueHead. Its size is a power of two, and it only
+	 * grows when more writes are pending at once than ever before.
+	 */
+	Common::Array<RegisterWrite> _writeQueue;
+	uint _writeQueueHead;
+	uint _writeQueueCount;
+	Common::Mutex _writeQueueMutex;
+
 	Audio::SoundHandle *_handle;
 };
 
@@ -0,0 +1,335 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+
+#include "audio/midicache.h"
+#include "audio/audiostream.h"
+#include "audio/midiparser.h"
+#include "audio/mixer.h"
+#include "audio/decoders/raw.h"
+
+#include "common/config-manager.h"
+#include "common/debug.h"
+#include "common/endian.h"
+#include "common/fs.h"
+#include "common/md5.h"
+#include "common/memstream.h"
+#include "common/stream.h"
+#include "common/substream.h"
+#include "common/system.h"
+#include "common/textconsole.h"
+#include "common/timer.h"
+
+namespace Audio {
+
+/*
+ * The cache files consist of a header, the rendered samples as 16 bit
+ * little endian PCM, and a trailer. The trailer is only written once the
+ * track has been rendered completely, so interrupted renderings are never
+ * mistaken for finished ones.
+ */
+enum {
+	kHeaderTag = MKTAG('M', 'R', 'C', '1'),
+	kTrailerTag = MKTAG('M', 'R', 'C', 'E'),
+	kHeaderSize = 12,
+	kTrailerSize = 8,
+
+	kTimerInterval = 20000,
+	// Time spent rendering per timer call, in milliseconds. Rendering stops
+	// after the first chunk which takes longer, so the other timer
+	// callbacks are only held up a little.
+	kRenderBudget = 4,
+	// Rendered per timer call at most, in milliseconds of audio
+	kRenderSlice = 250,
+	kRenderChunk = 512,
+	// Reverb and release tails are rendered until this many milliseconds
+	// are silent, or the tail becomes too long
+	kSilenceLength = 500,
+	kMaxTailLength = 10000,
+	kSilenceThreshold = 2,
+	// Guards against tracks which never end
+	kMaxTrackLength = 30 * 60
+};
+
+MidiRenderCache::MidiRenderCache() : _enabled(isConfigured()), _current(0), _timerInstalled(false) {
+	if (_enabled)
+		_directory = Common::FSNode(ConfMan.get("midi_render_cache"));
+}
+
+MidiRenderCache::MidiRenderCache(const Common::FSNode &directory) : _directory(directory), _enabled(true), _current(0), _timerInstalled(false) {
+}
+
+MidiRenderCache::~MidiRenderCache() {
+	if (_timerInstalled)
+		g_system->getTimerManager()->removeTimerProc(timerProc);
+
+	// An interrupted rendering has no trailer, so it is rendered again the
+	// next time
+	if (_current) {
+		_current->driver->setTimerCallback(0, 0);
+		delete _current->file;
+		deleteJob(_current);
+	}
+
+	for (Common::List<Job *>::iterator i = _jobs.begin(); i != _jobs.end(); ++i)
+		deleteJob(*i);
+}
+
+bool MidiRenderCache::isConfigured() {
+	return !ConfMan.get("midi_render_cache").empty();
+}
+
+Common::String MidiRenderCache::getFileName(const byte *data, uint32 size, int track, const Common::String &deviceKey) {
+	Common::MemoryReadStream dataStream(data, size);
+	const Common::String dataMD5 = Common::computeStreamMD5AsString(dataStream);
+
+	// The soft synths render at the output rate of the mixer
+	const Common::String key = Common::String::format("%s|%d|%d|%s", dataMD5.c_str(), track,
+		g_system->getMixer()->getOutputRate(), deviceKey.c_str());
+
+	Common::MemoryReadStream keyStream((const byte *)key.c_str(), key.size());
+	return Common::computeStreamMD5AsString(keyStream) + ".pcm";
+}
+
+SeekableAudioStream *MidiRenderCache::open(const byte *data, uint32 size, int track, const Common::String &deviceKey) const {
+	if (!_enabled)
+		return 0;
+
+	return openFile(getFileName(data, size, track, deviceKey));
+}
+
+SeekableAudioStream *MidiRenderCache::openFile(const Common::String &name) const {
+	const Common::FSNode node = _directory.getChild(name);
+	if (!node.exists())
+		return 0;
+
+	Common::SeekableReadStream *file = node.createReadStream();
+	if (!file)
+		return 0;
+
+	const int32 fileSize = file->size();
+	if (fileSize >= kHeaderSize + kTrailerSize && file->readUint32BE() == kHeaderTag) {
+		const uint32 rate = file->readUint32LE();
+		const uint16 channels = file->readUint16LE();
+		file->skip(2);
+
+		file->seek(fileSize - kTrailerSize);
+		const uint32 tag = file->readUint32BE();
+		const uint32 frames = file->readUint32LE();
+		const int32 dataSize = fileSize - kHeaderSize - kTrailerSize;
+
+		if (tag == kTrailerTag && (channels == 1 || channels == 2) && !file->err() && dataSize == (int32)(frames * channels * 2)) {
+			byte flags = FLAG_16BITS | FLAG_LITTLE_ENDIAN;
+			if (channels == 2)
+				flags |= FLAG_STEREO;
+
+			Common::SeekableReadStream *samples = new Common::SeekableSubReadStream(file, kHeaderSize, kHeaderSize + dataSize, DisposeAfterUse::YES);
+			return makeRawStream(samples, rate, flags, DisposeAfterUse::YES);
+		}
+	}
+
+	debug(3, "MidiRenderCache: Ignoring invalid cache file '%s'", node.getName().c_str());
+	delete file;
+	return 0;
+}
+
+void MidiRenderCache::queue(MidiParser *parser, MidiDriver *driver, const byte *data, uint32 size, int track, const Common::String &deviceKey) {
+	if (!_enabled || !driver) {
+		delete parser;
+		delete driver;
+		return;
+	}
+
+	const Common::String name = getFileName(data, size, track, deviceKey);
+
+	Common::StackLock lock(_mutex);
+
+	bool queued = (_current && _current->name == name);
+	for (Common::List<Job *>::const_iterator i = _jobs.begin(); i != _jobs.end() && !queued; ++i)
+		queued = ((*i)->name == name);
+	for (Common::List<Common::String>::const_iterator i = _failed.begin(); i != _failed.end() && !queued; ++i)
+		queued = (*i == name);
+
+	SeekableAudioStream *cached = queued ? 0 : openFile(name);
+	if (queued || cached) {
+		delete cached;
+		delete parser;
+		delete driver;
+		return;
+	}
+
+	Job *job = new Job();
+	job->name = name;
+	job->parser = parser;
+	job->data = new byte[size];
+	memcpy(job->data, data, size);
+	job->size = size;
+	job->track = track;
+	job->driver = driver;
+	job->isOpen = false;
+	job->stream = 0;
+	job->file = 0;
+	job->frames = 0;
+	job->silentFrames = 0;
+	_jobs.push_back(job);
+
+	if (!_timerInstalled)
+		_timerInstalled = g_system->getTimerManager()->installTimerProc(timerProc, kTimerInterval, this, "MidiRenderCache");
+}
+
+bool MidiRenderCache::isRendering() const {
+	Common::StackLock lock(_mutex);
+	return _current || !_jobs.empty();
+}
+
+bool MidiRenderCache::startJob(Job *job) {
+	job->driver->property(MidiDriver::PROP_DETACHED_STREAM, 1);
+	if (job->driver->open())
+		return false;
+	job->isOpen = true;
+
+	job->stream = job->driver->detachStream();
+	if (!job->stream)
+		return false;
+
+	job->parser->setMidiDriver(job->driver);
+	job->parser->setTimerRate(job->driver->getBaseTempo());
+	job->parser->property(MidiParser::mpAutoLoop, 0);
+	if (!job->parser->loadMusic(job->data, job->size) || !job->parser->setTrack(job->track))
+		return false;
+	job->driver->setTimerCallback(job->parser, MidiParser::timerCallback);
+
+	job->file = _directory.getChild(job->name).createWriteStream();
+	if (!job->file)
+		return false;
+
+	job->file->writeUint32BE(kHeaderTag);
+	job->file->writeUint32LE(job->stream->getRate());
+	job->file->writeUint16LE(job->stream->isStereo() ? 2 : 1);
+	job->file->writeUint16LE(0);
+	return !job->file->err();
+}
+
+bool MidiRenderCache::renderJob(Job *job) {
+	const int channels = job->stream->isStereo() ? 2 : 1;
+	const uint32 rate = job->stream->getRate();
+	int16 buffer[kRenderChunk * 2];
+
+	const uint32 start = g_system->getMillis();
+	const uint32 sliceEnd = job->frames + rate * kRenderSlice / 1000;
+	do {
+		const uint32 frames = kRenderChunk;
+		job->stream->readBuffer(buffer, frames * channels);
+
+		bool silent = true;
+		for (uint32 i = 0; i < frames * channels; ++i) {
+			silent = silent && ABS(buffer[i]) <= kSilenceThreshold;
+			job->file->writeUint16LE(buffer[i]);
+		}
+		job->frames += frames;
+
+		if (job->file->err())
+			return true;
+
+		// Once the track is over, wait for the output to fall silent
+		if (!job->parser->isPlaying()) {
+			job->silentFrames = silent ? job->silentFrames + frames : 0;
+			if (job->silentFrames >= rate * kSilenceLength / 1000 || job->silentFrames >= rate * kMaxTailLength / 1000)
+				return true;
+		}
+
+		if (job->frames >= rate * kMaxTrackLength)
+			return true;
+	} while (job->frames < sliceEnd && g_system->getMillis() - start < kRenderBudget);
+
+	return false;
+}
+
+void MidiRenderCache::finishJob(Job *job, bool success) {
+	job->driver->setTimerCallback(0, 0);
+
+	if (job->file) {
+		if (success) {
+			job->file->writeUint32BE(kTrailerTag);
+			job->file->writeUint32LE(job->frames);
+			job->file->finalize();
+			success = !job->file->err();
+		}
+		delete job->file;
+		job->file = 0;
+	}
+
+	if (!success) {
+		warning("MidiRenderCache: Failed to render track %d to '%s'", job->track, job->name.c_str());
+
+		Common::StackLock lock(_mutex);
+		_failed.push_back(job->name);
+	}
+
+	deleteJob(job);
+}
+
+void MidiRenderCache::deleteJob(Job *job) {
+	// The parser turns off its notes when deleted, so the driver has to
+	// outlive it
+	if (job->parser) {
+		job->parser->unloadMusic();
+		delete job->parser;
+	}
+
+	if (job->isOpen)
+		job->driver->close();
+	delete job->driver;
+
+	delete[] job->data;
+	delete job;
+}
+
+void MidiRenderCache::timerProc(void *refCon) {
+	((MidiRenderCache *)refCon)->onTimer();
+}
+
+void MidiRenderCache::onTimer() {
+	if (!_current) {
+		Common::StackLock lock(_mutex);
+		if (_jobs.empty())
+			return;
+
+		_current = _jobs.front();
+		_jobs.pop_front();
+	}
+
+	bool success = true;
+	if (!_current->file)
+		success = startJob(_current);
+
+	if (!success || renderJob(_current)) {
+		Job *job = _current;
+		{
+			Common::StackLock lock(_mutex);
+			_current = 0;
+		}
+		finishJob(job, success && !job->file->err());
+	}
+}
+
+} // End of namespace Audio
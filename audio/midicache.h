@@ -0,0 +1,162 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+
+#ifndef AUDIO_MIDICACHE_H
+#define AUDIO_MIDICACHE_H
+
+#include "audio/mididrv.h"
+
+#include "common/fs.h"
+#include "common/list.h"
+#include "common/mutex.h"
+#include "common/str.h"
+
+class MidiParser;
+
+namespace Common {
+class WriteStream;
+}
+
+namespace Audio {
+
+class AudioStream;
+class SeekableAudioStream;
+
+/**
+ * Cache of MIDI tracks rendered to PCM on disk.
+ *
+ * Software synths like the MT-32 emulator are expensive, yet games loop the
+ * same few music tracks over and over. This renders a track through its own
+ * instance of the selected music driver once, in the background, and stores
+ * the result in the directory given by the 'midi_render_cache' config key.
+ * Afterwards the track can be played as a plain SeekableAudioStream.
+ *
+ * The rendering is done by the timer callback, a few milliseconds at a
+ * time, so that it does not hold up the other timer callbacks.
+ *
+ * The device is given as a string with everything that changes the output
+ * of the driver, like the device id and its settings, and is part of the
+ * name of the cache files. Audio::MidiPlayer does all of this in
+ * playRenderedTrack(). Typical usage by other music players:
+ * @code
+ * Audio::SeekableAudioStream *stream = _cache.open(data, size, track, deviceKey);
+ * if (stream) {
+ *     // play stream, looped if needed, through the mixer
+ * } else {
+ *     // play through the MidiParser as usual and
+ *     _cache.queue(MidiParser::createParser_SMF(), MidiDriver::createMidi(dev), data, size, track, deviceKey);
+ * }
+ * @endcode
+ *
+ * Only the track itself is rendered, so this is not suitable for music which
+ * depends on driver setup done by the engine (custom instruments, sysEx) or
+ * on callbacks while playing. Only soft synths which play through the mixer
+ * can be rendered, see MidiDriver::detachStream(). AdLib is not supported,
+ * as there can only be one OPL emulator instance at a time.
+ */
+class MidiRenderCache {
+public:
+	/** Create a cache in the directory set by 'midi_render_cache'. */
+	MidiRenderCache();
+
+	/** Create a cache in the given directory. */
+	explicit MidiRenderCache(const Common::FSNode &directory);
+
+	~MidiRenderCache();
+
+	/** Whether a cache directory is configured. */
+	static bool isConfigured();
+
+	/** Whether this cache has a directory to store the tracks in. */
+	bool isEnabled() const { return _enabled; }
+
+	/**
+	 * Open the cached rendering of a track.
+	 *
+	 * @param data       the MIDI data, as passed to MidiParser::loadMusic
+	 * @param size       the size of the MIDI data
+	 * @param track      the track number to play
+	 * @param deviceKey  the music device the track is played on
+	 * @return the rendered track, or 0 if it is not cached (yet)
+	 */
+	SeekableAudioStream *open(const byte *data, uint32 size, int track, const Common::String &deviceKey) const;
+
+	/**
+	 * Queue a track for rendering in the background. Does nothing if the
+	 * track is already cached, queued or failed to render before.
+	 *
+	 * @param parser     a new parser for the data format, ownership is taken
+	 * @param driver     a new driver for the device, not opened yet,
+	 *                   ownership is taken
+	 * @param data       the MIDI data, which is copied
+	 * @param size       the size of the MIDI data
+	 * @param track      the track number to render
+	 * @param deviceKey  the music device to render the track with
+	 */
+	void queue(MidiParser *parser, MidiDriver *driver, const byte *data, uint32 size, int track, const Common::String &deviceKey);
+
+	/** Whether there are tracks left to render. */
+	bool isRendering() const;
+
+private:
+	struct Job {
+		Common::String name;
+		MidiParser *parser;
+		byte *data;
+		uint32 size;
+		int track;
+
+		MidiDriver *driver;
+		bool isOpen;
+		AudioStream *stream;
+		Common::WriteStream *file;
+		uint32 frames;
+		uint32 silentFrames;
+	};
+
+	static Common::String getFileName(const byte *data, uint32 size, int track, const Common::String &deviceKey);
+	SeekableAudioStream *openFile(const Common::String &name) const;
+
+	bool startJob(Job *job);
+	bool renderJob(Job *job);
+	void finishJob(Job *job, bool success);
+	static void deleteJob(Job *job);
+
+	static void timerProc(void *refCon);
+	void onTimer();
+
+	Common::FSNode _directory;
+	bool _enabled;
+
+	mutable Common::Mutex _mutex;
+	Common::List<Job *> _jobs;
+	/** The job being rendered, only changed by the timer callback. */
+	Job *_current;
+	bool _timerInstalled;
+	/** Tracks which could not be rendered, so they are not tried again. */
+	Common::List<Common::String> _failed;
+};
+
+} // End of namespace Audio
+
+#endif
@@ -29,6 +29,10 @@
 
 class MidiChannel;
 
+namespace Audio {
+class AudioStream;
+}
+
 /**
  * Music types that music drivers can implement and engines can rely on.
  */
@@ -119,6 +123,25 @@ public:
 	 */
 	virtual void sysEx(const byte *msg, uint16 length) { }
 
+	/**
+	 * Output a packed midi command, which takes effect the given time after
+	 * the start of the current timer callback. Drivers which render their
+	 * output themselves apply it at the exact sample; the default is to
+	 * send it right away.
+	 *
+	 * This may only be called from the driver's timer callback.
+	 *
+	 * @param b      the packed midi command, as for send()
+	 * @param delay  the delay in microseconds
+	 */
+	virtual void sendDelayed(uint32 b, uint32 delay) { send(b); }
+
+	/**
+	 * Transmit a sysEx, which takes effect the given time after the start of
+	 * the current timer callback. See sendDelayed() and sysEx().
+	 */
+	virtual void sysExDelayed(const byte *msg, uint16 length, uint32 delay) { sysEx(msg, length); }
+
 	// TODO: Document this.
 	virtual void metaEvent(byte type, byte *data, uint16 length) { }
 };
@@ -196,7 +219,10 @@ public:
 		PROP_OLD_ADLIB = 2,
 		PROP_CHANNEL_MASK = 3,
 		// HACK: Not so nice, but our SCUMM AdLib code is in audio/
-		PROP_SCUMM_OPL3 = 4
+		PROP_SCUMM_OPL3 = 4,
+		// Set before open() when the output is going to be pulled through
+		// detachStream() instead of being played in real time
+		PROP_DETACHED_STREAM = 5
 	};
 
 	/**
@@ -216,6 +242,17 @@ public:
 	/** Get or set a property. */
 	virtual uint32 property(int prop, uint32 param) { return 0; }
 
+	/**
+	 * Stop playing the output of an opened driver through the mixer and
+	 * return the stream it renders into instead. The caller then pulls the
+	 * output itself, which also drives the timer callback. Used to render
+	 * music ahead of time, see Audio::MidiRenderCache.
+	 *
+	 * @return the output stream, or 0 if the driver does not produce its
+	 *         output through the mixer (e.g. hardware MIDI devices)
+	 */
+	virtual Audio::AudioStream *detachStream() { return 0; }
+
 	/** Retrieve a string representation of an error code. */
 	static const char *getErrorName(int error_code);
 
@@ -42,6 +42,9 @@ _autoLoop(false),
 _smartJump(false),
 _centerPitchWheelOnUnload(false),
 _sendSustainOffOnNotesOff(false),
+_timestampEvents(false),
+_sendDelayed(false),
+_eventDelay(0),
 _numTracks(0),
 _activeTrack(255),
 _abortParse(false),
@@ -68,11 +71,17 @@ void MidiParser::property(int prop, int value) {
 	case mpSendSustainOffOnNotesOff:
 		_sendSustainOffOnNotesOff = (value != 0);
 		break;
+	case mpTimestampEvents:
+		_timestampEvents = (value != 0);
+		break;
 	}
 }
 
 void MidiParser::sendToDriver(uint32 b) {
-	_driver->send(b);
+	if (_sendDelayed)
+		_driver->sendDelayed(b, _eventDelay);
+	else
+		_driver->send(b);
 }
 
 void MidiParser::setTempo(uint32 tempo) {
@@ -171,6 +180,7 @@ void MidiParser::onTimer() {
 
 	_abortParse = false;
 	endTime = _position._playTime + _timerRate;
+	_sendDelayed = _timestampEvents;
 
 	// Scan our hanging notes for any
 	// that should be turned off.
@@ -180,6 +190,7 @@ void MidiParser::onTimer() {
 		for (i = ARRAYSIZE(_hangingNotes); i; --i, ++ptr) {
 			if (ptr->timeLeft) {
 				if (ptr->timeLeft <= _timerRate) {
+					_eventDelay = ptr->timeLeft;
 					sendToDriver(0x80 | ptr->channel, ptr->note, 0);
 					ptr->timeLeft = 0;
 					--_hangingNotesCount;
@@ -202,6 +213,7 @@ void MidiParser::onTimer() {
 		if (info.event < 0x80) {
 			warning("Bad command or running status %02X", info.event);
 			_position._playPos = 0;
+			_sendDelayed = false;
 			return;
 		}
 
@@ -214,6 +226,8 @@ void MidiParser::onTimer() {
 				activeNote(info.channel(), info.basic.param1, true);
 		}
 
+		_eventDelay = (eventTime > _position._playTime) ? eventTime - _position._playTime : 0;
+
 		// Player::metaEvent() in SCUMM will delete the parser object,
 		// so return immediately if that might have happened.
 		bool ret = processEvent(info);
@@ -226,6 +240,9 @@ void MidiParser::onTimer() {
 		}
 	}
 
+	_sendDelayed = false;
+	_eventDelay = 0;
+
 	if (!_abortParse) {
 		_position._playTime = endTime;
 		_position._playTick = (_position._playTime - _position._lastEventTime) / _psecPerTick + _position._lastEventTick;
@@ -237,16 +254,23 @@ bool MidiParser::processEvent(const EventInfo &info, bool fireEvents) {
 		// SysEx event
 		// Check for trailing 0xF7 -- if present, remove it.
 		if (fireEvents) {
+			uint16 length = (uint16)info.length;
 			if (info.ext.data[info.length-1] == 0xF7)
-				_driver->sysEx(info.ext.data, (uint16)info.length-1);
+				--length;
+
+			if (_sendDelayed)
+				_driver->sysExDelayed(info.ext.data, length, _eventDelay);
 			else
-				_driver->sysEx(info.ext.data, (uint16)info.length);
+				_driver->sysEx(info.ext.data, length);
 		}
 	} else if (info.event == 0xFF) {
 		// META event
 		if (info.ext.type == 0x2F) {
 			// End of Track must be processed by us,
 			// as well as sending it to the output device.
+			// onTimer() returns right away, and the parser might be
+			// deleted by metaEvent(), so stop sending delayed here.
+			_sendDelayed = false;
 			if (_autoLoop) {
 				jumpToTick(0);
 				parseNextEvent(_nextEvent);
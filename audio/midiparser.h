@@ -278,6 +278,9 @@ protected:
 	bool   _smartJump;      ///< Support smart expiration of hanging notes when jumping
 	bool   _centerPitchWheelOnUnload;  ///< Center the pitch wheels when unloading a song
 	bool   _sendSustainOffOnNotesOff;   ///< Send a sustain off on a notes off event, stopping hanging notes
+	bool   _timestampEvents; ///< Send events with their time inside the timer period, see mpTimestampEvents
+	bool   _sendDelayed;    ///< True while onTimer() sends events with _eventDelay
+	uint32 _eventDelay;     ///< Time in microseconds of the current event after the start of the timer period
 	byte  *_tracks[120];    ///< Multi-track MIDI formats are supported, up to 120 tracks.
 	byte   _numTracks;     ///< Count of total tracks for multi-track MIDI formats. 1 for single-track formats.
 	byte   _activeTrack;   ///< Keeps track of the currently active track, in multi-track formats.
@@ -365,7 +368,16 @@ public:
 		 * Sends a sustain off event when a notes off event is triggered.
 		 * Stops hanging notes.
 		 */
-		 mpSendSustainOffOnNotesOff = 5
+		 mpSendSustainOffOnNotesOff = 5,
+
+		/**
+		 * Sends the events due in a timer period through sendDelayed(),
+		 * with their exact time inside the period, instead of all at
+		 * once. Drivers rendering their own output then apply them at
+		 * the right sample, so the timing no longer depends on the timer
+		 * granularity.
+		 */
+		mpTimestampEvents = 6
 	};
 
 public:
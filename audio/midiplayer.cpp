@@ -21,9 +21,12 @@
  */
 
 #include "audio/midiplayer.h"
+#include "audio/audiostream.h"
+#include "audio/midicache.h"
 #include "audio/midiparser.h"
 
 #include "common/config-manager.h"
+#include "common/system.h"
 
 namespace Audio {
 
@@ -34,7 +37,10 @@ MidiPlayer::MidiPlayer() :
 	_isLooping(false),
 	_isPlaying(false),
 	_masterVolume(0),
-	_nativeMT32(false) {
+	_nativeMT32(false),
+	_dev(0),
+	_renderCache(0),
+	_playingRendered(false) {
 
 	memset(_channelsTable, 0, sizeof(_channelsTable));
 	memset(_channelsVolume, 127, sizeof(_channelsVolume));
@@ -49,6 +55,9 @@ MidiPlayer::~MidiPlayer() {
 	// watch out for regressions.
 	stop();
 
+	// The tracks being rendered use drivers of their own
+	delete _renderCache;
+
 	// Unhook & unload the driver
 	if (_driver) {
 		_driver->setTimerCallback(0, 0);
@@ -66,6 +75,46 @@ void MidiPlayer::createDriver(int flags) {
 	assert(_driver);
 	if (_nativeMT32)
 		_driver->property(MidiDriver::PROP_CHANNEL_MASK, 0x03FE);
+
+	// Only the soft synths play through the mixer, so that they can be
+	// rendered ahead of time
+	const Common::String driverId = MidiDriver::getDeviceString(dev, MidiDriver::kDriverId);
+	if (MidiRenderCache::isConfigured() && !_renderCache && (driverId == "mt32" || driverId == "fluidsynth")) {
+		_dev = dev;
+		_renderDeviceKey = Common::String::format("%s|%d|%s|%s", MidiDriver::getDeviceString(dev, MidiDriver::kDeviceId).c_str(),
+			_nativeMT32, ConfMan.get("midi_gain").c_str(), ConfMan.get("soundfont").c_str());
+		_renderCache = new MidiRenderCache();
+	}
+}
+
+bool MidiPlayer::playRenderedTrack(const byte *data, uint32 size, int track, bool loop, MidiParser *renderParser) {
+	if (!_renderCache) {
+		delete renderParser;
+		return false;
+	}
+
+	SeekableAudioStream *stream = _renderCache->open(data, size, track, _renderDeviceKey);
+	if (!stream) {
+		_renderCache->queue(renderParser, MidiDriver::createMidi(_dev), data, size, track, _renderDeviceKey);
+		return false;
+	}
+	delete renderParser;
+
+	Common::StackLock lock(_mutex);
+
+	stop();
+	syncVolume();
+
+	// The rendering was made at full volume, so the master volume is
+	// applied by the mixer
+	Mixer *mixer = g_system->getMixer();
+	mixer->playStream(Mixer::kPlainSoundType, &_renderedHandle, makeLoopingAudioStream(stream, loop ? 0 : 1),
+		-1, _masterVolume);
+
+	_isLooping = loop;
+	_isPlaying = true;
+	_playingRendered = true;
+	return true;
 }
 
 
@@ -77,6 +126,7 @@ void MidiPlayer::setVolume(int volume) {
 	Common::StackLock lock(_mutex);
 
 	_masterVolume = volume;
+	g_system->getMixer()->setChannelVolume(_renderedHandle, _masterVolume);
 	for (int i = 0; i < kNumChannels; ++i) {
 		if (_channelsTable[i]) {
 			_channelsTable[i]->volume(_channelsVolume[i] * _masterVolume / 255);
@@ -155,6 +205,10 @@ void MidiPlayer::onTimer() {
 
 	if (_isPlaying && _parser) {
 		_parser->onTimer();
+	} else if (_isPlaying && _playingRendered && !g_system->getMixer()->isSoundHandleActive(_renderedHandle)) {
+		// A rendered track which was not looped is over
+		_isPlaying = false;
+		_playingRendered = false;
 	}
 }
 
@@ -163,6 +217,8 @@ void MidiPlayer::stop() {
 	Common::StackLock lock(_mutex);
 
 	_isPlaying = false;
+	_playingRendered = false;
+	g_system->getMixer()->stopHandle(_renderedHandle);
 	if (_parser) {
 		_parser->unloadMusic();
 
@@ -184,11 +240,13 @@ void MidiPlayer::pause() {
 //	debugC(2, kDraciSoundDebugLevel, "Pausing track %d", _track);
 	_isPlaying = false;
 	setVolume(-1);	// FIXME: This should be 0, shouldn't it?
+	g_system->getMixer()->pauseHandle(_renderedHandle, true);
 }
 
 void MidiPlayer::resume() {
 //	debugC(2, kDraciSoundDebugLevel, "Resuming track %d", _track);
 	syncVolume();
+	g_system->getMixer()->pauseHandle(_renderedHandle, false);
 	_isPlaying = true;
 }
 
@@ -26,11 +26,14 @@
 #include "common/scummsys.h"
 #include "common/mutex.h"
 #include "audio/mididrv.h"
+#include "audio/mixer.h"
 
 class MidiParser;
 
 namespace Audio {
 
+class MidiRenderCache;
+
 /**
  * Simple MIDI playback class.
  *
@@ -142,6 +145,26 @@ protected:
 	void createDriver(int flags = MDT_MIDI | MDT_ADLIB | MDT_PREFER_GM);
 
 protected:
+	/**
+	 * Play a track rendered by the MIDI render cache instead of through
+	 * the driver, if the 'midi_render_cache' setting is on and the track
+	 * has been rendered before. Otherwise, the track is queued for
+	 * rendering, and the caller plays it through its parser as usual.
+	 *
+	 * This is only meant for music which sounds the same when played by a
+	 * fresh driver, see MidiRenderCache. The driver has to be created by
+	 * createDriver().
+	 *
+	 * @param data          the MIDI data, as passed to MidiParser::loadMusic
+	 * @param size          the size of the MIDI data
+	 * @param track         the track number to play
+	 * @param loop          whether to loop the track
+	 * @param renderParser  a new parser for the data format, used to render
+	 *                      the track, ownership is taken
+	 * @return true if the rendered track is played
+	 */
+	bool playRenderedTrack(const byte *data, uint32 size, int track, bool loop, MidiParser *renderParser);
+
 	enum {
 		/**
 		 * The number of MIDI channels supported.
@@ -180,6 +203,15 @@ protected:
 	int _masterVolume;	// FIXME: byte or int ?
 
 	bool _nativeMT32;
+
+private:
+	MidiDriver::DeviceHandle _dev;
+	MidiRenderCache *_renderCache;
+	/** Identifies the device and its settings in the render cache. */
+	Common::String _renderDeviceKey;
+	/** The track played by playRenderedTrack(). */
+	SoundHandle _renderedHandle;
+	bool _playingRendered;
 };
 
 
@@ -22,6 +22,7 @@
 
 #include "gui/EventRecorder.h"
 
+#include "common/config-manager.h"
 #include "common/util.h"
 #include "common/system.h"
 #include "common/textconsole.h"
@@ -41,10 +42,16 @@ namespace Audio {
 
 /**
  * Channel used by the default Mixer implementation.
+ *
+ * The volume, balance and pause level are engine side settings. The audio
+ * thread only sees their effect, which MixerImpl passes on through the
+ * settings of the slot (see setMixVolumes() and setMixPaused()). In the
+ * other direction, the audio thread publishes the playback position without
+ * any lock (see publishPosition()).
  */
 class Channel {
 public:
-	Channel(Mixer *mixer, Mixer::SoundType type, AudioStream *stream, DisposeAfterUse::Flag autofreeStream, bool reverseStereo, int id, bool permanent);
+	Channel(Mixer *mixer, Mixer::SoundType type, AudioStream *stream, DisposeAfterUse::Flag autofreeStream, bool reverseStereo, int id, bool permanent, ResamplingMode resamplingMode);
 	~Channel();
 
 	/**
@@ -58,10 +65,18 @@ public:
 	 */
 	int mix(int16 *data, uint len);
 
+	/**
+	 * Adds the channel's samples to the given 32 bit buffer, without any
+	 * clamping. The samples keep 8 fractional bits.
+	 *
+	 * @see RateConverter::flowAccumulate
+	 */
+	int mix(int32 *data, uint len);
+
 	/**
 	 * Queries whether the channel is still playing or not.
 	 */
-	bool isFinished() const { return _stream->endOfStream(); }
+	bool isFinished() const { return _stream->endOfStream() && !_converter->hasPendingOutput(); }
 
 	/**
 	 * Queries whether the channel is a permanent channel.
@@ -88,6 +103,17 @@ public:
 	 */
 	bool isPaused() const { return (_pauseLevel != 0); }
 
+	/**
+	 * Sets whether the audio thread skips the channel. Only called by the
+	 * audio thread, or before the channel is handed to it.
+	 */
+	void setMixPaused(bool paused) { _mixPaused = paused; }
+
+	/**
+	 * Queries whether the audio thread skips the channel.
+	 */
+	bool isMixPaused() const { return _mixPaused; }
+
 	/**
 	 * Sets the channel's own volume.
 	 *
@@ -117,10 +143,22 @@ public:
 	int8 getBalance();
 
 	/**
-	 * Notifies the channel that the global sound type
-	 * volume settings changed.
+	 * Computes the effective volume of the left and right channel from
+	 * the channel volume and balance and the sound type settings.
 	 */
-	void notifyGlobalVolChange() { updateChannelVolumes(); }
+	void getEffectiveVolumes(st_volume_t &volL, st_volume_t &volR) const;
+
+	/**
+	 * Sets the effective volumes used for mixing. Only called by the
+	 * audio thread, or before the channel is handed to it.
+	 */
+	void setMixVolumes(st_volume_t volL, st_volume_t volR) { _volL = volL; _volR = volR; }
+
+	/**
+	 * Makes the playback position of the last mix() call visible to
+	 * getElapsedTime(). Only called by the audio thread.
+	 */
+	void publishPosition();
 
 	/**
 	 * Queries how long the channel has been playing.
@@ -154,16 +192,25 @@ private:
 	byte _volume;
 	int8 _balance;
 
-	void updateChannelVolumes();
-	st_volume_t _volL, _volR;
-
 	Mixer *_mixer;
 
+	// Engine side
+	uint32 _pauseStartTime;
+	uint32 _pauseEndTime;
+	uint32 _pauseTime;
+
+	// Audio thread side
+	st_volume_t _volL, _volR;
+	bool _mixPaused;
 	uint32 _samplesConsumed;
 	uint32 _samplesDecoded;
 	uint32 _mixerTimeStamp;
-	uint32 _pauseStartTime;
-	uint32 _pauseTime;
+
+	// Published by the audio thread. The sequence number is odd while the
+	// position is being updated.
+	volatile uint32 _positionSeq;
+	volatile uint32 _publishedSamplesConsumed;
+	volatile uint32 _publishedTimeStamp;
 
 	RateConverter *_converter;
 	Common::DisposablePtr<AudioStream> _stream;
@@ -175,17 +222,44 @@ private:
 
 // TODO: parameter "system" is unused
 MixerImpl::MixerImpl(OSystem *system, uint sampleRate)
-	: _mutex(), _sampleRate(sampleRate), _mixerReady(false), _handleSeed(0), _soundTypeSettings() {
+	: _mutex(), _mixState(kMixIdle), _sampleRate(sampleRate), _resamplingMode(kResamplingLinear), _mixerReady(false), _handleSeed(0),
+	  _soundTypeSettings(), _useMixBus(false), _busSize(0), _limiterGain(1 << 16), _ditherSeed(1),
+	  _commandWrite(0), _commandRead(0), _retiredWrite(0), _retiredRead(0) {
 
 	assert(sampleRate > 0);
 
-	for (int i = 0; i != NUM_CHANNELS; i++)
+	// Like output_rate, this is only configurable through the config file
+	const char *const appDomain = Common::ConfigManager::kApplicationDomain;
+	if (ConfMan.hasKey("audio_resampler", appDomain) && ConfMan.get("audio_resampler", appDomain) == "sinc")
+		_resamplingMode = kResamplingSinc;
+	if (ConfMan.hasKey("audio_mix_bus", appDomain) && ConfMan.get("audio_mix_bus", appDomain) == "int32")
+		_useMixBus = true;
+
+	for (int i = 0; i != NUM_SOUND_TYPES + 1; i++)
+		_buses[i] = 0;
+
+	for (int i = 0; i != NUM_CHANNELS; i++) {
 		_channels[i] = 0;
+		_stoppingChannels[i] = 0;
+		_slotSettings[i] = 0;
+		_mixChannels[i] = 0;
+	}
 }
 
 MixerImpl::~MixerImpl() {
+	// The audio callback is no longer running at this point, so it is safe
+	// to apply the outstanding commands from here. Afterwards every channel
+	// is either in the mix table or in the retired queue.
+	processCommands();
+
+	for (uint32 i = _retiredRead; i != _retiredWrite; i++)
+		delete _retired[i % RETIRED_QUEUE_SIZE];
+
 	for (int i = 0; i != NUM_CHANNELS; i++)
-		delete _channels[i];
+		delete _mixChannels[i];
+
+	for (int i = 0; i != NUM_SOUND_TYPES + 1; i++)
+		free(_buses[i]);
 }
 
 void MixerImpl::setReady(bool ready) {
@@ -199,7 +273,7 @@ uint MixerImpl::getOutputRate() const {
 void MixerImpl::insertChannel(SoundHandle *handle, Channel *chan) {
 	int index = -1;
 	for (int i = 0; i != NUM_CHANNELS; i++) {
-		if (_channels[i] == 0) {
+		if (_channels[i] == 0 && _stoppingChannels[i] == 0) {
 			index = i;
 			break;
 		}
@@ -219,6 +293,130 @@ void MixerImpl::insertChannel(SoundHandle *handle, Channel *chan) {
 	_handleSeed++;
 	if (handle)
 		*handle = chanHandle;
+
+	// The settings of the slot are in place before the audio thread can see
+	// the channel
+	publishSettings(index);
+
+	Command cmd;
+	cmd.type = Command::kCommandInsert;
+	cmd.slot = index;
+	cmd.channel = chan;
+	postCommand(cmd);
+}
+
+uint32 MixerImpl::removeChannel(int slot) {
+	Channel *chan = _channels[slot];
+	assert(chan);
+	assert(!_stoppingChannels[slot]);
+
+	_channels[slot] = 0;
+	_stoppingChannels[slot] = chan;
+
+	Command cmd;
+	cmd.type = Command::kCommandRemove;
+	cmd.slot = slot;
+	cmd.channel = chan;
+	return postCommand(cmd);
+}
+
+void MixerImpl::publishSettings(int slot) {
+	const Channel *chan = _channels[slot];
+
+	st_volume_t volL, volR;
+	chan->getEffectiveVolumes(volL, volR);
+	assert(volL <= kSettingsVolumeMask && volR <= kSettingsVolumeMask);
+
+	uint32 settings = volL | ((uint32)volR << kSettingsVolumeBits);
+	if (chan->isPaused())
+		settings |= kSettingsPaused;
+	Common::atomicStore(&_slotSettings[slot], settings);
+}
+
+void MixerImpl::waitForMixer(uint32 generation) {
+	while ((int32)(Common::atomicLoad(&_commandRead) - generation) < 0) {
+		// If no callback is running, there might be no audio thread at all
+		// (yet), so apply the commands ourselves. The audio thread does not
+		// wait for us meanwhile.
+		if (Common::atomicCompareAndSwap(&_mixState, kMixIdle, kMixEngine)) {
+			processCommands();
+			Common::atomicStore(&_mixState, kMixIdle);
+			return;
+		}
+
+		g_system->delayMillis(1);
+	}
+}
+
+void MixerImpl::collectRetiredChannels() {
+	const uint32 write = Common::atomicLoad(&_retiredWrite);
+
+	// The audio thread never waits for a stream destructor, as it only
+	// hands the channels over
+	for (uint32 read = _retiredRead; read != write; read++) {
+		Channel *chan = _retired[read % RETIRED_QUEUE_SIZE];
+		const int slot = chan->getHandle()._val % NUM_CHANNELS;
+		if (_channels[slot] == chan)
+			_channels[slot] = 0;
+		if (_stoppingChannels[slot] == chan)
+			_stoppingChannels[slot] = 0;
+		delete chan;
+	}
+
+	Common::atomicStore(&_retiredRead, write);
+}
+
+uint32 MixerImpl::postCommand(const Command &cmd) {
+	const uint32 write = _commandWrite;
+	assert(write - Common::atomicLoad(&_commandRead) < COMMAND_QUEUE_SIZE);
+
+	_commands[write % COMMAND_QUEUE_SIZE] = cmd;
+	Common::atomicStore(&_commandWrite, write + 1);
+	return write + 1;
+}
+
+void MixerImpl::processCommands() {
+	const uint32 write = Common::atomicLoad(&_commandWrite);
+
+	for (uint32 read = _commandRead; read != write; read++) {
+		const Command &cmd = _commands[read % COMMAND_QUEUE_SIZE];
+
+		switch (cmd.type) {
+		case Command::kCommandInsert:
+			assert(_mixChannels[cmd.slot] == 0);
+			_mixChannels[cmd.slot] = cmd.channel;
+			break;
+
+		case Command::kCommandRemove:
+			// The channel might have finished and been retired already
+			if (_mixChannels[cmd.slot] == cmd.channel) {
+				_mixChannels[cmd.slot] = 0;
+				retireChannel(cmd.channel);
+			}
+			break;
+		}
+	}
+
+	Common::atomicStore(&_commandRead, write);
+}
+
+void MixerImpl::applySettings() {
+	for (int i = 0; i != NUM_CHANNELS; i++) {
+		if (!_mixChannels[i])
+			continue;
+
+		const uint32 settings = Common::atomicLoad(&_slotSettings[i]);
+		_mixChannels[i]->setMixVolumes(settings & kSettingsVolumeMask, (settings >> kSettingsVolumeBits) & kSettingsVolumeMask);
+		_mixChannels[i]->setMixPaused((settings & kSettingsPaused) != 0);
+	}
+}
+
+void MixerImpl::retireChannel(Channel *chan) {
+	const uint32 write = _retiredWrite;
+	assert(write - Common::atomicLoad(&_retiredRead) < RETIRED_QUEUE_SIZE);
+
+	_retired[write % RETIRED_QUEUE_SIZE] = chan;
+	Common::atomicStore(&_retiredWrite, write + 1);
 }
 
 void MixerImpl::playStream(
@@ -230,6 +428,7 @@ void MixerImpl::playStream(
 			bool permanent,
 			bool reverseStereo) {
 	Common::StackLock lock(_mutex);
+	collectRetiredChannels();
 
 	if (stream == 0) {
 		warning("stream is 0");
@@ -260,7 +459,7 @@ void MixerImpl::playStream(
 #endif
 
 	// Create the channel
-	Channel *chan = new Channel(this, type, stream, autofreeStream, reverseStereo, id, permanent);
+	Channel *chan = new Channel(this, type, stream, autofreeStream, reverseStereo, id, permanent, _resamplingMode);
 	chan->setVolume(volume);
 	chan->setBalance(balance);
 	insertChannel(handle, chan);
@@ -269,8 +468,6 @@ void MixerImpl::playStream(
 int MixerImpl::mixCallback(byte *samples, uint len) {
 	assert(samples);
 
-	Common::StackLock lock(_mutex);
-
 	int16 *buf = (int16 *)samples;
 	// we store stereo, 16-bit samples
 	assert(len % 4 == 0);
@@ -279,66 +476,218 @@ int MixerImpl::mixCallback(byte *samples, uint len) {
 	// Since the mixer callback has been called, the mixer must be ready...
 	_mixerReady = true;
 
+	// Note that no lock is taken here: engine threads communicate with the
+	// audio thread through the command queue and the slot settings only.
+	// An engine thread which applies the commands itself is done after a
+	// handful of instructions, so rather play silence than wait for it.
+	if (!Common::atomicCompareAndSwap(&_mixState, kMixIdle, kMixRunning)) {
+		memset(buf, 0, 2 * len * sizeof(int16));
+		return 0;
+	}
+
+	processCommands();
+	applySettings();
+
+	const int res = _useMixBus ? mixChannelsToBus(buf, len) : mixChannels(buf, len);
+
+	Common::atomicStore(&_mixState, kMixIdle);
+	return res;
+}
+
+int MixerImpl::mixChannels(int16 *buf, uint len) {
 	//  zero the buf
 	memset(buf, 0, 2 * len * sizeof(int16));
 
 	// mix all channels
 	int res = 0, tmp;
 	for (int i = 0; i != NUM_CHANNELS; i++)
-		if (_channels[i]) {
-			if (_channels[i]->isFinished()) {
-				delete _channels[i];
-				_channels[i] = 0;
-			} else if (!_channels[i]->isPaused()) {
-				tmp = _channels[i]->mix(buf, len);
+		if (_mixChannels[i]) {
+			if (_mixChannels[i]->isFinished()) {
+				// Hand the channel back to the engine side, which frees it
+				// outside of the realtime path.
+				retireChannel(_mixChannels[i]);
+				_mixChannels[i] = 0;
+			} else if (!_mixChannels[i]->isMixPaused()) {
+				tmp = _mixChannels[i]->mix(buf, len);
 
 				if (tmp > res)
 					res = tmp;
 			}
 		}
 
+	publishPositions();
 	return res;
 }
 
+int MixerImpl::mixChannelsToBus(int16 *buf, uint len) {
+	// The buffer size normally stays the same between calls, so this only
+	// allocates on the first call.
+	if (len > _busSize) {
+		for (int i = 0; i != NUM_SOUND_TYPES + 1; i++) {
+			free(_buses[i]);
+			_buses[i] = (int32 *)malloc(2 * len * sizeof(int32));
+			if (!_buses[i])
+				error("MixerImpl::mixChannelsToBus: Cannot allocate memory for the mix buses");
+		}
+		_busSize = len;
+	}
+
+	for (int i = 0; i != NUM_SOUND_TYPES; i++)
+		memset(_buses[i], 0, 2 * len * sizeof(int32));
+
+	// mix all channels into the bus of their sound type
+	int res = 0, tmp;
+	for (int i = 0; i != NUM_CHANNELS; i++)
+		if (_mixChannels[i]) {
+			if (_mixChannels[i]->isFinished()) {
+				retireChannel(_mixChannels[i]);
+				_mixChannels[i] = 0;
+			} else if (!_mixChannels[i]->isMixPaused()) {
+				tmp = _mixChannels[i]->mix(_buses[_mixChannels[i]->getType()], len);
+
+				if (tmp > res)
+					res = tmp;
+			}
+		}
+
+	publishPositions();
+
+	renderMasterBus(buf, len);
+
+	return res;
+}
+
+void MixerImpl::publishPositions() {
+	for (int i = 0; i != NUM_CHANNELS; i++)
+		if (_mixChannels[i])
+			_mixChannels[i]->publishPosition();
+}
+
+void MixerImpl::renderMasterBus(int16 *buf, uint len) {
+	// The buses carry 8 fractional bits
+	const int32 threshold = ST_SAMPLE_MAX << 8;
+	const int32 unity = 1 << 16;
+
+	int32 *master = _buses[NUM_SOUND_TYPES];
+	memcpy(master, _buses[0], 2 * len * sizeof(int32));
+	for (int bus = 1; bus != NUM_SOUND_TYPES; bus++)
+		for (uint i = 0; i != 2 * len; i++)
+			master[i] += _buses[bus][i];
+
+	for (uint i = 0; i != len; i++) {
+		int32 sample[2] = { master[2 * i], master[2 * i + 1] };
+
+		// Peak limiter with instant attack and a release time of roughly
+		// 4096 sample pairs.
+		const int32 peak = MAX(ABS(sample[0]), ABS(sample[1]));
+		if (((int64)peak * _limiterGain) >> 16 > threshold)
+			_limiterGain = (int32)(((int64)threshold << 16) / peak);
+
+		if (_limiterGain != unity) {
+			sample[0] = (int32)(((int64)sample[0] * _limiterGain) >> 16);
+			sample[1] = (int32)(((int64)sample[1] * _limiterGain) >> 16);
+			_limiterGain += ((unity - _limiterGain) >> 12) + 1;
+			if (_limiterGain > unity)
+				_limiterGain = unity;
+		}
+
+		for (int c = 0; c != 2; c++) {
+			int32 val = sample[c];
+
+			// Triangular dither of +-1 LSB. Samples without a fractional
+			// part (digital silence, sounds at full volume) stay untouched.
+			if (val & 0xFF) {
+				_ditherSeed = _ditherSeed * 1664525 + 1013904223;
+				val += (int32)((_ditherSeed >> 24) & 0xFF) + (int32)((_ditherSeed >> 16) & 0xFF) - 255;
+			}
+
+			val = CLIP<int32>((val + 0x80) >> 8, ST_SAMPLE_MIN, ST_SAMPLE_MAX);
+
+#ifdef OUTPUT_UNSIGNED_AUDIO
+			buf[2 * i + c] = ((int16)val) ^ 0x8000;
+#else
+			buf[2 * i + c] = (int16)val;
+#endif
+		}
+	}
+}
+
 void MixerImpl::stopAll() {
-	Common::StackLock lock(_mutex);
-	for (int i = 0; i != NUM_CHANNELS; i++) {
-		if (_channels[i] != 0 && !_channels[i]->isPermanent()) {
-			delete _channels[i];
-			_channels[i] = 0;
+	uint32 generation = 0;
+	bool stopped = false;
+	{
+		Common::StackLock lock(_mutex);
+		collectRetiredChannels();
+		for (int i = 0; i != NUM_CHANNELS; i++) {
+			if (_channels[i] != 0 && !_channels[i]->isPermanent()) {
+				generation = removeChannel(i);
+				stopped = true;
+			}
 		}
 	}
+
+	if (!stopped)
+		return;
+
+	// Callers may free the streams as soon as we return
+	waitForMixer(generation);
+
+	Common::StackLock lock(_mutex);
+	collectRetiredChannels();
 }
 
 void MixerImpl::stopID(int id) {
-	Common::StackLock lock(_mutex);
-	for (int i = 0; i != NUM_CHANNELS; i++) {
-		if (_channels[i] != 0 && _channels[i]->getId() == id) {
-			delete _channels[i];
-			_channels[i] = 0;
+	uint32 generation = 0;
+	bool stopped = false;
+	{
+		Common::StackLock lock(_mutex);
+		collectRetiredChannels();
+		for (int i = 0; i != NUM_CHANNELS; i++) {
+			if (_channels[i] != 0 && _channels[i]->getId() == id) {
+				generation = removeChannel(i);
+				stopped = true;
+			}
 		}
 	}
+
+	if (!stopped)
+		return;
+
+	waitForMixer(generation);
+
+	Common::StackLock lock(_mutex);
+	collectRetiredChannels();
 }
 
 void MixerImpl::stopHandle(SoundHandle handle) {
-	Common::StackLock lock(_mutex);
+	uint32 generation;
+	{
+		Common::StackLock lock(_mutex);
+		collectRetiredChannels();
+
+		// Simply ignore stop requests for handles of sounds that already terminated
+		const int index = handle._val % NUM_CHANNELS;
+		if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
+			return;
 
-	// Simply ignore stop requests for handles of sounds that already terminated
-	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
-		return;
+		generation = removeChannel(index);
+	}
 
-	delete _channels[index];
-	_channels[index] = 0;
+	waitForMixer(generation);
+
+	Common::StackLock lock(_mutex);
+	collectRetiredChannels();
 }
 
 void MixerImpl::muteSoundType(SoundType type, bool mute) {
 	assert(0 <= (int)type && (int)type < ARRAYSIZE(_soundTypeSettings));
+
+	Common::StackLock lock(_mutex);
 	_soundTypeSettings[type].mute = mute;
 
 	for (int i = 0; i != NUM_CHANNELS; ++i) {
 		if (_channels[i] && _channels[i]->getType() == type)
-			_channels[i]->notifyGlobalVolChange();
+			publishSettings(i);
 	}
 }
 
@@ -355,9 +704,12 @@ void MixerImpl::setChannelVolume(SoundHandle handle, byte volume) {
 		return;
 
 	_channels[index]->setVolume(volume);
+	publishSettings(index);
 }
 
 byte MixerImpl::getChannelVolume(SoundHandle handle) {
+	Common::StackLock lock(_mutex);
+
 	const int index = handle._val % NUM_CHANNELS;
 	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
 		return 0;
@@ -373,9 +725,12 @@ void MixerImpl::setChannelBalance(SoundHandle handle, int8 balance) {
 		return;
 
 	_channels[index]->setBalance(balance);
+	publishSettings(index);
 }
 
 int8 MixerImpl::getChannelBalance(SoundHandle handle) {
+	Common::StackLock lock(_mutex);
+
 	const int index = handle._val % NUM_CHANNELS;
 	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
 		return 0;
@@ -402,6 +757,7 @@ void MixerImpl::pauseAll(bool paused) {
 	for (int i = 0; i != NUM_CHANNELS; i++) {
 		if (_channels[i] != 0) {
 			_channels[i]->pause(paused);
+			publishSettings(i);
 		}
 	}
 }
@@ -411,6 +767,7 @@ void MixerImpl::pauseID(int id, bool paused) {
 	for (int i = 0; i != NUM_CHANNELS; i++) {
 		if (_channels[i] != 0 && _channels[i]->getId() == id) {
 			_channels[i]->pause(paused);
+			publishSettings(i);
 			return;
 		}
 	}
@@ -425,10 +782,12 @@ void MixerImpl::pauseHandle(SoundHandle handle, bool paused) {
 		return;
 
 	_channels[index]->pause(paused);
+	publishSettings(index);
 }
 
 bool MixerImpl::isSoundIDActive(int id) {
 	Common::StackLock lock(_mutex);
+	collectRetiredChannels();
 
 #ifdef ENABLE_EVENTRECORDER
 	g_eventRec.updateSubsystems();
@@ -442,6 +801,7 @@ bool MixerImpl::isSoundIDActive(int id) {
 
 int MixerImpl::getSoundID(SoundHandle handle) {
 	Common::StackLock lock(_mutex);
+	collectRetiredChannels();
 	const int index = handle._val % NUM_CHANNELS;
 	if (_channels[index] && _channels[index]->getHandle()._val == handle._val)
 		return _channels[index]->getId();
@@ -450,6 +810,7 @@ int MixerImpl::getSoundID(SoundHandle handle) {
 
 bool MixerImpl::isSoundHandleActive(SoundHandle handle) {
 	Common::StackLock lock(_mutex);
+	collectRetiredChannels();
 
 #ifdef ENABLE_EVENTRECORDER
 	g_eventRec.updateSubsystems();
@@ -461,6 +822,7 @@ bool MixerImpl::isSoundHandleActive(SoundHandle handle) {
 
 bool MixerImpl::hasActiveChannelOfType(SoundType type) {
 	Common::StackLock lock(_mutex);
+	collectRetiredChannels();
 	for (int i = 0; i != NUM_CHANNELS; i++)
 		if (_channels[i] && _channels[i]->getType() == type)
 			return true;
@@ -481,7 +843,7 @@ void MixerImpl::setVolumeForSoundType(SoundType type, int volume) {
 
 	for (int i = 0; i != NUM_CHANNELS; ++i) {
 		if (_channels[i] && _channels[i]->getType() == type)
-			_channels[i]->notifyGlobalVolChange();
+			publishSettings(i);
 	}
 }
 
@@ -497,16 +859,18 @@ int MixerImpl::getVolumeForSoundType(SoundType type) const {
 #pragma mark -
 
 Channel::Channel(Mixer *mixer, Mixer::SoundType type, AudioStream *stream,
-                 DisposeAfterUse::Flag autofreeStream, bool reverseStereo, int id, bool permanent)
+                 DisposeAfterUse::Flag autofreeStream, bool reverseStereo, int id, bool permanent,
+                 ResamplingMode resamplingMode)
     : _type(type), _mixer(mixer), _id(id), _permanent(permanent), _volume(Mixer::kMaxChannelVolume),
-      _balance(0), _pauseLevel(0), _samplesConsumed(0), _samplesDecoded(0), _mixerTimeStamp(0),
-      _pauseStartTime(0), _pauseTime(0), _converter(0), _volL(0), _volR(0),
+      _balance(0), _pauseLevel(0), _pauseStartTime(0), _pauseEndTime(0), _pauseTime(0),
+      _volL(0), _volR(0), _mixPaused(false), _samplesConsumed(0), _samplesDecoded(0), _mixerTimeStamp(0),
+      _positionSeq(0), _publishedSamplesConsumed(0), _publishedTimeStamp(0), _converter(0),
       _stream(stream, autofreeStream) {
 	assert(mixer);
 	assert(stream);
 
 	// Get a rate converter instance
-	_converter = makeRateConverter(_stream->getRate(), mixer->getOutputRate(), _stream->isStereo(), reverseStereo);
+	_converter = makeRateConverter(_stream->getRate(), mixer->getOutputRate(), _stream->isStereo(), reverseStereo, resamplingMode);
 }
 
 Channel::~Channel() {
@@ -515,7 +879,6 @@ Channel::~Channel() {
 
 void Channel::setVolume(const byte volume) {
 	_volume = volume;
-	updateChannelVolumes();
 }
 
 byte Channel::getVolume() {
@@ -524,14 +887,13 @@ byte Channel::getVolume() {
 
 void Channel::setBalance(const int8 balance) {
 	_balance = balance;
-	updateChannelVolumes();
 }
 
 int8 Channel::getBalance() {
 	return _balance;
 }
 
-void Channel::updateChannelVolumes() {
+void Channel::getEffectiveVolumes(st_volume_t &volL, st_volume_t &volR) const {
 	// From the channel balance/volume and the global volume, we compute
 	// the effective volume for the left and right channel. Note the
 	// slightly odd divisor: the 255 reflects the fact that the maximal
@@ -544,17 +906,17 @@ void Channel::updateChannelVolumes() {
 		int vol = _mixer->getVolumeForSoundType(_type) * _volume;
 
 		if (_balance == 0) {
-			_volL = vol / Mixer::kMaxChannelVolume;
-			_volR = vol / Mixer::kMaxChannelVolume;
+			volL = vol / Mixer::kMaxChannelVolume;
+			volR = vol / Mixer::kMaxChannelVolume;
 		} else if (_balance < 0) {
-			_volL = vol / Mixer::kMaxChannelVolume;
-			_volR = ((127 + _balance) * vol) / (Mixer::kMaxChannelVolume * 127);
+			volL = vol / Mixer::kMaxChannelVolume;
+			volR = ((127 + _balance) * vol) / (Mixer::kMaxChannelVolume * 127);
 		} else {
-			_volL = ((127 - _balance) * vol) / (Mixer::kMaxChannelVolume * 127);
-			_volR = vol / Mixer::kMaxChannelVolume;
+			volL = ((127 - _balance) * vol) / (Mixer::kMaxChannelVolume * 127);
+			volR = vol / Mixer::kMaxChannelVolume;
 		}
 	} else {
-		_volL = _volR = 0;
+		volL = volR = 0;
 	}
 }
 
@@ -570,29 +932,52 @@ void Channel::pause(bool paused) {
 		_pauseLevel--;
 
 		if (!_pauseLevel) {
-			_pauseTime = (g_system->getMillis(true) - _pauseStartTime);
+			_pauseEndTime = g_system->getMillis(true);
+			_pauseTime = _pauseEndTime - _pauseStartTime;
 			_pauseStartTime = 0;
 		}
 	}
 }
 
+void Channel::publishPosition() {
+	const uint32 seq = _positionSeq;
+	Common::atomicStore(&_positionSeq, seq + 1);
+	Common::atomicStore(&_publishedSamplesConsumed, _samplesConsumed);
+	Common::atomicStore(&_publishedTimeStamp, _mixerTimeStamp);
+	Common::atomicStore(&_positionSeq, seq + 2);
+}
+
 Timestamp Channel::getElapsedTime() {
 	const uint32 rate = _mixer->getOutputRate();
 	uint32 delta = 0;
 
 	Audio::Timestamp ts(0, rate);
 
-	if (_mixerTimeStamp == 0)
+	// The audio thread never waits while it updates the position, so just
+	// retry until we read one which is consistent
+	uint32 seq, samplesConsumed, timeStamp;
+	do {
+		seq = Common::atomicLoad(&_positionSeq);
+		samplesConsumed = Common::atomicLoad(&_publishedSamplesConsumed);
+		timeStamp = Common::atomicLoad(&_publishedTimeStamp);
+	} while ((seq & 1) || Common::atomicLoad(&_positionSeq) != seq);
+
+	if (timeStamp == 0)
 		return ts;
 
-	if (isPaused())
-		delta = _pauseStartTime - _mixerTimeStamp;
-	else
-		delta = g_system->getMillis(true) - _mixerTimeStamp - _pauseTime;
+	if (isPaused()) {
+		delta = _pauseStartTime - timeStamp;
+	} else {
+		delta = g_system->getMillis(true) - timeStamp;
+		// Only the last pause counts, and only if it ended after the last
+		// mixing
+		if ((int32)(timeStamp - _pauseEndTime) < 0)
+			delta -= _pauseTime;
+	}
 
 	// Convert the number of samples into a time duration.
 
-	ts = ts.addFrames(_samplesConsumed);
+	ts = ts.addFrames(samplesConsumed);
 	ts = ts.addMsecs(delta);
 
 	// In theory it would seem like a good idea to limit the approximation
@@ -606,15 +991,13 @@ Timestamp Channel::getElapsedTime() {
 
 int Channel::mix(int16 *data, uint len) {
 	assert(_stream);
+	assert(_converter);
 
+	// The converter may still hold back output after the end of the data
 	int res = 0;
-	if (_stream->endOfData()) {
-		// TODO: call drain method
-	} else {
-		assert(_converter);
+	if (!_stream->endOfData() || _converter->hasPendingOutput()) {
 		_samplesConsumed = _samplesDecoded;
 		_mixerTimeStamp = g_system->getMillis(true);
-		_pauseTime = 0;
 		res = _converter->flow(*_stream, data, len, _volL, _volR);
 		_samplesDecoded += res;
 	}
@@ -622,4 +1005,20 @@ int Channel::mix(int16 *data, uint len) {
 	return res;
 }
 
+int Channel::mix(int32 *data, uint len) {
+	assert(_stream);
+	assert(_converter);
+
+	// The converter may still hold back output after the end of the data
+	int res = 0;
+	if (!_stream->endOfData() || _converter->hasPendingOutput()) {
+		_samplesConsumed = _samplesDecoded;
+		_mixerTimeStamp = g_system->getMillis(true);
+		res = _converter->flowAccumulate(*_stream, data, len, _volL, _volR);
+		_samplesDecoded += res;
+	}
+
+	return res;
+}
+
 } // End of namespace Audio
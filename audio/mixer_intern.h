@@ -24,8 +24,10 @@
 #define AUDIO_MIXER_INTERN_H
 
 #include "common/scummsys.h"
+#include "common/atomic.h"
 #include "common/mutex.h"
 #include "audio/mixer.h"
+#include "audio/rate.h"
 
 namespace Audio {
 
@@ -51,12 +53,63 @@ namespace Audio {
 class MixerImpl : public Mixer {
 private:
 	enum {
-		NUM_CHANNELS = 16
+		NUM_CHANNELS = 16,
+		NUM_SOUND_TYPES = 4,
+		/**
+		 * A stopped channel keeps its slot until it has been freed, so
+		 * every slot has at most the removal of an old channel and the
+		 * insertion and removal of the next one queued at any time.
+		 * Both queue sizes must divide 2^32, as their positions wrap around.
+		 */
+		COMMAND_QUEUE_SIZE = 4 * NUM_CHANNELS,
+		RETIRED_QUEUE_SIZE = 2 * NUM_CHANNELS
 	};
 
+	/**
+	 * Control message posted by engine threads and drained by the audio
+	 * thread at the start of each mixCallback() invocation.
+	 */
+	struct Command {
+		enum Type {
+			kCommandInsert,
+			kCommandRemove
+		};
+
+		Type type;
+		int slot;
+		Channel *channel;
+	};
+
+	/** Owner of the audio thread side state (_mixChannels and the queues) */
+	enum MixState {
+		kMixIdle,
+		/** Inside mixCallback() */
+		kMixRunning,
+		/** An engine thread applies the pending commands (see waitForMixer()) */
+		kMixEngine
+	};
+
+	/** Layout of the per slot settings word (see publishSettings()) */
+	enum {
+		kSettingsVolumeBits = 15,
+		kSettingsVolumeMask = (1 << kSettingsVolumeBits) - 1,
+		kSettingsPaused = 1 << (2 * kSettingsVolumeBits)
+	};
+
+	/**
+	 * Protects the engine side channel table (_channels) and serializes
+	 * all control calls. Never taken by the audio thread.
+	 */
 	Common::Mutex _mutex;
 
+	/**
+	 * A MixState. The audio thread never waits for it: if an engine thread
+	 * owns the state, the callback plays silence.
+	 */
+	volatile uint32 _mixState;
+
 	const uint _sampleRate;
+	ResamplingMode _resamplingMode;
 	bool _mixerReady;
 	uint32 _handleSeed;
 
@@ -67,9 +120,63 @@ private:
 		int volume;
 	};
 
-	SoundTypeSettings _soundTypeSettings[4];
+	SoundTypeSettings _soundTypeSettings[NUM_SOUND_TYPES];
+
+	/**
+	 * Whether channels are mixed into 32 bit buses (with 8 fractional bits)
+	 * instead of directly into the 16 bit output buffer.
+	 */
+	bool _useMixBus;
+
+	/**
+	 * One submix bus per sound type, followed by the master bus. All of them
+	 * hold _busSize interleaved stereo sample pairs. Only used by the audio
+	 * thread.
+	 */
+	int32 *_buses[NUM_SOUND_TYPES + 1];
+	uint _busSize;
+
+	/** Current gain of the output limiter, 16.16 fixed point */
+	int32 _limiterGain;
+	uint32 _ditherSeed;
+
+	/** Engine side view of the channels, indexed by handle slot. */
 	Channel *_channels[NUM_CHANNELS];
 
+	/**
+	 * Channels which have been stopped, but not freed yet. They keep their
+	 * slot until then.
+	 */
+	Channel *_stoppingChannels[NUM_CHANNELS];
+
+	/**
+	 * Effective volumes and pause state of every slot, written by engine
+	 * threads and applied by the audio thread at every mixCallback().
+	 */
+	volatile uint32 _slotSettings[NUM_CHANNELS];
+
+	/** Audio thread side view of the channels. Only touched by mixCallback(). */
+	Channel *_mixChannels[NUM_CHANNELS];
+
+	/**
+	 * Single producer, single consumer queue from the engine threads, which
+	 * post with _mutex held, to the owner of the mix state. Both positions
+	 * only ever grow. Once the read position has passed a command, the
+	 * audio thread is done with it, so the write position after a command
+	 * serves as the generation to wait for (see waitForMixer()).
+	 */
+	Command _commands[COMMAND_QUEUE_SIZE];
+	volatile uint32 _commandWrite;
+	volatile uint32 _commandRead;
+
+	/**
+	 * Channels dropped by the owner of the mix state, waiting to be freed
+	 * by an engine thread with _mutex held. Same scheme as the command queue.
+	 */
+	Channel *_retired[RETIRED_QUEUE_SIZE];
+	volatile uint32 _retiredWrite;
+	volatile uint32 _retiredRead;
+
 
 public:
 
@@ -121,6 +228,65 @@ public:
 protected:
 	void insertChannel(SoundHandle *handle, Channel *chan);
 
+	/**
+	 * Removes the channel in the given slot from the engine side table and
+	 * asks the audio thread to stop mixing it. Must be called with _mutex
+	 * held.
+	 *
+	 * @return the generation to pass to waitForMixer()
+	 */
+	uint32 removeChannel(int slot);
+
+	/**
+	 * Frees all channels the audio thread has dropped since the last call
+	 * and clears their slots in the engine side table. Must be called with
+	 * _mutex held.
+	 */
+	void collectRetiredChannels();
+
+private:
+	/**
+	 * Queues a command for the audio thread. Must be called with _mutex
+	 * held.
+	 *
+	 * @return the generation to pass to waitForMixer()
+	 */
+	uint32 postCommand(const Command &cmd);
+
+	/**
+	 * Passes the current effective volumes and pause state of a channel to
+	 * the audio thread. Must be called with _mutex held.
+	 */
+	void publishSettings(int slot);
+
+	/**
+	 * Waits until the audio thread has applied all commands up to the given
+	 * generation, or applies them itself while no mixCallback() is running.
+	 * Afterwards the audio thread no longer uses any channel removed before,
+	 * so the caller can free it, and with it the stream.
+	 *
+	 * Must be called without _mutex held, as the streams being mixed may
+	 * call into the mixer. For the same reason, sounds must not be stopped
+	 * from within a stream which is being mixed, as that would wait for the
+	 * very callback it is part of.
+	 */
+	void waitForMixer(uint32 generation);
+
+	/** Only called by the owner of the mix state */
+	void processCommands();
+	void applySettings();
+	void retireChannel(Channel *chan);
+
+	int mixChannels(int16 *buf, uint len);
+	void publishPositions();
+	int mixChannelsToBus(int16 *buf, uint len);
+
+	/**
+	 * Sums up the submix buses, then limits and dithers the result down to
+	 * 16 bit in one single pass.
+	 */
+	void renderMasterBus(int16 *buf, uint len);
+
 public:
 	/**
 	 * The mixer callback function, to be called at regular intervals by
@@ -133,6 +299,24 @@ public:
 	 */
 	int mixCallback(byte *samples, uint len);
 
+	/**
+	 * Set the interpolation used for streams which do not match the output
+	 * rate. Only affects streams started afterwards.
+	 * By default it is taken from the 'audio_resampler' config key.
+	 */
+	void setResamplingMode(ResamplingMode mode) { _resamplingMode = mode; }
+	ResamplingMode getResamplingMode() const { return _resamplingMode; }
+
+	/**
+	 * Enable or disable mixing through 32 bit buses. When enabled, every
+	 * sound type is mixed into its own submix bus without clipping, and
+	 * limiting and dithering down to 16 bit happens only once per buffer.
+	 * By default it is enabled when the 'audio_mix_bus' config key is set
+	 * to "int32".
+	 */
+	void setMixBusEnabled(bool enable) { _useMixBus = enable; }
+	bool isMixBusEnabled() const { return _useMixBus; }
+
 	/**
 	 * Set the internal 'is ready' flag of the mixer.
 	 * Backends should invoke Mixer::setReady(true) once initialisation of
@@ -4,6 +4,7 @@ MODULE_OBJS := \
 	adlib.o \
 	audiostream.o \
 	fmopl.o \
+	midicache.o \
 	mididrv.o \
 	midiparser_qt.o \
 	midiparser_smf.o \
@@ -16,6 +17,8 @@ MODULE_OBJS := \
 	mpu401.o \
 	musicplugin.o \
 	null.o \
+	rate_simd.o \
+	soundcache.o \
 	timestamp.o \
 	decoders/3do.o \
 	decoders/aac.o \
@@ -43,6 +46,7 @@ MODULE_OBJS := \
 	mods/soundfx.o \
 	mods/tfmx.o \
 	softsynth/cms.o \
+	softsynth/emumidi.o \
 	softsynth/opl/dbopl.o \
 	softsynth/opl/dosbox.o \
 	softsynth/opl/mame.o \
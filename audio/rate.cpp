@@ -30,11 +30,23 @@
 
 #include "audio/audiostream.h"
 #include "audio/rate.h"
+#include "audio/rate_simd.h"
 #include "audio/mixer.h"
+#include "common/array.h"
 #include "common/frac.h"
+#include "common/mutex.h"
+#include "common/singleton.h"
 #include "common/textconsole.h"
 #include "common/util.h"
 
+namespace Audio {
+class SincFilterBankCache;
+}
+
+namespace Common {
+DECLARE_SINGLETON(Audio::SincFilterBankCache);
+}
+
 namespace Audio {
 
 
@@ -46,6 +58,12 @@ namespace Audio {
  */
 #define INTERMEDIATE_BUFFER_SIZE 512
 
+/**
+ * The size of the buffer the resampled (but not yet volume adjusted)
+ * output is collected in before it gets mixed into the output buffer.
+ */
+#define MIX_BUFFER_SIZE 512
+
 /**
  * The default fractional type in frac.h (with 16 fractional bits) limits
  * the rate conversion code to 65536Hz audio: we need to able to handle
@@ -57,6 +75,54 @@ enum {
 	FRAC_HALF_LOW = (1L << (FRAC_BITS_LOW-1))
 };
 
+/**
+ * Mixes resampled stereo data into the output buffer. The samples in buf
+ * are expected to be in output channel order already, i.e. with reversed
+ * stereo the left input channel is stored second. The volumes are swapped
+ * accordingly so that vol_l still applies to the left input channel.
+ */
+template<bool reverseStereo>
+static inline void mixResampled(st_sample_t *obuf, const st_sample_t *buf, st_size_t len, st_volume_t vol_l, st_volume_t vol_r) {
+	if (reverseStereo)
+		mixStereoSamples(obuf, buf, len, vol_r, vol_l);
+	else
+		mixStereoSamples(obuf, buf, len, vol_l, vol_r);
+}
+
+/**
+ * Same as above, but accumulating into a 32 bit buffer.
+ */
+template<bool reverseStereo>
+static inline void mixResampled(int32 *obuf, const st_sample_t *buf, st_size_t len, st_volume_t vol_l, st_volume_t vol_r) {
+	if (reverseStereo)
+		accumulateStereoSamples(obuf, buf, len, vol_r, vol_l);
+	else
+		accumulateStereoSamples(obuf, buf, len, vol_l, vol_r);
+}
+
+/**
+ * Resamples through the converter's resample() method in chunks of
+ * MIX_BUFFER_SIZE and mixes each chunk into the output buffer.
+ */
+template<bool reverseStereo, class Converter, typename OutputT>
+static int flowResampled(Converter &converter, AudioStream &input, OutputT *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
+	st_sample_t mixBuf[MIX_BUFFER_SIZE];
+	st_size_t done = 0;
+
+	while (done < osamp) {
+		const st_size_t len = MIN<st_size_t>(osamp - done, MIX_BUFFER_SIZE / 2);
+		const st_size_t res = converter.resample(input, mixBuf, len);
+
+		mixResampled<reverseStereo>(obuf + done * 2, mixBuf, res, vol_l, vol_r);
+		done += res;
+
+		if (res < len)
+			break;
+	}
+
+	return done;
+}
+
 /**
  * Audio rate converter based on simple resampling. Used when no
  * interpolation is required.
@@ -79,7 +145,13 @@ protected:
 
 public:
 	SimpleRateConverter(st_rate_t inrate, st_rate_t outrate);
-	int flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r);
+	st_size_t resample(AudioStream &input, st_sample_t *obuf, st_size_t osamp);
+	int flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
+		return flowResampled<reverseStereo>(*this, input, obuf, osamp, vol_l, vol_r);
+	}
+	int flowAccumulate(AudioStream &input, int32 *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
+		return flowResampled<reverseStereo>(*this, input, obuf, osamp, vol_l, vol_r);
+	}
 	int drain(st_sample_t *obuf, st_size_t osamp, st_volume_t vol) {
 		return ST_SUCCESS;
 	}
@@ -108,11 +180,12 @@ SimpleRateConverter<stereo, reverseStereo>::SimpleRateConverter(st_rate_t inrate
 }
 
 /*
- * Processed signed long samples from ibuf to obuf.
+ * Resample signed long samples from the input into obuf, without applying
+ * any volume.
  * Return number of sample pairs processed.
  */
 template<bool stereo, bool reverseStereo>
-int SimpleRateConverter<stereo, reverseStereo>::flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
+st_size_t SimpleRateConverter<stereo, reverseStereo>::resample(AudioStream &input, st_sample_t *obuf, st_size_t osamp) {
 	st_sample_t *ostart, *oend;
 
 	ostart = obuf;
@@ -144,10 +217,10 @@ int SimpleRateConverter<stereo, reverseStereo>::flow(AudioStream &input, st_samp
 		opos += opos_inc;
 
 		// output left channel
-		clampedAdd(obuf[reverseStereo    ], (out0 * (int)vol_l) / Audio::Mixer::kMaxMixerVolume);
+		obuf[reverseStereo    ] = out0;
 
 		// output right channel
-		clampedAdd(obuf[reverseStereo ^ 1], (out1 * (int)vol_r) / Audio::Mixer::kMaxMixerVolume);
+		obuf[reverseStereo ^ 1] = out1;
 
 		obuf += 2;
 	}
@@ -185,7 +258,13 @@ protected:
 
 public:
 	LinearRateConverter(st_rate_t inrate, st_rate_t outrate);
-	int flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r);
+	st_size_t resample(AudioStream &input, st_sample_t *obuf, st_size_t osamp);
+	int flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
+		return flowResampled<reverseStereo>(*this, input, obuf, osamp, vol_l, vol_r);
+	}
+	int flowAccumulate(AudioStream &input, int32 *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
+		return flowResampled<reverseStereo>(*this, input, obuf, osamp, vol_l, vol_r);
+	}
 	int drain(st_sample_t *obuf, st_size_t osamp, st_volume_t vol) {
 		return ST_SUCCESS;
 	}
@@ -217,11 +296,12 @@ LinearRateConverter<stereo, reverseStereo>::LinearRateConverter(st_rate_t inrate
 }
 
 /*
- * Processed signed long samples from ibuf to obuf.
+ * Resample signed long samples from the input into obuf, without applying
+ * any volume.
  * Return number of sample pairs processed.
  */
 template<bool stereo, bool reverseStereo>
-int LinearRateConverter<stereo, reverseStereo>::flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
+st_size_t LinearRateConverter<stereo, reverseStereo>::resample(AudioStream &input, st_sample_t *obuf, st_size_t osamp) {
 	st_sample_t *ostart, *oend;
 
 	ostart = obuf;
@@ -259,10 +339,10 @@ int LinearRateConverter<stereo, reverseStereo>::flow(AudioStream &input, st_samp
 						  out0);
 
 			// output left channel
-			clampedAdd(obuf[reverseStereo    ], (out0 * (int)vol_l) / Audio::Mixer::kMaxMixerVolume);
+			obuf[reverseStereo    ] = out0;
 
 			// output right channel
-			clampedAdd(obuf[reverseStereo ^ 1], (out1 * (int)vol_r) / Audio::Mixer::kMaxMixerVolume);
+			obuf[reverseStereo ^ 1] = out1;
 
 			obuf += 2;
 
@@ -277,6 +357,366 @@ int LinearRateConverter<stereo, reverseStereo>::flow(AudioStream &input, st_samp
 #pragma mark -
 
 
+/**
+ * Number of taps of every phase of the sinc filter. Must be a multiple of 8
+ * to suit the dot product kernels.
+ */
+#define SINC_TAPS 16
+
+/**
+ * Maximal number of phases in the sinc filter bank. Ratios which need at
+ * most that many phases (which covers all the usual combinations of
+ * 11025/22050/44100 Hz input and 44100/48000 Hz output) are resampled
+ * exactly, others use the nearest precomputed phase.
+ */
+#define SINC_MAX_PHASES 1024
+
+/**
+ * Number of unused sinc filter banks kept, for sounds which are played one
+ * after another.
+ */
+#define SINC_MAX_UNUSED_BANKS 4
+
+/**
+ * Precomputed sinc filter bank for the ratio inrate:outrate = step:phases
+ * (reduced), SINC_TAPS coefficients per bank phase. It does not change once
+ * it is built, so all converters with the same ratio share it.
+ */
+struct SincFilterBank {
+	enum {
+		kCoeffBits = 14
+	};
+
+	uint32 step;
+	uint32 phases;
+	uint32 bankPhases;
+	int16 *coeffs;
+
+	/** The number of converters using the bank */
+	uint refCount;
+
+	SincFilterBank(uint32 step_, uint32 phases_);
+	~SincFilterBank() {
+		delete[] coeffs;
+	}
+};
+
+/*
+ * Precompute one Blackman windowed sinc filter for each sub-sample offset,
+ * which is the only place floating point arithmetic is used.
+ */
+SincFilterBank::SincFilterBank(uint32 step_, uint32 phases_)
+	: step(step_), phases(phases_), bankPhases(MIN<uint32>(phases_, SINC_MAX_PHASES)), refCount(0) {
+	// Cutoff relative to the input Nyquist frequency. Slightly below the
+	// output Nyquist frequency when downsampling, to leave room for the
+	// transition band of the short filter.
+	const double cutoff = (step > phases) ? 0.95 * phases / step : 1.0;
+
+	coeffs = new int16[bankPhases * SINC_TAPS];
+	for (uint32 p = 0; p < bankPhases; ++p) {
+		double taps[SINC_TAPS];
+		double sum = 0.0;
+
+		for (int k = 0; k < SINC_TAPS; ++k) {
+			// Distance of tap k to the output position
+			const double x = (k - SINC_TAPS / 2 + 1) - (double)p / bankPhases;
+			const double sincX = M_PI * cutoff * x;
+			const double windowX = M_PI * x / (SINC_TAPS / 2);
+
+			taps[k] = (x == 0.0) ? 1.0 : sin(sincX) / sincX;
+			taps[k] *= (fabs(x) >= SINC_TAPS / 2) ? 0.0 : 0.42 + 0.5 * cos(windowX) + 0.08 * cos(2 * windowX);
+			sum += taps[k];
+		}
+
+		// Normalize every phase to unity gain, to avoid DC ripple
+		for (int k = 0; k < SINC_TAPS; ++k)
+			coeffs[p * SINC_TAPS + k] = (int16)floor(taps[k] / sum * (1 << kCoeffBits) + 0.5);
+	}
+}
+
+/**
+ * The sinc filter banks in use, and a few unused ones. Converters are
+ * created and destroyed on the mixer thread as well, so the list is
+ * guarded by a mutex.
+ */
+class SincFilterBankCache : public Common::Singleton<SincFilterBankCache> {
+public:
+	~SincFilterBankCache() {
+		for (uint i = 0; i < _banks.size(); ++i)
+			delete _banks[i];
+	}
+
+	/**
+	 * Return the bank for the given ratio, building it if there is none.
+	 * Every call has to be matched by a call to release().
+	 */
+	const SincFilterBank *acquire(uint32 step, uint32 phases);
+
+	void release(const SincFilterBank *bank);
+
+private:
+	friend class Common::Singleton<SincFilterBankCache>;
+	SincFilterBankCache() {}
+
+	Common::Mutex _mutex;
+	/** The banks, the unused ones in the order they were released */
+	Common::Array<SincFilterBank *> _banks;
+};
+
+const SincFilterBank *SincFilterBankCache::acquire(uint32 step, uint32 phases) {
+	Common::StackLock lock(_mutex);
+
+	for (uint i = 0; i < _banks.size(); ++i) {
+		if (_banks[i]->step == step && _banks[i]->phases == phases) {
+			_banks[i]->refCount++;
+			return _banks[i];
+		}
+	}
+
+	SincFilterBank *bank = new SincFilterBank(step, phases);
+	bank->refCount = 1;
+	_banks.push_back(bank);
+	return bank;
+}
+
+void SincFilterBankCache::release(const SincFilterBank *bank) {
+	Common::StackLock lock(_mutex);
+
+	for (uint i = 0; i < _banks.size(); ++i) {
+		if (_banks[i] != bank)
+			continue;
+
+		if (--_banks[i]->refCount != 0)
+			return;
+
+		// Move it behind the ones released earlier
+		_banks.push_back(_banks[i]);
+		_banks.remove_at(i);
+		break;
+	}
+
+	// Drop the bank released first when too many are unused
+	uint unused = 0;
+	uint first = 0;
+	for (uint i = 0; i < _banks.size(); ++i) {
+		if (_banks[i]->refCount == 0 && unused++ == 0)
+			first = i;
+	}
+
+	if (unused > SINC_MAX_UNUSED_BANKS) {
+		delete _banks[first];
+		_banks.remove_at(first);
+	}
+}
+
+/**
+ * Audio rate converter based on a polyphase windowed sinc filter.
+ *
+ * For the ratio inrate:outrate = step:phases (reduced), output sample i is
+ * located at input position i * step / phases, so only 'phases' distinct
+ * sub-sample offsets ever occur. The filters for them come from a
+ * SincFilterBank shared with the other converters of the same ratio. When
+ * downsampling, the cutoff is lowered to the output Nyquist frequency.
+ */
+template<bool stereo, bool reverseStereo>
+class SincRateConverter : public RateConverter {
+protected:
+	enum {
+		kHistorySize = INTERMEDIATE_BUFFER_SIZE + SINC_TAPS,
+		kCoeffBits = SincFilterBank::kCoeffBits
+	};
+
+	st_sample_t inBuf[INTERMEDIATE_BUFFER_SIZE];
+
+	/** deinterleaved input samples, the filter window starts at pos */
+	st_sample_t history[stereo ? 2 : 1][kHistorySize];
+	uint historyLen;
+	uint pos;
+
+	/** whether the silence after the end of the input was appended */
+	bool flushed;
+
+	/** position between two input samples, in units of 1 / phases */
+	uint32 phase;
+	uint32 phases;
+	uint32 step;
+
+	/** shared filter bank, SINC_TAPS coefficients per bank phase */
+	const SincFilterBank *bank;
+	const int16 *coeffs;
+	uint32 bankPhases;
+
+	DotProductProc dotProduct;
+
+	bool refill(AudioStream &input);
+	void flush();
+
+public:
+	SincRateConverter(st_rate_t inrate, st_rate_t outrate);
+	~SincRateConverter() {
+		SincFilterBankCache::instance().release(bank);
+	}
+
+	st_size_t resample(AudioStream &input, st_sample_t *obuf, st_size_t osamp);
+	int flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
+		return flowResampled<reverseStereo>(*this, input, obuf, osamp, vol_l, vol_r);
+	}
+	int flowAccumulate(AudioStream &input, int32 *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
+		return flowResampled<reverseStereo>(*this, input, obuf, osamp, vol_l, vol_r);
+	}
+	int drain(st_sample_t *obuf, st_size_t osamp, st_volume_t vol) {
+		return ST_SUCCESS;
+	}
+	bool hasPendingOutput() const {
+		return !flushed || pos + SINC_TAPS <= historyLen;
+	}
+};
+
+static uint32 greatestCommonDivisor(uint32 a, uint32 b) {
+	while (b) {
+		const uint32 t = a % b;
+		a = b;
+		b = t;
+	}
+	return a;
+}
+
+/*
+ * Prepare processing.
+ */
+template<bool stereo, bool reverseStereo>
+SincRateConverter<stereo, reverseStereo>::SincRateConverter(st_rate_t inrate, st_rate_t outrate) {
+	if (inrate >= 131072 || outrate >= 131072) {
+		error("rate effect can only handle rates < 131072");
+	}
+
+	const uint32 gcd = greatestCommonDivisor(inrate, outrate);
+	phases = outrate / gcd;
+	step = inrate / gcd;
+
+	bank = SincFilterBankCache::instance().acquire(step, phases);
+	coeffs = bank->coeffs;
+	bankPhases = bank->bankPhases;
+
+	dotProduct = getDotProductProc(getBestMixKernel());
+
+	// Start with SINC_TAPS / 2 - 1 samples of silence, so that the first
+	// output sample is centered on the first input sample.
+	memset(history, 0, sizeof(history));
+	historyLen = SINC_TAPS / 2 - 1;
+	pos = 0;
+	phase = 0;
+	flushed = false;
+}
+
+/*
+ * Append new input samples to the history, dropping the ones which are no
+ * longer covered by the filter window.
+ * Return false if the input stream ran out of data.
+ */
+template<bool stereo, bool reverseStereo>
+bool SincRateConverter<stereo, reverseStereo>::refill(AudioStream &input) {
+	const int channels = stereo ? 2 : 1;
+
+	if (pos >= historyLen) {
+		// When downsampling the window might already be ahead of all
+		// the samples we have. The remaining distance gets skipped once
+		// the new samples are in.
+		pos -= historyLen;
+		historyLen = 0;
+	} else {
+		for (int c = 0; c < channels; ++c)
+			memmove(history[c], history[c] + pos, (historyLen - pos) * sizeof(st_sample_t));
+		historyLen -= pos;
+		pos = 0;
+	}
+
+	const int len = input.readBuffer(inBuf, MIN<int>(kHistorySize - historyLen, INTERMEDIATE_BUFFER_SIZE / channels) * channels);
+	if (len <= 0)
+		return false;
+
+	const st_sample_t *inPtr = inBuf;
+	for (int i = 0; i < len / channels; ++i) {
+		history[0][historyLen] = *inPtr++;
+		if (stereo)
+			history[1][historyLen] = *inPtr++;
+		historyLen++;
+	}
+
+	return true;
+}
+
+/*
+ * Append SINC_TAPS / 2 samples of silence, so that the filter window can
+ * move over the last input samples, like it started with silence before
+ * the first ones.
+ */
+template<bool stereo, bool reverseStereo>
+void SincRateConverter<stereo, reverseStereo>::flush() {
+	const int channels = stereo ? 2 : 1;
+
+	// refill() just made room for more than a whole window
+	assert(historyLen + SINC_TAPS / 2 <= kHistorySize);
+	for (int c = 0; c < channels; ++c)
+		memset(history[c] + historyLen, 0, SINC_TAPS / 2 * sizeof(st_sample_t));
+	historyLen += SINC_TAPS / 2;
+	flushed = true;
+}
+
+/*
+ * Resample signed long samples from the input into obuf, without applying
+ * any volume.
+ * Return number of sample pairs processed.
+ */
+template<bool stereo, bool reverseStereo>
+st_size_t SincRateConverter<stereo, reverseStereo>::resample(AudioStream &input, st_sample_t *obuf, st_size_t osamp) {
+	st_sample_t *ostart, *oend;
+
+	ostart = obuf;
+	oend = obuf + osamp * 2;
+
+	while (obuf < oend) {
+		// make sure the whole filter window is available
+		while (pos + SINC_TAPS > historyLen) {
+			if (refill(input))
+				continue;
+
+			// Streams which only ran dry for now, like queuing
+			// streams, continue where they left off later on
+			if (flushed || !input.endOfStream())
+				return (obuf - ostart) / 2;
+			flush();
+		}
+
+		const int16 *filter = coeffs + ((bankPhases == phases) ? phase : phase * bankPhases / phases) * SINC_TAPS;
+		const int32 round = 1 << (kCoeffBits - 1);
+
+		st_sample_t out0, out1;
+		out0 = (st_sample_t)CLIP<int32>((dotProduct(history[0] + pos, filter, SINC_TAPS) + round) >> kCoeffBits, ST_SAMPLE_MIN, ST_SAMPLE_MAX);
+		out1 = (stereo ?
+		        (st_sample_t)CLIP<int32>((dotProduct(history[stereo ? 1 : 0] + pos, filter, SINC_TAPS) + round) >> kCoeffBits, ST_SAMPLE_MIN, ST_SAMPLE_MAX) :
+		        out0);
+
+		// output left channel
+		obuf[reverseStereo    ] = out0;
+
+		// output right channel
+		obuf[reverseStereo ^ 1] = out1;
+
+		obuf += 2;
+
+		// Increment output position
+		phase += step;
+		pos += phase / phases;
+		phase %= phases;
+	}
+	return (obuf - ostart) / 2;
+}
+
+
+#pragma mark -
+
+
 /**
  * Simple audio rate converter for the case that the inrate equals the outrate.
  */
@@ -290,46 +730,63 @@ public:
 		free(_buffer);
 	}
 
-	virtual int flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
+	/**
+	 * Read up to 'osamp' sample pairs into our temporary buffer, in output
+	 * channel order.
+	 * Return number of sample pairs read.
+	 */
+	st_size_t read(AudioStream &input, st_size_t osamp) {
 		assert(input.isStereo() == stereo);
 
-		st_sample_t *ptr;
 		st_size_t len;
 
-		st_sample_t *ostart = obuf;
-
-		if (stereo)
-			osamp *= 2;
-
-		// Reallocate temp buffer, if necessary
-		if (osamp > _bufferSize) {
+		// Reallocate temp buffer, if necessary. It always has to hold
+		// 'osamp' sample pairs, since mono input gets expanded in place.
+		if (osamp * 2 > _bufferSize) {
 			free(_buffer);
-			_buffer = (st_sample_t *)malloc(osamp * 2);
-			_bufferSize = osamp;
+			_buffer = (st_sample_t *)malloc(osamp * 2 * sizeof(st_sample_t));
+			_bufferSize = osamp * 2;
 		}
 
 		if (!_buffer)
 			error("[CopyRateConverter::flow] Cannot allocate memory for temp buffer");
 
-		// Read up to 'osamp' samples into our temporary buffer
-		len = input.readBuffer(_buffer, osamp);
+		if (stereo) {
+			const int res = input.readBuffer(_buffer, osamp * 2);
+			len = (res > 0) ? res / 2 : 0;
 
-		// Mix the data into the output buffer
-		ptr = _buffer;
-		for (; len > 0; len -= (stereo ? 2 : 1)) {
-			st_sample_t out0, out1;
-			out0 = *ptr++;
-			out1 = (stereo ? *ptr++ : out0);
+			if (reverseStereo) {
+				for (st_size_t i = 0; i < len; ++i)
+					SWAP(_buffer[i * 2], _buffer[i * 2 + 1]);
+			}
+		} else {
+			// Read up to 'osamp' samples into the upper half of our temporary
+			// buffer and duplicate them into sample pairs. Every write stays
+			// behind the samples which still have to be read.
+			st_sample_t *ptr = _buffer + osamp;
+			const int res = input.readBuffer(ptr, osamp);
+			len = (res > 0) ? res : 0;
+
+			for (st_size_t i = 0; i < len; ++i)
+				_buffer[i * 2] = _buffer[i * 2 + 1] = ptr[i];
+		}
 
-			// output left channel
-			clampedAdd(obuf[reverseStereo    ], (out0 * (int)vol_l) / Audio::Mixer::kMaxMixerVolume);
+		return len;
+	}
 
-			// output right channel
-			clampedAdd(obuf[reverseStereo ^ 1], (out1 * (int)vol_r) / Audio::Mixer::kMaxMixerVolume);
+	virtual int flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
+		const st_size_t len = read(input, osamp);
 
-			obuf += 2;
-		}
-		return (obuf - ostart) / 2;
+		// Mix the data into the output buffer
+		mixResampled<reverseStereo>(obuf, _buffer, len, vol_l, vol_r);
+		return len;
+	}
+
+	virtual int flowAccumulate(AudioStream &input, int32 *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
+		const st_size_t len = read(input, osamp);
+
+		mixResampled<reverseStereo>(obuf, _buffer, len, vol_l, vol_r);
+		return len;
 	}
 
 	virtual int drain(st_sample_t *obuf, st_size_t osamp, st_volume_t vol) {
@@ -341,9 +798,11 @@ public:
 #pragma mark -
 
 template<bool stereo, bool reverseStereo>
-RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate) {
+RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate, ResamplingMode mode) {
 	if (inrate != outrate) {
-		if ((inrate % outrate) == 0 && (inrate < 65536)) {
+		if (mode == kResamplingSinc) {
+			return new SincRateConverter<stereo, reverseStereo>(inrate, outrate);
+		} else if ((inrate % outrate) == 0 && (inrate < 65536)) {
 			return new SimpleRateConverter<stereo, reverseStereo>(inrate, outrate);
 		} else {
 			return new LinearRateConverter<stereo, reverseStereo>(inrate, outrate);
@@ -356,14 +815,14 @@ RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate) {
 /**
  * Create and return a RateConverter object for the specified input and output rates.
  */
-RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate, bool stereo, bool reverseStereo) {
+RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate, bool stereo, bool reverseStereo, ResamplingMode mode) {
 	if (stereo) {
 		if (reverseStereo)
-			return makeRateConverter<true, true>(inrate, outrate);
+			return makeRateConverter<true, true>(inrate, outrate, mode);
 		else
-			return makeRateConverter<true, false>(inrate, outrate);
+			return makeRateConverter<true, false>(inrate, outrate, mode);
 	} else
-		return makeRateConverter<false, false>(inrate, outrate);
+		return makeRateConverter<false, false>(inrate, outrate, mode);
 }
 
 } // End of namespace Audio
@@ -75,10 +75,48 @@ public:
 	 */
 	virtual int flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) = 0;
 
+	/**
+	 * Like flow(), but adds the samples to a 32 bit buffer without any
+	 * clamping. The samples are multiplied by the volumes, but not divided
+	 * by Mixer::kMaxMixerVolume, so the output has 8 fractional bits.
+	 *
+	 * @return Number of sample pairs written into the buffer.
+	 */
+	virtual int flowAccumulate(AudioStream &input, int32 *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) = 0;
+
 	virtual int drain(st_sample_t *obuf, st_size_t osamp, st_volume_t vol) = 0;
+
+	/**
+	 * Whether the converter still holds back output for input it has
+	 * read already, which flow() returns once the stream has ended.
+	 */
+	virtual bool hasPendingOutput() const { return false; }
 };
 
-RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate, bool stereo, bool reverseStereo = false);
+/**
+ * The interpolation used by a RateConverter when the input and output rates
+ * differ.
+ */
+enum ResamplingMode {
+	/**
+	 * Nearest neighbour for integral downsampling ratios, linear
+	 * interpolation otherwise. Cheap, but aliases noticeably.
+	 */
+	kResamplingLinear = 0,
+
+	/**
+	 * Polyphase windowed sinc filter. Considerably more expensive, but
+	 * mostly free of aliasing when upsampling low rate game samples.
+	 */
+	kResamplingSinc
+};
+
+/**
+ * Create and return a RateConverter object for the specified input and output rates.
+ *
+ * @note Builds using the ARM assembly converters ignore the mode parameter.
+ */
+RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate, bool stereo, bool reverseStereo = false, ResamplingMode mode = kResamplingLinear);
 
 } // End of namespace Audio
 
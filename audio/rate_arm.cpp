@@ -43,6 +43,7 @@
 
 #include "audio/audiostream.h"
 #include "audio/rate.h"
+#include "audio/rate_simd.h"
 #include "audio/mixer.h"
 #include "common/util.h"
 #include "common/textconsole.h"
@@ -79,6 +80,37 @@ enum {
 	FRAC_HALF_LOW = (1L << (FRAC_BITS_LOW-1))
 };
 
+/**
+ * There are no assembly versions of the accumulating converters. At unity
+ * gain flow() yields the plain resampled samples in output channel order,
+ * which then get accumulated with the volumes swapped accordingly.
+ */
+template<bool reverseStereo>
+static int flowAccumulateGeneric(RateConverter &converter, AudioStream &input, int32 *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
+	st_sample_t buf[INTERMEDIATE_BUFFER_SIZE];
+	st_size_t done = 0;
+
+	while (done < osamp) {
+		const st_size_t len = MIN<st_size_t>(osamp - done, INTERMEDIATE_BUFFER_SIZE / 2);
+		memset(buf, 0, len * 2 * sizeof(st_sample_t));
+
+		const int res = converter.flow(input, buf, len, Audio::Mixer::kMaxMixerVolume, Audio::Mixer::kMaxMixerVolume);
+		if (res <= 0)
+			break;
+
+		if (reverseStereo)
+			accumulateStereoSamples(obuf + done * 2, buf, res, vol_r, vol_l);
+		else
+			accumulateStereoSamples(obuf + done * 2, buf, res, vol_l, vol_r);
+		done += res;
+
+		if ((st_size_t)res < len)
+			break;
+	}
+
+	return done;
+}
+
 /**
  * Audio rate converter based on simple resampling. Used when no
  * interpolation is required.
@@ -106,6 +138,9 @@ protected:
 public:
 	SimpleRateConverter(st_rate_t inrate, st_rate_t outrate);
 	int flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r);
+	int flowAccumulate(AudioStream &input, int32 *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
+		return flowAccumulateGeneric<reverseStereo>(*this, input, obuf, osamp, vol_l, vol_r);
+	}
 	int drain(st_sample_t *obuf, st_size_t osamp, st_volume_t vol) {
 		return (ST_SUCCESS);
 	}
@@ -280,6 +315,9 @@ protected:
 public:
 	LinearRateConverter(st_rate_t inrate, st_rate_t outrate);
 	int flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r);
+	int flowAccumulate(AudioStream &input, int32 *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
+		return flowAccumulateGeneric<reverseStereo>(*this, input, obuf, osamp, vol_l, vol_r);
+	}
 	int drain(st_sample_t *obuf, st_size_t osamp, st_volume_t vol) {
 		return (ST_SUCCESS);
 	}
@@ -435,6 +473,10 @@ public:
 		return (obuf - ostart) / 2;
 	}
 
+	virtual int flowAccumulate(AudioStream &input, int32 *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
+		return flowAccumulateGeneric<reverseStereo>(*this, input, obuf, osamp, vol_l, vol_r);
+	}
+
 	virtual int drain(st_sample_t *obuf, st_size_t osamp, st_volume_t vol) {
 		return (ST_SUCCESS);
 	}
@@ -446,8 +488,9 @@ public:
 
 /**
  * Create and return a RateConverter object for the specified input and output rates.
+ * There is no ARM optimised sinc converter, so the mode is ignored.
  */
-RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate, bool stereo, bool reverseStereo) {
+RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate, bool stereo, bool reverseStereo, ResamplingMode mode) {
 	if (inrate != outrate) {
 		if ((inrate % outrate) == 0 && (inrate < 65536)) {
 			if (stereo) {
@@ -0,0 +1,417 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "audio/rate_simd.h"
+#include "audio/mixer.h"
+#include "common/simd.h"
+
+// The vector kernels rely on the saturating 16 bit add of the respective
+// instruction set, which does not match clampedAdd() for unsigned output.
+#ifndef OUTPUT_UNSIGNED_AUDIO
+
+#ifdef SCUMMVM_SIMD_X86
+#define AUDIO_MIX_X86
+#endif
+
+#ifdef SCUMMVM_SIMD_NEON
+#define AUDIO_MIX_NEON
+#endif
+
+#endif // OUTPUT_UNSIGNED_AUDIO
+
+namespace Audio {
+
+static void mixStereoScalar(st_sample_t *obuf, const st_sample_t *ibuf, st_size_t len, st_volume_t vol_l, st_volume_t vol_r) {
+	for (; len > 0; --len) {
+		clampedAdd(obuf[0], (ibuf[0] * (int)vol_l) / Audio::Mixer::kMaxMixerVolume);
+		clampedAdd(obuf[1], (ibuf[1] * (int)vol_r) / Audio::Mixer::kMaxMixerVolume);
+		obuf += 2;
+		ibuf += 2;
+	}
+}
+
+static void accumulateStereoScalar(int32 *obuf, const st_sample_t *ibuf, st_size_t len, st_volume_t vol_l, st_volume_t vol_r) {
+	for (; len > 0; --len) {
+		obuf[0] += ibuf[0] * (int32)vol_l;
+		obuf[1] += ibuf[1] * (int32)vol_r;
+		obuf += 2;
+		ibuf += 2;
+	}
+}
+
+static int32 dotProductScalar(const st_sample_t *samples, const int16 *coeffs, uint len) {
+	int32 sum = 0;
+	for (uint i = 0; i < len; ++i)
+		sum += samples[i] * coeffs[i];
+	return sum;
+}
+
+// All vector kernels below work on 32 bit products and divide them by
+// kMaxMixerVolume with truncation towards zero, like the scalar code does.
+// As long as the volumes do not exceed kMaxMixerVolume the quotient always
+// fits into 16 bits, so the saturating add is the only clamping step. Larger
+// volumes (which the mixer never produces) are handed to the scalar code.
+
+#ifdef AUDIO_MIX_X86
+
+SIMD_TARGET("sse2")
+static inline __m128i scaleSSE2(__m128i lo, __m128i hi) {
+	const __m128i bias = _mm_set1_epi32(Audio::Mixer::kMaxMixerVolume - 1);
+	__m128i p0 = _mm_unpacklo_epi16(lo, hi);
+	__m128i p1 = _mm_unpackhi_epi16(lo, hi);
+	p0 = _mm_srai_epi32(_mm_add_epi32(p0, _mm_and_si128(_mm_srai_epi32(p0, 31), bias)), 8);
+	p1 = _mm_srai_epi32(_mm_add_epi32(p1, _mm_and_si128(_mm_srai_epi32(p1, 31), bias)), 8);
+	return _mm_packs_epi32(p0, p1);
+}
+
+SIMD_TARGET("sse2")
+static void mixStereoSSE2(st_sample_t *obuf, const st_sample_t *ibuf, st_size_t len, st_volume_t vol_l, st_volume_t vol_r) {
+	if (vol_l > Audio::Mixer::kMaxMixerVolume || vol_r > Audio::Mixer::kMaxMixerVolume) {
+		mixStereoScalar(obuf, ibuf, len, vol_l, vol_r);
+		return;
+	}
+
+	const __m128i vol = _mm_set_epi16(vol_r, vol_l, vol_r, vol_l, vol_r, vol_l, vol_r, vol_l);
+
+	// 4 sample pairs per iteration
+	for (; len >= 4; len -= 4) {
+		const __m128i in = _mm_loadu_si128((const __m128i *)ibuf);
+		const __m128i out = _mm_loadu_si128((const __m128i *)obuf);
+		const __m128i scaled = scaleSSE2(_mm_mullo_epi16(in, vol), _mm_mulhi_epi16(in, vol));
+		_mm_storeu_si128((__m128i *)obuf, _mm_adds_epi16(out, scaled));
+		obuf += 8;
+		ibuf += 8;
+	}
+
+	mixStereoScalar(obuf, ibuf, len, vol_l, vol_r);
+}
+
+SIMD_TARGET("avx2")
+static void mixStereoAVX2(st_sample_t *obuf, const st_sample_t *ibuf, st_size_t len, st_volume_t vol_l, st_volume_t vol_r) {
+	if (vol_l > Audio::Mixer::kMaxMixerVolume || vol_r > Audio::Mixer::kMaxMixerVolume) {
+		mixStereoScalar(obuf, ibuf, len, vol_l, vol_r);
+		return;
+	}
+
+	const __m256i vol = _mm256_set_epi16(vol_r, vol_l, vol_r, vol_l, vol_r, vol_l, vol_r, vol_l,
+	                                     vol_r, vol_l, vol_r, vol_l, vol_r, vol_l, vol_r, vol_l);
+	const __m256i bias = _mm256_set1_epi32(Audio::Mixer::kMaxMixerVolume - 1);
+
+	// 8 sample pairs per iteration. Unpacking and packing both operate on
+	// the two 128 bit lanes separately, so the sample order is preserved.
+	for (; len >= 8; len -= 8) {
+		const __m256i in = _mm256_loadu_si256((const __m256i *)ibuf);
+		const __m256i out = _mm256_loadu_si256((const __m256i *)obuf);
+		const __m256i lo = _mm256_mullo_epi16(in, vol);
+		const __m256i hi = _mm256_mulhi_epi16(in, vol);
+		__m256i p0 = _mm256_unpacklo_epi16(lo, hi);
+		__m256i p1 = _mm256_unpackhi_epi16(lo, hi);
+		p0 = _mm256_srai_epi32(_mm256_add_epi32(p0, _mm256_and_si256(_mm256_srai_epi32(p0, 31), bias)), 8);
+		p1 = _mm256_srai_epi32(_mm256_add_epi32(p1, _mm256_and_si256(_mm256_srai_epi32(p1, 31), bias)), 8);
+		_mm256_storeu_si256((__m256i *)obuf, _mm256_adds_epi16(out, _mm256_packs_epi32(p0, p1)));
+		obuf += 16;
+		ibuf += 16;
+	}
+
+	mixStereoSSE2(obuf, ibuf, len, vol_l, vol_r);
+}
+
+SIMD_TARGET("sse2")
+static void accumulateStereoSSE2(int32 *obuf, const st_sample_t *ibuf, st_size_t len, st_volume_t vol_l, st_volume_t vol_r) {
+	if (vol_l > 0x7FFF || vol_r > 0x7FFF) {
+		accumulateStereoScalar(obuf, ibuf, len, vol_l, vol_r);
+		return;
+	}
+
+	const __m128i vol = _mm_set_epi16(vol_r, vol_l, vol_r, vol_l, vol_r, vol_l, vol_r, vol_l);
+
+	// 4 sample pairs per iteration
+	for (; len >= 4; len -= 4) {
+		const __m128i in = _mm_loadu_si128((const __m128i *)ibuf);
+		const __m128i lo = _mm_mullo_epi16(in, vol);
+		const __m128i hi = _mm_mulhi_epi16(in, vol);
+		const __m128i out0 = _mm_loadu_si128((const __m128i *)obuf);
+		const __m128i out1 = _mm_loadu_si128((const __m128i *)(obuf + 4));
+		_mm_storeu_si128((__m128i *)obuf, _mm_add_epi32(out0, _mm_unpacklo_epi16(lo, hi)));
+		_mm_storeu_si128((__m128i *)(obuf + 4), _mm_add_epi32(out1, _mm_unpackhi_epi16(lo, hi)));
+		obuf += 8;
+		ibuf += 8;
+	}
+
+	accumulateStereoScalar(obuf, ibuf, len, vol_l, vol_r);
+}
+
+SIMD_TARGET("avx2")
+static void accumulateStereoAVX2(int32 *obuf, const st_sample_t *ibuf, st_size_t len, st_volume_t vol_l, st_volume_t vol_r) {
+	const __m256i vol = _mm256_set_epi32(vol_r, vol_l, vol_r, vol_l, vol_r, vol_l, vol_r, vol_l);
+
+	// 4 sample pairs per iteration, widened to 32 bits before multiplying
+	for (; len >= 4; len -= 4) {
+		const __m256i in = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i *)ibuf));
+		const __m256i out = _mm256_loadu_si256((const __m256i *)obuf);
+		_mm256_storeu_si256((__m256i *)obuf, _mm256_add_epi32(out, _mm256_mullo_epi32(in, vol)));
+		obuf += 8;
+		ibuf += 8;
+	}
+
+	accumulateStereoScalar(obuf, ibuf, len, vol_l, vol_r);
+}
+
+SIMD_TARGET("sse2")
+static int32 dotProductSSE2(const st_sample_t *samples, const int16 *coeffs, uint len) {
+	__m128i sum = _mm_setzero_si128();
+
+	for (uint i = 0; i < len; i += 8) {
+		const __m128i s = _mm_loadu_si128((const __m128i *)(samples + i));
+		const __m128i c = _mm_loadu_si128((const __m128i *)(coeffs + i));
+		sum = _mm_add_epi32(sum, _mm_madd_epi16(s, c));
+	}
+
+	sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+	sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+	return _mm_cvtsi128_si32(sum);
+}
+
+SIMD_TARGET("avx2")
+static int32 dotProductAVX2(const st_sample_t *samples, const int16 *coeffs, uint len) {
+	__m256i sum = _mm256_setzero_si256();
+	uint i = 0;
+
+	for (; i + 16 <= len; i += 16) {
+		const __m256i s = _mm256_loadu_si256((const __m256i *)(samples + i));
+		const __m256i c = _mm256_loadu_si256((const __m256i *)(coeffs + i));
+		sum = _mm256_add_epi32(sum, _mm256_madd_epi16(s, c));
+	}
+
+	__m128i sum128 = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+	if (i < len) {
+		const __m128i s = _mm_loadu_si128((const __m128i *)(samples + i));
+		const __m128i c = _mm_loadu_si128((const __m128i *)(coeffs + i));
+		sum128 = _mm_add_epi32(sum128, _mm_madd_epi16(s, c));
+	}
+
+	sum128 = _mm_add_epi32(sum128, _mm_shuffle_epi32(sum128, _MM_SHUFFLE(1, 0, 3, 2)));
+	sum128 = _mm_add_epi32(sum128, _mm_shuffle_epi32(sum128, _MM_SHUFFLE(2, 3, 0, 1)));
+	return _mm_cvtsi128_si32(sum128);
+}
+
+#endif // AUDIO_MIX_X86
+
+#ifdef AUDIO_MIX_NEON
+
+static inline int16x4_t scaleNEON(int32x4_t p) {
+	const int32x4_t bias = vdupq_n_s32(Audio::Mixer::kMaxMixerVolume - 1);
+	p = vaddq_s32(p, vandq_s32(vshrq_n_s32(p, 31), bias));
+	return vqmovn_s32(vshrq_n_s32(p, 8));
+}
+
+static void mixStereoNEON(st_sample_t *obuf, const st_sample_t *ibuf, st_size_t len, st_volume_t vol_l, st_volume_t vol_r) {
+	if (vol_l > Audio::Mixer::kMaxMixerVolume || vol_r > Audio::Mixer::kMaxMixerVolume) {
+		mixStereoScalar(obuf, ibuf, len, vol_l, vol_r);
+		return;
+	}
+
+	const int16 volData[4] = { (int16)vol_l, (int16)vol_r, (int16)vol_l, (int16)vol_r };
+	const int16x4_t vol = vld1_s16(volData);
+
+	// 4 sample pairs per iteration
+	for (; len >= 4; len -= 4) {
+		const int16x8_t in = vld1q_s16(ibuf);
+		const int16x8_t out = vld1q_s16(obuf);
+		const int16x4_t s0 = scaleNEON(vmull_s16(vget_low_s16(in), vol));
+		const int16x4_t s1 = scaleNEON(vmull_s16(vget_high_s16(in), vol));
+		vst1q_s16(obuf, vqaddq_s16(out, vcombine_s16(s0, s1)));
+		obuf += 8;
+		ibuf += 8;
+	}
+
+	mixStereoScalar(obuf, ibuf, len, vol_l, vol_r);
+}
+
+static void accumulateStereoNEON(int32 *obuf, const st_sample_t *ibuf, st_size_t len, st_volume_t vol_l, st_volume_t vol_r) {
+	if (vol_l > 0x7FFF || vol_r > 0x7FFF) {
+		accumulateStereoScalar(obuf, ibuf, len, vol_l, vol_r);
+		return;
+	}
+
+	const int16 volData[4] = { (int16)vol_l, (int16)vol_r, (int16)vol_l, (int16)vol_r };
+	const int16x4_t vol = vld1_s16(volData);
+
+	// 4 sample pairs per iteration
+	for (; len >= 4; len -= 4) {
+		const int16x8_t in = vld1q_s16(ibuf);
+		vst1q_s32(obuf, vmlal_s16(vld1q_s32(obuf), vget_low_s16(in), vol));
+		vst1q_s32(obuf + 4, vmlal_s16(vld1q_s32(obuf + 4), vget_high_s16(in), vol));
+		obuf += 8;
+		ibuf += 8;
+	}
+
+	accumulateStereoScalar(obuf, ibuf, len, vol_l, vol_r);
+}
+
+static int32 dotProductNEON(const st_sample_t *samples, const int16 *coeffs, uint len) {
+	int32x4_t sum = vdupq_n_s32(0);
+
+	for (uint i = 0; i < len; i += 8) {
+		const int16x8_t s = vld1q_s16(samples + i);
+		const int16x8_t c = vld1q_s16(coeffs + i);
+		sum = vmlal_s16(sum, vget_low_s16(s), vget_low_s16(c));
+		sum = vmlal_s16(sum, vget_high_s16(s), vget_high_s16(c));
+	}
+
+	const int32x2_t half = vadd_s32(vget_low_s32(sum), vget_high_s32(sum));
+	return vget_lane_s32(vpadd_s32(half, half), 0);
+}
+
+#endif // AUDIO_MIX_NEON
+
+MixStereoProc getMixStereoProc(MixKernel kernel) {
+	switch (kernel) {
+	case kMixKernelScalar:
+		return mixStereoScalar;
+
+#ifdef AUDIO_MIX_X86
+	case kMixKernelSSE2:
+		if (Common::hasSSE2())
+			return mixStereoSSE2;
+		break;
+
+	case kMixKernelAVX2:
+		if (Common::hasAVX2())
+			return mixStereoAVX2;
+		break;
+#endif
+
+#ifdef AUDIO_MIX_NEON
+	case kMixKernelNEON:
+		return mixStereoNEON;
+#endif
+
+	default:
+		break;
+	}
+
+	return 0;
+}
+
+AccumulateStereoProc getAccumulateStereoProc(MixKernel kernel) {
+	switch (kernel) {
+	case kMixKernelScalar:
+		return accumulateStereoScalar;
+
+#ifdef AUDIO_MIX_X86
+	case kMixKernelSSE2:
+		if (Common::hasSSE2())
+			return accumulateStereoSSE2;
+		break;
+
+	case kMixKernelAVX2:
+		if (Common::hasAVX2())
+			return accumulateStereoAVX2;
+		break;
+#endif
+
+#ifdef AUDIO_MIX_NEON
+	case kMixKernelNEON:
+		return accumulateStereoNEON;
+#endif
+
+	default:
+		break;
+	}
+
+	return 0;
+}
+
+DotProductProc getDotProductProc(MixKernel kernel) {
+	switch (kernel) {
+	case kMixKernelScalar:
+		return dotProductScalar;
+
+#ifdef AUDIO_MIX_X86
+	case kMixKernelSSE2:
+		if (Common::hasSSE2())
+			return dotProductSSE2;
+		break;
+
+	case kMixKernelAVX2:
+		if (Common::hasAVX2())
+			return dotProductAVX2;
+		break;
+#endif
+
+#ifdef AUDIO_MIX_NEON
+	case kMixKernelNEON:
+		return dotProductNEON;
+#endif
+
+	default:
+		break;
+	}
+
+	return 0;
+}
+
+const char *getMixKernelName(MixKernel kernel) {
+	static const char *const names[kMixKernelCount] = {
+		"scalar",
+		"SSE2",
+		"AVX2",
+		"NEON"
+	};
+
+	assert(kernel >= 0 && kernel < kMixKernelCount);
+	return names[kernel];
+}
+
+MixKernel getBestMixKernel() {
+	static int bestKernel = -1;
+
+	if (bestKernel < 0) {
+		int kernel = kMixKernelCount - 1;
+		while (kernel > kMixKernelScalar && !getMixStereoProc((MixKernel)kernel))
+			--kernel;
+		bestKernel = kernel;
+	}
+
+	return (MixKernel)bestKernel;
+}
+
+void mixStereoSamples(st_sample_t *obuf, const st_sample_t *ibuf, st_size_t len, st_volume_t vol_l, st_volume_t vol_r) {
+	static MixStereoProc proc = 0;
+
+	if (!proc)
+		proc = getMixStereoProc(getBestMixKernel());
+
+	proc(obuf, ibuf, len, vol_l, vol_r);
+}
+
+void accumulateStereoSamples(int32 *obuf, const st_sample_t *ibuf, st_size_t len, st_volume_t vol_l, st_volume_t vol_r) {
+	static AccumulateStereoProc proc = 0;
+
+	if (!proc)
+		proc = getAccumulateStereoProc(getBestMixKernel());
+
+	proc(obuf, ibuf, len, vol_l, vol_r);
+}
+
+} // End of namespace Audio
@@ -0,0 +1,131 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef AUDIO_RATE_SIMD_H
+#define AUDIO_RATE_SIMD_H
+
+#include "audio/rate.h"
+
+namespace Audio {
+
+/**
+ * Signature of a stereo mix kernel.
+ *
+ * Scales the interleaved stereo samples in ibuf by vol_l / vol_r (with
+ * Mixer::kMaxMixerVolume being unity gain) and adds them with saturation to
+ * the interleaved stereo samples in obuf. The result must be bit identical
+ * to applying clampedAdd() to every sample.
+ *
+ * @param obuf  output buffer to mix into
+ * @param ibuf  input buffer
+ * @param len   number of sample *pairs* to process
+ * @param vol_l volume for the left channel
+ * @param vol_r volume for the right channel
+ */
+typedef void (*MixStereoProc)(st_sample_t *obuf, const st_sample_t *ibuf, st_size_t len, st_volume_t vol_l, st_volume_t vol_r);
+
+/**
+ * Signature of a stereo accumulate kernel.
+ *
+ * Like MixStereoProc, but adds the scaled samples to a 32 bit buffer
+ * without any clamping. The products are not divided by
+ * Mixer::kMaxMixerVolume, so the output keeps 8 fractional bits.
+ */
+typedef void (*AccumulateStereoProc)(int32 *obuf, const st_sample_t *ibuf, st_size_t len, st_volume_t vol_l, st_volume_t vol_r);
+
+/**
+ * Signature of a FIR filter kernel.
+ *
+ * Computes the dot product of the samples with the 16 bit filter
+ * coefficients. The caller has to make sure that the sum of the absolute
+ * coefficients, multiplied by 32768, does not overflow 32 bits.
+ *
+ * @param samples input samples
+ * @param coeffs  filter coefficients
+ * @param len     number of taps, must be a multiple of 8
+ */
+typedef int32 (*DotProductProc)(const st_sample_t *samples, const int16 *coeffs, uint len);
+
+/**
+ * The available implementations of the stereo mix and FIR filter kernels.
+ */
+enum MixKernel {
+	kMixKernelScalar = 0,
+	kMixKernelSSE2,
+	kMixKernelAVX2,
+	kMixKernelNEON,
+
+	kMixKernelCount
+};
+
+/**
+ * Returns the given mix kernel, or 0 if it is not available either in this
+ * build or on the CPU we are running on. The scalar kernel is always
+ * available.
+ */
+MixStereoProc getMixStereoProc(MixKernel kernel);
+
+/**
+ * Returns the accumulate kernel of the given implementation, or 0 if it is
+ * not available.
+ *
+ * @see getMixStereoProc
+ */
+AccumulateStereoProc getAccumulateStereoProc(MixKernel kernel);
+
+/**
+ * Returns the FIR filter kernel of the given implementation, or 0 if it is
+ * not available.
+ *
+ * @see getMixStereoProc
+ */
+DotProductProc getDotProductProc(MixKernel kernel);
+
+/**
+ * Returns the name of the given mix kernel, for debug output.
+ */
+const char *getMixKernelName(MixKernel kernel);
+
+/**
+ * Returns the fastest mix kernel usable on this machine. The detection is
+ * only done once.
+ */
+MixKernel getBestMixKernel();
+
+/**
+ * Mixes stereo samples using the fastest kernel available on this machine.
+ *
+ * @see MixStereoProc
+ */
+void mixStereoSamples(st_sample_t *obuf, const st_sample_t *ibuf, st_size_t len, st_volume_t vol_l, st_volume_t vol_r);
+
+/**
+ * Accumulates stereo samples using the fastest kernel available on this
+ * machine.
+ *
+ * @see AccumulateStereoProc
+ */
+void accumulateStereoSamples(int32 *obuf, const st_sample_t *ibuf, st_size_t len, st_volume_t vol_l, st_volume_t vol_r);
+
+} // End of namespace Audio
+
+#endif
@@ -0,0 +1,179 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "audio/softsynth/emumidi.h"
+
+#include "common/debug.h"
+#include "common/system.h"
+#include "common/timer.h"
+#include "common/util.h"
+
+void MidiDriver_Emulated::startRenderAhead(uint ms) {
+	const int stereoFactor = isStereo() ? 2 : 1;
+
+	_renderAheadFrames = (uint)(((uint64)getRate() * ms) / 1000);
+	if (!_renderAheadFrames)
+		return;
+
+	_ringMutex = new Common::Mutex();
+	_deferredMutex = new Common::Mutex();
+	_ringSize = _renderAheadFrames + kRenderAheadChunk;
+	_ring = new int16[_ringSize * stereoFactor];
+	_ringRead = 0;
+	_ringFill = 0;
+	_playedFrames = _samplePosition;
+
+	renderAhead(_renderAheadFrames, _renderAheadFrames);
+	g_system->getTimerManager()->installTimerProc(renderAheadProc, MAX<int32>(ms * 250, 10000), this, "EmulatedMidiRenderAhead");
+}
+
+void MidiDriver_Emulated::stopRenderAhead() {
+	if (!_renderAheadFrames)
+		return;
+
+	// This waits for a running render to finish
+	g_system->getTimerManager()->removeTimerProc(renderAheadProc);
+
+	delete[] _ring;
+	_ring = 0;
+	_renderAheadFrames = 0;
+	_deferredEvents.clear();
+
+	delete _ringMutex;
+	_ringMutex = 0;
+	delete _deferredMutex;
+	_deferredMutex = 0;
+}
+
+void MidiDriver_Emulated::renderAheadProc(void *refCon) {
+	MidiDriver_Emulated *driver = (MidiDriver_Emulated *)refCon;
+	// The timer thread is shared with other callbacks, so catch up after an
+	// underrun over several calls. The callback runs four times per render
+	// ahead time, so this is still twice the rate of playback.
+	driver->renderAhead(driver->_renderAheadFrames, driver->_renderAheadFrames / 2);
+}
+
+void MidiDriver_Emulated::renderAhead(uint targetFill, uint maxFrames) {
+	const int stereoFactor = isStereo() ? 2 : 1;
+
+	while (maxFrames > 0) {
+		uint fill, write;
+		{
+			Common::StackLock lock(*_ringMutex);
+			fill = _ringFill;
+			write = (_ringRead + _ringFill) % _ringSize;
+		}
+
+		if (fill >= targetFill)
+			break;
+
+		// The consumer never touches the free part of the ring, so we can
+		// render into it without holding the lock.
+		const uint frames = MIN<uint>(MIN<uint>(MIN<uint>(targetFill - fill, _ringSize - write), kRenderAheadChunk), maxFrames);
+		render(_ring + write * stereoFactor, frames * stereoFactor);
+		maxFrames -= frames;
+
+		Common::StackLock lock(*_ringMutex);
+		_ringFill += frames;
+	}
+}
+
+int MidiDriver_Emulated::readRenderedAhead(int16 *data, const int numSamples) {
+	const int stereoFactor = isStereo() ? 2 : 1;
+
+	uint frames = numSamples / stereoFactor;
+	while (frames > 0) {
+		uint fill, read;
+		{
+			Common::StackLock lock(*_ringMutex);
+			fill = _ringFill;
+			read = _ringRead;
+		}
+
+		if (!fill) {
+			// The timer could not keep up. Rendering here would mean waiting
+			// for the timer callback, so play silence until it catches up.
+			debug(1, "MidiDriver_Emulated: Render ahead buffer underrun");
+			memset(data, 0, frames * stereoFactor * sizeof(int16));
+			break;
+		}
+
+		const uint count = MIN<uint>(MIN<uint>(frames, fill), _ringSize - read);
+		memcpy(data, _ring + read * stereoFactor, count * stereoFactor * sizeof(int16));
+
+		{
+			Common::StackLock lock(*_ringMutex);
+			_ringRead = (read + count) % _ringSize;
+			_ringFill -= count;
+			_playedFrames += count;
+		}
+
+		data += count * stereoFactor;
+		frames -= count;
+	}
+
+	return numSamples;
+}
+
+bool MidiDriver_Emulated::deferEvent(uint32 b, const byte *msg, uint16 length) {
+	if (!_renderAheadFrames)
+		return false;
+
+	Common::StackLock lock(*_deferredMutex);
+	if (_sendingPlayerEvents)
+		return false;
+
+	DeferredEvent event;
+	{
+		Common::StackLock ringLock(*_ringMutex);
+		event.samplePos = _playedFrames + _renderAheadFrames;
+	}
+	event.b = b;
+	if (length)
+		event.sysEx = Common::Array<byte>(msg, length);
+
+	// An event must never overtake an earlier one
+	if (!_deferredEvents.empty() && (int32)(event.samplePos - _deferredEvents.back().samplePos) < 0)
+		event.samplePos = _deferredEvents.back().samplePos;
+
+	_deferredEvents.push_back(event);
+	return true;
+}
+
+void MidiDriver_Emulated::processDeferredEvents(int step) {
+	Common::StackLock lock(*_deferredMutex);
+
+	while (!_deferredEvents.empty()) {
+		const DeferredEvent &event = _deferredEvents.front();
+		// The render position is never further ahead of the playback
+		// position than the render ahead time, so events are never late
+		const uint32 offset = MAX<int32>(event.samplePos - _samplePosition, 0);
+		if (offset >= (uint32)step)
+			break;
+
+		if (event.sysEx.empty())
+			playDeferredEvent(event.b, 0, 0, offset);
+		else
+			playDeferredEvent(0, event.sysEx.begin(), event.sysEx.size(), offset);
+		_deferredEvents.pop_front();
+	}
+}
@@ -27,6 +27,10 @@
 #include "audio/mididrv.h"
 #include "audio/mixer.h"
 
+#include "common/array.h"
+#include "common/list.h"
+#include "common/mutex.h"
+
 class MidiDriver_Emulated : public Audio::AudioStream, public MidiDriver {
 protected:
 	bool _isOpen;
@@ -44,12 +48,204 @@ private:
 	int _nextTick;
 	int _samplesPerTick;
 
+	struct DelayedEvent {
+		uint32 samplePos;
+		uint32 b;
+		uint32 sysExOffset;
+		uint16 sysExLength;  ///< 0 for channel messages
+	};
+
+	/** Number of sample frames rendered so far. */
+	uint32 _samplePosition;
+
+	/**
+	 * Events from sendDelayed() and sysExDelayed(), ordered by time. These
+	 * are only touched by the thread which renders the output.
+	 */
+	Common::Array<DelayedEvent> _delayedEvents;
+	Common::Array<byte> _delayedSysEx;
+	uint _delayedHead;
+
+	void queueEvent(uint32 delay, uint32 b, const byte *msg, uint16 length) {
+		queueEventAt(_samplePosition + (uint32)(((uint64)delay * getRate()) / 1000000), b, msg, length);
+	}
+
+	void queueEventAt(uint32 samplePos, uint32 b, const byte *msg, uint16 length) {
+		DelayedEvent event;
+		event.samplePos = samplePos;
+		event.b = b;
+		event.sysExOffset = _delayedSysEx.size();
+		event.sysExLength = length;
+
+		// An event must never overtake an earlier one
+		if (_delayedHead < _delayedEvents.size() && (int32)(event.samplePos - _delayedEvents.back().samplePos) < 0)
+			event.samplePos = _delayedEvents.back().samplePos;
+
+		for (uint16 i = 0; i < length; ++i)
+			_delayedSysEx.push_back(msg[i]);
+		_delayedEvents.push_back(event);
+	}
+
+	/**
+	 * Sends all delayed events which are due at the current sample position.
+	 *
+	 * @return number of sample frames until the next delayed event, but at
+	 *         most maxStep
+	 */
+	int processDelayedEvents(int maxStep) {
+		while (_delayedHead < _delayedEvents.size()) {
+			const DelayedEvent event = _delayedEvents[_delayedHead];
+			const int32 wait = (int32)(event.samplePos - _samplePosition);
+			if (wait > 0)
+				return MIN<int32>(wait, maxStep);
+
+			++_delayedHead;
+			setSendingPlayerEvents(true);
+			if (event.sysExLength)
+				sysEx(&_delayedSysEx[event.sysExOffset], event.sysExLength);
+			else
+				send(event.b);
+			setSendingPlayerEvents(false);
+		}
+
+		_delayedEvents.resize(0);
+		_delayedSysEx.resize(0);
+		_delayedHead = 0;
+		return maxStep;
+	}
+
+	// Render ahead, see startRenderAhead(). A timer callback renders into
+	// a ring buffer, so the mixer callback only has to copy finished
+	// samples. The timer callback is the only producer and the mixer
+	// callback the only consumer.
+	enum {
+		kRenderAheadChunk = 256
+	};
+
+	uint _renderAheadFrames;
+	int16 *_ring;
+	uint _ringSize;
+	uint _ringRead;
+	uint _ringFill;
+	/** Number of sample frames the mixer has taken from the ring. */
+	uint32 _playedFrames;
+	// Guards the ring positions, never held while rendering. Both mutexes
+	// only exist while rendering ahead, so that drivers can still be
+	// created without a system.
+	Common::Mutex *_ringMutex;
+
+	struct DeferredEvent {
+		uint32 samplePos;
+		uint32 b;
+		Common::Array<byte> sysEx;  ///< empty for channel messages
+	};
+
+	/** Events from deferEvent(), ordered by time. */
+	Common::List<DeferredEvent> _deferredEvents;
+	/** Whether the renderer is sending the events of the player. */
+	bool _sendingPlayerEvents;
+	// Guards the deferred events and _sendingPlayerEvents
+	Common::Mutex *_deferredMutex;
+
+	static void renderAheadProc(void *refCon);
+	void renderAhead(uint targetFill, uint maxFrames);
+	int readRenderedAhead(int16 *data, const int numSamples);
+	void processDeferredEvents(int step);
+
+	void setSendingPlayerEvents(bool sending) {
+		if (!_renderAheadFrames)
+			return;
+		Common::StackLock lock(*_deferredMutex);
+		_sendingPlayerEvents = sending;
+	}
+
+	int render(int16 *data, const int numSamples) {
+		const int stereoFactor = isStereo() ? 2 : 1;
+		int len = numSamples / stereoFactor;
+		int step;
+
+		do {
+			step = len;
+			if (step > (_nextTick >> FIXP_SHIFT))
+				step = (_nextTick >> FIXP_SHIFT);
+
+			if (_renderAheadFrames)
+				processDeferredEvents(step);
+
+			// Split the block at the next delayed event
+			step = processDelayedEvents(step);
+
+			generateSamples(data, step);
+			_samplePosition += step;
+
+			_nextTick -= step << FIXP_SHIFT;
+			if (!(_nextTick >> FIXP_SHIFT)) {
+				setSendingPlayerEvents(true);
+				if (_timerProc)
+					(*_timerProc)(_timerParam);
+
+				onTimer();
+				setSendingPlayerEvents(false);
+
+				_nextTick += _samplesPerTick;
+			}
+
+			data += step * stereoFactor;
+			len -= step;
+		} while (len);
+
+		return numSamples;
+	}
+
 protected:
 	int _baseFreq;
 
 	virtual void generateSamples(int16 *buf, int len) = 0;
 	virtual void onTimer() {}
 
+	/**
+	 * Render the output ahead from a timer callback, for synths which are
+	 * too slow to render on the mixer thread. Call this from open(), after
+	 * MidiDriver_Emulated::open() and before the stream is played.
+	 *
+	 * The player callback keeps its sample accurate timing, as it is
+	 * called while rendering. Events from other threads have to go through
+	 * deferEvent().
+	 *
+	 * @param ms	milliseconds to render ahead, 0 to render on the mixer
+	 *              thread as usual
+	 */
+	void startRenderAhead(uint ms);
+
+	/**
+	 * Stop rendering ahead. Call this from close(), after the player
+	 * callback was removed and the stream was stopped.
+	 */
+	void stopRenderAhead();
+
+	/**
+	 * Call this first in send() and sysEx() of drivers which render
+	 * ahead. Everything up to the render position has been rendered
+	 * already, so events from other threads than the player are played
+	 * the render ahead time after the sample frame which the mixer plays
+	 * when they are sent. That way they keep their order and spacing.
+	 * Events sent while the player callback runs count as player events.
+	 *
+	 * @return true if the event is played later through
+	 *         playDeferredEvent(), false if it has to be played right away
+	 */
+	bool deferEvent(uint32 b, const byte *msg, uint16 length);
+
+	/**
+	 * Play an event from deferEvent(), the given number of sample frames
+	 * into the block which is rendered next. The default splits the block
+	 * there and sends the event through send() or sysEx(), synths with an
+	 * event queue of their own can timestamp it instead.
+	 */
+	virtual void playDeferredEvent(uint32 b, const byte *msg, uint16 length, uint32 offset) {
+		queueEventAt(_samplePosition + offset, b, msg, length);
+	}
+
 public:
 	MidiDriver_Emulated(Audio::Mixer *mixer) :
 		_mixer(mixer),
@@ -58,9 +254,26 @@ public:
 		_timerParam(0),
 		_nextTick(0),
 		_samplesPerTick(0),
+		_samplePosition(0),
+		_delayedHead(0),
+		_renderAheadFrames(0),
+		_ring(0),
+		_ringSize(0),
+		_ringRead(0),
+		_ringFill(0),
+		_playedFrames(0),
+		_ringMutex(0),
+		_sendingPlayerEvents(false),
+		_deferredMutex(0),
 		_baseFreq(250) {
 	}
 
+	virtual ~MidiDriver_Emulated() {
+		delete[] _ring;
+		delete _ringMutex;
+		delete _deferredMutex;
+	}
+
 	// MidiDriver API
 	virtual int open() {
 		_isOpen = true;
@@ -87,34 +300,25 @@ public:
 		return 1000000 / _baseFreq;
 	}
 
-	// AudioStream API
-	virtual int readBuffer(int16 *data, const int numSamples) {
-		const int stereoFactor = isStereo() ? 2 : 1;
-		int len = numSamples / stereoFactor;
-		int step;
-
-		do {
-			step = len;
-			if (step > (_nextTick >> FIXP_SHIFT))
-				step = (_nextTick >> FIXP_SHIFT);
-
-			generateSamples(data, step);
-
-			_nextTick -= step << FIXP_SHIFT;
-			if (!(_nextTick >> FIXP_SHIFT)) {
-				if (_timerProc)
-					(*_timerProc)(_timerParam);
-
-				onTimer();
+	virtual void sendDelayed(uint32 b, uint32 delay) {
+		queueEvent(delay, b, 0, 0);
+	}
 
-				_nextTick += _samplesPerTick;
-			}
+	virtual void sysExDelayed(const byte *msg, uint16 length, uint32 delay) {
+		if (length)
+			queueEvent(delay, 0, msg, length);
+	}
 
-			data += step * stereoFactor;
-			len -= step;
-		} while (len);
+	virtual Audio::AudioStream *detachStream() {
+		_mixer->stopHandle(_mixerSoundHandle);
+		return this;
+	}
 
-		return numSamples;
+	// AudioStream API
+	virtual int readBuffer(int16 *data, const int numSamples) {
+		if (_renderAheadFrames)
+			return readRenderedAhead(data, numSamples);
+		return render(data, numSamples);
 	}
 
 	virtual bool endOfData() const {
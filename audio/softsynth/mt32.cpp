@@ -35,6 +35,7 @@
 #include "common/events.h"
 #include "common/file.h"
 #include "common/system.h"
+#include "common/timer.h"
 #include "common/util.h"
 #include "common/archive.h"
 #include "common/textconsole.h"
@@ -113,8 +114,15 @@ private:
 
 	int _outputRate;
 
+	// Rendering ahead is pointless when the output is not played in real
+	// time, see PROP_DETACHED_STREAM
+	bool _detachedStream;
+
+	void playSysEx(const byte *msg, uint16 length, uint32 timestamp);
+
 protected:
 	void generateSamples(int16 *buf, int len);
+	void playDeferredEvent(uint32 b, const byte *msg, uint16 length, uint32 offset);
 
 public:
 	MidiDriver_MT32(Audio::Mixer *mixer);
@@ -150,6 +158,7 @@ MidiDriver_MT32::MidiDriver_MT32(Audio::Mixer *mixer) : MidiDriver_Emulated(mixe
 	_outputRate = 0;
 	_controlData = nullptr;
 	_pcmData = nullptr;
+	_detachedStream = false;
 }
 
 MidiDriver_MT32::~MidiDriver_MT32() {
@@ -221,12 +230,22 @@ int MidiDriver_MT32::open() {
 
 	MidiDriver_Emulated::open();
 
+	// With render ahead enabled, the music timer callbacks are invoked while
+	// rendering, so the MIDI events they send are played at the exact sample
+	// position. Events sent from other threads are queued in MUNT with the
+	// playback position plus the render ahead time as their timestamp.
+	if (ConfMan.hasKey("mt32_render_ahead") && !_detachedStream)
+		startRenderAhead(CLIP<int>(ConfMan.getInt("mt32_render_ahead"), 0, 1000));
+
 	_mixer->playStream(Audio::Mixer::kPlainSoundType, &_mixerSoundHandle, this, -1, Audio::Mixer::kMaxChannelVolume, 0, DisposeAfterUse::NO, true);
 
 	return 0;
 }
 
 void MidiDriver_MT32::send(uint32 b) {
+	if (deferEvent(b, 0, 0))
+		return;
+
 	Common::StackLock lock(_mutex);
 	_service.playMsg(b);
 }
@@ -237,28 +256,61 @@ void MidiDriver_MT32::setPitchBendRange(byte channel, uint range) {
 	if (range > 24) {
 		warning("setPitchBendRange() called with range > 24: %d", range);
 	}
-	byte benderRangeSysex[4] = { 0, 0, 4, (uint8)range };
-	Common::StackLock lock(_mutex);
-	_service.writeSysex(channel, benderRangeSysex, 4);
+	// A DT1 message for the part of the channel, which goes through sysEx()
+	// so that it is deferred like other events
+	byte benderRangeSysex[9] = { 0x41, (byte)channel, 0x16, 0x12, 0, 0, 4, (uint8)range, 0 };
+	benderRangeSysex[8] = (128 - ((4 + range) & 0x7F)) & 0x7F;
+	sysEx(benderRangeSysex, sizeof(benderRangeSysex));
 }
 
 void MidiDriver_MT32::sysEx(const byte *msg, uint16 length) {
+	if (deferEvent(0, msg, length))
+		return;
+
+	Common::StackLock lock(_mutex);
+	playSysEx(msg, length, _service.getInternalRenderedSampleCount());
+}
+
+void MidiDriver_MT32::playDeferredEvent(uint32 b, const byte *msg, uint16 length, uint32 offset) {
+	// The output rate is the internal rate of MUNT, so the sample frames of
+	// the stream are its timestamps
+	Common::StackLock lock(_mutex);
+	const uint32 timestamp = _service.getInternalRenderedSampleCount() + offset;
+	if (length)
+		playSysEx(msg, length, timestamp);
+	else
+		_service.playMsgAt(b, timestamp);
+}
+
+void MidiDriver_MT32::playSysEx(const byte *msg, uint16 length, uint32 timestamp) {
 	if (msg[0] == 0xf0) {
-		Common::StackLock lock(_mutex);
-		_service.playSysex(msg, length);
-	} else {
-		enum {
-			SYSEX_CMD_DT1 = 0x12,
-			SYSEX_CMD_DAT = 0x42
-		};
+		_service.playSysexAt(msg, length, timestamp);
+		return;
+	}
 
-		if (msg[3] == SYSEX_CMD_DT1 || msg[3] == SYSEX_CMD_DAT) {
-			Common::StackLock lock(_mutex);
-			_service.writeSysex(msg[1], msg + 4, length - 5);
-		} else {
-			warning("Unused sysEx command %d", msg[3]);
-		}
+	enum {
+		SYSEX_CMD_DT1 = 0x12,
+		SYSEX_CMD_DAT = 0x42
+	};
+
+	if (msg[3] != SYSEX_CMD_DT1 && msg[3] != SYSEX_CMD_DAT) {
+		warning("Unused sysEx command %d", msg[3]);
+		return;
+	}
+
+	if (timestamp == _service.getInternalRenderedSampleCount()) {
+		_service.writeSysex(msg[1], msg + 4, length - 5);
+		return;
 	}
+
+	// Only framed messages can be queued in MUNT
+	Common::Array<byte> framed;
+	framed.reserve(length + 2);
+	framed.push_back(0xf0);
+	for (uint16 i = 0; i < length; ++i)
+		framed.push_back(msg[i]);
+	framed.push_back(0xf7);
+	_service.playSysexAt(framed.begin(), framed.size(), timestamp);
 }
 
 void MidiDriver_MT32::close() {
@@ -268,8 +320,10 @@ void MidiDriver_MT32::close() {
 
 	// Detach the player callback handler
 	setTimerCallback(NULL, NULL);
-	// Detach the mixer callback handler
+	// Detach the mixer callback handler. This waits until the mixer has
+	// dropped the stream, so the ring is not in use anymore afterwards.
 	_mixer->stopHandle(_mixerSoundHandle);
+	stopRenderAhead();
 
 	Common::StackLock lock(_mutex);
 	_service.closeSynth();
@@ -290,6 +344,9 @@ uint32 MidiDriver_MT32::property(int prop, uint32 param) {
 	case PROP_CHANNEL_MASK:
 		_channelMask = param & 0xFFFF;
 		return 1;
+	case PROP_DETACHED_STREAM:
+		_detachedStream = (param != 0);
+		return 1;
 	}
 
 	return 0;
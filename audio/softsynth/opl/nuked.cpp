@@ -31,6 +31,7 @@
 #include "audio/mixer.h"
 #include "common/system.h"
 #include "common/scummsys.h"
+#include "common/simd.h"
 #include "nuked.h"
 
 #ifndef DISABLE_NUKED_OPL
@@ -1050,12 +1051,14 @@ static Bit16s OPL3_ClipSample(Bit32s sample)
     return (Bit16s)sample;
 }
 
+static void OPL3_UpdateTimers(opl3_chip *chip);
+static Bit8u OPL3_ProcessWriteBuf(opl3_chip *chip);
+
 void OPL3_Generate(opl3_chip *chip, Bit16s *buf)
 {
     Bit8u ii;
     Bit8u jj;
     Bit16s accm;
-    Bit8u shift = 0;
 
     buf[1] = OPL3_ClipSample(chip->mixbuff[1]);
 
@@ -1115,6 +1118,14 @@ void OPL3_Generate(opl3_chip *chip, Bit16s *buf)
         OPL3_SlotGenerate(&chip->slot[ii]);
     }
 
+    OPL3_UpdateTimers(chip);
+    OPL3_ProcessWriteBuf(chip);
+}
+
+static void OPL3_UpdateTimers(opl3_chip *chip)
+{
+    Bit8u shift = 0;
+
     if ((chip->timer & 0x3f) == 0x3f)
     {
         chip->tremolopos = (chip->tremolopos + 1) % 210;
@@ -1167,6 +1178,11 @@ void OPL3_Generate(opl3_chip *chip, Bit16s *buf)
     }
 
     chip->eg_state ^= 1;
+}
+
+static Bit8u OPL3_ProcessWriteBuf(opl3_chip *chip)
+{
+    Bit8u written = 0;
 
     while (chip->writebuf[chip->writebuf_cur].time <= chip->writebuf_samplecnt)
     {
@@ -1178,8 +1194,10 @@ void OPL3_Generate(opl3_chip *chip, Bit16s *buf)
         OPL3_WriteReg(chip, chip->writebuf[chip->writebuf_cur].reg,
                       chip->writebuf[chip->writebuf_cur].data);
         chip->writebuf_cur = (chip->writebuf_cur + 1) % OPL_WRITEBUF_SIZE;
+        written = 1;
     }
     chip->writebuf_samplecnt++;
+    return written;
 }
 
 void OPL3_GenerateResampled(opl3_chip *chip, Bit16s *buf)
@@ -1383,6 +1401,808 @@ void OPL3_GenerateStream(opl3_chip *chip, Bit16s *sndptr, Bit32u numsamples)
     }
 }
 
+//
+// Vectorized variant
+//
+
+static Bit8u OPL3_VectorValueIndex(const opl3_chip *chip, const Bit16s *ptr)
+{
+    const char *base = (const char *)chip->slot;
+    Bit32u offset;
+    Bit8u slotnum;
+
+    if (ptr == &chip->zeromod)
+    {
+        return OPL3_VECTOR_ZERO;
+    }
+    offset = (Bit32u)((const char *)ptr - base);
+    slotnum = (Bit8u)(offset / sizeof(opl3_slot));
+    if (ptr == &chip->slot[slotnum].fbmod)
+    {
+        return OPL3_VECTOR_FBMOD + slotnum;
+    }
+    return slotnum;
+}
+
+static void OPL3_VectorSync(opl3_vector *vec)
+{
+    opl3_chip *chip = vec->chip;
+    Bit8u ii;
+    Bit8u jj;
+
+    for (ii = 0; ii < 36; ii++)
+    {
+        const opl3_slot *slot = &chip->slot[ii];
+        const opl3_channel *channel = slot->channel;
+
+        vec->key[ii] = slot->key ? -1 : 0;
+        vec->rate_ar[ii] = slot->reg_ar;
+        vec->rate_dr[ii] = slot->reg_dr;
+        vec->rate_sus[ii] = slot->reg_type ? 0 : slot->reg_rr;
+        vec->rate_rr[ii] = slot->reg_rr;
+        vec->reg_sl[ii] = slot->reg_sl;
+        vec->ks[ii] = channel->ksv >> ((slot->reg_ksr ^ 1) << 1);
+        vec->eg_base[ii] = (slot->reg_tl << 2) + (slot->eg_ksl >> kslshift[slot->reg_ksl]);
+        vec->trem[ii] = (slot->trem == &chip->tremolo) ? -1 : 0;
+        vec->f_num[ii] = channel->f_num;
+        vec->block_mul[ii] = 1 << channel->block;
+        vec->mult[ii] = mt[slot->reg_mult];
+        vec->vib[ii] = slot->reg_vib ? 0xffffffff : 0;
+        vec->wf[ii] = slot->reg_wf;
+        vec->fb[ii] = channel->fb;
+        vec->mod[ii] = OPL3_VectorValueIndex(chip, slot->mod);
+    }
+    for (ii = 0; ii < 18; ii++)
+    {
+        for (jj = 0; jj < 4; jj++)
+        {
+            vec->ch_out[ii][jj] = OPL3_VectorValueIndex(chip, chip->channel[ii].out[jj]);
+        }
+        vec->cha[ii] = chip->channel[ii].cha;
+        vec->chb[ii] = chip->channel[ii].chb;
+    }
+    vec->dirty = 0;
+}
+
+// Same as OPL3_EnvelopeCalc, operating on all slots at once
+static void OPL3_VectorEnvelopeScalar(opl3_vector *vec, const opl3_vector_eg *eg)
+{
+    Bit8u ii;
+
+    for (ii = 0; ii < OPL3_VECTOR_SLOTS; ii++)
+    {
+        Bit8u rate;
+        Bit8u rate_hi;
+        Bit8u rate_lo;
+        Bit8u reg_rate = 0;
+        Bit8u eg_shift, shift;
+        Bit16u eg_rout;
+        Bit16s eg_inc;
+        Bit8u eg_off;
+        Bit8u reset = 0;
+        vec->eg_out[ii] = vec->eg_rout[ii] + vec->eg_base[ii] + (vec->trem[ii] & eg->tremolo);
+        if (vec->key[ii] && vec->eg_gen[ii] == envelope_gen_num_release)
+        {
+            reset = 1;
+            reg_rate = (Bit8u)vec->rate_ar[ii];
+        }
+        else
+        {
+            switch (vec->eg_gen[ii])
+            {
+            case envelope_gen_num_attack:
+                reg_rate = (Bit8u)vec->rate_ar[ii];
+                break;
+            case envelope_gen_num_decay:
+                reg_rate = (Bit8u)vec->rate_dr[ii];
+                break;
+            case envelope_gen_num_sustain:
+                reg_rate = (Bit8u)vec->rate_sus[ii];
+                break;
+            case envelope_gen_num_release:
+                reg_rate = (Bit8u)vec->rate_rr[ii];
+                break;
+            }
+        }
+        vec->pg_reset[ii] = reset ? 0xffffffff : 0;
+        rate = vec->ks[ii] + (reg_rate << 2);
+        rate_hi = rate >> 2;
+        rate_lo = rate & 0x03;
+        if (rate_hi & 0x10)
+        {
+            rate_hi = 0x0f;
+        }
+        eg_shift = rate_hi + eg->eg_add;
+        shift = 0;
+        if (reg_rate != 0)
+        {
+            if (rate_hi < 12)
+            {
+                if (eg->eg_state)
+                {
+                    switch (eg_shift)
+                    {
+                    case 12:
+                        shift = 1;
+                        break;
+                    case 13:
+                        shift = (rate_lo >> 1) & 0x01;
+                        break;
+                    case 14:
+                        shift = rate_lo & 0x01;
+                        break;
+                    default:
+                        break;
+                    }
+                }
+            }
+            else
+            {
+                shift = (rate_hi & 0x03) + eg->incstep[rate_lo];
+                if (shift & 0x04)
+                {
+                    shift = 0x03;
+                }
+                if (!shift)
+                {
+                    shift = (Bit8u)eg->eg_state;
+                }
+            }
+        }
+        eg_rout = vec->eg_rout[ii];
+        eg_inc = 0;
+        eg_off = 0;
+        // Instant attack
+        if (reset && rate_hi == 0x0f)
+        {
+            eg_rout = 0x00;
+        }
+        // Envelope off
+        if ((vec->eg_rout[ii] & 0x1f8) == 0x1f8)
+        {
+            eg_off = 1;
+        }
+        if (vec->eg_gen[ii] != envelope_gen_num_attack && !reset && eg_off)
+        {
+            eg_rout = 0x1ff;
+        }
+        switch (vec->eg_gen[ii])
+        {
+        case envelope_gen_num_attack:
+            if (!vec->eg_rout[ii])
+            {
+                vec->eg_gen[ii] = envelope_gen_num_decay;
+            }
+            else if (vec->key[ii] && shift > 0 && rate_hi != 0x0f)
+            {
+                eg_inc = ((~vec->eg_rout[ii]) << shift) >> 4;
+            }
+            break;
+        case envelope_gen_num_decay:
+            if ((vec->eg_rout[ii] >> 4) == vec->reg_sl[ii])
+            {
+                vec->eg_gen[ii] = envelope_gen_num_sustain;
+            }
+            else if (!eg_off && !reset && shift > 0)
+            {
+                eg_inc = 1 << (shift - 1);
+            }
+            break;
+        case envelope_gen_num_sustain:
+        case envelope_gen_num_release:
+            if (!eg_off && !reset && shift > 0)
+            {
+                eg_inc = 1 << (shift - 1);
+            }
+            break;
+        }
+        vec->eg_rout[ii] = (eg_rout + eg_inc) & 0x1ff;
+        // Key off
+        if (reset)
+        {
+            vec->eg_gen[ii] = envelope_gen_num_attack;
+        }
+        if (!vec->key[ii])
+        {
+            vec->eg_gen[ii] = envelope_gen_num_release;
+        }
+    }
+}
+
+// Same as the phase accumulator part of OPL3_PhaseGenerate. The rhythm
+// mode phases are patched in by OPL3_VectorRhythm afterwards.
+static void OPL3_VectorPhaseScalar(opl3_vector *vec, const opl3_vector_pg *pg)
+{
+    Bit8u ii;
+
+    for (ii = 0; ii < OPL3_VECTOR_SLOTS; ii++)
+    {
+        Bit32u range = ((vec->f_num[ii] >> 7) & 7) >> pg->vib_shift;
+        Bit32u f_num;
+        Bit32u basefreq;
+
+        range &= vec->vib[ii] & pg->vib_on;
+        range = (range ^ pg->vib_neg) - pg->vib_neg;
+        f_num = (vec->f_num[ii] + range) & 0xffff;
+        basefreq = (f_num * vec->block_mul[ii]) >> 1;
+        vec->pg_phase_out[ii] = (vec->pg_phase[ii] >> 9) & 0xffff;
+        vec->pg_phase[ii] = (vec->pg_phase[ii] & ~vec->pg_reset[ii])
+                          + ((basefreq * vec->mult[ii]) >> 1);
+    }
+}
+
+#ifdef SCUMMVM_SIMD_X86
+
+// 8 slots per iteration, see OPL3_VectorEnvelopeScalar for the logic
+SIMD_TARGET("sse2")
+static void OPL3_VectorEnvelopeSSE2(opl3_vector *vec, const opl3_vector_eg *eg)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i ones = _mm_set1_epi16(-1);
+    const __m128i c1 = _mm_set1_epi16(1);
+    const __m128i c2 = _mm_set1_epi16(2);
+    const __m128i c3 = _mm_set1_epi16(3);
+    const __m128i c4 = _mm_set1_epi16(4);
+    const __m128i c12 = _mm_set1_epi16(12);
+    const __m128i c13 = _mm_set1_epi16(13);
+    const __m128i c14 = _mm_set1_epi16(14);
+    const __m128i c15 = _mm_set1_epi16(15);
+    const __m128i c1f8 = _mm_set1_epi16(0x1f8);
+    const __m128i c1ff = _mm_set1_epi16(0x1ff);
+    const __m128i eg_state = _mm_set1_epi16(eg->eg_state);
+    const __m128i eg_state_mask = _mm_cmpgt_epi16(eg_state, zero);
+    const __m128i eg_add = _mm_set1_epi16(eg->eg_add);
+    const __m128i tremolo = _mm_set1_epi16(eg->tremolo);
+    const __m128i inc0 = _mm_set1_epi16(eg->incstep[0]);
+    const __m128i inc1 = _mm_set1_epi16(eg->incstep[1]);
+    const __m128i inc2 = _mm_set1_epi16(eg->incstep[2]);
+    const __m128i inc3 = _mm_set1_epi16(eg->incstep[3]);
+    Bit8u ii;
+
+    for (ii = 0; ii < OPL3_VECTOR_SLOTS; ii += 8)
+    {
+        const __m128i rout = _mm_loadu_si128((const __m128i *)&vec->eg_rout[ii]);
+        const __m128i gen = _mm_loadu_si128((const __m128i *)&vec->eg_gen[ii]);
+        const __m128i key = _mm_loadu_si128((const __m128i *)&vec->key[ii]);
+        const __m128i trem = _mm_loadu_si128((const __m128i *)&vec->trem[ii]);
+        const __m128i base = _mm_loadu_si128((const __m128i *)&vec->eg_base[ii]);
+        const __m128i is_att = _mm_cmpeq_epi16(gen, zero);
+        const __m128i is_dec = _mm_cmpeq_epi16(gen, c1);
+        const __m128i is_sus = _mm_cmpeq_epi16(gen, c2);
+        const __m128i is_rel = _mm_cmpeq_epi16(gen, c3);
+        const __m128i reset = _mm_and_si128(key, is_rel);
+        __m128i reg_rate, rate, rate_hi, rate_lo, rate15, eg_shift;
+        __m128i shift_lo, shift_hi, shift, eg_off, shift_pos, rout_zero, sl_reached;
+        __m128i new_rout, not_rout, att_inc, lin_inc, att_cond, lin_cond, new_gen;
+
+        _mm_storeu_si128((__m128i *)&vec->eg_out[ii],
+                         _mm_add_epi16(_mm_add_epi16(rout, base), _mm_and_si128(trem, tremolo)));
+
+        reg_rate = _mm_and_si128(_mm_or_si128(reset, is_att),
+                                 _mm_loadu_si128((const __m128i *)&vec->rate_ar[ii]));
+        reg_rate = _mm_or_si128(reg_rate, _mm_and_si128(is_dec,
+                                _mm_loadu_si128((const __m128i *)&vec->rate_dr[ii])));
+        reg_rate = _mm_or_si128(reg_rate, _mm_and_si128(is_sus,
+                                _mm_loadu_si128((const __m128i *)&vec->rate_sus[ii])));
+        reg_rate = _mm_or_si128(reg_rate, _mm_andnot_si128(reset, _mm_and_si128(is_rel,
+                                _mm_loadu_si128((const __m128i *)&vec->rate_rr[ii]))));
+        _mm_storeu_si128((__m128i *)&vec->pg_reset[ii], _mm_unpacklo_epi16(reset, reset));
+        _mm_storeu_si128((__m128i *)&vec->pg_reset[ii + 4], _mm_unpackhi_epi16(reset, reset));
+
+        rate = _mm_add_epi16(_mm_loadu_si128((const __m128i *)&vec->ks[ii]), _mm_slli_epi16(reg_rate, 2));
+        rate_hi = _mm_min_epi16(_mm_srai_epi16(rate, 2), c15);
+        rate_lo = _mm_and_si128(rate, c3);
+        rate15 = _mm_cmpeq_epi16(rate_hi, c15);
+
+        // Rates below 12 step on some samples only
+        eg_shift = _mm_add_epi16(rate_hi, eg_add);
+        shift_lo = _mm_and_si128(_mm_cmpeq_epi16(eg_shift, c12), c1);
+        shift_lo = _mm_or_si128(shift_lo, _mm_and_si128(_mm_cmpeq_epi16(eg_shift, c13),
+                                _mm_and_si128(_mm_srli_epi16(rate_lo, 1), c1)));
+        shift_lo = _mm_or_si128(shift_lo, _mm_and_si128(_mm_cmpeq_epi16(eg_shift, c14),
+                                _mm_and_si128(rate_lo, c1)));
+        shift_lo = _mm_and_si128(shift_lo, eg_state_mask);
+
+        // Higher rates step every sample
+        shift_hi = _mm_and_si128(_mm_cmpeq_epi16(rate_lo, zero), inc0);
+        shift_hi = _mm_or_si128(shift_hi, _mm_and_si128(_mm_cmpeq_epi16(rate_lo, c1), inc1));
+        shift_hi = _mm_or_si128(shift_hi, _mm_and_si128(_mm_cmpeq_epi16(rate_lo, c2), inc2));
+        shift_hi = _mm_or_si128(shift_hi, _mm_and_si128(_mm_cmpeq_epi16(rate_lo, c3), inc3));
+        shift_hi = _mm_min_epi16(_mm_add_epi16(_mm_and_si128(rate_hi, c3), shift_hi), c3);
+        shift_hi = _mm_or_si128(shift_hi, _mm_and_si128(_mm_cmpeq_epi16(shift_hi, zero), eg_state));
+
+        shift = _mm_cmplt_epi16(rate_hi, c12);
+        shift = _mm_or_si128(_mm_and_si128(shift, shift_lo), _mm_andnot_si128(shift, shift_hi));
+        shift = _mm_andnot_si128(_mm_cmpeq_epi16(reg_rate, zero), shift);
+
+        // Instant attack and envelope off
+        eg_off = _mm_cmpeq_epi16(_mm_and_si128(rout, c1f8), c1f8);
+        new_rout = _mm_andnot_si128(_mm_and_si128(reset, rate15), rout);
+        new_rout = _mm_or_si128(new_rout, _mm_and_si128(_mm_andnot_si128(_mm_or_si128(is_att, reset), eg_off), c1ff));
+
+        shift_pos = _mm_cmpgt_epi16(shift, zero);
+        rout_zero = _mm_cmpeq_epi16(rout, zero);
+        sl_reached = _mm_cmpeq_epi16(_mm_srai_epi16(rout, 4),
+                                     _mm_loadu_si128((const __m128i *)&vec->reg_sl[ii]));
+
+        not_rout = _mm_xor_si128(rout, ones);
+        att_inc = _mm_and_si128(_mm_cmpeq_epi16(shift, c1), _mm_slli_epi16(not_rout, 1));
+        att_inc = _mm_or_si128(att_inc, _mm_and_si128(_mm_cmpeq_epi16(shift, c2), _mm_slli_epi16(not_rout, 2)));
+        att_inc = _mm_or_si128(att_inc, _mm_and_si128(_mm_cmpeq_epi16(shift, c3), _mm_slli_epi16(not_rout, 3)));
+        att_inc = _mm_srai_epi16(att_inc, 4);
+        att_cond = _mm_and_si128(_mm_andnot_si128(rout_zero, is_att),
+                                 _mm_andnot_si128(rate15, _mm_and_si128(key, shift_pos)));
+
+        lin_inc = _mm_and_si128(_mm_cmpeq_epi16(shift, c1), c1);
+        lin_inc = _mm_or_si128(lin_inc, _mm_and_si128(_mm_cmpeq_epi16(shift, c2), c2));
+        lin_inc = _mm_or_si128(lin_inc, _mm_and_si128(_mm_cmpeq_epi16(shift, c3), c4));
+        lin_cond = _mm_or_si128(_mm_or_si128(is_sus, is_rel), _mm_andnot_si128(sl_reached, is_dec));
+        lin_cond = _mm_andnot_si128(_mm_or_si128(eg_off, reset), lin_cond);
+
+        new_rout = _mm_add_epi16(new_rout, _mm_and_si128(att_cond, att_inc));
+        new_rout = _mm_add_epi16(new_rout, _mm_and_si128(lin_cond, lin_inc));
+        _mm_storeu_si128((__m128i *)&vec->eg_rout[ii], _mm_and_si128(new_rout, c1ff));
+
+        new_gen = _mm_add_epi16(gen, _mm_and_si128(_mm_and_si128(is_att, rout_zero), c1));
+        new_gen = _mm_add_epi16(new_gen, _mm_and_si128(_mm_and_si128(is_dec, sl_reached), c1));
+        new_gen = _mm_andnot_si128(reset, new_gen);
+        new_gen = _mm_or_si128(_mm_and_si128(key, new_gen), _mm_andnot_si128(key, c3));
+        _mm_storeu_si128((__m128i *)&vec->eg_gen[ii], new_gen);
+    }
+}
+
+SIMD_TARGET("sse2")
+static inline __m128i OPL3_MulLoSSE2(__m128i a, __m128i b)
+{
+    const __m128i even = _mm_mul_epu32(a, b);
+    const __m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+    return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+                              _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+}
+
+// 4 slots per iteration, see OPL3_VectorPhaseScalar
+SIMD_TARGET("sse2")
+static void OPL3_VectorPhaseSSE2(opl3_vector *vec, const opl3_vector_pg *pg)
+{
+    const __m128i c7 = _mm_set1_epi32(7);
+    const __m128i cffff = _mm_set1_epi32(0xffff);
+    const __m128i vib_on = _mm_set1_epi32(pg->vib_on);
+    const __m128i vib_neg = _mm_set1_epi32(pg->vib_neg);
+    const __m128i vib_shift = _mm_cvtsi32_si128(pg->vib_shift);
+    Bit8u ii;
+
+    for (ii = 0; ii < OPL3_VECTOR_SLOTS; ii += 4)
+    {
+        const __m128i f_num = _mm_loadu_si128((const __m128i *)&vec->f_num[ii]);
+        const __m128i phase = _mm_loadu_si128((const __m128i *)&vec->pg_phase[ii]);
+        const __m128i reset = _mm_loadu_si128((const __m128i *)&vec->pg_reset[ii]);
+        __m128i range, basefreq;
+
+        range = _mm_srl_epi32(_mm_and_si128(_mm_srli_epi32(f_num, 7), c7), vib_shift);
+        range = _mm_and_si128(range, _mm_and_si128(vib_on,
+                              _mm_loadu_si128((const __m128i *)&vec->vib[ii])));
+        range = _mm_sub_epi32(_mm_xor_si128(range, vib_neg), vib_neg);
+        basefreq = _mm_and_si128(_mm_add_epi32(f_num, range), cffff);
+        basefreq = _mm_srli_epi32(OPL3_MulLoSSE2(basefreq,
+                                  _mm_loadu_si128((const __m128i *)&vec->block_mul[ii])), 1);
+        basefreq = _mm_srli_epi32(OPL3_MulLoSSE2(basefreq,
+                                  _mm_loadu_si128((const __m128i *)&vec->mult[ii])), 1);
+        _mm_storeu_si128((__m128i *)&vec->pg_phase_out[ii], _mm_and_si128(_mm_srli_epi32(phase, 9), cffff));
+        _mm_storeu_si128((__m128i *)&vec->pg_phase[ii], _mm_add_epi32(_mm_andnot_si128(reset, phase), basefreq));
+    }
+}
+
+// 16 slots per iteration, see OPL3_VectorEnvelopeScalar
+SIMD_TARGET("avx2")
+static void OPL3_VectorEnvelopeAVX2(opl3_vector *vec, const opl3_vector_eg *eg)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i ones = _mm256_set1_epi16(-1);
+    const __m256i c1 = _mm256_set1_epi16(1);
+    const __m256i c2 = _mm256_set1_epi16(2);
+    const __m256i c3 = _mm256_set1_epi16(3);
+    const __m256i c4 = _mm256_set1_epi16(4);
+    const __m256i c12 = _mm256_set1_epi16(12);
+    const __m256i c13 = _mm256_set1_epi16(13);
+    const __m256i c14 = _mm256_set1_epi16(14);
+    const __m256i c15 = _mm256_set1_epi16(15);
+    const __m256i c1f8 = _mm256_set1_epi16(0x1f8);
+    const __m256i c1ff = _mm256_set1_epi16(0x1ff);
+    const __m256i eg_state = _mm256_set1_epi16(eg->eg_state);
+    const __m256i eg_state_mask = _mm256_cmpgt_epi16(eg_state, zero);
+    const __m256i eg_add = _mm256_set1_epi16(eg->eg_add);
+    const __m256i tremolo = _mm256_set1_epi16(eg->tremolo);
+    const __m256i inc0 = _mm256_set1_epi16(eg->incstep[0]);
+    const __m256i inc1 = _mm256_set1_epi16(eg->incstep[1]);
+    const __m256i inc2 = _mm256_set1_epi16(eg->incstep[2]);
+    const __m256i inc3 = _mm256_set1_epi16(eg->incstep[3]);
+    Bit8u ii;
+
+    for (ii = 0; ii < OPL3_VECTOR_SLOTS; ii += 16)
+    {
+        const __m256i rout = _mm256_loadu_si256((const __m256i *)&vec->eg_rout[ii]);
+        const __m256i gen = _mm256_loadu_si256((const __m256i *)&vec->eg_gen[ii]);
+        const __m256i key = _mm256_loadu_si256((const __m256i *)&vec->key[ii]);
+        const __m256i trem = _mm256_loadu_si256((const __m256i *)&vec->trem[ii]);
+        const __m256i base = _mm256_loadu_si256((const __m256i *)&vec->eg_base[ii]);
+        const __m256i is_att = _mm256_cmpeq_epi16(gen, zero);
+        const __m256i is_dec = _mm256_cmpeq_epi16(gen, c1);
+        const __m256i is_sus = _mm256_cmpeq_epi16(gen, c2);
+        const __m256i is_rel = _mm256_cmpeq_epi16(gen, c3);
+        const __m256i reset = _mm256_and_si256(key, is_rel);
+        __m256i reg_rate, rate, rate_hi, rate_lo, rate15, eg_shift;
+        __m256i shift_lo, shift_hi, shift, eg_off, shift_pos, rout_zero, sl_reached;
+        __m256i new_rout, not_rout, att_inc, lin_inc, att_cond, lin_cond, new_gen;
+        __m256i reset32;
+
+        _mm256_storeu_si256((__m256i *)&vec->eg_out[ii],
+                            _mm256_add_epi16(_mm256_add_epi16(rout, base), _mm256_and_si256(trem, tremolo)));
+
+        reg_rate = _mm256_and_si256(_mm256_or_si256(reset, is_att),
+                                    _mm256_loadu_si256((const __m256i *)&vec->rate_ar[ii]));
+        reg_rate = _mm256_or_si256(reg_rate, _mm256_and_si256(is_dec,
+                                   _mm256_loadu_si256((const __m256i *)&vec->rate_dr[ii])));
+        reg_rate = _mm256_or_si256(reg_rate, _mm256_and_si256(is_sus,
+                                   _mm256_loadu_si256((const __m256i *)&vec->rate_sus[ii])));
+        reg_rate = _mm256_or_si256(reg_rate, _mm256_andnot_si256(reset, _mm256_and_si256(is_rel,
+                                   _mm256_loadu_si256((const __m256i *)&vec->rate_rr[ii]))));
+        // Widening works on the 128 bit halves separately
+        reset32 = _mm256_cvtepi16_epi32(_mm256_castsi256_si128(reset));
+        _mm256_storeu_si256((__m256i *)&vec->pg_reset[ii], reset32);
+        reset32 = _mm256_cvtepi16_epi32(_mm256_extracti128_si256(reset, 1));
+        _mm256_storeu_si256((__m256i *)&vec->pg_reset[ii + 8], reset32);
+
+        rate = _mm256_add_epi16(_mm256_loadu_si256((const __m256i *)&vec->ks[ii]), _mm256_slli_epi16(reg_rate, 2));
+        rate_hi = _mm256_min_epi16(_mm256_srai_epi16(rate, 2), c15);
+        rate_lo = _mm256_and_si256(rate, c3);
+        rate15 = _mm256_cmpeq_epi16(rate_hi, c15);
+
+        eg_shift = _mm256_add_epi16(rate_hi, eg_add);
+        shift_lo = _mm256_and_si256(_mm256_cmpeq_epi16(eg_shift, c12), c1);
+        shift_lo = _mm256_or_si256(shift_lo, _mm256_and_si256(_mm256_cmpeq_epi16(eg_shift, c13),
+                                   _mm256_and_si256(_mm256_srli_epi16(rate_lo, 1), c1)));
+        shift_lo = _mm256_or_si256(shift_lo, _mm256_and_si256(_mm256_cmpeq_epi16(eg_shift, c14),
+                                   _mm256_and_si256(rate_lo, c1)));
+        shift_lo = _mm256_and_si256(shift_lo, eg_state_mask);
+
+        shift_hi = _mm256_and_si256(_mm256_cmpeq_epi16(rate_lo, zero), inc0);
+        shift_hi = _mm256_or_si256(shift_hi, _mm256_and_si256(_mm256_cmpeq_epi16(rate_lo, c1), inc1));
+        shift_hi = _mm256_or_si256(shift_hi, _mm256_and_si256(_mm256_cmpeq_epi16(rate_lo, c2), inc2));
+        shift_hi = _mm256_or_si256(shift_hi, _mm256_and_si256(_mm256_cmpeq_epi16(rate_lo, c3), inc3));
+        shift_hi = _mm256_min_epi16(_mm256_add_epi16(_mm256_and_si256(rate_hi, c3), shift_hi), c3);
+        shift_hi = _mm256_or_si256(shift_hi, _mm256_and_si256(_mm256_cmpeq_epi16(shift_hi, zero), eg_state));
+
+        shift = _mm256_cmpgt_epi16(c12, rate_hi);
+        shift = _mm256_blendv_epi8(shift_hi, shift_lo, shift);
+        shift = _mm256_andnot_si256(_mm256_cmpeq_epi16(reg_rate, zero), shift);
+
+        eg_off = _mm256_cmpeq_epi16(_mm256_and_si256(rout, c1f8), c1f8);
+        new_rout = _mm256_andnot_si256(_mm256_and_si256(reset, rate15), rout);
+        new_rout = _mm256_or_si256(new_rout, _mm256_and_si256(_mm256_andnot_si256(_mm256_or_si256(is_att, reset), eg_off), c1ff));
+
+        shift_pos = _mm256_cmpgt_epi16(shift, zero);
+        rout_zero = _mm256_cmpeq_epi16(rout, zero);
+        sl_reached = _mm256_cmpeq_epi16(_mm256_srai_epi16(rout, 4),
+                                        _mm256_loadu_si256((const __m256i *)&vec->reg_sl[ii]));
+
+        not_rout = _mm256_xor_si256(rout, ones);
+        att_inc = _mm256_and_si256(_mm256_cmpeq_epi16(shift, c1), _mm256_slli_epi16(not_rout, 1));
+        att_inc = _mm256_or_si256(att_inc, _mm256_and_si256(_mm256_cmpeq_epi16(shift, c2), _mm256_slli_epi16(not_rout, 2)));
+        att_inc = _mm256_or_si256(att_inc, _mm256_and_si256(_mm256_cmpeq_epi16(shift, c3), _mm256_slli_epi16(not_rout, 3)));
+        att_inc = _mm256_srai_epi16(att_inc, 4);
+        att_cond = _mm256_and_si256(_mm256_andnot_si256(rout_zero, is_att),
+                                    _mm256_andnot_si256(rate15, _mm256_and_si256(key, shift_pos)));
+
+        lin_inc = _mm256_and_si256(_mm256_cmpeq_epi16(shift, c1), c1);
+        lin_inc = _mm256_or_si256(lin_inc, _mm256_and_si256(_mm256_cmpeq_epi16(shift, c2), c2));
+        lin_inc = _mm256_or_si256(lin_inc, _mm256_and_si256(_mm256_cmpeq_epi16(shift, c3), c4));
+        lin_cond = _mm256_or_si256(_mm256_or_si256(is_sus, is_rel), _mm256_andnot_si256(sl_reached, is_dec));
+        lin_cond = _mm256_andnot_si256(_mm256_or_si256(eg_off, reset), lin_cond);
+
+        new_rout = _mm256_add_epi16(new_rout, _mm256_and_si256(att_cond, att_inc));
+        new_rout = _mm256_add_epi16(new_rout, _mm256_and_si256(lin_cond, lin_inc));
+        _mm256_storeu_si256((__m256i *)&vec->eg_rout[ii], _mm256_and_si256(new_rout, c1ff));
+
+        new_gen = _mm256_add_epi16(gen, _mm256_and_si256(_mm256_and_si256(is_att, rout_zero), c1));
+        new_gen = _mm256_add_epi16(new_gen, _mm256_and_si256(_mm256_and_si256(is_dec, sl_reached), c1));
+        new_gen = _mm256_andnot_si256(reset, new_gen);
+        new_gen = _mm256_or_si256(_mm256_and_si256(key, new_gen), _mm256_andnot_si256(key, c3));
+        _mm256_storeu_si256((__m256i *)&vec->eg_gen[ii], new_gen);
+    }
+}
+
+// 8 slots per iteration, see OPL3_VectorPhaseScalar
+SIMD_TARGET("avx2")
+static void OPL3_VectorPhaseAVX2(opl3_vector *vec, const opl3_vector_pg *pg)
+{
+    const __m256i c7 = _mm256_set1_epi32(7);
+    const __m256i cffff = _mm256_set1_epi32(0xffff);
+    const __m256i vib_on = _mm256_set1_epi32(pg->vib_on);
+    const __m256i vib_neg = _mm256_set1_epi32(pg->vib_neg);
+    const __m128i vib_shift = _mm_cvtsi32_si128(pg->vib_shift);
+    Bit8u ii;
+
+    for (ii = 0; ii < OPL3_VECTOR_SLOTS; ii += 8)
+    {
+        const __m256i f_num = _mm256_loadu_si256((const __m256i *)&vec->f_num[ii]);
+        const __m256i phase = _mm256_loadu_si256((const __m256i *)&vec->pg_phase[ii]);
+        const __m256i reset = _mm256_loadu_si256((const __m256i *)&vec->pg_reset[ii]);
+        __m256i range, basefreq;
+
+        range = _mm256_srl_epi32(_mm256_and_si256(_mm256_srli_epi32(f_num, 7), c7), vib_shift);
+        range = _mm256_and_si256(range, _mm256_and_si256(vib_on,
+                                 _mm256_loadu_si256((const __m256i *)&vec->vib[ii])));
+        range = _mm256_sub_epi32(_mm256_xor_si256(range, vib_neg), vib_neg);
+        basefreq = _mm256_and_si256(_mm256_add_epi32(f_num, range), cffff);
+        basefreq = _mm256_srli_epi32(_mm256_mullo_epi32(basefreq,
+                                     _mm256_loadu_si256((const __m256i *)&vec->block_mul[ii])), 1);
+        basefreq = _mm256_srli_epi32(_mm256_mullo_epi32(basefreq,
+                                     _mm256_loadu_si256((const __m256i *)&vec->mult[ii])), 1);
+        _mm256_storeu_si256((__m256i *)&vec->pg_phase_out[ii], _mm256_and_si256(_mm256_srli_epi32(phase, 9), cffff));
+        _mm256_storeu_si256((__m256i *)&vec->pg_phase[ii], _mm256_add_epi32(_mm256_andnot_si256(reset, phase), basefreq));
+    }
+}
+
+#endif // SCUMMVM_SIMD_X86
+
+// Rhythm mode part of OPL3_PhaseGenerate, and the noise generator which
+// advances once per slot
+static void OPL3_VectorRhythm(opl3_vector *vec)
+{
+    opl3_chip *chip = vec->chip;
+    Bit32u noise = chip->noise;
+    Bit32u noise_hh = 0;
+    Bit32u noise_sd = 0;
+    Bit16u phase;
+    Bit8u rm_xor;
+    Bit8u ii;
+
+    for (ii = 0; ii < 36; ii++)
+    {
+        if (ii == 13)
+        {
+            noise_hh = noise;
+        }
+        else if (ii == 16)
+        {
+            noise_sd = noise;
+        }
+        noise = (noise >> 1) | ((((noise >> 14) ^ noise) & 0x01) << 22);
+    }
+    chip->noise = noise;
+
+    phase = (Bit16u)vec->pg_phase_out[13];
+    chip->rm_hh_bit2 = (phase >> 2) & 1;
+    chip->rm_hh_bit3 = (phase >> 3) & 1;
+    chip->rm_hh_bit7 = (phase >> 7) & 1;
+    chip->rm_hh_bit8 = (phase >> 8) & 1;
+    if (!(chip->rhy & 0x20))
+    {
+        return;
+    }
+
+    // hh, still using the tc bits of the previous sample
+    rm_xor = (chip->rm_hh_bit2 ^ chip->rm_hh_bit7)
+           | (chip->rm_hh_bit3 ^ chip->rm_tc_bit5)
+           | (chip->rm_tc_bit3 ^ chip->rm_tc_bit5);
+    vec->pg_phase_out[13] = rm_xor << 9;
+    if (rm_xor ^ (noise_hh & 1))
+    {
+        vec->pg_phase_out[13] |= 0xd0;
+    }
+    else
+    {
+        vec->pg_phase_out[13] |= 0x34;
+    }
+    // sd
+    vec->pg_phase_out[16] = (chip->rm_hh_bit8 << 9)
+                          | ((chip->rm_hh_bit8 ^ (noise_sd & 1)) << 8);
+    // tc
+    phase = (Bit16u)vec->pg_phase_out[17];
+    chip->rm_tc_bit3 = (phase >> 3) & 1;
+    chip->rm_tc_bit5 = (phase >> 5) & 1;
+    rm_xor = (chip->rm_hh_bit2 ^ chip->rm_hh_bit7)
+           | (chip->rm_hh_bit3 ^ chip->rm_tc_bit5)
+           | (chip->rm_tc_bit3 ^ chip->rm_tc_bit5);
+    vec->pg_phase_out[17] = (rm_xor << 9) | 0x80;
+}
+
+// Feedback and operator output, these depend on the outputs of the
+// preceding slots and have to run in order
+static void OPL3_VectorSlotGenerate(opl3_vector *vec, Bit8u first, Bit8u last)
+{
+    Bit8u ii;
+
+    for (ii = first; ii < last; ii++)
+    {
+        Bit16s out = vec->value[ii];
+        if (vec->fb[ii] != 0x00)
+        {
+            vec->value[OPL3_VECTOR_FBMOD + ii] = (vec->prout[ii] + out) >> (0x09 - vec->fb[ii]);
+        }
+        else
+        {
+            vec->value[OPL3_VECTOR_FBMOD + ii] = 0;
+        }
+        vec->prout[ii] = out;
+        vec->value[ii] = envelope_sin[vec->wf[ii]]((Bit16u)(vec->pg_phase_out[ii] + vec->value[vec->mod[ii]]),
+                                                   vec->eg_out[ii]);
+    }
+}
+
+static Bit32s OPL3_VectorMix(const opl3_vector *vec, const Bit16u *mask)
+{
+    Bit32s mix = 0;
+    Bit16s accm;
+    Bit8u ii;
+
+    for (ii = 0; ii < 18; ii++)
+    {
+        accm = vec->value[vec->ch_out[ii][0]] + vec->value[vec->ch_out[ii][1]]
+             + vec->value[vec->ch_out[ii][2]] + vec->value[vec->ch_out[ii][3]];
+        mix += (Bit16s)(accm & mask[ii]);
+    }
+    return mix;
+}
+
+Bit8u OPL3_VectorSupported(Bit8u impl)
+{
+    switch (impl)
+    {
+    case vector_impl_scalar:
+        return 1;
+#ifdef SCUMMVM_SIMD_X86
+    case vector_impl_sse2:
+        return Common::hasSSE2() ? 1 : 0;
+    case vector_impl_avx2:
+        return Common::hasAVX2() ? 1 : 0;
+#endif
+    default:
+        return 0;
+    }
+}
+
+Bit8u OPL3_VectorSetImpl(opl3_vector *vec, Bit8u impl)
+{
+    if (!OPL3_VectorSupported(impl))
+    {
+        return 0;
+    }
+    switch (impl)
+    {
+#ifdef SCUMMVM_SIMD_X86
+    case vector_impl_sse2:
+        vec->envelope = OPL3_VectorEnvelopeSSE2;
+        vec->phase = OPL3_VectorPhaseSSE2;
+        break;
+    case vector_impl_avx2:
+        vec->envelope = OPL3_VectorEnvelopeAVX2;
+        vec->phase = OPL3_VectorPhaseAVX2;
+        break;
+#endif
+    default:
+        vec->envelope = OPL3_VectorEnvelopeScalar;
+        vec->phase = OPL3_VectorPhaseScalar;
+        break;
+    }
+    vec->impl = impl;
+    return 1;
+}
+
+void OPL3_VectorReset(opl3_vector *vec, opl3_chip *chip)
+{
+    Bit8u impl;
+    Bit8u ii;
+
+    memset(vec, 0, sizeof(opl3_vector));
+    vec->chip = chip;
+    for (ii = 0; ii < 36; ii++)
+    {
+        vec->eg_rout[ii] = chip->slot[ii].eg_rout;
+        vec->eg_gen[ii] = chip->slot[ii].eg_gen;
+        vec->eg_out[ii] = chip->slot[ii].eg_out;
+        vec->pg_phase[ii] = chip->slot[ii].pg_phase;
+        vec->pg_phase_out[ii] = chip->slot[ii].pg_phase_out;
+        vec->prout[ii] = chip->slot[ii].prout;
+        vec->value[ii] = chip->slot[ii].out;
+        vec->value[OPL3_VECTOR_FBMOD + ii] = chip->slot[ii].fbmod;
+    }
+    OPL3_VectorSync(vec);
+
+    impl = vector_impl_count - 1;
+    while (!OPL3_VectorSetImpl(vec, impl))
+    {
+        impl--;
+    }
+}
+
+void OPL3_VectorGenerate(opl3_vector *vec, Bit16s *buf)
+{
+    opl3_chip *chip = vec->chip;
+    opl3_vector_eg eg;
+    opl3_vector_pg pg;
+    Bit8u ii;
+
+    if (vec->dirty)
+    {
+        OPL3_VectorSync(vec);
+    }
+
+    buf[1] = OPL3_ClipSample(chip->mixbuff[1]);
+
+    eg.eg_state = chip->eg_state;
+    eg.eg_add = chip->eg_add;
+    eg.tremolo = chip->tremolo;
+    for (ii = 0; ii < 4; ii++)
+    {
+        eg.incstep[ii] = eg_incstep[ii][chip->timer & 0x03];
+    }
+    vec->envelope(vec, &eg);
+
+    pg.vib_on = (chip->vibpos & 3) ? 0xffffffff : 0;
+    pg.vib_neg = (chip->vibpos & 4) ? 0xffffffff : 0;
+    pg.vib_shift = (chip->vibpos & 1) + chip->vibshift;
+    vec->phase(vec, &pg);
+    OPL3_VectorRhythm(vec);
+
+    OPL3_VectorSlotGenerate(vec, 0, 15);
+    chip->mixbuff[0] = OPL3_VectorMix(vec, vec->cha);
+    OPL3_VectorSlotGenerate(vec, 15, 18);
+
+    buf[0] = OPL3_ClipSample(chip->mixbuff[0]);
+
+    OPL3_VectorSlotGenerate(vec, 18, 33);
+    chip->mixbuff[1] = OPL3_VectorMix(vec, vec->chb);
+    OPL3_VectorSlotGenerate(vec, 33, 36);
+
+    OPL3_UpdateTimers(chip);
+    if (OPL3_ProcessWriteBuf(chip))
+    {
+        vec->dirty = 1;
+    }
+}
+
+void OPL3_VectorGenerateResampled(opl3_vector *vec, Bit16s *buf)
+{
+    opl3_chip *chip = vec->chip;
+
+    while (chip->samplecnt >= chip->rateratio)
+    {
+        chip->oldsamples[0] = chip->samples[0];
+        chip->oldsamples[1] = chip->samples[1];
+        OPL3_VectorGenerate(vec, chip->samples);
+        chip->samplecnt -= chip->rateratio;
+    }
+    buf[0] = (Bit16s)((chip->oldsamples[0] * (chip->rateratio - chip->samplecnt)
+                     + chip->samples[0] * chip->samplecnt) / chip->rateratio);
+    buf[1] = (Bit16s)((chip->oldsamples[1] * (chip->rateratio - chip->samplecnt)
+                     + chip->samples[1] * chip->samplecnt) / chip->rateratio);
+    chip->samplecnt += 1 << RSM_FRAC;
+}
+
+void OPL3_VectorWriteReg(opl3_vector *vec, Bit16u reg, Bit8u v)
+{
+    OPL3_WriteReg(vec->chip, reg, v);
+    vec->dirty = 1;
+}
+
+void OPL3_VectorWriteRegBuffered(opl3_vector *vec, Bit16u reg, Bit8u v)
+{
+    OPL3_WriteRegBuffered(vec->chip, reg, v);
+    vec->dirty = 1;
+}
+
+void OPL3_VectorGenerateStream(opl3_vector *vec, Bit16s *sndptr, Bit32u numsamples)
+{
+    Bit32u i;
+
+    for(i = 0; i < numsamples; i++)
+    {
+        OPL3_VectorGenerateResampled(vec, sndptr);
+        sndptr += 2;
+    }
+}
+
 OPL::OPL(Config::OplType type) : _type(type), _rate(0) {
 }
 
@@ -1478,7 +2298,39 @@ byte OPL::read(int port) {
 }
 
 void OPL::generateSamples(int16*buffer, int length) {
-	OPL3_GenerateStream(&chip, (Bit16s*)buffer, (Bit16u)length / 2);
+	OPL3_GenerateStream(&chip, (Bit16s*)buffer, (Bit32u)length / 2);
+}
+
+VectorOPL::VectorOPL(Config::OplType type) : OPL(type) {
+}
+
+bool VectorOPL::init() {
+	if (!OPL::init())
+		return false;
+
+	OPL3_VectorReset(&_vector, &chip);
+	return true;
+}
+
+void VectorOPL::reset() {
+	OPL::reset();
+	OPL3_VectorReset(&_vector, &chip);
+}
+
+void VectorOPL::write(int port, int val) {
+	OPL::write(port, val);
+
+	// Data writes change the register state the vector code works with
+	if (port & 1)
+		_vector.dirty = 1;
+}
+
+void VectorOPL::writeReg(int r, int v) {
+	OPL3_VectorWriteRegBuffered(&_vector, (Bit16u)r, (Bit8u)v);
+}
+
+void VectorOPL::generateSamples(int16 *buffer, int length) {
+	OPL3_VectorGenerateStream(&_vector, (Bit16s *)buffer, (Bit32u)length / 2);
 }
 
 }
@@ -147,6 +147,85 @@ struct _opl3_chip {
     opl3_writebuf writebuf[OPL_WRITEBUF_SIZE];
 };
 
+//
+// Vectorized variant
+//
+// Keeps the operator state in struct-of-arrays form, so the envelope and
+// phase generators can process all 36 operators with SIMD instructions.
+// The register state stays in an opl3_chip, which is shared with the
+// scalar emulator code. The output is bit identical to OPL3_Generate().
+//
+
+#define OPL3_VECTOR_SLOTS   48
+#define OPL3_VECTOR_FBMOD   36
+#define OPL3_VECTOR_ZERO    72
+
+// Implementations of the envelope and phase generators
+enum {
+    vector_impl_scalar = 0,
+    vector_impl_sse2,
+    vector_impl_avx2,
+    vector_impl_count
+};
+
+typedef struct _opl3_vector opl3_vector;
+
+typedef struct _opl3_vector_eg {
+    Bit16s eg_state;
+    Bit16s eg_add;
+    Bit16s tremolo;
+    Bit16s incstep[4];
+} opl3_vector_eg;
+
+typedef struct _opl3_vector_pg {
+    Bit32u vib_on;
+    Bit32u vib_neg;
+    Bit32u vib_shift;
+} opl3_vector_pg;
+
+typedef void (*opl3_vector_egfunc)(opl3_vector *vec, const opl3_vector_eg *eg);
+typedef void (*opl3_vector_pgfunc)(opl3_vector *vec, const opl3_vector_pg *pg);
+
+struct _opl3_vector {
+    opl3_chip *chip;
+    Bit8u dirty;
+    Bit8u impl;
+    opl3_vector_egfunc envelope;
+    opl3_vector_pgfunc phase;
+
+    // Operator state, updated every sample
+    Bit16s eg_rout[OPL3_VECTOR_SLOTS];
+    Bit16s eg_gen[OPL3_VECTOR_SLOTS];
+    Bit16s eg_out[OPL3_VECTOR_SLOTS];
+    Bit32u pg_reset[OPL3_VECTOR_SLOTS];
+    Bit32u pg_phase[OPL3_VECTOR_SLOTS];
+    Bit32u pg_phase_out[OPL3_VECTOR_SLOTS];
+    Bit16s prout[OPL3_VECTOR_SLOTS];
+    // Operator outputs, followed by the feedback values and a zero
+    Bit16s value[OPL3_VECTOR_ZERO + 1];
+
+    // Register state, copied from the chip after register writes
+    Bit16s key[OPL3_VECTOR_SLOTS];
+    Bit16s rate_ar[OPL3_VECTOR_SLOTS];
+    Bit16s rate_dr[OPL3_VECTOR_SLOTS];
+    Bit16s rate_sus[OPL3_VECTOR_SLOTS];
+    Bit16s rate_rr[OPL3_VECTOR_SLOTS];
+    Bit16s reg_sl[OPL3_VECTOR_SLOTS];
+    Bit16s ks[OPL3_VECTOR_SLOTS];
+    Bit16s eg_base[OPL3_VECTOR_SLOTS];
+    Bit16s trem[OPL3_VECTOR_SLOTS];
+    Bit32u f_num[OPL3_VECTOR_SLOTS];
+    Bit32u block_mul[OPL3_VECTOR_SLOTS];
+    Bit32u mult[OPL3_VECTOR_SLOTS];
+    Bit32u vib[OPL3_VECTOR_SLOTS];
+    Bit8u wf[OPL3_VECTOR_SLOTS];
+    Bit8u fb[OPL3_VECTOR_SLOTS];
+    Bit8u mod[OPL3_VECTOR_SLOTS];
+    Bit8u ch_out[18][4];
+    Bit16u cha[18];
+    Bit16u chb[18];
+};
+
 void OPL3_Generate(opl3_chip *chip, Bit16s *buf);
 void OPL3_GenerateResampled(opl3_chip *chip, Bit16s *buf);
 void OPL3_Reset(opl3_chip *chip, Bit32u samplerate);
@@ -154,14 +233,25 @@ void OPL3_WriteReg(opl3_chip *chip, Bit16u reg, Bit8u v);
 void OPL3_WriteRegBuffered(opl3_chip *chip, Bit16u reg, Bit8u v);
 void OPL3_GenerateStream(opl3_chip *chip, Bit16s *sndptr, Bit32u numsamples);
 
+Bit8u OPL3_VectorSupported(Bit8u impl);
+Bit8u OPL3_VectorSetImpl(opl3_vector *vec, Bit8u impl);
+void OPL3_VectorReset(opl3_vector *vec, opl3_chip *chip);
+void OPL3_VectorGenerate(opl3_vector *vec, Bit16s *buf);
+void OPL3_VectorGenerateResampled(opl3_vector *vec, Bit16s *buf);
+void OPL3_VectorWriteReg(opl3_vector *vec, Bit16u reg, Bit8u v);
+void OPL3_VectorWriteRegBuffered(opl3_vector *vec, Bit16u reg, Bit8u v);
+void OPL3_VectorGenerateStream(opl3_vector *vec, Bit16s *sndptr, Bit32u numsamples);
+
 class OPL : public ::OPL::EmulatedOPL {
 private:
 	Config::OplType _type;
 	uint _rate;
-	opl3_chip chip;
 	uint address[2];
 	void dualWrite(uint8 index, uint8 reg, uint8 val);
 
+protected:
+	opl3_chip chip;
+
 public:
 	OPL(Config::OplType type);
 	~OPL();
@@ -180,6 +270,28 @@ protected:
 	void generateSamples(int16 *buffer, int length);
 };
 
+/**
+ * Nuked OPL emulator using the vectorized operator code. Sounds exactly
+ * like the scalar one, but renders considerably faster.
+ */
+class VectorOPL : public OPL {
+private:
+	opl3_vector _vector;
+
+public:
+	VectorOPL(Config::OplType type);
+
+	bool init();
+	void reset();
+
+	void write(int a, int v);
+
+	void writeReg(int r, int v);
+
+protected:
+	void generateSamples(int16 *buffer, int length);
+};
+
 }
 }
 
@@ -0,0 +1,208 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+
+#include "audio/soundcache.h"
+#include "audio/audiostream.h"
+
+#include "common/archive.h"
+#include "common/array.h"
+#include "common/debug.h"
+#include "common/mutex.h"
+#include "common/stream.h"
+
+namespace Audio {
+
+/**
+ * The decoded PCM of a sound, shared between the cache and the streams
+ * playing it. The mixer deletes streams on its own thread, so the
+ * reference count is guarded by a mutex. The samples do not change once
+ * the sound is complete.
+ */
+class DecodedSound {
+public:
+	Common::String key;
+	Common::Array<int16> samples;
+	int rate;
+	bool stereo;
+
+	DecodedSound() : rate(0), stereo(false), _refCount(1) {}
+
+	uint32 getSize() const { return samples.size() * sizeof(int16); }
+
+	void incRef() {
+		Common::StackLock lock(_mutex);
+		++_refCount;
+	}
+
+	void decRef() {
+		_mutex.lock();
+		const bool last = (--_refCount == 0);
+		_mutex.unlock();
+
+		if (last)
+			delete this;
+	}
+
+private:
+	~DecodedSound() {}
+
+	Common::Mutex _mutex;
+	uint _refCount;
+};
+
+/**
+ * Plays a sound from the cache.
+ */
+class CachedSoundStream : public SeekableAudioStream {
+public:
+	CachedSoundStream(DecodedSound *sound) : _sound(sound), _pos(0) {
+		_sound->incRef();
+	}
+
+	~CachedSoundStream() {
+		_sound->decRef();
+	}
+
+	int readBuffer(int16 *buffer, const int numSamples) {
+		const uint32 count = MIN<uint32>(numSamples, _sound->samples.size() - _pos);
+		if (count)
+			memcpy(buffer, &_sound->samples[_pos], count * sizeof(int16));
+		_pos += count;
+		return count;
+	}
+
+	bool isStereo() const { return _sound->stereo; }
+	int getRate() const { return _sound->rate; }
+	bool endOfData() const { return _pos >= _sound->samples.size(); }
+
+	bool seek(const Timestamp &where) {
+		const uint32 channels = _sound->stereo ? 2 : 1;
+		const uint32 frame = where.convertToFramerate(_sound->rate).totalNumberOfFrames();
+		if (frame > _sound->samples.size() / channels)
+			return false;
+
+		_pos = frame * channels;
+		return true;
+	}
+
+	Timestamp getLength() const {
+		return Timestamp(0, _sound->samples.size() / (_sound->stereo ? 2 : 1), _sound->rate);
+	}
+
+private:
+	DecodedSound *_sound;
+	uint32 _pos;
+};
+
+DecodedSoundCache::DecodedSoundCache(uint32 maxSize) : _maxSize(maxSize), _size(0), _hits(0), _misses(0) {
+}
+
+DecodedSoundCache::~DecodedSoundCache() {
+	clear();
+}
+
+SeekableAudioStream *DecodedSoundCache::createStream(const Common::Archive &archive, const Common::String &archiveName, const Common::String &name, DecoderProc decoder) {
+	// The length keeps names containing the separator apart
+	Common::String key = name;
+	key.toLowercase();
+	key = Common::String::format("%u:", archiveName.size()) + archiveName + ":" + key;
+
+	SoundMap::iterator i = _map.find(key);
+	if (i != _map.end()) {
+		// Move the sound to the front of the LRU list
+		DecodedSound *sound = *i->_value;
+		_sounds.erase(i->_value);
+		_sounds.push_front(sound);
+		i->_value = _sounds.begin();
+
+		++_hits;
+		return new CachedSoundStream(sound);
+	}
+
+	++_misses;
+
+	Common::SeekableReadStream *file = archive.createReadStreamForMember(name);
+	if (!file)
+		return 0;
+
+	SeekableAudioStream *stream = decoder(file, DisposeAfterUse::YES);
+	if (!stream)
+		return 0;
+
+	// Don't bother decoding sounds into memory which would not fit anyway
+	const uint32 channels = stream->isStereo() ? 2 : 1;
+	const uint64 size = (uint64)stream->getLength().totalNumberOfFrames() * channels * sizeof(int16);
+	if (size > _maxSize)
+		return stream;
+
+	DecodedSound *sound = new DecodedSound();
+	sound->key = key;
+	sound->samples.reserve((uint32)size / sizeof(int16));
+
+	int16 buffer[4096];
+	while (!stream->endOfData()) {
+		const int count = stream->readBuffer(buffer, ARRAYSIZE(buffer));
+		if (count <= 0)
+			break;
+
+		const uint32 pos = sound->samples.size();
+		sound->samples.resize(pos + count);
+		memcpy(&sound->samples[pos], buffer, count * sizeof(int16));
+	}
+
+	sound->rate = stream->getRate();
+	sound->stereo = stream->isStereo();
+	delete stream;
+
+	// The initial reference belongs to the cache, which drops it when the
+	// sound does not fit
+	SeekableAudioStream *result = new CachedSoundStream(sound);
+	if (sound->getSize() > _maxSize) {
+		sound->decRef();
+		return result;
+	}
+
+	evict(_maxSize - sound->getSize());
+	_sounds.push_front(sound);
+	_map[key] = _sounds.begin();
+	_size += sound->getSize();
+
+	debug(5, "DecodedSoundCache: Added '%s', %d bytes used", name.c_str(), _size);
+	return result;
+}
+
+void DecodedSoundCache::clear() {
+	evict(0);
+}
+
+void DecodedSoundCache::evict(uint32 maxSize) {
+	while (_size > maxSize && !_sounds.empty()) {
+		DecodedSound *sound = _sounds.back();
+		_sounds.pop_back();
+		_map.erase(sound->key);
+		_size -= sound->getSize();
+		sound->decRef();
+	}
+}
+
+} // End of namespace Audio
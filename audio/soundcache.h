@@ -0,0 +1,117 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+
+#ifndef AUDIO_SOUNDCACHE_H
+#define AUDIO_SOUNDCACHE_H
+
+#include "common/hashmap.h"
+#include "common/hash-str.h"
+#include "common/list.h"
+#include "common/str.h"
+#include "common/types.h"
+
+namespace Common {
+class Archive;
+class SeekableReadStream;
+}
+
+namespace Audio {
+
+class SeekableAudioStream;
+class DecodedSound;
+
+/**
+ * Cache of decoded compressed sounds.
+ *
+ * Engines play the same short effects over and over, and decoding them from
+ * MP3, Ogg Vorbis or FLAC every time costs a decoder setup and a full decode
+ * pass. This keeps the decoded PCM of recently played archive members, up to
+ * a total size, and hands out streams which play from memory.
+ *
+ * Sounds are evicted in least recently used order. Streams created from an
+ * evicted sound keep playing, the memory is freed once the last of them is
+ * deleted. The streams may be deleted on any thread, like the mixer thread,
+ * but the cache itself is meant to be used from the engine side only.
+ */
+class DecodedSoundCache {
+public:
+	/**
+	 * Pointer to a function creating a decoder, like makeMP3Stream(),
+	 * makeVorbisStream() or makeFLACStream().
+	 */
+	typedef SeekableAudioStream *(*DecoderProc)(Common::SeekableReadStream *stream, DisposeAfterUse::Flag disposeAfterUse);
+
+	/**
+	 * @param maxSize  the maximal size of the decoded PCM kept, in bytes
+	 */
+	DecodedSoundCache(uint32 maxSize);
+	~DecodedSoundCache();
+
+	/**
+	 * Create a stream playing the given archive member. On a miss, the
+	 * member is decoded completely and added to the cache. Sounds larger
+	 * than the whole cache are returned as the plain decoder stream.
+	 *
+	 * @param archive      the archive containing the sound
+	 * @param archiveName  identifies the archive in the cache, usually its
+	 *                     path; archives opened again under the same name
+	 *                     share their sounds
+	 * @param name         the name of the member
+	 * @param decoder      the decoder for the format of the member
+	 * @return the new stream, or 0 if the member could not be opened or
+	 *         decoded
+	 */
+	SeekableAudioStream *createStream(const Common::Archive &archive, const Common::String &archiveName, const Common::String &name, DecoderProc decoder);
+
+	/** Remove all sounds from the cache. */
+	void clear();
+
+	/** The number of streams created from cached sounds. */
+	uint32 getHits() const { return _hits; }
+
+	/** The number of streams which required decoding. */
+	uint32 getMisses() const { return _misses; }
+
+	/** The size of the decoded PCM in the cache, in bytes. */
+	uint32 getSize() const { return _size; }
+
+private:
+	/** Each sound holds a reference for the cache. */
+	typedef Common::List<DecodedSound *> SoundList;
+	typedef Common::HashMap<Common::String, SoundList::iterator> SoundMap;
+
+	void evict(uint32 maxSize);
+
+	const uint32 _maxSize;
+	uint32 _size;
+	uint32 _hits;
+	uint32 _misses;
+
+	/** The cached sounds, most recently used first. */
+	SoundList _sounds;
+	SoundMap _map;
+};
+
+} // End of namespace Audio
+
+#endif
@@ -534,6 +534,11 @@ bool SdlEventSource::pollEvent(Common::Event &event) {
 		return true;
 	}
 
+	// Engines waiting for input still get the frames the frame pacing held
+	// back
+	if (_graphicsManager)
+		_graphicsManager->presentPendingFrame();
+
 	SDL_Event ev;
 	while (SDL_PollEvent(&ev)) {
 		preprocessEvents(&ev);
@@ -63,6 +63,17 @@ protected:
 	 */
 	virtual AbstractFSNode *getChild(const Common::String &name) const = 0;
 
+	/**
+	 * Returns the child node with the given name, which is known to exist
+	 * with the given type from an earlier listing of this directory.
+	 * Backends which can create such a node without accessing the file
+	 * system should do so. The default implementation calls getChild().
+	 *
+	 * @param name        the name of the child, as returned by its getName()
+	 * @param isDirectory whether the child is a directory
+	 */
+	virtual AbstractFSNode *getListedChild(const Common::String &name, bool isDirectory) const { return getChild(name); }
+
 	/**
 	 * The parent node of this directory.
 	 * The parent of the root is the root itself.
@@ -119,6 +130,32 @@ public:
 	 */
 	virtual bool getChildren(AbstractFSList &list, ListMode mode, bool hidden) const = 0;
 
+	/**
+	 * Returns a stamp of this directory which changes whenever entries are
+	 * added to, removed from or renamed in it, usually its modification
+	 * time. It is used to check whether a listing of the directory stored
+	 * in a DirectoryIndex, possibly during an earlier run, is still valid.
+	 * The listing has to be reproducible through getListedChild().
+	 *
+	 * @param stamp set to the stamp of the directory
+	 * @return false if this is not a directory, or if the backend cannot
+	 *         provide a reliable stamp for it (the default)
+	 */
+	virtual bool getDirectoryStamp(uint32 &stamp) const { return false; }
+
+	/**
+	 * Returns the size and a stamp of this file which changes whenever its
+	 * contents change, usually its modification time. It is used to check
+	 * whether data computed from the file, possibly during an earlier run,
+	 * is still valid.
+	 *
+	 * @param size  set to the size of the file
+	 * @param stamp set to the stamp of the file
+	 * @return false if this is not a file, or if the backend cannot provide
+	 *         a reliable stamp for it (the default)
+	 */
+	virtual bool getFileStamp(uint32 &size, uint32 &stamp) const { return false; }
+
 	/**
 	 * Returns a human readable path string.
 	 *
@@ -33,6 +33,7 @@
 #define FORBIDDEN_SYMBOL_EXCEPTION_srandom
 
 #include "backends/fs/posix/posix-fs.h"
+#include "backends/fs/posix/posix-mappedstream.h"
 #include "backends/fs/stdiostream.h"
 #include "common/algorithm.h"
 
@@ -47,6 +48,7 @@
 #include <stdio.h>
 #include <errno.h>
 #include <fcntl.h>
+#include <time.h>
 
 #ifdef __OS2__
 #define INCL_DOS
@@ -134,6 +136,58 @@ AbstractFSNode *POSIXFilesystemNode::getChild(const Common::String &n) const {
 	return makeNode(newPath);
 }
 
+AbstractFSNode *POSIXFilesystemNode::getListedChild(const Common::String &n, bool isDirectory) const {
+	assert(_isDirectory);
+	assert(!n.contains('/'));
+
+	// Set up the node like getChildren() does, without calling stat()
+	POSIXFilesystemNode *entry = new POSIXFilesystemNode(*this);
+	entry->_displayName = n;
+	if (_path.lastChar() != '/')
+		entry->_path += '/';
+	entry->_path += n;
+	entry->_isDirectory = isDirectory;
+	entry->_isValid = true;
+
+	return entry;
+}
+
+bool POSIXFilesystemNode::getDirectoryStamp(uint32 &stamp) const {
+	// Relative paths depend on the current directory, and the roots of
+	// OS/2 and PS Vita are virtual
+	if (!_isDirectory || !_path.hasPrefix("/") || _path == "/")
+		return false;
+
+	struct stat st;
+	if (stat(_path.c_str(), &st) != 0 || !S_ISDIR(st.st_mode))
+		return false;
+
+	// The modification time has a resolution of one second, so a directory
+	// modified just now may still change without changing its stamp
+	if (st.st_mtime >= time(nullptr) - 1)
+		return false;
+
+	stamp = (uint32)st.st_mtime;
+	return true;
+}
+
+bool POSIXFilesystemNode::getFileStamp(uint32 &size, uint32 &stamp) const {
+	if (_isDirectory || !_path.hasPrefix("/"))
+		return false;
+
+	struct stat st;
+	if (stat(_path.c_str(), &st) != 0 || !S_ISREG(st.st_mode) || st.st_size > 0x7FFFFFFF)
+		return false;
+
+	// Same as for directories, a file written just now may still change
+	if (st.st_mtime >= time(nullptr) - 1)
+		return false;
+
+	size = (uint32)st.st_size;
+	stamp = (uint32)st.st_mtime;
+	return true;
+}
+
 bool POSIXFilesystemNode::getChildren(AbstractFSList &myList, ListMode mode, bool hidden) const {
 	assert(_isDirectory);
 
@@ -276,7 +330,12 @@ AbstractFSNode *POSIXFilesystemNode::getParent() const {
 }
 
 Common::SeekableReadStream *POSIXFilesystemNode::createReadStream() {
+#if defined(POSIX) && defined(HAVE_MMAP)
+	// Archives can then be parsed in place with getDirectData()
+	return POSIXMappedStream::makeFromPath(getPath());
+#else
 	return StdioStream::makeFromPath(getPath(), false);
+#endif
 }
 
 Common::WriteStream *POSIXFilesystemNode::createWriteStream() {
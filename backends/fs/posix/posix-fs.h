@@ -68,7 +68,10 @@ public:
 	virtual bool isWritable() const { return access(_path.c_str(), W_OK) == 0; }
 
 	virtual AbstractFSNode *getChild(const Common::String &n) const;
+	virtual AbstractFSNode *getListedChild(const Common::String &n, bool isDirectory) const;
 	virtual bool getChildren(AbstractFSList &list, ListMode mode, bool hidden) const;
+	virtual bool getDirectoryStamp(uint32 &stamp) const;
+	virtual bool getFileStamp(uint32 &size, uint32 &stamp) const;
 	virtual AbstractFSNode *getParent() const;
 
 	virtual Common::SeekableReadStream *createReadStream();
@@ -0,0 +1,85 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#if defined(POSIX) && defined(HAVE_MMAP)
+
+// Disable symbol overrides so that we can use FILE and fileno
+#define FORBIDDEN_SYMBOL_ALLOW_ALL
+
+#include "backends/fs/posix/posix-mappedstream.h"
+
+#include <stdio.h>
+#include <sys/mman.h>
+
+// On hosts with 32 bit pointers, larger files would take up too much of
+// the address space
+static const uint32 kMaxMappedSize32 = 256 * 1024 * 1024;
+
+POSIXMappedStream *POSIXMappedStream::makeFromPath(const Common::String &path) {
+	FILE *handle = fopen(path.c_str(), "rb");
+	if (handle)
+		return new POSIXMappedStream(handle);
+	return nullptr;
+}
+
+POSIXMappedStream::POSIXMappedStream(void *handle)
+	: StdioStream(handle),
+	  _mapping(nullptr),
+	  _mappingSize(0),
+	  _mapFailed(false) {
+}
+
+POSIXMappedStream::~POSIXMappedStream() {
+	if (_mapping)
+		munmap(_mapping, _mappingSize);
+}
+
+const byte *POSIXMappedStream::getDirectData(uint32 offset, uint32 size) const {
+	if (!map() || offset > _mappingSize || size > _mappingSize - offset)
+		return nullptr;
+
+	return (const byte *)_mapping + offset;
+}
+
+bool POSIXMappedStream::map() const {
+	if (_mapping)
+		return true;
+	if (_mapFailed)
+		return false;
+
+	// Empty files cannot be mapped
+	_mapFailed = true;
+	const int32 fileSize = size();
+	if (fileSize <= 0 || (sizeof(void *) < 8 && (uint32)fileSize > kMaxMappedSize32))
+		return false;
+
+	void *mapping = mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, fileno((FILE *)_handle), 0);
+	if (mapping == MAP_FAILED)
+		return false;
+
+	_mapping = mapping;
+	_mappingSize = fileSize;
+	_mapFailed = false;
+	return true;
+}
+
+#endif
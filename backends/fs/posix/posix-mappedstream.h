@@ -0,0 +1,65 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef BACKENDS_FS_POSIX_MAPPEDSTREAM_H
+#define BACKENDS_FS_POSIX_MAPPEDSTREAM_H
+
+#include "backends/fs/stdiostream.h"
+
+/**
+ * Read stream for a file which can be mapped into memory with mmap().
+ *
+ * Reads go through stdio. The file is only mapped when getDirectData() is
+ * called for the first time, so callers which parse the file in place get
+ * pointers into the mapping, and other callers are not affected by it.
+ *
+ * The file must not be truncated while it is mapped, reading the missing
+ * part of the mapping raises SIGBUS. I/O errors while reading through the
+ * mapping do as well, so only callers asking for direct access take that
+ * risk.
+ */
+class POSIXMappedStream : public StdioStream {
+public:
+	/**
+	 * Opens the file at the given path for reading.
+	 *
+	 * @return the new stream, or 0 if the file could not be opened
+	 */
+	static POSIXMappedStream *makeFromPath(const Common::String &path);
+
+	virtual ~POSIXMappedStream();
+
+	virtual const byte *getDirectData(uint32 offset, uint32 size) const;
+
+private:
+	POSIXMappedStream(void *handle);
+
+	/** Maps the whole file, returns whether the mapping exists. */
+	bool map() const;
+
+	mutable void *_mapping;
+	mutable uint32 _mappingSize;
+	/** Whether mapping was tried and failed, so it is not tried again */
+	mutable bool _mapFailed;
+};
+
+#endif
@@ -38,6 +38,7 @@ void Context::reset() {
 	shadersSupported = false;
 	multitextureSupported = false;
 	framebufferObjectSupported = false;
+	pixelBufferObjectSupported = false;
 
 #define GL_FUNC_DEF(ret, name, param) name = nullptr;
 #include "backends/graphics/opengl/opengl-func.h"
@@ -138,6 +139,8 @@ void OpenGLGraphicsManager::initializeGLContext() {
 			g_context.multitextureSupported = true;
 		} else if (token == "GL_EXT_framebuffer_object") {
 			g_context.framebufferObjectSupported = true;
+		} else if (token == "GL_ARB_pixel_buffer_object" || token == "GL_EXT_pixel_buffer_object" || token == "GL_NV_pixel_buffer_object") {
+			g_context.pixelBufferObjectSupported = true;
 		}
 	}
 
@@ -153,6 +156,12 @@ void OpenGLGraphicsManager::initializeGLContext() {
 
 		// GLES2 always has FBO support.
 		g_context.framebufferObjectSupported = true;
+
+		// GLES3 contexts, which are also created for GLES2, have PBO support.
+		const char *version = (const char *)g_context.glGetString(GL_VERSION);
+		if (version && !strncmp(version, "OpenGL ES 3", 11)) {
+			g_context.pixelBufferObjectSupported = true;
+		}
 	} else {
 		g_context.shadersSupported = ARBShaderObjects & ARBShadingLanguage100 & ARBVertexShader & ARBFragmentShader;
 	}
@@ -177,6 +186,7 @@ void OpenGLGraphicsManager::initializeGLContext() {
 	debug(5, "OpenGL: Shader support: %d", g_context.shadersSupported);
 	debug(5, "OpenGL: Multitexture support: %d", g_context.multitextureSupported);
 	debug(5, "OpenGL: FBO support: %d", g_context.framebufferObjectSupported);
+	debug(5, "OpenGL: PBO support: %d", g_context.pixelBufferObjectSupported);
 }
 
 } // End of namespace OpenGL
@@ -79,6 +79,7 @@ GL_FUNC_DEF(void, glEnable, (GLenum cap));
 GL_FUNC_DEF(void, glDisable, (GLenum cap));
 GL_FUNC_DEF(GLboolean, glIsEnabled, (GLenum cap));
 GL_FUNC_DEF(void, glClear, (GLbitfield mask));
+GL_FUNC_DEF(void, glFinish, ());
 GL_FUNC_DEF(void, glColor4f, (GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha));
 GL_FUNC_DEF(void, glViewport, (GLint x, GLint y, GLsizei width, GLsizei height));
 GL_FUNC_DEF(void, glMatrixMode, (GLenum mode));
@@ -110,6 +111,7 @@ GL_FUNC_2_DEF(void, glEnableVertexAttribArray, glEnableVertexAttribArrayARB, (GL
 GL_FUNC_2_DEF(void, glDisableVertexAttribArray, glDisableVertexAttribArrayARB, (GLuint index));
 GL_FUNC_2_DEF(void, glUniform1i, glUniform1iARB, (GLint location, GLint v0));
 GL_FUNC_2_DEF(void, glUniform1f, glUniform1fARB, (GLint location, GLfloat v0));
+GL_FUNC_2_DEF(void, glUniform2f, glUniform2fARB, (GLint location, GLfloat v0, GLfloat v1));
 GL_FUNC_2_DEF(void, glUniformMatrix4fv, glUniformMatrix4fvARB, (GLint location, GLsizei count, GLboolean transpose, const GLfloat *value));
 GL_FUNC_2_DEF(void, glVertexAttrib4f, glVertexAttrib4fARB, (GLuint index, GLfloat x, GLfloat y, GLfloat z, GLfloat w));
 GL_FUNC_2_DEF(void, glVertexAttribPointer, glVertexAttribPointerARB, (GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void *pointer));
@@ -140,6 +142,12 @@ GL_FUNC_2_DEF(void, glFramebufferTexture2D, glFramebufferTexture2DEXT, (GLenum t
 GL_FUNC_2_DEF(GLenum, glCheckFramebufferStatus, glCheckFramebufferStatusEXT, (GLenum target));
 
 GL_FUNC_2_DEF(void, glActiveTexture, glActiveTextureARB, (GLenum texture));
+
+GL_FUNC_2_DEF(void, glGenBuffers, glGenBuffersARB, (GLsizei n, GLuint *buffers));
+GL_FUNC_2_DEF(void, glDeleteBuffers, glDeleteBuffersARB, (GLsizei n, const GLuint *buffers));
+GL_FUNC_2_DEF(void, glBindBuffer, glBindBufferARB, (GLenum target, GLuint buffer));
+GL_FUNC_2_DEF(void, glBufferData, glBufferDataARB, (GLenum target, GLsizeiptr size, const void *data, GLenum usage));
+GL_FUNC_2_DEF(void, glBufferSubData, glBufferSubDataARB, (GLenum target, GLintptr offset, GLsizeiptr size, const void *data));
 #endif
 
 #ifdef DEFINED_GL_EXT_FUNC_DEF
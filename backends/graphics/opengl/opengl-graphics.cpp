@@ -25,6 +25,7 @@
 #include "backends/graphics/opengl/texture.h"
 #include "backends/graphics/opengl/pipelines/pipeline.h"
 #include "backends/graphics/opengl/pipelines/fixed.h"
+#include "backends/graphics/opengl/pipelines/scaler.h"
 #include "backends/graphics/opengl/pipelines/shader.h"
 #include "backends/graphics/opengl/shader.h"
 
@@ -53,6 +54,9 @@ namespace OpenGL {
 OpenGLGraphicsManager::OpenGLGraphicsManager()
     : _currentState(), _oldState(), _transactionMode(kTransactionNone), _screenChangeID(1 << (sizeof(int) * 8 - 2)),
       _pipeline(nullptr),
+#if !USE_FORCED_GLES
+      _scalerPipeline(nullptr),
+#endif
       _defaultFormat(), _defaultFormatAlpha(),
       _gameScreen(nullptr), _gameScreenShakeOffset(0), _overlay(nullptr),
       _cursor(nullptr),
@@ -147,9 +151,39 @@ namespace {
 
 const OSystem::GraphicsMode glGraphicsModes[] = {
 	{ "opengl",  _s("OpenGL"),                GFX_OPENGL  },
+#if !USE_FORCED_GLES
+	{ "opengl_advmame2x", _s("OpenGL AdvMAME2x"), GFX_OPENGL_ADVMAME2X },
+	{ "opengl_advmame3x", _s("OpenGL AdvMAME3x"), GFX_OPENGL_ADVMAME3X },
+	{ "opengl_hq2x",      _s("OpenGL HQ2x"),      GFX_OPENGL_HQ2X      },
+	{ "opengl_hq3x",      _s("OpenGL HQ3x"),      GFX_OPENGL_HQ3X      },
+	{ "opengl_tv2x",      _s("OpenGL TV2x"),      GFX_OPENGL_TV2X      },
+#endif
 	{ nullptr, nullptr, 0 }
 };
 
+#if !USE_FORCED_GLES
+/**
+ * Return the scaler shader used in a graphics mode, kMaxUsages if there is
+ * none.
+ */
+ShaderManager::ShaderUsage getScalerShader(int mode) {
+	switch (mode) {
+	case GFX_OPENGL_ADVMAME2X:
+		return ShaderManager::kAdvMame2x;
+	case GFX_OPENGL_ADVMAME3X:
+		return ShaderManager::kAdvMame3x;
+	case GFX_OPENGL_HQ2X:
+		return ShaderManager::kHQ2x;
+	case GFX_OPENGL_HQ3X:
+		return ShaderManager::kHQ3x;
+	case GFX_OPENGL_TV2X:
+		return ShaderManager::kTV2x;
+	default:
+		return ShaderManager::kMaxUsages;
+	}
+}
+#endif
+
 } // End of anonymous namespace
 
 const OSystem::GraphicsMode *OpenGLGraphicsManager::getSupportedGraphicsModes() const {
@@ -165,6 +199,14 @@ bool OpenGLGraphicsManager::setGraphicsMode(int mode) {
 
 	switch (mode) {
 	case GFX_OPENGL:
+#if !USE_FORCED_GLES
+	// The scaler modes fall back to plain drawing without shader support.
+	case GFX_OPENGL_ADVMAME2X:
+	case GFX_OPENGL_ADVMAME3X:
+	case GFX_OPENGL_HQ2X:
+	case GFX_OPENGL_HQ3X:
+	case GFX_OPENGL_TV2X:
+#endif
 		_currentState.graphicsMode = mode;
 		return true;
 
@@ -284,6 +326,10 @@ OSystem::TransactionError OpenGLGraphicsManager::endGFXTransaction() {
 		_currentState.valid = true;
 	} while (_transactionMode == kTransactionRollback);
 
+#if !USE_FORCED_GLES
+	updateScalerPipeline();
+#endif
+
 	if (setupNewGameScreen) {
 		delete _gameScreen;
 		_gameScreen = nullptr;
@@ -423,8 +469,19 @@ void OpenGLGraphicsManager::updateScreen() {
 	// Alpha blending is disabled when drawing the screen
 	_backBuffer.enableBlend(Framebuffer::kBlendModeDisabled);
 
-	// First step: Draw the (virtual) game screen.
+	// First step: Draw the (virtual) game screen. The scaler shaders are
+	// only used for it.
+#if !USE_FORCED_GLES
+	if (_scalerPipeline) {
+		g_context.setPipeline(_scalerPipeline);
+	}
+#endif
 	g_context.getActivePipeline()->drawTexture(_gameScreen->getGLTexture(), _gameDrawRect.left, _gameDrawRect.top + shakeOffset, _gameDrawRect.width(), _gameDrawRect.height());
+#if !USE_FORCED_GLES
+	if (_scalerPipeline) {
+		g_context.setPipeline(_pipeline);
+	}
+#endif
 
 	// Second step: Draw the overlay if visible.
 	if (_overlayVisible) {
@@ -884,6 +941,9 @@ void OpenGLGraphicsManager::notifyContextCreate(const Graphics::PixelFormat &def
 	_pipeline = nullptr;
 
 #if !USE_FORCED_GLES
+	delete _scalerPipeline;
+	_scalerPipeline = nullptr;
+
 	if (g_context.shadersSupported) {
 		ShaderMan.notifyCreate();
 		_pipeline = new ShaderPipeline(ShaderMan.query(ShaderManager::kDefault));
@@ -898,6 +958,10 @@ void OpenGLGraphicsManager::notifyContextCreate(const Graphics::PixelFormat &def
 
 	g_context.setPipeline(_pipeline);
 
+#if !USE_FORCED_GLES
+	updateScalerPipeline();
+#endif
+
 	// Disable 3D properties.
 	GL_CALL(glDisable(GL_CULL_FACE));
 	GL_CALL(glDisable(GL_DEPTH_TEST));
@@ -985,10 +1049,32 @@ void OpenGLGraphicsManager::notifyContextDestroy() {
 	delete _pipeline;
 	_pipeline = nullptr;
 
+#if !USE_FORCED_GLES
+	delete _scalerPipeline;
+	_scalerPipeline = nullptr;
+#endif
+
 	// Rest our context description since the context is gone soon.
 	g_context.reset();
 }
 
+#if !USE_FORCED_GLES
+void OpenGLGraphicsManager::updateScalerPipeline() {
+	const ShaderManager::ShaderUsage usage = getScalerShader(_currentState.graphicsMode);
+	if (_scalerPipeline && _scalerPipeline->getUsage() == usage) {
+		return;
+	}
+
+	delete _scalerPipeline;
+	_scalerPipeline = nullptr;
+
+	if (usage != ShaderManager::kMaxUsages && ScalerPipeline::isSupportedByContext(usage)) {
+		_scalerPipeline = new ScalerPipeline(usage);
+		_scalerPipeline->setFramebuffer(&_backBuffer);
+	}
+}
+#endif
+
 Surface *OpenGLGraphicsManager::createSurface(const Graphics::PixelFormat &format, bool wantAlpha) {
 	GLenum glIntFormat, glFormat, glType;
 	if (format.bytesPerPixel == 1) {
@@ -47,10 +47,16 @@ class Surface;
 class Pipeline;
 #if !USE_FORCED_GLES
 class Shader;
+class ScalerPipeline;
 #endif
 
 enum {
-	GFX_OPENGL = 0
+	GFX_OPENGL = 0,
+	GFX_OPENGL_ADVMAME2X = 1,
+	GFX_OPENGL_ADVMAME3X = 2,
+	GFX_OPENGL_HQ2X = 3,
+	GFX_OPENGL_HQ3X = 4,
+	GFX_OPENGL_TV2X = 5
 };
 
 class OpenGLGraphicsManager : virtual public WindowedGraphicsManager {
@@ -278,6 +284,19 @@ private:
 	 */
 	Pipeline *_pipeline;
 
+#if !USE_FORCED_GLES
+	/**
+	 * Set up the scaler pipeline for the current graphics mode, if it uses
+	 * one of the scaler shaders.
+	 */
+	void updateScalerPipeline();
+
+	/**
+	 * Pipeline used to draw the game screen with the scaler shaders.
+	 */
+	ScalerPipeline *_scalerPipeline;
+#endif
+
 protected:
 	/**
 	 * Query the address of an OpenGL function by name.
@@ -123,6 +123,9 @@ struct Context {
 	/** Whether multi texture support is available or not. */
 	bool multitextureSupported;
 
+	/** Whether pixel buffer objects are available or not. */
+	bool pixelBufferObjectSupported;
+
 	/** Whether FBO support is available or not. */
 	bool framebufferObjectSupported;
 
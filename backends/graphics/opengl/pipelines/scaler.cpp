@@ -0,0 +1,131 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "backends/graphics/opengl/pipelines/scaler.h"
+#include "backends/graphics/opengl/shader.h"
+#include "backends/graphics/opengl/framebuffer.h"
+
+#include "graphics/surface.h"
+#include "graphics/scaler/hq_rules.h"
+
+namespace OpenGL {
+
+#if !USE_FORCED_GLES
+namespace {
+
+void fillLookUpRows(byte *dst, const HQRule *rules) {
+	for (uint diffs = 0; diffs < 16; ++diffs) {
+		for (uint pattern = 0; pattern < 256; ++pattern) {
+			const byte *weights = getHQRuleWeights(rules[pattern], diffs);
+
+			// Stored in 256ths, so that all of them fit into a byte
+			*dst++ = weights[0] * 16;
+			*dst++ = weights[1] * 16;
+			*dst++ = weights[2] * 16;
+			*dst++ = 0;
+		}
+	}
+}
+
+} // End of anonymous namespace
+
+ScalerPipeline::ScalerPipeline(ShaderManager::ShaderUsage usage)
+    : ShaderPipeline(ShaderMan.query(usage)), _usage(usage), _lookUpTexture(nullptr),
+      _textureWidth(0), _textureHeight(0), _inputWidth(0), _inputHeight(0) {
+	setColor(1.0f, 1.0f, 1.0f, 1.0f);
+
+	if (_usage == ShaderManager::kHQ2x || _usage == ShaderManager::kHQ3x) {
+		setUpLookUpTexture();
+	}
+}
+
+ScalerPipeline::~ScalerPipeline() {
+	delete _lookUpTexture;
+}
+
+bool ScalerPipeline::isSupportedByContext(ShaderManager::ShaderUsage usage) {
+	if (!g_context.shadersSupported) {
+		return false;
+	}
+
+	// The HQ scalers need a second texture unit for their rules.
+	if (usage == ShaderManager::kHQ2x || usage == ShaderManager::kHQ3x) {
+		return g_context.multitextureSupported;
+	}
+
+	return true;
+}
+
+void ScalerPipeline::setUpLookUpTexture() {
+	// One row per combination of differences between the direct neighbours,
+	// the corner rules go first, then the edge rules.
+	byte *data = new byte[256 * 32 * 4];
+	memset(data, 0, 256 * 32 * 4);
+
+	if (_usage == ShaderManager::kHQ2x) {
+		fillLookUpRows(data, g_hq2xCornerRules);
+	} else {
+		fillLookUpRows(data, g_hq3xCornerRules);
+		fillLookUpRows(data + 256 * 16 * 4, g_hq3xEdgeRules);
+	}
+
+	Graphics::Surface lookUp;
+	lookUp.init(256, 32, 256 * 4, data,
+#ifdef SCUMM_LITTLE_ENDIAN
+	            Graphics::PixelFormat(4, 8, 8, 8, 8, 0, 8, 16, 24) // ABGR8888
+#else
+	            Graphics::PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0) // RGBA8888
+#endif
+	           );
+
+	_lookUpTexture = new GLTexture(GL_RGBA, GL_RGBA, GL_UNSIGNED_BYTE);
+	_lookUpTexture->setSize(256, 32);
+	_lookUpTexture->updateArea(Common::Rect(256, 32), lookUp);
+
+	delete[] data;
+}
+
+void ScalerPipeline::drawTexture(const GLTexture &texture, const GLfloat *coordinates) {
+	// Only pass the sizes on when they changed, the uniforms are kept by the
+	// shader.
+	if (   texture.getWidth() != _textureWidth || texture.getHeight() != _textureHeight
+	    || texture.getLogicalWidth() != _inputWidth || texture.getLogicalHeight() != _inputHeight) {
+		_textureWidth = texture.getWidth();
+		_textureHeight = texture.getHeight();
+		_inputWidth = texture.getLogicalWidth();
+		_inputHeight = texture.getLogicalHeight();
+
+		_activeShader->setUniform("textureSize", new ShaderUniformFloat2(_textureWidth, _textureHeight));
+		_activeShader->setUniform("inputSize", new ShaderUniformFloat2(_inputWidth, _inputHeight));
+	}
+
+	if (_lookUpTexture) {
+		GL_CALL(glActiveTexture(GL_TEXTURE1));
+		_lookUpTexture->bind();
+		GL_CALL(glActiveTexture(GL_TEXTURE0));
+	}
+
+	ShaderPipeline::drawTexture(texture, coordinates);
+}
+#endif // !USE_FORCED_GLES
+
+} // End of namespace OpenGL
@@ -0,0 +1,73 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef BACKENDS_GRAPHICS_OPENGL_PIPELINES_SCALER_H
+#define BACKENDS_GRAPHICS_OPENGL_PIPELINES_SCALER_H
+
+#include "backends/graphics/opengl/pipelines/shader.h"
+#include "backends/graphics/opengl/shader.h"
+
+namespace OpenGL {
+
+#if !USE_FORCED_GLES
+/**
+ * Pipeline running one of the scaler shaders.
+ *
+ * The scaler is applied to whole source pixels, i.e. the output is exact when
+ * the texture is drawn at the scale factor of the scaler. At other sizes the
+ * scaled picture is sampled with the nearest output pixel.
+ */
+class ScalerPipeline : public ShaderPipeline {
+public:
+	/**
+	 * Create a pipeline for one of the scaler shaders.
+	 *
+	 * @param usage One of the scaler shaders of the ShaderManager.
+	 */
+	ScalerPipeline(ShaderManager::ShaderUsage usage);
+	virtual ~ScalerPipeline();
+
+	ShaderManager::ShaderUsage getUsage() const { return _usage; }
+
+	/**
+	 * Test whether the context can run the shader of the given usage.
+	 */
+	static bool isSupportedByContext(ShaderManager::ShaderUsage usage);
+
+	virtual void drawTexture(const GLTexture &texture, const GLfloat *coordinates);
+
+private:
+	void setUpLookUpTexture();
+
+	const ShaderManager::ShaderUsage _usage;
+
+	/** The rules of the HQ scalers, if used. */
+	GLTexture *_lookUpTexture;
+
+	uint _textureWidth, _textureHeight;
+	uint _inputWidth, _inputHeight;
+};
+#endif // !USE_FORCED_GLES
+
+} // End of namespace OpenGL
+
+#endif
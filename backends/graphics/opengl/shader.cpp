@@ -77,6 +77,137 @@ const char *const g_lookUpFragmentShader =
 	"\tgl_FragColor = blendColor * texture2D(palette, vec2(index.a * adjustFactor, 0.0));\n"
 	"}\n";
 
+// Common part of the scaler shaders. The output pixel is located in a
+// SCALE x SCALE block of sub pixels for the source pixel at "texel". The
+// neighbourhood is rotated and mirrored with "orientation", so that the sub
+// pixel always ends up in the top left corner or at the top edge of the block.
+// This way the shaders need to handle only these two cases.
+const char *const g_scalerFragmentShaderHeader =
+	"varying vec2 texCoord;\n"
+	"varying vec4 blendColor;\n"
+	"\n"
+	"uniform sampler2D texture;\n"
+	"uniform vec2 textureSize;\n"
+	"uniform vec2 inputSize;\n"
+	"\n"
+	"vec2 texel;\n"
+	"vec2 sub;\n"
+	"vec2 dir;\n"
+	"mat2 orientation;\n"
+	"\n"
+	"vec4 fetch(vec2 offset) {\n"
+	"\tvec2 pos = clamp(texel + orientation * offset, vec2(0.5), inputSize - 0.5);\n"
+	"\treturn texture2D(texture, pos / textureSize);\n"
+	"}\n"
+	"\n"
+	"void setUp() {\n"
+	"\tvec2 pos = texCoord * textureSize;\n"
+	"\ttexel = floor(pos) + 0.5;\n"
+	"\tsub = min(floor(fract(pos) * SCALE), SCALE - 1.0);\n"
+	"\tdir = (SCALE == 2.0) ? sub * 2.0 - 1.0 : sub - 1.0;\n"
+	"\n"
+	"\tif (dir.x != 0.0 && dir.y == 0.0) {\n"
+	"\t\torientation = mat2(0.0, 1.0, -dir.x, 0.0);\n"
+	"\t} else {\n"
+	"\t\torientation = mat2(dir.x == 0.0 ? 1.0 : -dir.x, 0.0, 0.0, -dir.y);\n"
+	"\t}\n"
+	"}\n"
+	"\n"
+	"bool isCorner() {\n"
+	"\treturn dir.x != 0.0 && dir.y != 0.0;\n"
+	"}\n";
+
+const char *const g_advMameFragmentShader =
+	"void main(void) {\n"
+	"\tsetUp();\n"
+	"\n"
+	"\tvec4 E = fetch(vec2(0.0, 0.0));\n"
+	"\tvec4 color = E;\n"
+	"\n"
+	"\tif (dir != vec2(0.0, 0.0)) {\n"
+	"\t\tvec4 A = fetch(vec2(-1.0, -1.0));\n"
+	"\t\tvec4 B = fetch(vec2( 0.0, -1.0));\n"
+	"\t\tvec4 C = fetch(vec2( 1.0, -1.0));\n"
+	"\t\tvec4 D = fetch(vec2(-1.0,  0.0));\n"
+	"\t\tvec4 F = fetch(vec2( 1.0,  0.0));\n"
+	"\t\tvec4 H = fetch(vec2( 0.0,  1.0));\n"
+	"\n"
+	"\t\tif (B != H && D != F) {\n"
+	"\t\t\tif (isCorner()) {\n"
+	"\t\t\t\tif (D == B)\n"
+	"\t\t\t\t\tcolor = D;\n"
+	"\t\t\t} else if ((D == B && E != C) || (F == B && E != A)) {\n"
+	"\t\t\t\tcolor = B;\n"
+	"\t\t\t}\n"
+	"\t\t}\n"
+	"\t}\n"
+	"\n"
+	"\tgl_FragColor = blendColor * color;\n"
+	"}\n";
+
+// The rules of the scaler, indexed by the pattern and the differences between
+// the direct neighbours. They hold the weights of the corner, the vertical and
+// the horizontal neighbour, the rest goes to the source pixel.
+const char *const g_hqFragmentShader =
+	"uniform sampler2D lookUp;\n"
+	"\n"
+	"vec3 toYUV(vec4 color) {\n"
+	"\tvec3 c = floor(color.rgb * 255.0 + 0.5);\n"
+	"\treturn floor(vec3(c.r + c.g + c.b, c.r - c.b, 2.0 * c.g - c.r - c.b) / vec3(4.0, 4.0, 8.0));\n"
+	"}\n"
+	"\n"
+	"float differs(vec3 yuv1, vec3 yuv2) {\n"
+	"\tvec3 diff = abs(yuv1 - yuv2);\n"
+	"\treturn (diff.x > 48.0 || diff.y > 7.0 || diff.z > 6.0) ? 1.0 : 0.0;\n"
+	"}\n"
+	"\n"
+	"void main(void) {\n"
+	"\tsetUp();\n"
+	"\n"
+	"\tvec4 w5 = fetch(vec2(0.0, 0.0));\n"
+	"\tvec4 color = w5;\n"
+	"\n"
+	"\tif (dir != vec2(0.0, 0.0)) {\n"
+	"\t\tvec4 w1 = fetch(vec2(-1.0, -1.0));\n"
+	"\t\tvec4 w2 = fetch(vec2( 0.0, -1.0));\n"
+	"\t\tvec4 w4 = fetch(vec2(-1.0,  0.0));\n"
+	"\n"
+	"\t\tvec3 y1 = toYUV(w1);\n"
+	"\t\tvec3 y2 = toYUV(w2);\n"
+	"\t\tvec3 y3 = toYUV(fetch(vec2( 1.0, -1.0)));\n"
+	"\t\tvec3 y4 = toYUV(w4);\n"
+	"\t\tvec3 y5 = toYUV(w5);\n"
+	"\t\tvec3 y6 = toYUV(fetch(vec2( 1.0,  0.0)));\n"
+	"\t\tvec3 y7 = toYUV(fetch(vec2(-1.0,  1.0)));\n"
+	"\t\tvec3 y8 = toYUV(fetch(vec2( 0.0,  1.0)));\n"
+	"\t\tvec3 y9 = toYUV(fetch(vec2( 1.0,  1.0)));\n"
+	"\n"
+	"\t\tfloat pattern = differs(y5, y1) + 2.0 * differs(y5, y2) + 4.0 * differs(y5, y3)\n"
+	"\t\t              + 8.0 * differs(y5, y4) + 16.0 * differs(y5, y6) + 32.0 * differs(y5, y7)\n"
+	"\t\t              + 64.0 * differs(y5, y8) + 128.0 * differs(y5, y9);\n"
+	"\t\tfloat row = differs(y2, y6) + 2.0 * differs(y4, y2) + 4.0 * differs(y6, y8) + 8.0 * differs(y8, y4);\n"
+	"\t\tif (!isCorner())\n"
+	"\t\t\trow += 16.0;\n"
+	"\n"
+	"\t\tvec3 weights = texture2D(lookUp, vec2((pattern + 0.5) / 256.0, (row + 0.5) / 32.0)).rgb * (255.0 / 256.0);\n"
+	"\t\tcolor = w5 * (1.0 - weights.r - weights.g - weights.b) + w1 * weights.r + w2 * weights.g + w4 * weights.b;\n"
+	"\t}\n"
+	"\n"
+	"\tgl_FragColor = blendColor * color;\n"
+	"}\n";
+
+const char *const g_tvFragmentShader =
+	"void main(void) {\n"
+	"\tsetUp();\n"
+	"\n"
+	"\tvec4 color = fetch(vec2(0.0, 0.0));\n"
+	"\t// Every second line is darkened to 7/8 of its intensity.\n"
+	"\tif (sub.y != 0.0)\n"
+	"\t\tcolor.rgb = floor(floor(color.rgb * 255.0 + 0.5) * 7.0 / 8.0) / 255.0;\n"
+	"\n"
+	"\tgl_FragColor = blendColor * color;\n"
+	"}\n";
+
 
 // Taken from: https://en.wikibooks.org/wiki/OpenGL_Programming/Modern_OpenGL_Tutorial_03#OpenGL_ES_2_portability
 const char *const g_precisionDefines =
@@ -104,6 +235,10 @@ void ShaderUniformFloat::set(GLint location) const {
 	GL_CALL(glUniform1f(location, _value));
 }
 
+void ShaderUniformFloat2::set(GLint location) const {
+	GL_CALL(glUniform2f(location, _x, _y));
+}
+
 void ShaderUniformMatrix44::set(GLint location) const {
 	GL_CALL(glUniformMatrix4fv(location, 1, GL_FALSE, _matrix));
 }
@@ -311,6 +446,16 @@ void ShaderManager::notifyCreate() {
 		_builtIn[kCLUT8LookUp] = new Shader(g_defaultVertexShader, g_lookUpFragmentShader);
 		_builtIn[kCLUT8LookUp]->setUniform1I("palette", 1);
 
+		const Common::String scaler2x = Common::String("#define SCALE 2.0\n") + g_scalerFragmentShaderHeader;
+		const Common::String scaler3x = Common::String("#define SCALE 3.0\n") + g_scalerFragmentShaderHeader;
+		_builtIn[kAdvMame2x] = new Shader(g_defaultVertexShader, scaler2x + g_advMameFragmentShader);
+		_builtIn[kAdvMame3x] = new Shader(g_defaultVertexShader, scaler3x + g_advMameFragmentShader);
+		_builtIn[kHQ2x] = new Shader(g_defaultVertexShader, scaler2x + g_hqFragmentShader);
+		_builtIn[kHQ2x]->setUniform1I("lookUp", 1);
+		_builtIn[kHQ3x] = new Shader(g_defaultVertexShader, scaler3x + g_hqFragmentShader);
+		_builtIn[kHQ3x]->setUniform1I("lookUp", 1);
+		_builtIn[kTV2x] = new Shader(g_defaultVertexShader, scaler2x + g_tvFragmentShader);
+
 		for (uint i = 0; i < kMaxUsages; ++i) {
 			_builtIn[i]->setUniform1I("texture", 0);
 		}
@@ -74,6 +74,20 @@ private:
 	const GLfloat _value;
 };
 
+/**
+ * Two component float vector value for a shader uniform.
+ */
+class ShaderUniformFloat2 : public ShaderUniformValue {
+public:
+	ShaderUniformFloat2(GLfloat x, GLfloat y) : _x(x), _y(y) {}
+
+	virtual void set(GLint location) const override;
+
+private:
+	const GLfloat _x;
+	const GLfloat _y;
+};
+
 /**
  * 4x4 Matrix value for a shader uniform.
  */
@@ -249,6 +263,21 @@ public:
 		/** CLUT8 look up shader. */
 		kCLUT8LookUp,
 
+		/** AdvMAME2x (Scale2x) scaler shader. */
+		kAdvMame2x,
+
+		/** AdvMAME3x (Scale3x) scaler shader. */
+		kAdvMame3x,
+
+		/** HQ2x scaler shader, needs a rule look up texture. */
+		kHQ2x,
+
+		/** HQ3x scaler shader, needs a rule look up texture. */
+		kHQ3x,
+
+		/** TV2x scaler shader. */
+		kTV2x,
+
 		/** Number of built-in shaders. Should not be used for query. */
 		kMaxUsages
 	};
@@ -26,6 +26,7 @@
 #include "backends/graphics/opengl/pipelines/clut8.h"
 #include "backends/graphics/opengl/framebuffer.h"
 
+#include "common/algorithm.h"
 #include "common/rect.h"
 #include "common/textconsole.h"
 
@@ -49,11 +50,20 @@ GLTexture::GLTexture(GLenum glIntFormat, GLenum glFormat, GLenum glType)
       _width(0), _height(0), _logicalWidth(0), _logicalHeight(0),
       _texCoords(), _glFilter(GL_NEAREST),
       _glTexture(0) {
+#if !USE_FORCED_GLES
+	_pixelBuffers[0] = _pixelBuffers[1] = 0;
+	_nextPixelBuffer = 0;
+#endif
 	create();
 }
 
 GLTexture::~GLTexture() {
 	GL_CALL_SAFE(glDeleteTextures, (1, &_glTexture));
+#if !USE_FORCED_GLES
+	if (_pixelBuffers[0]) {
+		GL_CALL_SAFE(glDeleteBuffers, (2, _pixelBuffers));
+	}
+#endif
 }
 
 void GLTexture::enableLinearFiltering(bool enable) {
@@ -72,6 +82,13 @@ void GLTexture::enableLinearFiltering(bool enable) {
 void GLTexture::destroy() {
 	GL_CALL(glDeleteTextures(1, &_glTexture));
 	_glTexture = 0;
+
+#if !USE_FORCED_GLES
+	if (_pixelBuffers[0]) {
+		GL_CALL(glDeleteBuffers(2, _pixelBuffers));
+		_pixelBuffers[0] = _pixelBuffers[1] = 0;
+	}
+#endif
 }
 
 void GLTexture::create() {
@@ -164,8 +181,65 @@ void GLTexture::updateArea(const Common::Rect &area, const Graphics::Surface &sr
 	//
 	// 3) Use glTexSubImage2D per line changed. This is what the old OpenGL
 	//    graphics manager did but it is much slower! Thus, we do not use it.
+	const void *pixels = src.getBasePtr(0, area.top);
+
+#if !USE_FORCED_GLES
+	// With pixel buffer objects glTexSubImage2D does not need to wait until
+	// the GPU is done with the texture, it only schedules the copy. The
+	// buffers are used in turns and their old storage is dropped before they
+	// are filled, so that filling them does not wait either.
+	if (g_context.pixelBufferObjectSupported) {
+		if (!_pixelBuffers[0]) {
+			GL_CALL(glGenBuffers(2, _pixelBuffers));
+		}
+
+		const GLsizeiptr size = src.pitch * area.height();
+		GL_CALL(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, _pixelBuffers[_nextPixelBuffer]));
+		GL_CALL(glBufferData(GL_PIXEL_UNPACK_BUFFER, size, nullptr, GL_STREAM_DRAW));
+		GL_CALL(glBufferSubData(GL_PIXEL_UNPACK_BUFFER, 0, size, pixels));
+		_nextPixelBuffer ^= 1;
+
+		// The data now comes from the start of the bound buffer.
+		pixels = nullptr;
+	}
+#endif
+
 	GL_CALL(glTexSubImage2D(GL_TEXTURE_2D, 0, 0, area.top, src.w, area.height(),
-	                       _glFormat, _glType, src.getBasePtr(0, area.top)));
+	                       _glFormat, _glType, pixels));
+
+#if !USE_FORCED_GLES
+	if (g_context.pixelBufferObjectSupported) {
+		GL_CALL(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0));
+	}
+#endif
+}
+
+namespace {
+bool startsAbove(const Common::Rect &a, const Common::Rect &b) {
+	return a.top < b.top;
+}
+} // End of anonymous namespace
+
+void GLTexture::updateAreas(const Common::Array<Common::Rect> &areas, const Graphics::Surface &src) {
+	if (areas.empty()) {
+		return;
+	}
+
+	// updateArea uploads whole rows, so it is called once for every range
+	// of rows which are covered by any of the areas.
+	Common::Array<Common::Rect> sorted(areas);
+	Common::sort(sorted.begin(), sorted.end(), startsAbove);
+
+	Common::Rect rows = sorted[0];
+	for (uint i = 1; i < sorted.size(); ++i) {
+		if (sorted[i].top <= rows.bottom) {
+			rows.bottom = MAX(rows.bottom, sorted[i].bottom);
+		} else {
+			updateArea(rows, src);
+			rows = sorted[i];
+		}
+	}
+	updateArea(rows, src);
 }
 
 //
@@ -173,7 +247,7 @@ void GLTexture::updateArea(const Common::Rect &area, const Graphics::Surface &sr
 //
 
 Surface::Surface()
-    : _allDirty(false), _dirtyArea() {
+    : _allDirty(false), _dirtyAreas() {
 }
 
 void Surface::copyRectToTexture(uint x, uint y, uint w, uint h, const void *srcPtr, uint srcPitch) {
@@ -181,15 +255,7 @@ void Surface::copyRectToTexture(uint x, uint y, uint w, uint h, const void *srcP
 	assert(x + w <= dstSurf->w);
 	assert(y + h <= dstSurf->h);
 
-	// *sigh* Common::Rect::extend behaves unexpected whenever one of the two
-	// parameters is an empty rect. Thus, we check whether the current dirty
-	// area is valid. In case it is not we simply use the parameters as new
-	// dirty area. Otherwise, we simply call extend.
-	if (_dirtyArea.isEmpty()) {
-		_dirtyArea = Common::Rect(x, y, x + w, y + h);
-	} else {
-		_dirtyArea.extend(Common::Rect(x, y, x + w, y + h));
-	}
+	addDirtyArea(Common::Rect(x, y, x + w, y + h));
 
 	const byte *src = (const byte *)srcPtr;
 	byte *dst = (byte *)dstSurf->getBasePtr(x, y);
@@ -214,11 +280,50 @@ void Surface::fill(uint32 color) {
 	flagDirty();
 }
 
-Common::Rect Surface::getDirtyArea() const {
+void Surface::addDirtyArea(const Common::Rect &area) {
+	// *sigh* Common::Rect::extend behaves unexpected whenever one of the two
+	// parameters is an empty rect. Thus, we never store empty areas.
+	if (area.isEmpty() || _allDirty) {
+		return;
+	}
+
+	// Two small updates in opposite corners of the screen should not result
+	// in uploading the whole screen. Thus, we only merge areas which overlap
+	// or whose bounding box is not much larger than the areas themselves.
+	Common::Rect merged = area;
+	for (uint i = 0; i < _dirtyAreas.size(); ++i) {
+		const Common::Rect &other = _dirtyAreas[i];
+
+		Common::Rect bounds = merged;
+		bounds.extend(other);
+
+		const int mergedSize = merged.width() * merged.height();
+		const int otherSize = other.width() * other.height();
+		const int boundsSize = bounds.width() * bounds.height();
+		if (merged.intersects(other) || boundsSize * 4 <= (mergedSize + otherSize) * 5) {
+			merged = bounds;
+			_dirtyAreas.remove_at(i);
+			// The larger area might now touch areas we already checked.
+			i = (uint)-1;
+		}
+	}
+
+	// Too many separate areas cost more in upload calls than they save.
+	if (_dirtyAreas.size() >= kMaxDirtyAreas) {
+		for (uint i = 0; i < _dirtyAreas.size(); ++i) {
+			merged.extend(_dirtyAreas[i]);
+		}
+		_dirtyAreas.clear();
+	}
+
+	_dirtyAreas.push_back(merged);
+}
+
+Common::Array<Common::Rect> Surface::getDirtyAreas() const {
 	if (_allDirty) {
-		return Common::Rect(getWidth(), getHeight());
+		return Common::Array<Common::Rect>(1, Common::Rect(getWidth(), getHeight()));
 	} else {
-		return _dirtyArea;
+		return _dirtyAreas;
 	}
 }
 
@@ -279,11 +384,13 @@ void Texture::updateGLTexture() {
 		return;
 	}
 
-	Common::Rect dirtyArea = getDirtyArea();
+	Common::Array<Common::Rect> dirtyAreas = getDirtyAreas();
 
 	// In case we use linear filtering we might need to duplicate the last
 	// pixel row/column to avoid glitches with filtering.
-	if (_glTexture.isLinearFilteringEnabled()) {
+	for (uint i = 0; i < dirtyAreas.size() && _glTexture.isLinearFilteringEnabled(); ++i) {
+		Common::Rect &dirtyArea = dirtyAreas[i];
+
 		if (dirtyArea.right == _userPixelData.w && _userPixelData.w != _textureData.w) {
 			uint height = dirtyArea.height();
 
@@ -310,7 +417,7 @@ void Texture::updateGLTexture() {
 		}
 	}
 
-	_glTexture.updateArea(dirtyArea, _textureData);
+	_glTexture.updateAreas(dirtyAreas, _textureData);
 
 	// We should have handled everything, thus not dirty anymore.
 	clearDirty();
@@ -410,20 +517,25 @@ void TextureCLUT8::updateGLTexture() {
 	// Do the palette look up
 	Graphics::Surface *outSurf = Texture::getSurface();
 
-	Common::Rect dirtyArea = getDirtyArea();
-
-	if (outSurf->format.bytesPerPixel == 2) {
-		doPaletteLookUp<uint16>((uint16 *)outSurf->getBasePtr(dirtyArea.left, dirtyArea.top),
-		                        (const byte *)_clut8Data.getBasePtr(dirtyArea.left, dirtyArea.top),
-		                        dirtyArea.width(), dirtyArea.height(),
-		                        outSurf->pitch, _clut8Data.pitch, (const uint16 *)_palette);
-	} else if (outSurf->format.bytesPerPixel == 4) {
-		doPaletteLookUp<uint32>((uint32 *)outSurf->getBasePtr(dirtyArea.left, dirtyArea.top),
-		                        (const byte *)_clut8Data.getBasePtr(dirtyArea.left, dirtyArea.top),
-		                        dirtyArea.width(), dirtyArea.height(),
-		                        outSurf->pitch, _clut8Data.pitch, (const uint32 *)_palette);
-	} else {
-		warning("TextureCLUT8::updateTexture: Unsupported pixel depth: %d", outSurf->format.bytesPerPixel);
+	const Common::Array<Common::Rect> dirtyAreas = getDirtyAreas();
+
+	for (uint i = 0; i < dirtyAreas.size(); ++i) {
+		const Common::Rect &dirtyArea = dirtyAreas[i];
+
+		if (outSurf->format.bytesPerPixel == 2) {
+			doPaletteLookUp<uint16>((uint16 *)outSurf->getBasePtr(dirtyArea.left, dirtyArea.top),
+			                        (const byte *)_clut8Data.getBasePtr(dirtyArea.left, dirtyArea.top),
+			                        dirtyArea.width(), dirtyArea.height(),
+			                        outSurf->pitch, _clut8Data.pitch, (const uint16 *)_palette);
+		} else if (outSurf->format.bytesPerPixel == 4) {
+			doPaletteLookUp<uint32>((uint32 *)outSurf->getBasePtr(dirtyArea.left, dirtyArea.top),
+			                        (const byte *)_clut8Data.getBasePtr(dirtyArea.left, dirtyArea.top),
+			                        dirtyArea.width(), dirtyArea.height(),
+			                        outSurf->pitch, _clut8Data.pitch, (const uint32 *)_palette);
+		} else {
+			warning("TextureCLUT8::updateTexture: Unsupported pixel depth: %d", outSurf->format.bytesPerPixel);
+			break;
+		}
 	}
 
 	// Do generic handling of updating the texture.
@@ -464,25 +576,29 @@ void TextureRGB555::updateTexture() {
 	// Convert color space.
 	Graphics::Surface *outSurf = Texture::getSurface();
 
-	const Common::Rect dirtyArea = getDirtyArea();
+	const Common::Array<Common::Rect> dirtyAreas = getDirtyAreas();
 
-	uint16 *dst = (uint16 *)outSurf->getBasePtr(dirtyArea.left, dirtyArea.top);
-	const uint dstAdd = outSurf->pitch - 2 * dirtyArea.width();
+	for (uint i = 0; i < dirtyAreas.size(); ++i) {
+		const Common::Rect &dirtyArea = dirtyAreas[i];
 
-	const uint16 *src = (const uint16 *)_rgb555Data.getBasePtr(dirtyArea.left, dirtyArea.top);
-	const uint srcAdd = _rgb555Data.pitch - 2 * dirtyArea.width();
+		uint16 *dst = (uint16 *)outSurf->getBasePtr(dirtyArea.left, dirtyArea.top);
+		const uint dstAdd = outSurf->pitch - 2 * dirtyArea.width();
 
-	for (int height = dirtyArea.height(); height > 0; --height) {
-		for (int width = dirtyArea.width(); width > 0; --width) {
-			const uint16 color = *src++;
+		const uint16 *src = (const uint16 *)_rgb555Data.getBasePtr(dirtyArea.left, dirtyArea.top);
+		const uint srcAdd = _rgb555Data.pitch - 2 * dirtyArea.width();
 
-			*dst++ =   ((color & 0x7C00) << 1)                             // R
-			         | (((color & 0x03E0) << 1) | ((color & 0x0200) >> 4)) // G
-			         | (color & 0x001F);                                   // B
-		}
+		for (int height = dirtyArea.height(); height > 0; --height) {
+			for (int width = dirtyArea.width(); width > 0; --width) {
+				const uint16 color = *src++;
 
-		src = (const uint16 *)((const byte *)src + srcAdd);
-		dst = (uint16 *)((byte *)dst + dstAdd);
+				*dst++ =   ((color & 0x7C00) << 1)                             // R
+				         | (((color & 0x03E0) << 1) | ((color & 0x0200) >> 4)) // G
+				         | (color & 0x001F);                                   // B
+			}
+
+			src = (const uint16 *)((const byte *)src + srcAdd);
+			dst = (uint16 *)((byte *)dst + dstAdd);
+		}
 	}
 
 	// Do generic handling of updating the texture.
@@ -616,7 +732,7 @@ void TextureCLUT8GPU::updateGLTexture() {
 
 	// Update CLUT8 texture if necessary.
 	if (Surface::isDirty()) {
-		_clut8Texture.updateArea(getDirtyArea(), _clut8Data);
+		_clut8Texture.updateAreas(getDirtyAreas(), _clut8Data);
 		clearDirty();
 	}
 
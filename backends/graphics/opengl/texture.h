@@ -28,6 +28,7 @@
 #include "graphics/pixelformat.h"
 #include "graphics/surface.h"
 
+#include "common/array.h"
 #include "common/rect.h"
 
 namespace OpenGL {
@@ -99,6 +100,17 @@ public:
 	 */
 	void updateArea(const Common::Rect &area, const Graphics::Surface &src);
 
+	/**
+	 * Copy image data of several areas to the texture.
+	 *
+	 * Rows which are covered by more than one area are only uploaded once.
+	 *
+	 * @param areas    The areas to update.
+	 * @param src      Surface for the whole texture containing the pixel data
+	 *                 to upload.
+	 */
+	void updateAreas(const Common::Array<Common::Rect> &areas, const Graphics::Surface &src);
+
 	/**
 	 * Query the GL texture's width.
 	 */
@@ -143,6 +155,15 @@ private:
 	GLint _glFilter;
 
 	GLuint _glTexture;
+
+#if !USE_FORCED_GLES
+	/**
+	 * Pixel buffer objects used for uploads, if supported. They are used in
+	 * turns.
+	 */
+	GLuint _pixelBuffers[2];
+	uint _nextPixelBuffer;
+#endif
 };
 
 /**
@@ -201,7 +222,7 @@ public:
 	void fill(uint32 color);
 
 	void flagDirty() { _allDirty = true; }
-	virtual bool isDirty() const { return _allDirty || !_dirtyArea.isEmpty(); }
+	virtual bool isDirty() const { return _allDirty || !_dirtyAreas.empty(); }
 
 	virtual uint getWidth() const = 0;
 	virtual uint getHeight() const = 0;
@@ -239,12 +260,28 @@ public:
 	 */
 	virtual const GLTexture &getGLTexture() const = 0;
 protected:
-	void clearDirty() { _allDirty = false; _dirtyArea = Common::Rect(); }
+	void clearDirty() { _allDirty = false; _dirtyAreas.clear(); }
 
-	Common::Rect getDirtyArea() const;
+	/**
+	 * Add an area to the dirty areas.
+	 *
+	 * Areas which overlap or lie close to each other are merged, so that
+	 * there are only a few of them.
+	 */
+	void addDirtyArea(const Common::Rect &area);
+
+	/**
+	 * Query the areas which changed since the last update.
+	 */
+	Common::Array<Common::Rect> getDirtyAreas() const;
 private:
+	enum {
+		/** Maximum number of dirty areas, more are merged into one. */
+		kMaxDirtyAreas = 16
+	};
+
 	bool _allDirty;
-	Common::Rect _dirtyArea;
+	Common::Array<Common::Rect> _dirtyAreas;
 };
 
 /**
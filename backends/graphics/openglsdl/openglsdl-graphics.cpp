@@ -385,7 +385,12 @@ void OpenGLSdlGraphicsManager::updateScreen() {
 		--_ignoreResizeEvents;
 	}
 
+	if (!_framePacer.beginFrame(SdlFramePacer::getTicks())) {
+		return;
+	}
+
 	OpenGLGraphicsManager::updateScreen();
+	_framePacer.endUpdate();
 }
 
 void OpenGLSdlGraphicsManager::notifyVideoExpose() {
@@ -444,12 +449,22 @@ bool OpenGLSdlGraphicsManager::loadVideoMode(uint requestedWidth, uint requested
 }
 
 void OpenGLSdlGraphicsManager::refreshScreen() {
+	_framePacer.beginPresent(SdlFramePacer::getTicks());
+
 	// Swap OpenGL buffers
 #if SDL_VERSION_ATLEAST(2, 0, 0)
 	SDL_GL_SwapWindow(_window->getSDLWindow());
 #else
 	SDL_GL_SwapBuffers();
 #endif
+
+	// Wait until the frame is on the screen, so that the driver does not
+	// queue up further frames behind it.
+	if (_framePacer.isLowLatency()) {
+		GL_WRAP_DEBUG(OpenGL::g_context.glFinish(), glFinish);
+	}
+
+	_framePacer.endFrame(SdlFramePacer::getTicks());
 }
 
 void *OpenGLSdlGraphicsManager::getProcAddress(const char *name) const {
@@ -0,0 +1,134 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "common/scummsys.h"
+
+#if defined(SDL_BACKEND)
+
+#include "backends/graphics/sdl/sdl-framepacer.h"
+#include "backends/platform/sdl/sdl-sys.h"
+
+#include "common/debug.h"
+
+SdlFramePacer::SdlFramePacer()
+	: _frameTime(0), _lowLatency(false), _started(false), _deadline(0), _pending(false),
+	  _inFrame(false), _wasPending(false), _frameStart(0), _presentStart(0),
+	  _reportCpuTime(0), _reportPresentTime(0), _reportFrames(0) {
+	memset(&_stats, 0, sizeof(_stats));
+}
+
+void SdlFramePacer::setFrameRate(uint frameRate) {
+	_frameTime = frameRate ? 1000000 / frameRate : 0;
+
+	// The next frame starts a new series of deadlines. A frame which is
+	// held back is presented by the next updateScreen or
+	// presentPendingFrame call.
+	_started = false;
+}
+
+bool SdlFramePacer::beginFrame(uint32 now) {
+	if (_frameTime && _started && (int32)(now - _deadline) < 0) {
+		_pending = true;
+		++_stats.coalescedUpdates;
+		return false;
+	}
+
+	// Whatever was held back is part of this frame now, even if it turns
+	// out that there is nothing to draw.
+	_inFrame = true;
+	_wasPending = _pending;
+	_pending = false;
+	_frameStart = now;
+	_presentStart = now;
+	return true;
+}
+
+void SdlFramePacer::beginPresent(uint32 now) {
+	if (_inFrame) {
+		_presentStart = now;
+	}
+}
+
+void SdlFramePacer::endFrame(uint32 now) {
+	// updateScreen returns early when there is nothing to draw, in which
+	// case the frame does not count.
+	if (!_inFrame) {
+		return;
+	}
+	_inFrame = false;
+
+	_stats.cpuTime = _presentStart - _frameStart;
+	_stats.presentTime = now - _presentStart;
+	++_stats.frames;
+
+	if (_frameTime) {
+		if (_started) {
+			const uint32 late = _frameStart - _deadline;
+			if (_wasPending) {
+				_stats.droppedFrames += late / _frameTime;
+			}
+
+			// The deadlines stay on a fixed grid, so that frames are evenly
+			// spaced, unless we fell behind by a whole frame.
+			_deadline = (late < _frameTime ? _deadline : _frameStart) + _frameTime;
+		} else {
+			_deadline = _frameStart + _frameTime;
+			_started = true;
+		}
+	}
+
+	_reportCpuTime += _stats.cpuTime;
+	_reportPresentTime += _stats.presentTime;
+	if (++_reportFrames == kReportFrames) {
+		debug(2, "Frames: %u.%02u ms drawing, %u.%02u ms presenting, %u coalesced updates, %u dropped frames",
+		      _reportCpuTime / 100000, (_reportCpuTime / 1000) % 100,
+		      _reportPresentTime / 100000, (_reportPresentTime / 1000) % 100,
+		      _stats.coalescedUpdates, _stats.droppedFrames);
+		_reportCpuTime = 0;
+		_reportPresentTime = 0;
+		_reportFrames = 0;
+	}
+}
+
+uint32 SdlFramePacer::getTimeToDeadline(uint32 now) const {
+	if (!_frameTime || !_started) {
+		return 0;
+	}
+
+	const int32 remaining = (int32)(_deadline - now);
+	return remaining > 0 ? remaining : 0;
+}
+
+uint32 SdlFramePacer::getTicks() {
+#if SDL_VERSION_ATLEAST(2, 0, 0)
+	// The counter times 1000000 overflows even 64 bits after a few hours
+	// with nanosecond counters, so convert the whole seconds separately.
+	// The result wraps around, which the users of the ticks allow for.
+	const uint64 counter = SDL_GetPerformanceCounter();
+	const uint64 frequency = SDL_GetPerformanceFrequency();
+	return (uint32)((counter / frequency) * 1000000 + (counter % frequency) * 1000000 / frequency);
+#else
+	return SDL_GetTicks() * 1000;
+#endif
+}
+
+#endif
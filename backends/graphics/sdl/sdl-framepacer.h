@@ -0,0 +1,143 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef BACKENDS_GRAPHICS_SDL_FRAMEPACER_H
+#define BACKENDS_GRAPHICS_SDL_FRAMEPACER_H
+
+#include "common/scummsys.h"
+
+/**
+ * Schedules the frames presented by a SDL graphics manager.
+ *
+ * Without a frame rate set, every updateScreen call is presented right
+ * away. With a frame rate set, at most one frame is presented per frame
+ * interval: updates which arrive before the deadline of the next frame are
+ * held back and presented together once the deadline has passed, either
+ * by the next updateScreen call or by presentPendingFrame() of the graphics
+ * manager.
+ *
+ * All times are in microseconds.
+ */
+class SdlFramePacer {
+public:
+	/**
+	 * Timing of the presented frames.
+	 */
+	struct Stats {
+		/** Time spent drawing the last frame */
+		uint32 cpuTime;
+		/** Time spent handing the last frame to the display */
+		uint32 presentTime;
+		/** Frames presented so far */
+		uint32 frames;
+		/** updateScreen calls which were merged into a later frame */
+		uint32 coalescedUpdates;
+		/** Frame intervals which passed while a frame was held back */
+		uint32 droppedFrames;
+	};
+
+	SdlFramePacer();
+
+	/**
+	 * Sets the number of frames per second to pace to. 0 presents every
+	 * update right away.
+	 */
+	void setFrameRate(uint frameRate);
+	uint getFrameRate() const { return _frameTime ? 1000000 / _frameTime : 0; }
+
+	/**
+	 * Sets whether every frame has to be fully displayed before the next
+	 * one is drawn. This keeps the display driver from queuing frames, at
+	 * the price of less parallelism between the CPU and the GPU.
+	 */
+	void setLowLatency(bool lowLatency) { _lowLatency = lowLatency; }
+	bool isLowLatency() const { return _lowLatency; }
+
+	/**
+	 * Called at the start of updateScreen.
+	 *
+	 * @return true when the frame is to be drawn now, false when it is
+	 *         held back until the next deadline
+	 */
+	bool beginFrame(uint32 now);
+
+	/**
+	 * Called once the frame is drawn and about to be handed to the display.
+	 */
+	void beginPresent(uint32 now);
+
+	/**
+	 * Called once the frame has been handed to the display.
+	 */
+	void endFrame(uint32 now);
+
+	/**
+	 * Called at the end of updateScreen. When nothing was presented,
+	 * because there was nothing to draw, the frame does not count.
+	 */
+	void endUpdate() { _inFrame = false; }
+
+	/**
+	 * Returns whether a frame is held back.
+	 */
+	bool hasPendingFrame() const { return _pending; }
+
+	/**
+	 * Returns the time until a frame which is held back should be
+	 * presented, or 0 when it is already due.
+	 */
+	uint32 getTimeToDeadline(uint32 now) const;
+
+	const Stats &getStats() const { return _stats; }
+
+	/**
+	 * Returns a timestamp for the frame pacing.
+	 */
+	static uint32 getTicks();
+
+private:
+	enum {
+		/** Number of frames whose times are averaged in the debug output */
+		kReportFrames = 100
+	};
+
+	uint32 _frameTime;
+	bool _lowLatency;
+
+	/** Whether a frame was presented yet, i.e. whether _deadline is valid */
+	bool _started;
+	uint32 _deadline;
+	bool _pending;
+
+	/** Whether a frame is being drawn, and whether it was held back before */
+	bool _inFrame;
+	bool _wasPending;
+	uint32 _frameStart;
+	uint32 _presentStart;
+
+	Stats _stats;
+	uint32 _reportCpuTime;
+	uint32 _reportPresentTime;
+	uint32 _reportFrames;
+};
+
+#endif
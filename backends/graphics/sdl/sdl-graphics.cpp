@@ -34,6 +34,9 @@ SdlGraphicsManager::SdlGraphicsManager(SdlEventSource *source, SdlWindow *window
 #endif
 {
 	SDL_GetMouseState(&_cursorX, &_cursorY);
+
+	_mainThread = SDL_ThreadID();
+	initFramePacing();
 }
 
 void SdlGraphicsManager::activateManager() {
@@ -265,3 +268,39 @@ bool SdlGraphicsManager::createOrUpdateWindow(int width, int height, const Uint3
 	return true;
 }
 #endif
+
+void SdlGraphicsManager::initFramePacing() {
+	int frameRate = 0;
+	if (ConfMan.hasKey("frame_rate")) {
+		frameRate = CLIP(ConfMan.getInt("frame_rate"), 0, 1000);
+	}
+	_framePacer.setFrameRate(frameRate);
+	_framePacer.setLowLatency(ConfMan.get("frame_latency").equalsIgnoreCase("low"));
+
+	// A frame held back with the old settings is due now
+	presentPendingFrame();
+}
+
+void SdlGraphicsManager::presentPendingFrame() {
+	if (_framePacer.hasPendingFrame() && SDL_ThreadID() == _mainThread
+	    && _framePacer.getTimeToDeadline(SdlFramePacer::getTicks()) == 0) {
+		updateScreen();
+	}
+}
+
+uint SdlGraphicsManager::delayForPendingFrame(uint msecs) {
+	if (!_framePacer.hasPendingFrame() || SDL_ThreadID() != _mainThread) {
+		return msecs;
+	}
+
+	const uint wait = (_framePacer.getTimeToDeadline(SdlFramePacer::getTicks()) + 999) / 1000;
+	if (wait > msecs) {
+		return msecs;
+	}
+
+	if (wait) {
+		SDL_Delay(wait);
+	}
+	updateScreen();
+	return msecs - wait;
+}
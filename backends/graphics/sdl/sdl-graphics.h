@@ -24,6 +24,7 @@
 #define BACKENDS_GRAPHICS_SDL_SDLGRAPHICS_H
 
 #include "backends/graphics/windowed.h"
+#include "backends/graphics/sdl/sdl-framepacer.h"
 #include "backends/platform/sdl/sdl-window.h"
 
 #include "common/rect.h"
@@ -123,6 +124,32 @@ public:
 
 	virtual void initSizeHint(const Graphics::ModeList &modes) override;
 
+	/**
+	 * Reads the frame pacing settings (frame_rate and frame_latency) of the
+	 * active config domain.
+	 */
+	void initFramePacing();
+
+	/**
+	 * Presents a frame which the frame pacing held back, if its deadline
+	 * has passed.
+	 */
+	void presentPendingFrame();
+
+	/**
+	 * Waits until the deadline of a frame which the frame pacing held back
+	 * and presents it, provided the deadline is within the given time.
+	 *
+	 * @param msecs the time the caller wants to wait
+	 * @returns the part of msecs which is left to wait
+	 */
+	uint delayForPendingFrame(uint msecs);
+
+	/**
+	 * @returns the timing of the presented frames.
+	 */
+	const SdlFramePacer::Stats &getFrameStats() const { return _framePacer.getStats(); }
+
 protected:
 	virtual int getGraphicsModeScale(int mode) const = 0;
 
@@ -173,6 +200,16 @@ protected:
 	SDL_Surface *_hwScreen;
 	SdlEventSource *_eventSource;
 	SdlWindow *_window;
+
+	SdlFramePacer _framePacer;
+
+private:
+	/** Frames are only presented from the thread which created the manager */
+#if SDL_VERSION_ATLEAST(2, 0, 0)
+	SDL_threadID _mainThread;
+#else
+	Uint32 _mainThread;
+#endif
 };
 
 #endif
@@ -152,7 +152,8 @@ SurfaceSdlGraphicsManager::SurfaceSdlGraphicsManager(SdlEventSource *sdlEventSou
 	_screenFormat(Graphics::PixelFormat::createFormatCLUT8()),
 	_cursorFormat(Graphics::PixelFormat::createFormatCLUT8()),
 	_overlayscreen(0), _tmpscreen2(0),
-	_scalerProc(0), _screenChangeCount(0),
+	_scalerProc(0), _scalerPool(nullptr), _scalerTime(0), _scalerFrames(0),
+	_screenChangeCount(0),
 	_mouseData(nullptr), _mouseSurface(nullptr),
 	_mouseOrigSurface(nullptr), _cursorDontScale(false), _cursorPaletteDisabled(true),
 	_currentShakePos(0), _newShakePos(0),
@@ -215,6 +216,16 @@ SurfaceSdlGraphicsManager::SurfaceSdlGraphicsManager(SdlEventSource *sdlEventSou
 	// consult the psp2sdl backend which inherits from this class
 	_currentShader = 0;
 	_numShaders = 1;
+
+	// Scale the dirty rects on several threads. By default one per core,
+	// up to four, the scalers are limited by memory bandwidth beyond that.
+	int scalerThreads = 1;
+#if SDL_VERSION_ATLEAST(2, 0, 0)
+	scalerThreads = MIN(SDL_GetCPUCount(), 4);
+#endif
+	if (ConfMan.hasKey("scaler_threads"))
+		scalerThreads = CLIP(ConfMan.getInt("scaler_threads"), 1, 16);
+	_scalerPool = new SurfaceSdlScalerPool(scalerThreads);
 }
 
 SurfaceSdlGraphicsManager::~SurfaceSdlGraphicsManager() {
@@ -228,6 +239,7 @@ SurfaceSdlGraphicsManager::~SurfaceSdlGraphicsManager() {
 	if (_mouseSurface) {
 		SDL_FreeSurface(_mouseSurface);
 	}
+	delete _scalerPool;
 	g_system->deleteMutex(_graphicsMutex);
 	free(_currentPalette);
 	free(_cursorPalette);
@@ -1184,7 +1196,12 @@ void SurfaceSdlGraphicsManager::updateScreen() {
 
 	Common::StackLock lock(_graphicsMutex);	// Lock the mutex until this function ends
 
+	if (!_framePacer.beginFrame(SdlFramePacer::getTicks())) {
+		return;
+	}
+
 	internUpdateScreen();
+	_framePacer.endUpdate();
 }
 
 void SurfaceSdlGraphicsManager::updateShader() {
@@ -1290,6 +1307,8 @@ void SurfaceSdlGraphicsManager::internUpdateScreen() {
 		srcPitch = srcSurf->pitch;
 		dstPitch = _hwScreen->pitch;
 
+		const uint32 scalerStart = SdlFramePacer::getTicks();
+
 		for (r = _dirtyRectList; r != lastRect; ++r) {
 			int dst_y = r->y + _currentShakePos;
 			int dst_h = 0;
@@ -1312,7 +1331,7 @@ void SurfaceSdlGraphicsManager::internUpdateScreen() {
 					dst_y = real2Aspect(dst_y);
 
 				assert(scalerProc != NULL);
-				scalerProc((byte *)srcSurf->pixels + (r->x * 2 + 2) + (r->y + 1) * srcPitch, srcPitch,
+				_scalerPool->addRect(scalerProc, scale1, (byte *)srcSurf->pixels + (r->x * 2 + 2) + (r->y + 1) * srcPitch, srcPitch,
 					(byte *)_hwScreen->pixels + rx1 * 2 + dst_y * dstPitch, dstPitch, r->w, dst_h);
 			}
 
@@ -1322,10 +1341,27 @@ void SurfaceSdlGraphicsManager::internUpdateScreen() {
 			r->h = dst_h * scale1;
 
 #ifdef USE_SCALERS
-			if (_videoMode.aspectRatioCorrection && orig_dst_y < height && !_overlayVisible)
-				r->h = stretch200To240((uint8 *) _hwScreen->pixels, dstPitch, r->w, r->h, r->x, r->y, orig_dst_y * scale1, _videoMode.filtering);		
+			if (_videoMode.aspectRatioCorrection && orig_dst_y < height && !_overlayVisible) {
+				// The aspect ratio correction works in place on the
+				// complete scaled rect, which may overlap the next ones
+				_scalerPool->run();
+				r->h = stretch200To240((uint8 *) _hwScreen->pixels, dstPitch, r->w, r->h, r->x, r->y, orig_dst_y * scale1, _videoMode.filtering);
+			}
 #endif
 		}
+
+		// Without aspect ratio correction, the bands of all rects are
+		// scaled at once
+		_scalerPool->run();
+
+		_scalerTime += SdlFramePacer::getTicks() - scalerStart;
+		if (++_scalerFrames == 100) {
+			debug(2, "Scaler: %u.%02u ms per frame on %d threads", _scalerTime / 100000, (_scalerTime / 1000) % 100,
+			      _scalerPool->getThreadCount());
+			_scalerTime = 0;
+			_scalerFrames = 0;
+		}
+
 		SDL_UnlockSurface(srcSurf);
 		SDL_UnlockSurface(_hwScreen);
 
@@ -1416,8 +1452,11 @@ void SurfaceSdlGraphicsManager::internUpdateScreen() {
 
 		// Finally, blit all our changes to the screen
 		if (!_displayDisabled) {
+			_framePacer.beginPresent(SdlFramePacer::getTicks());
 			SDL_UpdateRects(_hwScreen, _numDirtyRects, _dirtyRectList);
 		}
+
+		_framePacer.endFrame(SdlFramePacer::getTicks());
 	}
 
 	_numDirtyRects = 0;
@@ -31,6 +31,7 @@
 #include "common/system.h"
 
 #include "backends/events/sdl/sdl-events.h"
+#include "backends/graphics/surfacesdl/surfacesdl-scalerpool.h"
 
 #include "backends/platform/sdl/sdl-sys.h"
 
@@ -285,6 +286,13 @@ protected:
 
 	ScalerProc *_scalerProc;
 	int _scalerType;
+
+	// Runs the scaler on several threads, see the scaler_threads setting
+	SurfaceSdlScalerPool *_scalerPool;
+	// Time spent scaling, in microseconds, and frames scaled since the
+	// last time it was reported
+	uint32 _scalerTime;
+	uint32 _scalerFrames;
 	int _transactionMode;
 
 	// Indicates whether it is needed to free _hwSurface in destructor
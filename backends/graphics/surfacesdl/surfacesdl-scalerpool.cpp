@@ -0,0 +1,154 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "common/scummsys.h"
+
+#if defined(SDL_BACKEND)
+
+#include "backends/graphics/surfacesdl/surfacesdl-scalerpool.h"
+
+#include "common/textconsole.h"
+#include "common/util.h"
+
+SurfaceSdlScalerPool::SurfaceSdlScalerPool(int numThreads)
+	: _nextBand(0), _pendingBands(0), _quit(false) {
+	_mutex = SDL_CreateMutex();
+	_workCond = SDL_CreateCond();
+	_doneCond = SDL_CreateCond();
+
+	for (int i = 1; i < numThreads; ++i) {
+#if SDL_VERSION_ATLEAST(2, 0, 0)
+		SDL_Thread *thread = SDL_CreateThread(threadProc, "ScummVM scaler", this);
+#else
+		SDL_Thread *thread = SDL_CreateThread(threadProc, this);
+#endif
+		if (!thread) {
+			warning("Could not create scaler thread: %s", SDL_GetError());
+			break;
+		}
+
+		_threads.push_back(thread);
+	}
+}
+
+SurfaceSdlScalerPool::~SurfaceSdlScalerPool() {
+	SDL_LockMutex(_mutex);
+	_quit = true;
+	SDL_CondBroadcast(_workCond);
+	SDL_UnlockMutex(_mutex);
+
+	for (uint i = 0; i < _threads.size(); ++i)
+		SDL_WaitThread(_threads[i], nullptr);
+
+	SDL_DestroyCond(_doneCond);
+	SDL_DestroyCond(_workCond);
+	SDL_DestroyMutex(_mutex);
+}
+
+void SurfaceSdlScalerPool::addRect(ScalerProc *scalerProc, int scale, const uint8 *srcPtr, uint32 srcPitch,
+                                   uint8 *dstPtr, uint32 dstPitch, int width, int height) {
+	int bands = MIN<int>(getThreadCount(), height / kMinBandHeight);
+	if (bands <= 1) {
+		addBand(scalerProc, srcPtr, srcPitch, dstPtr, dstPitch, width, height);
+		return;
+	}
+
+	// The last band takes the remaining lines
+	const int bandHeight = (height / bands) & ~3;
+	for (int i = 0; i < bands; ++i) {
+		const int h = (i == bands - 1) ? height - i * bandHeight : bandHeight;
+		addBand(scalerProc, srcPtr, srcPitch, dstPtr, dstPitch, width, h);
+
+		srcPtr += bandHeight * srcPitch;
+		dstPtr += bandHeight * scale * dstPitch;
+	}
+}
+
+void SurfaceSdlScalerPool::addBand(ScalerProc *scalerProc, const uint8 *srcPtr, uint32 srcPitch,
+                                   uint8 *dstPtr, uint32 dstPitch, int width, int height) {
+	Band band;
+	band.scalerProc = scalerProc;
+	band.srcPtr = srcPtr;
+	band.srcPitch = srcPitch;
+	band.dstPtr = dstPtr;
+	band.dstPitch = dstPitch;
+	band.width = width;
+	band.height = height;
+	_bands.push_back(band);
+}
+
+void SurfaceSdlScalerPool::run() {
+	if (_bands.empty())
+		return;
+
+	// Without worker threads, there is no need for any locking
+	if (_threads.empty()) {
+		for (uint i = 0; i < _bands.size(); ++i) {
+			const Band &band = _bands[i];
+			band.scalerProc(band.srcPtr, band.srcPitch, band.dstPtr, band.dstPitch, band.width, band.height);
+		}
+		_bands.clear();
+		return;
+	}
+
+	SDL_LockMutex(_mutex);
+	_nextBand = 0;
+	_pendingBands = _bands.size();
+	SDL_CondBroadcast(_workCond);
+
+	scaleBands();
+	while (_pendingBands > 0)
+		SDL_CondWait(_doneCond, _mutex);
+
+	_bands.clear();
+	_nextBand = 0;
+	SDL_UnlockMutex(_mutex);
+}
+
+void SurfaceSdlScalerPool::scaleBands() {
+	// The band list is only stable while bands are pending
+	while (_pendingBands > 0 && _nextBand < _bands.size()) {
+		const Band band = _bands[_nextBand++];
+
+		SDL_UnlockMutex(_mutex);
+		band.scalerProc(band.srcPtr, band.srcPitch, band.dstPtr, band.dstPitch, band.width, band.height);
+		SDL_LockMutex(_mutex);
+
+		if (--_pendingBands == 0)
+			SDL_CondSignal(_doneCond);
+	}
+}
+
+int SDLCALL SurfaceSdlScalerPool::threadProc(void *data) {
+	SurfaceSdlScalerPool *pool = (SurfaceSdlScalerPool *)data;
+
+	SDL_LockMutex(pool->_mutex);
+	while (!pool->_quit) {
+		pool->scaleBands();
+		SDL_CondWait(pool->_workCond, pool->_mutex);
+	}
+	SDL_UnlockMutex(pool->_mutex);
+
+	return 0;
+}
+
+#endif
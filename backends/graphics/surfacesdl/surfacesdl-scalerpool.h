@@ -0,0 +1,109 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef BACKENDS_GRAPHICS_SURFACESDL_SCALERPOOL_H
+#define BACKENDS_GRAPHICS_SURFACESDL_SCALERPOOL_H
+
+#include "backends/platform/sdl/sdl-sys.h"
+#include "graphics/scaler.h"
+#include "common/array.h"
+
+/**
+ * Runs a scaler over a list of rects on several threads.
+ *
+ * Each rect is split into horizontal bands which are scaled in parallel.
+ * The bands start at multiples of four source lines, so scalers which
+ * depend on the line number (like DotMatrix) produce the same output as
+ * when run over the whole rect. All scalers read one line above and below
+ * the scaled area, which is fine since the source is not changed while
+ * the jobs run.
+ */
+class SurfaceSdlScalerPool {
+public:
+	/**
+	 * Creates the pool.
+	 *
+	 * @param numThreads the number of threads scaling in parallel,
+	 *                   including the one calling run()
+	 */
+	SurfaceSdlScalerPool(int numThreads);
+	~SurfaceSdlScalerPool();
+
+	/**
+	 * Returns the number of threads scaling in parallel, including the
+	 * calling one.
+	 */
+	int getThreadCount() const { return _threads.size() + 1; }
+
+	/**
+	 * Queues scaling the given rect, with the same parameters as the
+	 * scaler itself.
+	 *
+	 * @param scale the number of destination lines per source line
+	 */
+	void addRect(ScalerProc *scalerProc, int scale, const uint8 *srcPtr, uint32 srcPitch,
+	             uint8 *dstPtr, uint32 dstPitch, int width, int height);
+
+	/**
+	 * Scales all queued rects, and returns when all are done.
+	 */
+	void run();
+
+private:
+	enum {
+		/** Rects are only split into bands of at least this many lines */
+		kMinBandHeight = 16
+	};
+
+	struct Band {
+		ScalerProc *scalerProc;
+		const uint8 *srcPtr;
+		uint32 srcPitch;
+		uint8 *dstPtr;
+		uint32 dstPitch;
+		int width, height;
+	};
+
+	void addBand(ScalerProc *scalerProc, const uint8 *srcPtr, uint32 srcPitch,
+	             uint8 *dstPtr, uint32 dstPitch, int width, int height);
+
+	/**
+	 * Scales queued bands until there are none left. Must be called with
+	 * the mutex locked, returns with it locked.
+	 */
+	void scaleBands();
+
+	static int SDLCALL threadProc(void *data);
+
+	Common::Array<Band> _bands;
+	Common::Array<SDL_Thread *> _threads;
+
+	SDL_mutex *_mutex;
+	SDL_cond *_workCond;
+	SDL_cond *_doneCond;
+
+	uint _nextBand;
+	uint _pendingBands;
+	bool _quit;
+};
+
+#endif
@@ -299,6 +299,7 @@ void OSystem_SDL::engineInit() {
 #if SDL_VERSION_ATLEAST(2, 0, 0)
 	dynamic_cast<SdlGraphicsManager *>(_graphicsManager)->unlockWindowSize();
 #endif
+	dynamic_cast<SdlGraphicsManager *>(_graphicsManager)->initFramePacing();
 #ifdef USE_TASKBAR
 	// Add the started engine to the list of recent tasks
 	_taskbarManager->addRecent(ConfMan.getActiveDomainName(), ConfMan.get("description"));
@@ -312,6 +313,7 @@ void OSystem_SDL::engineDone() {
 #if SDL_VERSION_ATLEAST(2, 0, 0)
 	dynamic_cast<SdlGraphicsManager *>(_graphicsManager)->unlockWindowSize();
 #endif
+	dynamic_cast<SdlGraphicsManager *>(_graphicsManager)->initFramePacing();
 #ifdef USE_TASKBAR
 	// Remove overlay icon
 	_taskbarManager->setOverlayIcon("", "");
@@ -509,7 +511,72 @@ void OSystem_SDL::delayMillis(uint msecs) {
 #ifdef ENABLE_EVENTRECORDER
 	if (!g_eventRec.processDelayMillis())
 #endif
+	{
+		// Present a frame held back by the frame pacing on time
+		SdlGraphicsManager *graphicsManager = dynamic_cast<SdlGraphicsManager *>(_graphicsManager);
+		if (graphicsManager) {
+			msecs = graphicsManager->delayForPendingFrame(msecs);
+		}
+
 		SDL_Delay(msecs);
+	}
+}
+
+#if SDL_VERSION_ATLEAST(2, 0, 0)
+namespace {
+
+struct SdlParallelJobs {
+	OSystem::ParallelJobProc proc;
+	void *param;
+	uint count;
+	SDL_atomic_t next;
+};
+
+int SDLCALL runSdlParallelJobs(void *data) {
+	SdlParallelJobs *jobs = (SdlParallelJobs *)data;
+
+	for (;;) {
+		const uint index = (uint)SDL_AtomicAdd(&jobs->next, 1);
+		if (index >= jobs->count)
+			return 0;
+		jobs->proc(jobs->param, index);
+	}
+}
+
+} // End of anonymous namespace
+#endif
+
+void OSystem_SDL::runParallelJobs(ParallelJobProc proc, void *param, uint count) {
+#if SDL_VERSION_ATLEAST(2, 0, 0)
+	// One thread per core, up to eight, including the calling one. The
+	// jobs are meant to be few and long, like reading files, so the
+	// threads only live for as long as the jobs run.
+	const uint numThreads = MIN<uint>(MIN(SDL_GetCPUCount(), 8), count);
+	if (numThreads > 1) {
+		SdlParallelJobs jobs;
+		jobs.proc = proc;
+		jobs.param = param;
+		jobs.count = count;
+		SDL_AtomicSet(&jobs.next, 0);
+
+		// Any jobs left over by threads which fail to start are run by
+		// the others
+		Common::Array<SDL_Thread *> threads;
+		for (uint i = 1; i < numThreads; ++i) {
+			SDL_Thread *thread = SDL_CreateThread(runSdlParallelJobs, "ScummVM jobs", &jobs);
+			if (thread)
+				threads.push_back(thread);
+		}
+
+		runSdlParallelJobs(&jobs);
+
+		for (uint i = 0; i < threads.size(); ++i)
+			SDL_WaitThread(threads[i], nullptr);
+		return;
+	}
+#endif
+
+	OSystem::runParallelJobs(proc, param, count);
 }
 
 void OSystem_SDL::getTimeAndDate(TimeDate &td) const {
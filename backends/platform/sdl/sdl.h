@@ -82,6 +82,7 @@ public:
 	virtual Audio::Mixer *getMixer();
 	virtual Common::TimerManager *getTimerManager();
 	virtual Common::SaveFileManager *getSavefileManager();
+	virtual void runParallelJobs(ParallelJobProc proc, void *param, uint count);
 
 	//Screenshots
 	virtual Common::String getScreenshotsPath();
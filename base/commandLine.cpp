@@ -134,7 +134,7 @@ static const char HELP_STRING[] =
 	"  --output-rate=RATE       Select output sample rate in Hz (e.g. 22050)\n"
 	"  --opl-driver=DRIVER      Select AdLib (OPL) emulator (db, mame"
 #ifndef DISABLE_NUKED_OPL
-                                                                     ", nuked"
+                                                                     ", nuked, nuked_vector"
 #endif
 #ifdef ENABLE_OPL2LPT
                                                                      ", opl2lpt"
@@ -286,6 +286,9 @@ void registerDefaults() {
 	ConfMan.registerDefault("gui_browser_show_hidden", false);
 	ConfMan.registerDefault("game", "");
 
+	ConfMan.registerDefault("fs_index", false);
+	ConfMan.registerDefault("md5_cache", false);
+
 #ifdef USE_FLUIDSYNTH
 	// The settings are deliberately stored the same way as in Qsynth. The
 	// FluidSynth music driver is responsible for transforming them into
@@ -41,6 +41,8 @@
 #include "common/config-manager.h"
 #include "common/debug.h"
 #include "common/debug-channels.h" /* for debug manager */
+#include "common/dirindex.h"
+#include "common/md5cache.h"
 #include "common/events.h"
 #include "gui/EventRecorder.h"
 #include "common/fs.h"
@@ -282,6 +284,80 @@ static Common::Error runGame(const Plugin *plugin, OSystem &system, const Common
 	return result;
 }
 
+// Persistent listings of the game directories and checksums of the game
+// files, see the fs_index and md5_cache options
+static Common::DirectoryIndex *s_directoryIndex = 0;
+static Common::FSNode s_directoryIndexFile;
+static Common::MD5Cache *s_md5Cache = 0;
+static Common::FSNode s_md5CacheFile;
+static bool s_md5CacheSaved = false;
+
+template<class T>
+static void loadCacheFile(T &cache, const Common::FSNode &file) {
+	if (!file.exists())
+		return;
+
+	Common::SeekableReadStream *stream = file.createReadStream();
+	if (stream && !cache.loadFromStream(*stream))
+		warning("Ignoring invalid cache file '%s'", file.getPath().c_str());
+	delete stream;
+}
+
+template<class T>
+static void saveCacheFile(T *cache, const Common::FSNode &file) {
+	if (!cache || !cache->isModified())
+		return;
+
+	Common::WriteStream *stream = file.createWriteStream();
+	if (!stream || !cache->saveToStream(*stream))
+		warning("Unable to write cache file '%s'", file.getPath().c_str());
+	delete stream;
+}
+
+static void openCaches(const Common::String &configFileName) {
+	// Keep the caches next to the config file
+	const Common::FSNode configDir = Common::FSNode(configFileName).getParent();
+
+	if (ConfMan.getBool("fs_index")) {
+		s_directoryIndexFile = configDir.getChild("scummvm-dirindex.dat");
+		s_directoryIndex = new Common::DirectoryIndex();
+		loadCacheFile(*s_directoryIndex, s_directoryIndexFile);
+		Common::DirectoryIndex::setActive(s_directoryIndex);
+	}
+
+	// The checksums are always shared between the engines, but are only
+	// kept across runs if enabled
+	s_md5Cache = new Common::MD5Cache();
+	s_md5CacheSaved = ConfMan.getBool("md5_cache");
+	if (s_md5CacheSaved) {
+		s_md5CacheFile = configDir.getChild("scummvm-md5cache.dat");
+		loadCacheFile(*s_md5Cache, s_md5CacheFile);
+	}
+	Common::MD5Cache::setActive(s_md5Cache);
+}
+
+static void saveCaches() {
+	saveCacheFile(s_directoryIndex, s_directoryIndexFile);
+	if (s_md5CacheSaved)
+		saveCacheFile(s_md5Cache, s_md5CacheFile);
+}
+
+static void closeCaches() {
+	saveCaches();
+	Common::DirectoryIndex::setActive(0);
+	delete s_directoryIndex;
+	s_directoryIndex = 0;
+	Common::MD5Cache::setActive(0);
+	delete s_md5Cache;
+	s_md5Cache = 0;
+}
+
+/** Makes sure the caches are saved on every way out of scummvm_main. */
+class CacheCloser {
+public:
+	~CacheCloser() { closeCaches(); }
+};
+
 static void setupGraphics(OSystem &system) {
 
 	system.beginGFXTransaction();
@@ -380,6 +456,7 @@ extern "C" int scummvm_main(int argc, const char * const argv[]) {
 	command = Base::parseCommandLine(settings, argc, argv);
 
 	// Load the config file (possibly overridden via command line):
+	const Common::String configFileName = settings.contains("config") ? settings["config"] : system.getDefaultConfigFileName();
 	if (settings.contains("config")) {
 		ConfMan.loadConfigFile(settings["config"]);
 		settings.erase("config");
@@ -390,6 +467,9 @@ extern "C" int scummvm_main(int argc, const char * const argv[]) {
 	// Update the config file
 	ConfMan.set("versioninfo", gScummVMVersion, Common::ConfigManager::kApplicationDomain);
 
+	openCaches(configFileName);
+	CacheCloser cacheCloser;
+
 	// Load and setup the debuglevel and the debug flags. We do this at the
 	// soonest possible moment to ensure debug output starts early on, if
 	// requested.
@@ -528,6 +608,10 @@ extern "C" int scummvm_main(int argc, const char * const argv[]) {
 				break;
 			}
 #endif
+			// Keep what the launcher and the detection listed, in case the
+			// game does not return
+			saveCaches();
+
 			// Try to run the game
 			Common::Error result = runGame(plugin, system, specialDebug);
 
@@ -616,6 +700,7 @@ extern "C" int scummvm_main(int argc, const char * const argv[]) {
 	Cloud::CloudManager::destroy();
 #endif
 #endif
+	closeCaches();
 	PluginManager::instance().unloadAllPlugins();
 	PluginManager::destroy();
 	GUI::GuiManager::destroy();
@@ -61,6 +61,9 @@ int Archive::listMatchingMembers(ArchiveMemberList &list, const String &pattern)
 }
 
 
+SearchSet::SearchSet() : _indexEnabled(false), _indexValid(false) {
+	resetLookupStats();
+}
 
 SearchSet::ArchiveNodeList::iterator SearchSet::find(const String &name) {
 	ArchiveNodeList::iterator it = _list.begin();
@@ -92,6 +95,7 @@ void SearchSet::insert(const Node &node) {
 			break;
 	}
 	_list.insert(it, node);
+	invalidateIndex();
 }
 
 void SearchSet::add(const String &name, Archive *archive, int priority, bool autoFree) {
@@ -173,6 +177,7 @@ void SearchSet::remove(const String &name) {
 		if (it->_autoFree)
 			delete it->_arc;
 		_list.erase(it);
+		invalidateIndex();
 	}
 }
 
@@ -187,6 +192,7 @@ void SearchSet::clear() {
 	}
 
 	_list.clear();
+	invalidateIndex();
 }
 
 void SearchSet::setPriority(const String &name, int priority) {
@@ -205,12 +211,93 @@ void SearchSet::setPriority(const String &name, int priority) {
 	insert(node);
 }
 
+void SearchSet::enableIndex(bool enable) {
+	_indexEnabled = enable;
+	invalidateIndex();
+}
+
+void SearchSet::invalidateIndex() {
+	_indexValid = false;
+	_memberIndex.clear(true);
+	_lookupCache.clear(true);
+}
+
+void SearchSet::resetLookupStats() {
+	_stats.lookups = 0;
+	_stats.indexHits = 0;
+	_stats.archiveProbes = 0;
+	_stats.indexBuilds = 0;
+}
+
+void SearchSet::buildIndex() const {
+	_memberIndex.clear();
+	_lookupCache.clear();
+
+	// The list is sorted by priority, so the first archive listing a name
+	// is the one serving it
+	ArchiveNodeList::const_iterator it = _list.begin();
+	for (; it != _list.end(); ++it) {
+		ArchiveMemberList members;
+		it->_arc->listMembers(members);
+
+		for (ArchiveMemberList::const_iterator member = members.begin(); member != members.end(); ++member) {
+			const String memberName = (*member)->getName();
+			if (!_memberIndex.contains(memberName))
+				_memberIndex[memberName] = &*it;
+		}
+	}
+
+	_indexValid = true;
+	++_stats.indexBuilds;
+}
+
+const SearchSet::Node *SearchSet::findArchive(const String &name) const {
+	if (!_indexValid)
+		buildIndex();
+
+	LookupCache::const_iterator cached = _lookupCache.find(name);
+	if (cached != _lookupCache.end()) {
+		++_stats.indexHits;
+		return cached->_value;
+	}
+
+	// The member lists are matched case insensitively, so make sure the
+	// archive really has the member under this name
+	MemberIndex::const_iterator listed = _memberIndex.find(name);
+	if (listed != _memberIndex.end()) {
+		++_stats.archiveProbes;
+		if (listed->_value->_arc->hasFile(name)) {
+			++_stats.indexHits;
+			_lookupCache[name] = listed->_value;
+			return listed->_value;
+		}
+	}
+
+	const Node *node = nullptr;
+	ArchiveNodeList::const_iterator it = _list.begin();
+	for (; it != _list.end(); ++it) {
+		++_stats.archiveProbes;
+		if (it->_arc->hasFile(name)) {
+			node = &*it;
+			break;
+		}
+	}
+
+	_lookupCache[name] = node;
+	return node;
+}
+
 bool SearchSet::hasFile(const String &name) const {
 	if (name.empty())
 		return false;
 
+	++_stats.lookups;
+	if (_indexEnabled)
+		return findArchive(name) != nullptr;
+
 	ArchiveNodeList::const_iterator it = _list.begin();
 	for (; it != _list.end(); ++it) {
+		++_stats.archiveProbes;
 		if (it->_arc->hasFile(name))
 			return true;
 	}
@@ -242,8 +329,15 @@ const ArchiveMemberPtr SearchSet::getMember(const String &name) const {
 	if (name.empty())
 		return ArchiveMemberPtr();
 
+	++_stats.lookups;
+	if (_indexEnabled) {
+		const Node *node = findArchive(name);
+		return node ? node->_arc->getMember(name) : ArchiveMemberPtr();
+	}
+
 	ArchiveNodeList::const_iterator it = _list.begin();
 	for (; it != _list.end(); ++it) {
+		++_stats.archiveProbes;
 		if (it->_arc->hasFile(name))
 			return it->_arc->getMember(name);
 	}
@@ -255,8 +349,23 @@ SeekableReadStream *SearchSet::createReadStreamForMember(const String &name) con
 	if (name.empty())
 		return nullptr;
 
+	++_stats.lookups;
+	if (_indexEnabled) {
+		const Node *node = findArchive(name);
+		if (!node)
+			return nullptr;
+
+		SeekableReadStream *stream = node->_arc->createReadStreamForMember(name);
+		if (stream)
+			return stream;
+
+		// The member exists but could not be opened, try the other
+		// archives like a plain lookup would
+	}
+
 	ArchiveNodeList::const_iterator it = _list.begin();
 	for (; it != _list.end(); ++it) {
+		++_stats.archiveProbes;
 		SeekableReadStream *stream = it->_arc->createReadStreamForMember(name);
 		if (stream)
 			return stream;
@@ -24,6 +24,8 @@
 #define COMMON_ARCHIVE_H
 
 #include "common/str.h"
+#include "common/hash-str.h"
+#include "common/hashmap.h"
 #include "common/list.h"
 #include "common/ptr.h"
 #include "common/singleton.h"
@@ -132,8 +134,29 @@ public:
  * contained Archives, hence the simplistic policy of always looking for the first
  * match. SearchSet *DOES* guarantee that searches are performed in *DESCENDING*
  * priority order. In case of conflicting priorities, insertion order prevails.
+ *
+ * Lookups normally ask every archive in turn. With the index enabled, names
+ * are resolved to the archive serving them through a hash lookup instead. See
+ * enableIndex() for the requirements on the archives.
  */
 class SearchSet : public Archive {
+public:
+	/**
+	 * Counters for the lookups through hasFile(), getMember() and
+	 * createReadStreamForMember().
+	 */
+	struct LookupStats {
+		/** Lookups of non-empty names */
+		uint32 lookups;
+		/** Lookups resolved through the index */
+		uint32 indexHits;
+		/** Archives asked whether they have a member */
+		uint32 archiveProbes;
+		/** Times the index was built from the member lists */
+		uint32 indexBuilds;
+	};
+
+private:
 	struct Node {
 		int		_priority;
 		String	_name;
@@ -152,7 +175,24 @@ class SearchSet : public Archive {
 	// Add an archive keeping the list sorted by descending priority.
 	void insert(const Node& node);
 
+	// Member names as listed by the archives, mapped to the first archive
+	// listing them.
+	typedef HashMap<String, const Node *, IgnoreCase_Hash, IgnoreCase_EqualTo> MemberIndex;
+	// Exact names already looked up, mapped to the archive serving them, or
+	// to 0 if none does.
+	typedef HashMap<String, const Node *> LookupCache;
+
+	bool _indexEnabled;
+	mutable bool _indexValid;
+	mutable MemberIndex _memberIndex;
+	mutable LookupCache _lookupCache;
+	mutable LookupStats _stats;
+
+	void buildIndex() const;
+	const Node *findArchive(const String &name) const;
+
 public:
+	SearchSet();
 	virtual ~SearchSet() { clear(); }
 
 	/**
@@ -236,6 +276,31 @@ public:
 	 */
 	void setPriority(const String& name, int priority);
 
+	/**
+	 * Enable or disable the name index. The index is built from the member
+	 * lists of the archives on the first lookup after an archive has been
+	 * added or removed, or after a priority change. Names no archive lists,
+	 * such as paths into sub directories of an FSDirectory, are resolved by
+	 * asking the archives once and remembered afterwards, whether they were
+	 * found or not.
+	 *
+	 * This requires the contents of the archives to stay the same while the
+	 * index is in use, and archives to list their members under the names
+	 * they are looked up with. Call invalidateIndex() when an archive
+	 * changes anyway, for example a SearchSet which has been added to this
+	 * one. The index is disabled by default.
+	 */
+	void enableIndex(bool enable);
+	bool isIndexEnabled() const { return _indexEnabled; }
+
+	/**
+	 * Discard the index, it will be rebuilt on the next lookup.
+	 */
+	void invalidateIndex();
+
+	const LookupStats &getLookupStats() const { return _stats; }
+	void resetLookupStats();
+
 	virtual bool hasFile(const String &name) const;
 	virtual int listMatchingMembers(ArchiveMemberList &list, const String &pattern) const;
 	virtual int listMembers(ArchiveMemberList &list) const;
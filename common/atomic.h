@@ -0,0 +1,100 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef COMMON_ATOMIC_H
+#define COMMON_ATOMIC_H
+
+#include "common/scummsys.h"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace Common {
+
+/**
+ * @defgroup common_atomic Atomic operations
+ * @ingroup common
+ *
+ * Sequentially consistent operations on 32 bit words which are shared
+ * between threads without a mutex, e.g. with the audio thread, which must
+ * never wait for another thread.
+ *
+ * On compilers without atomic builtins, these are plain volatile accesses.
+ * That is only good enough for targets which run all threads on one core.
+ * @{
+ */
+
+inline uint32 atomicLoad(const volatile uint32 *value) {
+#if defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 7))
+	return __atomic_load_n(value, __ATOMIC_SEQ_CST);
+#elif defined(__GNUC__)
+	__sync_synchronize();
+	const uint32 result = *value;
+	__sync_synchronize();
+	return result;
+#elif defined(_MSC_VER)
+	return (uint32)_InterlockedCompareExchange((volatile long *)value, 0, 0);
+#else
+	return *value;
+#endif
+}
+
+inline void atomicStore(volatile uint32 *value, uint32 newValue) {
+#if defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 7))
+	__atomic_store_n(value, newValue, __ATOMIC_SEQ_CST);
+#elif defined(__GNUC__)
+	__sync_synchronize();
+	*value = newValue;
+	__sync_synchronize();
+#elif defined(_MSC_VER)
+	_InterlockedExchange((volatile long *)value, (long)newValue);
+#else
+	*value = newValue;
+#endif
+}
+
+/**
+ * Set value to newValue if it is expected.
+ *
+ * @return whether value was changed
+ */
+inline bool atomicCompareAndSwap(volatile uint32 *value, uint32 expected, uint32 newValue) {
+#if defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 7))
+	return __atomic_compare_exchange_n(value, &expected, newValue, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+#elif defined(__GNUC__)
+	return __sync_bool_compare_and_swap(value, expected, newValue);
+#elif defined(_MSC_VER)
+	return (uint32)_InterlockedCompareExchange((volatile long *)value, (long)newValue, (long)expected) == expected;
+#else
+	if (*value != expected)
+		return false;
+	*value = newValue;
+	return true;
+#endif
+}
+
+/** @} */
+
+} // End of namespace Common
+
+#endif
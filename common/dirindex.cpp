@@ -0,0 +1,80 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "common/dirindex.h"
+
+namespace Common {
+
+DirectoryIndex *DirectoryIndex::_active = nullptr;
+
+DirectoryIndex::DirectoryIndex(uint maxDirectories)
+	: PersistentLRUStore<DirectoryIndexListing>(MKTAG('S', 'D', 'I', 'X'), 3, maxDirectories) {
+}
+
+String DirectoryIndex::makeKey(const String &path, bool hidden) {
+	return (hidden ? "+" : "-") + path;
+}
+
+const DirectoryIndex::EntryList *DirectoryIndex::find(const String &path, bool hidden, uint32 stamp) {
+	Item *item = lookUp(makeKey(path, hidden));
+	if (!item || item->value.stamp != stamp) {
+		miss();
+		return nullptr;
+	}
+
+	return &hit(*item).entries;
+}
+
+void DirectoryIndex::store(const String &path, bool hidden, uint32 stamp, const EntryList &entries) {
+	DirectoryIndexListing listing;
+	listing.stamp = stamp;
+	listing.entries = entries;
+	insert(makeKey(path, hidden), listing);
+}
+
+void DirectoryIndex::writeValue(WriteStream &stream, const DirectoryIndexListing &listing) const {
+	stream.writeUint32LE(listing.stamp);
+	stream.writeUint32LE(listing.entries.size());
+
+	for (EntryList::const_iterator entry = listing.entries.begin(); entry != listing.entries.end(); ++entry) {
+		writeString(stream, entry->name);
+		stream.writeByte(entry->isDirectory ? 1 : 0);
+	}
+}
+
+bool DirectoryIndex::readValue(SeekableReadStream &stream, DirectoryIndexListing &listing) const {
+	listing.stamp = stream.readUint32LE();
+	const uint32 entries = stream.readUint32LE();
+	if (stream.eos() || entries > kMaxCount)
+		return false;
+
+	listing.entries.resize(entries);
+	for (uint32 i = 0; i < entries; ++i) {
+		if (!readString(stream, listing.entries[i].name))
+			return false;
+		listing.entries[i].isDirectory = stream.readByte() != 0;
+	}
+
+	return true;
+}
+
+} // End of namespace Common
@@ -0,0 +1,104 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef COMMON_DIRINDEX_H
+#define COMMON_DIRINDEX_H
+
+#include "common/array.h"
+#include "common/lrustore.h"
+#include "common/str.h"
+
+namespace Common {
+
+/** An entry of a directory listing stored in a DirectoryIndex. */
+struct DirectoryIndexEntry {
+	String name;
+	bool isDirectory;
+};
+
+/** A directory listing stored in a DirectoryIndex. */
+struct DirectoryIndexListing {
+	uint32 stamp;
+	Array<DirectoryIndexEntry> entries;
+};
+
+/**
+ * Persistent index of directory listings.
+ *
+ * Listing the directories of a game can take seconds on slow file systems
+ * like network shares. While an index is active, FSNode::getChildren()
+ * stores the listings it gets from the backend in it, together with a
+ * stamp of the directory, usually its modification time. Later listings of
+ * an unchanged directory are served from the index, which only costs a
+ * check of the stamp. Saving the index and loading it on the next start
+ * makes this work across runs.
+ *
+ * Only directories for which the backend provides a stamp are indexed, see
+ * AbstractFSNode::getDirectoryStamp().
+ */
+class DirectoryIndex : public PersistentLRUStore<DirectoryIndexListing> {
+public:
+	typedef DirectoryIndexEntry Entry;
+	typedef Array<Entry> EntryList;
+
+	/**
+	 * @param maxDirectories  the number of directories kept; when more are
+	 *                        stored, the least recently used ones are
+	 *                        dropped
+	 */
+	DirectoryIndex(uint maxDirectories = 16384);
+
+	/**
+	 * Look up the listing of a directory.
+	 *
+	 * @param path    the path of the directory
+	 * @param hidden  whether the listing includes hidden entries
+	 * @param stamp   the current stamp of the directory
+	 * @return the stored listing, or 0 if there is none for this stamp
+	 */
+	const EntryList *find(const String &path, bool hidden, uint32 stamp);
+
+	/**
+	 * Store the listing of a directory, replacing any older one.
+	 */
+	void store(const String &path, bool hidden, uint32 stamp, const EntryList &entries);
+
+	/**
+	 * Set the index used by FSNode::getChildren(), or 0 to not use any.
+	 * The caller keeps ownership.
+	 */
+	static void setActive(DirectoryIndex *index) { _active = index; }
+	static DirectoryIndex *getActive() { return _active; }
+
+protected:
+	void writeValue(WriteStream &stream, const DirectoryIndexListing &listing) const;
+	bool readValue(SeekableReadStream &stream, DirectoryIndexListing &listing) const;
+
+private:
+	static String makeKey(const String &path, bool hidden);
+
+	static DirectoryIndex *_active;
+};
+
+} // End of namespace Common
+
+#endif
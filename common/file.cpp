@@ -143,6 +143,11 @@ uint32 File::read(void *ptr, uint32 len) {
 	return _handle->read(ptr, len);
 }
 
+const byte *File::getDirectData(uint32 offset, uint32 size) const {
+	assert(_handle);
+	return _handle->getDirectData(offset, size);
+}
+
 
 DumpFile::DumpFile() : _handle(nullptr) {
 }
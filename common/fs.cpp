@@ -20,6 +20,7 @@
  *
  */
 
+#include "common/dirindex.h"
 #include "common/system.h"
 #include "common/textconsole.h"
 #include "backends/fs/abstract-fs.h"
@@ -73,6 +74,11 @@ bool FSNode::getChildren(FSList &fslist, ListMode mode, bool hidden) const {
 	if (!_realNode || !_realNode->isDirectory())
 		return false;
 
+	DirectoryIndex *index = DirectoryIndex::getActive();
+	uint32 stamp;
+	if (index && _realNode->getDirectoryStamp(stamp))
+		return getIndexedChildren(*index, stamp, fslist, mode, hidden);
+
 	AbstractFSList tmp;
 
 	if (!_realNode->getChildren(tmp, mode, hidden))
@@ -86,6 +92,47 @@ bool FSNode::getChildren(FSList &fslist, ListMode mode, bool hidden) const {
 	return true;
 }
 
+bool FSNode::getIndexedChildren(DirectoryIndex &index, uint32 stamp, FSList &fslist, ListMode mode, bool hidden) const {
+	const String path = _realNode->getPath();
+	const DirectoryIndex::EntryList *indexed = index.find(path, hidden, stamp);
+
+	if (indexed) {
+		fslist.clear();
+		for (DirectoryIndex::EntryList::const_iterator i = indexed->begin(); i != indexed->end(); ++i) {
+			if ((mode == kListFilesOnly && i->isDirectory) || (mode == kListDirectoriesOnly && !i->isDirectory))
+				continue;
+			fslist.push_back(FSNode(_realNode->getListedChild(i->name, i->isDirectory)));
+		}
+
+		return true;
+	}
+
+	// Store the complete listing, so it serves all modes
+	AbstractFSList tmp;
+	if (!_realNode->getChildren(tmp, kListAll, hidden))
+		return false;
+
+	DirectoryIndex::EntryList entries;
+	entries.resize(tmp.size());
+	fslist.clear();
+	for (uint i = 0; i < tmp.size(); ++i) {
+		entries[i].name = tmp[i]->getName();
+		entries[i].isDirectory = tmp[i]->isDirectory();
+
+		if ((mode == kListFilesOnly && entries[i].isDirectory) || (mode == kListDirectoriesOnly && !entries[i].isDirectory))
+			delete tmp[i];
+		else
+			fslist.push_back(FSNode(tmp[i]));
+	}
+
+	index.store(path, hidden, stamp, entries);
+	return true;
+}
+
+bool FSNode::getFileStamp(uint32 &size, uint32 &stamp) const {
+	return _realNode && _realNode->getFileStamp(size, stamp);
+}
+
 String FSNode::getDisplayName() const {
 	assert(_realNode);
 	return _realNode->getDisplayName();
@@ -34,6 +34,7 @@ class AbstractFSNode;
 
 namespace Common {
 
+class DirectoryIndex;
 class FSNode;
 class SeekableReadStream;
 class WriteStream;
@@ -230,6 +231,23 @@ public:
 	 * @return pointer to the stream object, 0 in case of a failure
 	 */
 	WriteStream *createWriteStream() const;
+
+	/**
+	 * Returns the size and a stamp of the file referred by this node, which
+	 * changes whenever the contents of the file change. Data computed from
+	 * the file can be reused as long as both stay the same.
+	 *
+	 * @return false if the node does not refer to a file, or if the backend
+	 *         cannot provide a reliable stamp for it
+	 */
+	bool getFileStamp(uint32 &size, uint32 &stamp) const;
+
+private:
+	/**
+	 * Lists the children through the given directory index, asking the
+	 * backend only if the directory has changed since it was stored.
+	 */
+	bool getIndexedChildren(DirectoryIndex &index, uint32 stamp, FSList &fslist, ListMode mode, bool hidden) const;
 };
 
 /**
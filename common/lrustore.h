@@ -0,0 +1,275 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef COMMON_LRUSTORE_H
+#define COMMON_LRUSTORE_H
+
+#include "common/algorithm.h"
+#include "common/array.h"
+#include "common/hashmap.h"
+#include "common/hash-str.h"
+#include "common/stream.h"
+#include "common/str.h"
+
+namespace Common {
+
+/**
+ * Base class of caches which are kept across runs, like DirectoryIndex and
+ * MD5Cache. Values are stored under string keys. When more values than the
+ * limit are stored, the least recently used ones are dropped.
+ *
+ * Subclasses provide the lookups, which decide whether a stored value is
+ * still valid, and the saving and loading of the values.
+ */
+template<class Value>
+class PersistentLRUStore {
+public:
+	virtual ~PersistentLRUStore() {}
+
+	/**
+	 * Replace the contents of the store with the one saved in the stream.
+	 *
+	 * @return false if the stream does not contain a valid store, which
+	 *         leaves the store empty
+	 */
+	bool loadFromStream(SeekableReadStream &stream);
+
+	/**
+	 * Save the store, including the values loaded from an earlier save.
+	 */
+	bool saveToStream(WriteStream &stream);
+
+	void clear() {
+		_items.clear();
+		_modified = true;
+	}
+
+	/** Whether the store changed since it was loaded or saved. */
+	bool isModified() const { return _modified; }
+
+	uint32 getSize() const { return _items.size(); }
+
+	/** The number of lookups which found a valid value. */
+	uint32 getHits() const { return _hits; }
+
+	/** The number of lookups which found none. */
+	uint32 getMisses() const { return _misses; }
+
+protected:
+	struct Item {
+		/** The value of _useCount when the value was used last */
+		uint32 lastUse;
+		Value value;
+	};
+
+	/**
+	 * @param tag       identifies the saved data
+	 * @param version   the version of the saved data
+	 * @param maxItems  the number of values kept
+	 */
+	PersistentLRUStore(uint32 tag, uint32 version, uint maxItems)
+		: _tag(tag), _version(version), _maxItems(maxItems), _useCount(0), _modified(false), _hits(0), _misses(0) {}
+
+	/**
+	 * Look up the item stored under the key. The caller checks whether its
+	 * value is still valid and counts the lookup with hit() or miss().
+	 */
+	Item *lookUp(const String &key) {
+		typename ItemMap::iterator i = _items.find(key);
+		return (i != _items.end()) ? &i->_value : nullptr;
+	}
+
+	/** Count a lookup of a valid value and mark the value as used. */
+	const Value &hit(Item &item) {
+		item.lastUse = ++_useCount;
+		_modified = true;
+		++_hits;
+		return item.value;
+	}
+
+	/** Count a lookup which found no valid value. */
+	void miss() { ++_misses; }
+
+	/** Store a value, replacing any older one under the same key. */
+	void insert(const String &key, const Value &value);
+
+	/**
+	 * Save a value. The data is only read back by readValue() of the same
+	 * version of the store.
+	 */
+	virtual void writeValue(WriteStream &stream, const Value &value) const = 0;
+
+	/**
+	 * Load a value saved by writeValue().
+	 *
+	 * @return false if the data is damaged
+	 */
+	virtual bool readValue(SeekableReadStream &stream, Value &value) const = 0;
+
+	static void writeString(WriteStream &stream, const String &str);
+	static bool readString(SeekableReadStream &stream, String &str);
+
+	// Limits for rejecting damaged data before allocating anything
+	enum {
+		kMaxStringLength = 4096,
+		kMaxCount = 1 << 20
+	};
+
+private:
+	typedef HashMap<String, Item> ItemMap;
+
+	void dropLeastRecentlyUsed(uint keep);
+
+	const uint32 _tag;
+	const uint32 _version;
+	const uint _maxItems;
+	ItemMap _items;
+	/** Counts every use of a value, for the least recently used order */
+	uint32 _useCount;
+	bool _modified;
+	uint32 _hits;
+	uint32 _misses;
+};
+
+template<class Value>
+void PersistentLRUStore<Value>::insert(const String &key, const Value &value) {
+	if (!_items.contains(key) && _items.size() >= _maxItems) {
+		if (_maxItems == 0)
+			return;
+
+		// Make room for a few more at once, so that storing stays cheap
+		dropLeastRecentlyUsed(_maxItems - MAX<uint>(_maxItems / 8, 1));
+	}
+
+	Item &item = _items[key];
+	item.lastUse = ++_useCount;
+	item.value = value;
+	_modified = true;
+}
+
+template<class Value>
+void PersistentLRUStore<Value>::dropLeastRecentlyUsed(uint keep) {
+	if (_items.size() <= keep)
+		return;
+
+	_modified = true;
+	if (keep == 0) {
+		_items.clear();
+		return;
+	}
+
+	// Every use has a number of its own, so this keeps exactly the given
+	// number of values
+	Array<uint32> lastUses;
+	lastUses.reserve(_items.size());
+	for (typename ItemMap::const_iterator i = _items.begin(); i != _items.end(); ++i)
+		lastUses.push_back(i->_value.lastUse);
+	sort(lastUses.begin(), lastUses.end());
+	const uint32 oldestKept = lastUses[lastUses.size() - keep];
+
+	for (typename ItemMap::iterator i = _items.begin(); i != _items.end(); ++i) {
+		if (i->_value.lastUse < oldestKept)
+			_items.erase(i);
+	}
+}
+
+template<class Value>
+bool PersistentLRUStore<Value>::loadFromStream(SeekableReadStream &stream) {
+	_items.clear();
+	_modified = false;
+	_useCount = 0;
+
+	if (stream.readUint32BE() != _tag || stream.readUint32LE() != _version)
+		return false;
+
+	_useCount = stream.readUint32LE();
+	const uint32 count = stream.readUint32LE();
+	if (stream.eos() || count > kMaxCount)
+		return false;
+
+	for (uint32 i = 0; i < count; ++i) {
+		String key;
+		Item item;
+		if (!readString(stream, key))
+			break;
+
+		item.lastUse = stream.readUint32LE();
+		if (!readValue(stream, item.value) || stream.eos() || stream.err())
+			break;
+
+		_items[key] = item;
+	}
+
+	if (_items.size() != count) {
+		_items.clear();
+		_useCount = 0;
+		return false;
+	}
+
+	// The store may have been saved with a higher limit
+	dropLeastRecentlyUsed(_maxItems);
+	return true;
+}
+
+template<class Value>
+bool PersistentLRUStore<Value>::saveToStream(WriteStream &stream) {
+	stream.writeUint32BE(_tag);
+	stream.writeUint32LE(_version);
+	stream.writeUint32LE(_useCount);
+	stream.writeUint32LE(_items.size());
+
+	for (typename ItemMap::const_iterator i = _items.begin(); i != _items.end(); ++i) {
+		writeString(stream, i->_key);
+		stream.writeUint32LE(i->_value.lastUse);
+		writeValue(stream, i->_value.value);
+	}
+
+	if (!stream.flush() || stream.err())
+		return false;
+
+	_modified = false;
+	return true;
+}
+
+template<class Value>
+void PersistentLRUStore<Value>::writeString(WriteStream &stream, const String &str) {
+	stream.writeUint32LE(str.size());
+	stream.write(str.c_str(), str.size());
+}
+
+template<class Value>
+bool PersistentLRUStore<Value>::readString(SeekableReadStream &stream, String &str) {
+	const uint32 length = stream.readUint32LE();
+	if (stream.eos() || length > kMaxStringLength)
+		return false;
+
+	char buffer[kMaxStringLength];
+	if (stream.read(buffer, length) != length)
+		return false;
+
+	str = String(buffer, length);
+	return true;
+}
+
+} // End of namespace Common
+
+#endif
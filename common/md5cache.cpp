@@ -0,0 +1,136 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "common/md5cache.h"
+#include "common/md5.h"
+#include "common/system.h"
+
+namespace Common {
+
+MD5Cache *MD5Cache::_active = nullptr;
+
+MD5Cache::MD5Cache(uint maxEntries)
+	: PersistentLRUStore<MD5CacheEntry>(MKTAG('S', 'M', 'D', '5'), 2, maxEntries) {
+}
+
+String MD5Cache::makeKey(const String &path, uint32 length) {
+	return String::format("%u:", length) + path;
+}
+
+const String *MD5Cache::find(const String &path, uint32 length, uint32 size, uint32 stamp) {
+	Item *item = lookUp(makeKey(path, length));
+	if (!item || item->value.size != size || item->value.stamp != stamp) {
+		miss();
+		return nullptr;
+	}
+
+	return &hit(*item).md5;
+}
+
+void MD5Cache::store(const String &path, uint32 length, uint32 size, uint32 stamp, const String &md5) {
+	MD5CacheEntry entry;
+	entry.size = size;
+	entry.stamp = stamp;
+	entry.md5 = md5;
+	insert(makeKey(path, length), entry);
+}
+
+void MD5Cache::writeValue(WriteStream &stream, const MD5CacheEntry &entry) const {
+	stream.writeUint32LE(entry.size);
+	stream.writeUint32LE(entry.stamp);
+	writeString(stream, entry.md5);
+}
+
+bool MD5Cache::readValue(SeekableReadStream &stream, MD5CacheEntry &entry) const {
+	entry.size = stream.readUint32LE();
+	entry.stamp = stream.readUint32LE();
+	return readString(stream, entry.md5);
+}
+
+namespace {
+
+struct MD5Job {
+	FileMD5 *file;
+	bool cacheable;
+	uint32 size;
+	uint32 stamp;
+};
+
+struct MD5Jobs {
+	Array<MD5Job> jobs;
+	uint32 length;
+};
+
+// Runs on any thread, so it must not copy the nodes, which share their
+// backend node through a SharedPtr
+void computeFileMD5Job(void *param, uint index) {
+	MD5Jobs *jobs = (MD5Jobs *)param;
+	FileMD5 &file = *jobs->jobs[index].file;
+
+	SeekableReadStream *stream = file.node.createReadStream();
+	if (!stream) {
+		file.size = -1;
+		return;
+	}
+
+	file.size = stream->size();
+	file.md5 = computeStreamMD5AsString(*stream, jobs->length);
+	delete stream;
+}
+
+} // End of anonymous namespace
+
+void computeFileMD5s(Array<FileMD5> &files, uint32 length) {
+	MD5Cache *cache = MD5Cache::getActive();
+
+	MD5Jobs jobs;
+	jobs.length = length;
+	for (uint i = 0; i < files.size(); ++i) {
+		MD5Job job;
+		job.file = &files[i];
+		job.cacheable = cache && job.file->node.getFileStamp(job.size, job.stamp);
+
+		if (job.cacheable) {
+			const String *md5 = cache->find(job.file->node.getPath(), length, job.size, job.stamp);
+			if (md5) {
+				job.file->size = (int32)job.size;
+				job.file->md5 = *md5;
+				continue;
+			}
+		}
+
+		jobs.jobs.push_back(job);
+	}
+
+	if (!jobs.jobs.empty())
+		g_system->runParallelJobs(computeFileMD5Job, &jobs, jobs.jobs.size());
+
+	// The cache is only used on this thread. Files which changed size
+	// while being read are not stored.
+	for (uint i = 0; i < jobs.jobs.size(); ++i) {
+		const MD5Job &job = jobs.jobs[i];
+		if (job.cacheable && job.file->size >= 0 && (uint32)job.file->size == job.size && !job.file->md5.empty())
+			cache->store(job.file->node.getPath(), length, job.size, job.stamp, job.file->md5);
+	}
+}
+
+} // End of namespace Common
@@ -0,0 +1,121 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef COMMON_MD5CACHE_H
+#define COMMON_MD5CACHE_H
+
+#include "common/array.h"
+#include "common/fs.h"
+#include "common/lrustore.h"
+#include "common/str.h"
+
+namespace Common {
+
+/** A checksum stored in an MD5Cache. */
+struct MD5CacheEntry {
+	uint32 size;
+	uint32 stamp;
+	String md5;
+};
+
+/**
+ * Persistent cache of file MD5 checksums.
+ *
+ * Game detection computes the MD5 of the start of every candidate file, and
+ * every engine does so again for the files it looks at. While a cache is
+ * active, the checksums are stored in it together with the size and a stamp
+ * of the file, usually its modification time, and are reused for as long as
+ * both stay the same. Saving the cache and loading it on the next start
+ * makes this work across runs.
+ *
+ * Only files for which the backend provides a stamp are cached, see
+ * FSNode::getFileStamp().
+ */
+class MD5Cache : public PersistentLRUStore<MD5CacheEntry> {
+public:
+	/**
+	 * @param maxEntries  the number of checksums kept; when more are
+	 *                    stored, the least recently used ones are dropped
+	 */
+	MD5Cache(uint maxEntries = 65536);
+
+	/**
+	 * Look up the checksum of a file.
+	 *
+	 * @param path    the path of the file
+	 * @param length  the number of bytes the checksum covers, 0 for all
+	 * @param size    the current size of the file
+	 * @param stamp   the current stamp of the file
+	 * @return the stored checksum, or 0 if there is none for this file
+	 */
+	const String *find(const String &path, uint32 length, uint32 size, uint32 stamp);
+
+	/**
+	 * Store the checksum of a file, replacing any older one.
+	 */
+	void store(const String &path, uint32 length, uint32 size, uint32 stamp, const String &md5);
+
+	/**
+	 * Set the cache used by the game detection, or 0 to not use any.
+	 * The caller keeps ownership.
+	 */
+	static void setActive(MD5Cache *cache) { _active = cache; }
+	static MD5Cache *getActive() { return _active; }
+
+protected:
+	void writeValue(WriteStream &stream, const MD5CacheEntry &entry) const;
+	bool readValue(SeekableReadStream &stream, MD5CacheEntry &entry) const;
+
+private:
+	static String makeKey(const String &path, uint32 length);
+
+	static MD5Cache *_active;
+};
+
+/** A file for computeFileMD5s(). */
+struct FileMD5 {
+	/** The file. */
+	FSNode node;
+
+	/** Set to the size of the file, or -1 if it could not be read. */
+	int32 size;
+
+	/** Set to the checksum. */
+	String md5;
+
+	FileMD5() : size(-1) {}
+};
+
+/**
+ * Compute the checksums of the start of several files. The checksums are
+ * taken from the active MD5Cache where possible. The other files are read
+ * in parallel, see OSystem::runParallelJobs(), and their checksums are
+ * stored in the cache.
+ *
+ * @param files   the files
+ * @param length  the number of bytes the checksums cover, 0 for all
+ */
+void computeFileMD5s(Array<FileMD5> &files, uint32 length);
+
+} // End of namespace Common
+
+#endif
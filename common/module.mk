@@ -6,6 +6,7 @@ MODULE_OBJS := \
 	coroutines.o \
 	dcl.o \
 	debug.o \
+	dirindex.o \
 	error.o \
 	EventDispatcher.o \
 	EventMapper.o \
@@ -22,6 +23,7 @@ MODULE_OBJS := \
 	macresman.o \
 	memorypool.o \
 	md5.o \
+	md5cache.o \
 	mutex.o \
 	osd_message_queue.o \
 	platform.o \
@@ -0,0 +1,71 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef COMMON_SIMD_H
+#define COMMON_SIMD_H
+
+#include "common/scummsys.h"
+
+/**
+ * @file
+ * The vector instruction sets the SIMD kernels can be built for.
+ *
+ * SCUMMVM_SIMD_X86 is defined when the compiler can build SSE2 and AVX2
+ * functions with SIMD_TARGET, whatever the baseline of the build is. Those
+ * may only be called after checking the CPU with hasSSE2() or hasAVX2().
+ *
+ * SCUMMVM_SIMD_NEON is defined when the build targets NEON, which every
+ * CPU running the binary then supports.
+ */
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#if (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9)) || defined(__clang__)
+#define SCUMMVM_SIMD_X86
+#include <immintrin.h>
+#define SIMD_TARGET(x) __attribute__((target(x)))
+#endif
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define SCUMMVM_SIMD_NEON
+#include <arm_neon.h>
+#endif
+
+namespace Common {
+
+#ifdef SCUMMVM_SIMD_X86
+
+/** Whether the CPU running ScummVM supports SSE2. */
+inline bool hasSSE2() {
+	return __builtin_cpu_supports("sse2");
+}
+
+/** Whether the CPU running ScummVM supports AVX2. */
+inline bool hasAVX2() {
+	return __builtin_cpu_supports("avx2");
+}
+
+#endif
+
+} // End of namespace Common
+
+#endif
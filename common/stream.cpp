@@ -261,6 +261,13 @@ bool SeekableSubReadStream::seek(int32 offset, int whence) {
 	return ret;
 }
 
+const byte *SeekableSubReadStream::getDirectData(uint32 offset, uint32 size) const {
+	if (offset > _end - _begin || size > _end - _begin - offset)
+		return nullptr;
+
+	return _parentStream->getDirectData(_begin + offset, size);
+}
+
 uint32 SafeSeekableSubReadStream::read(void *dataPtr, uint32 dataSize) {
 	// Make sure the parent stream is at the right position
 	seek(0, SEEK_CUR);
@@ -511,6 +511,23 @@ public:
 	 */
 	virtual bool skip(uint32 offset) { return seek(offset, SEEK_CUR); }
 
+	/**
+	 * Returns a pointer to a range of the stream data, so it can be parsed
+	 * in place instead of being copied with read(). Only streams which
+	 * keep their data in memory, like MemoryReadStream, or which can map
+	 * their file into memory support this. Files are mapped on the first
+	 * call, so only call this when the data is parsed in place. The
+	 * position of the stream is not changed.
+	 *
+	 * The data stays valid as long as the stream exists.
+	 *
+	 * @param offset	the start of the range, from the start of the stream
+	 * @param size	the size of the range in bytes
+	 * @return a pointer to the data, or 0 if the stream does not support
+	 *         this or the range exceeds the stream
+	 */
+	virtual const byte *getDirectData(uint32 offset, uint32 size) const { return nullptr; }
+
 	/**
 	 * Reads at most one less than the number of characters specified
 	 * by bufSize from the and stores them in the string buf. Reading
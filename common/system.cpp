@@ -156,6 +156,11 @@ void OSystem::fatalError() {
 	exit(1);
 }
 
+void OSystem::runParallelJobs(ParallelJobProc proc, void *param, uint count) {
+	for (uint i = 0; i < count; ++i)
+		proc(param, i);
+}
+
 FilesystemFactory *OSystem::getFilesystemFactory() {
 	assert(_fsFactory);
 	return _fsFactory;
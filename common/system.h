@@ -1187,6 +1187,31 @@ public:
 	//@}
 
 
+	/**
+	 * @name Parallel jobs
+	 * There is no threading API (see above), but some work, like computing
+	 * the checksums of many files during the game detection, is easily
+	 * split up into independent jobs. Backends with threads may run those
+	 * on several threads at once.
+	 */
+	//@{
+
+	/** A job run by runParallelJobs(), index is the number of the job. */
+	typedef void (*ParallelJobProc)(void *param, uint index);
+
+	/**
+	 * Run proc(param, index) for every index from 0 to count - 1, and
+	 * return once all jobs are done. The jobs may run on several threads
+	 * at once and in any order, so they must guard any state they share,
+	 * and must not use the OSystem other than for mutexes and log output.
+	 *
+	 * The default implementation runs the jobs one after the other.
+	 */
+	virtual void runParallelJobs(ParallelJobProc proc, void *param, uint count);
+
+	//@}
+
+
 
 	/** @name Sound */
 	//@{
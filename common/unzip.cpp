@@ -106,6 +106,8 @@ typedef struct {
 #include "common/fs.h"
 #include "common/unzip.h"
 #include "common/memstream.h"
+#include "common/mutex.h"
+#include "common/textconsole.h"
 
 #include "common/hashmap.h"
 #include "common/hash-str.h"
@@ -378,10 +380,58 @@ typedef struct {
 typedef Common::HashMap<Common::String, cached_file_in_zip, Common::IgnoreCase_Hash,
 	Common::IgnoreCase_EqualTo> ZipHash;
 
+namespace Common {
+
+/**
+ * The stream of a ZIP archive, shared between the archive and the member
+ * streams it has handed out. Member streams may be read and deleted on
+ * other threads, for example the audio thread, so the reference count and
+ * every access to the stream are guarded by a mutex.
+ */
+class ZipSharedStream {
+public:
+	explicit ZipSharedStream(SeekableReadStream *stream) : _stream(stream), _refCount(1) {}
+
+	void incRef() {
+		StackLock lock(_mutex);
+		++_refCount;
+	}
+
+	void decRef() {
+		_mutex.lock();
+		const bool last = (--_refCount == 0);
+		_mutex.unlock();
+
+		if (last)
+			delete this;
+	}
+
+	/** Reads from the given offset, for member streams. */
+	uint32 readAt(uint32 offset, void *dataPtr, uint32 dataSize) {
+		StackLock lock(_mutex);
+		if (!_stream->seek(offset, SEEK_SET))
+			return 0;
+		return _stream->read(dataPtr, dataSize);
+	}
+
+	/** The archive takes this while it uses the stream directly. */
+	Mutex &getMutex() { return _mutex; }
+
+private:
+	~ZipSharedStream() { delete _stream; }
+
+	SeekableReadStream *_stream;
+	Mutex _mutex;
+	uint _refCount;
+};
+
+} // End of namespace Common
+
 /* unz_s contain internal information about the zipfile
 */
 typedef struct {
 	Common::SeekableReadStream *_stream;				/* io structore of the zipfile */
+	Common::ZipSharedStream *_sharedStream; /* owns _stream, shared with the member streams */
 	unz_global_info gi;				/* public global information */
 	uLong byte_before_the_zipfile;	/* byte before the zipfile, (>0 for sfx)*/
 	uLong num_file;					/* number of the current file in the zipfile*/
@@ -544,6 +594,7 @@ unzFile unzOpen(Common::SeekableReadStream *stream) {
 	int err=UNZ_OK;
 
 	us->_stream = stream;
+	us->_sharedStream = new Common::ZipSharedStream(stream);
 
 	central_pos = unzlocal_SearchCentralDir(*us->_stream);
 	if (central_pos==0)
@@ -595,7 +646,7 @@ unzFile unzOpen(Common::SeekableReadStream *stream) {
 		err=UNZ_BADZIPFILE;
 
 	if (err != UNZ_OK) {
-		delete us->_stream;
+		us->_sharedStream->decRef();
 		delete us;
 		return nullptr;
 	}
@@ -644,7 +695,7 @@ int unzClose(unzFile file) {
 	if (s->pfile_in_zip_read != nullptr)
 		unzCloseCurrentFile(file);
 
-	delete s->_stream;
+	s->_sharedStream->decRef();
 	delete s;
 	return UNZ_OK;
 }
@@ -1419,6 +1470,340 @@ int unzGetGlobalComment(unzFile file, char *szComment, uLong uSizeBuf) {
 
 namespace Common {
 
+namespace {
+
+/**
+ * Members up to this size are inflated into memory at once when they are
+ * opened. Larger ones are read from the archive on demand.
+ */
+const uint32 kZipStreamingThreshold = 64 * 1024;
+
+/**
+ * A stored member, read straight from the archive. Keeps the archive
+ * stream alive, so it may outlive the ZipArchive.
+ */
+class ZipStoredReadStream : public SeekableReadStream {
+public:
+	ZipStoredReadStream(ZipSharedStream *archiveStream, uint32 dataOffset, uint32 size)
+		: _archiveStream(archiveStream), _dataOffset(dataOffset), _size(size), _pos(0), _err(false), _eos(false) {
+		_archiveStream->incRef();
+	}
+
+	~ZipStoredReadStream() { _archiveStream->decRef(); }
+
+	bool err() const { return _err; }
+	void clearErr() { _err = false; _eos = false; }
+
+	uint32 read(void *dataPtr, uint32 dataSize);
+	bool eos() const { return _eos; }
+	int32 pos() const { return _pos; }
+	int32 size() const { return _size; }
+	bool seek(int32 offset, int whence = SEEK_SET);
+
+private:
+	ZipSharedStream *_archiveStream;
+	const uint32 _dataOffset;
+	const uint32 _size;
+	uint32 _pos;
+	bool _err;
+	bool _eos;
+};
+
+uint32 ZipStoredReadStream::read(void *dataPtr, uint32 dataSize) {
+	if (dataSize > _size - _pos) {
+		dataSize = _size - _pos;
+		_eos = true;
+	}
+
+	const uint32 done = _archiveStream->readAt(_dataOffset + _pos, dataPtr, dataSize);
+	if (done != dataSize)
+		_err = true;
+
+	_pos += done;
+	return done;
+}
+
+bool ZipStoredReadStream::seek(int32 offset, int whence) {
+	int32 newPos = 0;
+	switch (whence) {
+	case SEEK_SET:
+		newPos = offset;
+		break;
+	case SEEK_CUR:
+		newPos = _pos + offset;
+		break;
+	case SEEK_END:
+		newPos = _size + offset;
+		break;
+	}
+
+	if (newPos < 0 || newPos > (int32)_size)
+		return false;
+
+	_pos = newPos;
+	_eos = false;
+	return true;
+}
+
+#ifdef USE_ZLIB
+
+/**
+ * A deflated member, inflated on demand.
+ *
+ * Every stream has its own inflate state and reads the archive stream at
+ * its own offset, so several members can be read at the same time, even
+ * on different threads.
+ *
+ * To seek backwards, the stream restarts from the closest checkpoint
+ * before the target. Checkpoints are copies of the inflate state, taken at
+ * regular intervals of the uncompressed data while reading. The interval
+ * is doubled whenever there are too many of them, which keeps the memory
+ * use bounded for large members.
+ */
+class ZipInflateReadStream : public SeekableReadStream {
+public:
+	ZipInflateReadStream(ZipSharedStream *archiveStream, uint32 dataOffset, uint32 compressedSize, uint32 uncompressedSize, uint32 crc);
+	~ZipInflateReadStream();
+
+	bool err() const { return _err; }
+	void clearErr() { _eos = false; }
+
+	uint32 read(void *dataPtr, uint32 dataSize);
+	bool eos() const { return _eos; }
+	int32 pos() const { return _stream.total_out; }
+	int32 size() const { return _uncompressedSize; }
+	bool seek(int32 offset, int whence = SEEK_SET);
+
+private:
+	enum {
+		kBufferSize = 16384,
+		kMaxCheckpoints = 16,
+		kFirstCheckpointInterval = 256 * 1024
+	};
+
+	void fillBuffer();
+	void addCheckpoint();
+	void updateNextCheckpoint();
+	bool restart(const z_stream *checkpoint);
+
+	ZipSharedStream *_archiveStream;
+	const uint32 _dataOffset;
+	const uint32 _compressedSize;
+	const uint32 _uncompressedSize;
+	const uint32 _expectedCrc;
+
+	z_stream _stream;
+	uint32 _inPos;    ///< Compressed bytes fetched from the archive
+	uLong _crc;
+	bool _checkCrc;   ///< Whether _crc covers all data read so far
+	bool _err;
+	bool _eos;
+
+	Array<z_stream *> _checkpoints;
+	uint32 _checkpointInterval;
+	uint32 _nextCheckpoint;
+
+	byte _buffer[kBufferSize];
+};
+
+ZipInflateReadStream::ZipInflateReadStream(ZipSharedStream *archiveStream, uint32 dataOffset, uint32 compressedSize, uint32 uncompressedSize, uint32 crc)
+	: _archiveStream(archiveStream), _dataOffset(dataOffset), _compressedSize(compressedSize),
+	  _uncompressedSize(uncompressedSize), _expectedCrc(crc), _stream(), _inPos(0), _crc(0),
+	  _checkCrc(true), _err(false), _eos(false), _checkpointInterval(kFirstCheckpointInterval) {
+
+	_archiveStream->incRef();
+
+	// There is no zlib header in ZIP files
+	_err = inflateInit2(&_stream, -MAX_WBITS) != Z_OK;
+	_stream.next_in = _buffer;
+	_stream.avail_in = 0;
+	updateNextCheckpoint();
+}
+
+ZipInflateReadStream::~ZipInflateReadStream() {
+	for (uint i = 0; i < _checkpoints.size(); ++i) {
+		inflateEnd(_checkpoints[i]);
+		delete _checkpoints[i];
+	}
+
+	inflateEnd(&_stream);
+	_archiveStream->decRef();
+}
+
+void ZipInflateReadStream::fillBuffer() {
+	const uint32 size = MIN<uint32>(kBufferSize, _compressedSize - _inPos);
+	if (size == 0)
+		return;
+
+	if (_archiveStream->readAt(_dataOffset + _inPos, _buffer, size) != size)
+		return;
+
+	_inPos += size;
+	_stream.next_in = _buffer;
+	_stream.avail_in = size;
+}
+
+uint32 ZipInflateReadStream::read(void *dataPtr, uint32 dataSize) {
+	if (_err)
+		return 0;
+
+	const uint32 left = _uncompressedSize - _stream.total_out;
+	if (dataSize > left) {
+		dataSize = left;
+		_eos = true;
+	}
+
+	_stream.next_out = (Bytef *)dataPtr;
+	uint32 remaining = dataSize;
+
+	while (remaining > 0) {
+		// inflate() may still have output pending when all the input is
+		// used up, so running out of input is only an error when it makes
+		// no progress anymore
+		if (_stream.avail_in == 0)
+			fillBuffer();
+
+		// Stop at the next checkpoint to take a copy of the state there
+		uint32 chunk = remaining;
+		if (_stream.total_out < _nextCheckpoint)
+			chunk = MIN<uint32>(chunk, _nextCheckpoint - _stream.total_out);
+
+		_stream.avail_out = chunk;
+		const int result = inflate(&_stream, Z_NO_FLUSH);
+		const uint32 produced = chunk - _stream.avail_out;
+		remaining -= produced;
+
+		if (_stream.total_out == _nextCheckpoint)
+			addCheckpoint();
+
+		if (result == Z_BUF_ERROR && produced == 0) {
+			warning("ZipInflateReadStream: Unexpected end of data");
+			_err = true;
+			break;
+		} else if (result == Z_STREAM_END && remaining > 0) {
+			warning("ZipInflateReadStream: Compressed data ends early");
+			_err = true;
+			break;
+		} else if (result != Z_OK && result != Z_STREAM_END && result != Z_BUF_ERROR) {
+			warning("ZipInflateReadStream: Error %d while inflating", result);
+			_err = true;
+			break;
+		}
+	}
+
+	const uint32 done = dataSize - remaining;
+	if (_checkCrc) {
+		_crc = crc32(_crc, (const Bytef *)dataPtr, done);
+
+		if (_stream.total_out == _uncompressedSize && _crc != _expectedCrc) {
+			warning("ZipInflateReadStream: CRC mismatch");
+			_err = true;
+		}
+	}
+
+	return done;
+}
+
+void ZipInflateReadStream::addCheckpoint() {
+	if (_checkpoints.size() >= kMaxCheckpoints) {
+		// Keep every second one, at twice the interval
+		for (uint i = 0; i < _checkpoints.size(); ++i) {
+			if ((i & 1) == 0) {
+				inflateEnd(_checkpoints[i]);
+				delete _checkpoints[i];
+			} else {
+				_checkpoints[i / 2] = _checkpoints[i];
+			}
+		}
+
+		_checkpoints.resize(_checkpoints.size() / 2);
+		_checkpointInterval *= 2;
+	} else {
+		z_stream *checkpoint = new z_stream();
+		if (inflateCopy(checkpoint, &_stream) == Z_OK) {
+			_checkpoints.push_back(checkpoint);
+		} else {
+			// Running low on memory, go on without this one
+			delete checkpoint;
+		}
+	}
+
+	updateNextCheckpoint();
+}
+
+void ZipInflateReadStream::updateNextCheckpoint() {
+	const uint64 next = (uint64)(_checkpoints.size() + 1) * _checkpointInterval;
+	_nextCheckpoint = (next < _uncompressedSize) ? (uint32)next : 0xFFFFFFFF;
+}
+
+bool ZipInflateReadStream::restart(const z_stream *checkpoint) {
+	if (checkpoint) {
+		inflateEnd(&_stream);
+		if (inflateCopy(&_stream, const_cast<z_stream *>(checkpoint)) != Z_OK) {
+			// The state is gone, but inflateEnd() is fine on a zeroed one
+			memset(&_stream, 0, sizeof(_stream));
+			return false;
+		}
+
+		// The data read before the checkpoint is not known anymore
+		_checkCrc = false;
+	} else {
+		if (inflateReset(&_stream) != Z_OK)
+			return false;
+
+		_crc = 0;
+		_checkCrc = true;
+	}
+
+	// The inflate state holds no pointers to the input, so everything up
+	// to total_in has been consumed
+	_inPos = _stream.total_in;
+	_stream.next_in = _buffer;
+	_stream.avail_in = 0;
+	return true;
+}
+
+bool ZipInflateReadStream::seek(int32 offset, int whence) {
+	int32 newPos = 0;
+	switch (whence) {
+	case SEEK_SET:
+		newPos = offset;
+		break;
+	case SEEK_CUR:
+		newPos = pos() + offset;
+		break;
+	case SEEK_END:
+		newPos = size() + offset;
+		break;
+	}
+
+	if (newPos < 0 || newPos > size())
+		return false;
+
+	// Find the closest checkpoint before the target
+	const z_stream *checkpoint = nullptr;
+	for (uint i = 0; i < _checkpoints.size() && _checkpoints[i]->total_out <= (uint32)newPos; ++i)
+		checkpoint = _checkpoints[i];
+
+	if ((uint32)newPos < _stream.total_out || (checkpoint && checkpoint->total_out > _stream.total_out)) {
+		_err = !restart(checkpoint);
+		if (_err)
+			return false;
+	}
+
+	// Inflate the rest of the way
+	byte skipBuffer[4096];
+	uint32 skip = newPos - _stream.total_out;
+	while (skip > 0 && !_err)
+		skip -= read(skipBuffer, MIN<uint32>(skip, sizeof(skipBuffer)));
+
+	_eos = false;
+	return !_err;
+}
+
+#endif // USE_ZLIB
+
+} // End of anonymous namespace
 
 class ZipArchive : public Archive {
 	unzFile _zipFile;
@@ -1433,6 +1818,9 @@ public:
 	virtual int listMembers(ArchiveMemberList &list) const;
 	virtual const ArchiveMemberPtr getMember(const String &name) const;
 	virtual SeekableReadStream *createReadStreamForMember(const String &name) const;
+
+private:
+	Mutex &getMutex() const { return ((const unz_s *)_zipFile)->_sharedStream->getMutex(); }
 };
 
 /*
@@ -1462,6 +1850,7 @@ ZipArchive::~ZipArchive() {
 }
 
 bool ZipArchive::hasFile(const String &name) const {
+	StackLock lock(getMutex());
 	return (unzLocateFile(_zipFile, name.c_str(), 2) == UNZ_OK);
 }
 
@@ -1486,6 +1875,9 @@ const ArchiveMemberPtr ZipArchive::getMember(const String &name) const {
 }
 
 SeekableReadStream *ZipArchive::createReadStreamForMember(const String &name) const {
+	// Member streams of this archive may be in use on other threads
+	StackLock lock(getMutex());
+
 	if (unzLocateFile(_zipFile, name.c_str(), 2) != UNZ_OK)
 		return nullptr;
 
@@ -1496,6 +1888,25 @@ SeekableReadStream *ZipArchive::createReadStreamForMember(const String &name) co
 	if (unzGetCurrentFileInfo(_zipFile, &fileInfo, nullptr, 0, nullptr, 0, nullptr, 0) != UNZ_OK)
 		return nullptr;
 
+	if (fileInfo.uncompressed_size > kZipStreamingThreshold) {
+		const unz_s *const archive = (const unz_s *)_zipFile;
+		const file_in_zip_read_info_s *const member = archive->pfile_in_zip_read;
+		const uint32 dataOffset = member->pos_in_zipfile + member->byte_before_the_zipfile;
+
+		SeekableReadStream *stream = nullptr;
+		if (member->compression_method == 0) {
+			stream = new ZipStoredReadStream(archive->_sharedStream, dataOffset, fileInfo.uncompressed_size);
+#ifdef USE_ZLIB
+		} else {
+			stream = new ZipInflateReadStream(archive->_sharedStream, dataOffset, fileInfo.compressed_size,
+			                                  fileInfo.uncompressed_size, fileInfo.crc);
+#endif
+		}
+
+		unzCloseCurrentFile(_zipFile);
+		return stream;
+	}
+
 	byte *buffer = (byte *)malloc(fileInfo.uncompressed_size);
 	assert(buffer);
 
@@ -1510,11 +1921,6 @@ SeekableReadStream *ZipArchive::createReadStreamForMember(const String &name) co
 	}
 
 	return new MemoryReadStream(buffer, fileInfo.uncompressed_size, DisposeAfterUse::YES);
-
-	// FIXME: instead of reading all into a memory stream, we could
-	// instead create a new ZipStream class. But then we have to be
-	// careful to handle the case where the client code opens multiple
-	// files in the archive and tries to use them independently.
 }
 
 Archive *makeZipArchive(const String &name) {
@@ -22,9 +22,8 @@
 
 #include "common/debug.h"
 #include "common/util.h"
-#include "common/file.h"
 #include "common/macresman.h"
-#include "common/md5.h"
+#include "common/md5cache.h"
 #include "common/config-manager.h"
 #include "common/system.h"
 #include "common/textconsole.h"
@@ -375,13 +374,17 @@ bool AdvancedMetaEngine::getFileProperties(const Common::FSNode &parent, const F
 	if (!allFiles.contains(fname))
 		return false;
 
-	Common::File testFile;
+	// Every engine looks at the same files when detecting, so share the
+	// checksums between them, and across runs if the cache gets saved
+	Common::Array<Common::FileMD5> files(1);
+	files[0].node = allFiles[fname];
+	Common::computeFileMD5s(files, _md5Bytes);
 
-	if (!testFile.open(allFiles[fname]))
+	if (files[0].size < 0)
 		return false;
 
-	fileProps.size = (int32)testFile.size();
-	fileProps.md5 = Common::computeStreamMD5AsString(testFile, _md5Bytes);
+	fileProps.size = files[0].size;
+	fileProps.md5 = files[0].md5;
 	return true;
 }
 
@@ -396,7 +399,11 @@ ADDetectedGames AdvancedMetaEngine::detectGame(const Common::FSNode &parent, con
 	debug(3, "Starting detection in dir '%s'", parent.getPath().c_str());
 
 	// Check which files are included in some ADGameDescription *and* are present.
-	// Compute MD5s and file sizes for these files.
+	// Compute MD5s and file sizes for these files. The plain files are all
+	// read at once, so they can be read in parallel.
+	Common::Array<Common::FileMD5> plainFiles;
+	Common::Array<Common::String> plainNames;
+	FilePropertiesMap listed;
 	for (descPtr = _gameDescriptors; ((const ADGameDescription *)descPtr)->gameId != nullptr; descPtr += _descItemSize) {
 		g = (const ADGameDescription *)descPtr;
 
@@ -404,16 +411,35 @@ ADDetectedGames AdvancedMetaEngine::detectGame(const Common::FSNode &parent, con
 			Common::String fname = fileDesc->fileName;
 			FileProperties tmp;
 
-			if (filesProps.contains(fname))
+			if (listed.contains(fname))
 				continue;
+			listed[fname] = tmp;
 
-			if (getFileProperties(parent, allFiles, *g, fname, tmp)) {
+			if (!(g->flags & ADGF_MACRESFORK)) {
+				if (allFiles.contains(fname)) {
+					plainFiles.push_back(Common::FileMD5());
+					plainFiles.back().node = allFiles[fname];
+					plainNames.push_back(fname);
+				}
+			} else if (getFileProperties(parent, allFiles, *g, fname, tmp)) {
 				debug(3, "> '%s': '%s'", fname.c_str(), tmp.md5.c_str());
 				filesProps[fname] = tmp;
 			}
 		}
 	}
 
+	Common::computeFileMD5s(plainFiles, _md5Bytes);
+	for (uint i = 0; i < plainFiles.size(); ++i) {
+		if (plainFiles[i].size < 0)
+			continue;
+
+		FileProperties tmp;
+		tmp.size = plainFiles[i].size;
+		tmp.md5 = plainFiles[i].md5;
+		debug(3, "> '%s': '%s'", plainNames[i].c_str(), tmp.md5.c_str());
+		filesProps[plainNames[i]] = tmp;
+	}
+
 	int maxFilesMatched = 0;
 	bool gotAnyMatchesWithAllFiles = false;
 
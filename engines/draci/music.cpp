@@ -90,6 +90,13 @@ void MusicPlayer::playSMF(int track, bool loop) {
 	musicFile.read(_midiData, midiMusicSize);
 	musicFile.close();
 
+	// This frees _midiData when the rendered track is played
+	if (playRenderedTrack(_midiData, midiMusicSize, 0, loop, MidiParser::createParser_SMF())) {
+		_track = track;
+		debugC(2, kDraciSoundDebugLevel, "Playing rendered track %d", track);
+		return;
+	}
+
 	MidiParser *parser = MidiParser::createParser_SMF();
 	if (parser->loadMusic(_midiData, midiMusicSize)) {
 		parser->setTrack(0);
@@ -95,6 +95,10 @@ public:
 	AVIVideoTrack *getTransparencyTrack() {
 		return static_cast<AVIVideoTrack *>(_transparencyTrack.track);
 	}
+
+protected:
+	// The video tracks are accessed directly
+	bool supportsDecodeAhead() const { return false; }
 };
 
 class AVISurface {
@@ -38,6 +38,8 @@ public:
 protected:
 	void handleAudioTrack(byte track, uint32 chunkSize, uint32 unpackedSize);
 	SmackerVideoTrack *createVideoTrack(uint32 width, uint32 height, uint32 frameCount, const Common::Rational &frameRate, uint32 flags, uint32 signature) const;
+	// _lowRes is read from the packets and has to match the presented frame
+	bool supportsDecodeAhead() const { return false; }
 
 private:
 	bool _lowRes;
@@ -53,6 +53,10 @@ The meaning of these is masks is the following:
  appropriate data).
 
 
+ PixelType
+    -> the integer type holding one pixel; only defined for the formats
+       supported by the scalers, i.e. 555, 565 and 8888
+
  The kHighBitsMask / kLowBitsMask / qhighBits / qlowBits are special values that are
  used in the super-optimized interpolation functions in scaler/intern.h
  and scaler/aspect.cpp. Currently they are only available in 555 and 565 mode.
@@ -66,6 +70,8 @@ The meaning of these is masks is the following:
 
 template<>
 struct ColorMasks<565> {
+	typedef uint16 PixelType;
+
 	enum {
 		kHighBitsMask    = 0xF7DEF7DE,
 		kLowBitsMask     = 0x08210821,
@@ -100,6 +106,8 @@ struct ColorMasks<565> {
 
 template<>
 struct ColorMasks<555> {
+	typedef uint16 PixelType;
+
 	enum {
 		kHighBitsMask    = 0x7BDE7BDE,
 		kLowBitsMask     = 0x04210421,
@@ -245,6 +253,8 @@ struct ColorMasks<888> {
 
 template<>
 struct ColorMasks<8888> {
+	typedef uint32 PixelType;
+
 	enum {
 		kBytesPerPixel = 4,
 
@@ -36,6 +36,14 @@ Common::Rect Font::getBoundingBox(uint32 chr) const {
 	return Common::Rect(getCharWidth(chr), getFontHeight());
 }
 
+bool Font::drawStringRun(Surface *dst, const Common::String &str, int x, int y, int w, uint32 color, TextAlign align, int deltax) const {
+	return false;
+}
+
+bool Font::drawStringRun(Surface *dst, const Common::U32String &str, int x, int y, int w, uint32 color, TextAlign align, int deltax) const {
+	return false;
+}
+
 namespace {
 
 template<class StringType>
@@ -297,11 +305,13 @@ void Font::drawChar(ManagedSurface *dst, uint32 chr, int x, int y, uint32 color)
 
 void Font::drawString(Surface *dst, const Common::String &str, int x, int y, int w, uint32 color, TextAlign align, int deltax, bool useEllipsis) const {
 	Common::String renderStr = useEllipsis ? handleEllipsis(str, w) : str;
-	drawStringImpl(*this, dst, renderStr, x, y, w, color, align, deltax);
+	if (!drawStringRun(dst, renderStr, x, y, w, color, align, deltax))
+		drawStringImpl(*this, dst, renderStr, x, y, w, color, align, deltax);
 }
 
 void Font::drawString(Surface *dst, const Common::U32String &str, int x, int y, int w, uint32 color, TextAlign align, int deltax) const {
-	drawStringImpl(*this, dst, str, x, y, w, color, align, deltax);
+	if (!drawStringRun(dst, str, x, y, w, color, align, deltax))
+		drawStringImpl(*this, dst, str, x, y, w, color, align, deltax);
 }
 
 void Font::drawString(ManagedSurface *dst, const Common::String &str, int x, int y, int w, uint32 color, TextAlign align, int deltax, bool useEllipsis) const {
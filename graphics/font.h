@@ -178,6 +178,19 @@ public:
 	int wordWrapText(const Common::String &str, int maxWidth, Common::Array<Common::String> &lines, int initWidth = 0) const;
 	int wordWrapText(const Common::U32String &str, int maxWidth, Common::Array<Common::U32String> &lines, int initWidth = 0) const;
 
+protected:
+	/**
+	 * Draw a whole string at once. This is called by drawString, after the
+	 * ellipsis has been inserted, and has to give the same result as
+	 * drawing the characters one by one with drawChar. Fonts which can draw
+	 * strings faster than that override it.
+	 *
+	 * @return false if the string has to be drawn character by character,
+	 *         which is all the default implementation does.
+	 */
+	virtual bool drawStringRun(Surface *dst, const Common::String &str, int x, int y, int w, uint32 color, TextAlign align, int deltax) const;
+	virtual bool drawStringRun(Surface *dst, const Common::U32String &str, int x, int y, int w, uint32 color, TextAlign align, int deltax) const;
+
 private:
 	Common::String handleEllipsis(const Common::String &str, int w) const;
 };
@@ -34,7 +34,10 @@
 #include "common/singleton.h"
 #include "common/stream.h"
 #include "common/memstream.h"
+#include "common/array.h"
+#include "common/endian.h"
 #include "common/hashmap.h"
+#include "common/list.h"
 #include "common/ptr.h"
 
 #include <ft2build.h>
@@ -122,6 +125,11 @@ public:
 	virtual Common::Rect getBoundingBox(uint32 chr) const;
 
 	virtual void drawChar(Surface *dst, uint32 chr, int x, int y, uint32 color) const;
+
+protected:
+	virtual bool drawStringRun(Surface *dst, const Common::String &str, int x, int y, int w, uint32 color, TextAlign align, int deltax) const;
+	virtual bool drawStringRun(Surface *dst, const Common::U32String &str, int x, int y, int w, uint32 color, TextAlign align, int deltax) const;
+
 private:
 	bool _initialized;
 	FT_Face _face;
@@ -132,7 +140,17 @@ private:
 	int _width, _height;
 	int _ascent, _descent;
 
+	enum {
+		/** Width and minimal height of the glyph atlas pages */
+		kAtlasPageSize = 256,
+		/** Maximal size of the masks of the cached runs, in bytes */
+		kRunCacheSize = 256 * 1024,
+		/** Number of strings remembered until their second drawing */
+		kRecentRunCount = 64
+	};
+
 	struct Glyph {
+		/** The glyph coverage, a part of one of the atlas pages */
 		Surface image;
 		int xOffset, yOffset;
 		int advance;
@@ -145,6 +163,82 @@ private:
 	bool _allowLateCaching;
 	void assureCached(uint32 chr) const;
 
+	typedef Common::HashMap<uint32, int> KerningCache;
+	mutable KerningCache _kerning;
+
+	/**
+	 * The glyph images are packed into a few large pages, in rows of
+	 * glyphs, instead of being allocated one by one.
+	 */
+	mutable Common::Array<Surface> _atlasPages;
+	mutable int _atlasX, _atlasY, _atlasRowHeight;
+	Surface allocateGlyphImage(int w, int h) const;
+
+	/**
+	 * A string drawn with drawString. Its coverage mask holds all glyphs
+	 * which end up on the surface, at their final positions, so that
+	 * drawing the string again is a single blend.
+	 *
+	 * Blending twice rounds differently than blending once with the
+	 * combined coverage, so pixels covered by more than one glyph are left
+	 * out of the mask. They are kept as overlaps instead, which are blended
+	 * one by one in the order drawChar would have drawn them.
+	 */
+	struct RunKey {
+		Common::U32String str;
+		int w;
+		int align;
+		int deltax;
+
+		bool operator==(const RunKey &other) const {
+			return w == other.w && align == other.align && deltax == other.deltax && str == other.str;
+		}
+	};
+
+	struct RunKeyHash {
+		uint operator()(const RunKey &key) const;
+	};
+
+	struct RunOverlap {
+		/** Position relative to the mask */
+		int x, y;
+		uint8 coverage;
+	};
+
+	struct Run {
+		RunKey key;
+		Surface mask;
+		/** Position of the mask relative to the drawString position */
+		int xOffset, yOffset;
+		Common::Array<RunOverlap> overlaps;
+
+		uint32 getCacheSize() const {
+			return mask.w * mask.h + overlaps.size() * sizeof(RunOverlap) + sizeof(Run);
+		}
+	};
+
+	typedef Common::List<Run *> RunList;
+	typedef Common::HashMap<RunKey, RunList::iterator, RunKeyHash> RunMap;
+
+	/** The cached runs, most recently used first. */
+	mutable RunList _runs;
+	mutable RunMap _runMap;
+	mutable uint32 _runCacheSize;
+
+	/**
+	 * Hashes of recently drawn strings which have no run yet. A run is only
+	 * built when a string is drawn a second time, so that strings which
+	 * change every frame are not turned into runs at all.
+	 */
+	mutable uint _recentRuns[kRecentRunCount];
+
+	bool drawRun(Surface *dst, const RunKey &key, int x, int y, uint32 color) const;
+	void blendRun(Surface *dst, const Run &run, int x, int y, uint32 color) const;
+	void buildRun(Run &run) const;
+	void evictRuns(uint32 maxSize) const;
+
+	void drawMask(Surface *dst, const Surface &mask, int x, int y, uint32 color) const;
+
 	Common::SeekableReadStream *readTTFTable(FT_ULong tag) const;
 
 	int computePointSize(int size, TTFSizeMode sizeMode) const;
@@ -159,7 +253,9 @@ private:
 TTFFont::TTFFont()
     : _initialized(false), _face(), _ttfFile(0), _size(0), _width(0), _height(0), _ascent(0),
       _descent(0), _glyphs(), _loadFlags(FT_LOAD_TARGET_NORMAL), _renderMode(FT_RENDER_MODE_NORMAL),
-      _hasKerning(false), _allowLateCaching(false) {
+      _hasKerning(false), _allowLateCaching(false), _atlasX(0), _atlasY(0), _atlasRowHeight(0),
+      _runCacheSize(0) {
+	memset(_recentRuns, 0, sizeof(_recentRuns));
 }
 
 TTFFont::~TTFFont() {
@@ -169,11 +265,14 @@ TTFFont::~TTFFont() {
 		delete[] _ttfFile;
 		_ttfFile = 0;
 
-		for (GlyphCache::iterator i = _glyphs.begin(), end = _glyphs.end(); i != end; ++i)
-			i->_value.image.free();
-
 		_initialized = false;
 	}
+
+	// The glyph images point into the atlas pages
+	for (uint i = 0; i < _atlasPages.size(); ++i)
+		_atlasPages[i].free();
+
+	evictRuns(0);
 }
 
 bool TTFFont::load(Common::SeekableReadStream &stream, int size, TTFSizeMode sizeMode, uint dpi, TTFRenderMode renderMode, const uint32 *mapping) {
@@ -440,9 +539,24 @@ int TTFFont::getKerningOffset(uint32 left, uint32 right) const {
 	if (!leftGlyph || !rightGlyph)
 		return 0;
 
+	// Looking up the kerning in the font is slow compared to drawing the
+	// glyphs, so the pairs are cached. TrueType fonts have at most 65535
+	// glyphs, thus both glyph indices fit into the key.
+	const bool cachable = (leftGlyph <= 0xFFFF && rightGlyph <= 0xFFFF);
+	const uint32 pair = (leftGlyph << 16) | rightGlyph;
+	if (cachable) {
+		KerningCache::const_iterator kerningEntry = _kerning.find(pair);
+		if (kerningEntry != _kerning.end())
+			return kerningEntry->_value;
+	}
+
 	FT_Vector kerningVector;
 	FT_Get_Kerning(_face, leftGlyph, rightGlyph, FT_KERNING_DEFAULT, &kerningVector);
-	return (kerningVector.x / 64);
+	const int offset = kerningVector.x / 64;
+
+	if (cachable)
+		_kerning[pair] = offset;
+	return offset;
 }
 
 Common::Rect TTFFont::getBoundingBox(uint32 chr) const {
@@ -460,6 +574,12 @@ Common::Rect TTFFont::getBoundingBox(uint32 chr) const {
 
 namespace {
 
+/** A glyph image and where it goes in the mask of a run */
+struct GlyphPlacement {
+	Surface image;
+	int x, y;
+};
+
 template<typename ColorType>
 void renderGlyph(uint8 *dstPos, const int dstPitch, const uint8 *srcPos, const int srcPitch, const int w, const int h, ColorType color, const PixelFormat &dstFormat) {
 	uint8 sR, sG, sB;
@@ -494,6 +614,53 @@ void renderGlyph(uint8 *dstPos, const int dstPitch, const uint8 *srcPos, const i
 	}
 }
 
+// renderGlyph for 32 bit formats with 8 bits per color, which can blend the
+// channels in place.
+void renderGlyph888(uint8 *dstPos, const int dstPitch, const uint8 *srcPos, const int srcPitch, const int w, const int h, uint32 color, const PixelFormat &dstFormat) {
+	// The writes to the destination could alias the format, so the shifts
+	// are copied to locals to keep them in registers.
+	const uint rShift = dstFormat.rShift, gShift = dstFormat.gShift, bShift = dstFormat.bShift;
+	const uint32 alpha = (0xFF >> dstFormat.aLoss) << dstFormat.aShift;
+	const uint32 sR = (color >> rShift) & 0xFF;
+	const uint32 sG = (color >> gShift) & 0xFF;
+	const uint32 sB = (color >> bShift) & 0xFF;
+
+	for (int y = 0; y < h; ++y) {
+		uint32 *rDst = (uint32 *)dstPos;
+
+		for (int x = 0; x < w; ++x) {
+			// Most of a text mask is either empty or fully covered, so we
+			// look at four pixels at once where possible.
+			if (x + 4 <= w) {
+				const uint32 quad = READ_UINT32(srcPos + x);
+				if (quad == 0) {
+					x += 3;
+					continue;
+				} else if (quad == 0xFFFFFFFF) {
+					rDst[x] = rDst[x + 1] = rDst[x + 2] = rDst[x + 3] = color;
+					x += 3;
+					continue;
+				}
+			}
+
+			const uint32 a = srcPos[x];
+			if (a == 255) {
+				rDst[x] = color;
+			} else if (a) {
+				const uint32 d = rDst[x];
+				const uint32 dR = ((255 - a) * ((d >> rShift) & 0xFF) + a * sR) / 255;
+				const uint32 dG = ((255 - a) * ((d >> gShift) & 0xFF) + a * sG) / 255;
+				const uint32 dB = ((255 - a) * ((d >> bShift) & 0xFF) + a * sB) / 255;
+
+				rDst[x] = alpha | (dR << rShift) | (dG << gShift) | (dB << bShift);
+			}
+		}
+
+		dstPos += dstPitch;
+		srcPos += srcPitch;
+	}
+}
+
 } // End of anonymous namespace
 
 void TTFFont::drawChar(Surface *dst, uint32 chr, int x, int y, uint32 color) const {
@@ -503,19 +670,19 @@ void TTFFont::drawChar(Surface *dst, uint32 chr, int x, int y, uint32 color) con
 		return;
 
 	const Glyph &glyph = glyphEntry->_value;
+	drawMask(dst, glyph.image, x + glyph.xOffset, y + glyph.yOffset, color);
+}
 
-	x += glyph.xOffset;
-	y += glyph.yOffset;
-
+void TTFFont::drawMask(Surface *dst, const Surface &mask, int x, int y, uint32 color) const {
 	if (x > dst->w)
 		return;
 	if (y > dst->h)
 		return;
 
-	int w = glyph.image.w;
-	int h = glyph.image.h;
+	int w = mask.w;
+	int h = mask.h;
 
-	const uint8 *srcPos = (const uint8 *)glyph.image.getPixels();
+	const uint8 *srcPos = (const uint8 *)mask.getPixels();
 
 	// Make sure we are not drawing outside the screen bounds
 	if (x < 0) {
@@ -531,7 +698,7 @@ void TTFFont::drawChar(Surface *dst, uint32 chr, int x, int y, uint32 color) con
 		return;
 
 	if (y < 0) {
-		srcPos -= y * glyph.image.pitch;
+		srcPos -= y * mask.pitch;
 		h += y;
 		y = 0;
 	}
@@ -560,13 +727,242 @@ void TTFFont::drawChar(Surface *dst, uint32 chr, int x, int y, uint32 color) con
 			}
 
 			dstPos += dst->pitch;
-			srcPos += glyph.image.pitch;
+			srcPos += mask.pitch;
 		}
 	} else if (dst->format.bytesPerPixel == 2) {
-		renderGlyph<uint16>(dstPos, dst->pitch, srcPos, glyph.image.pitch, w, h, color, dst->format);
+		renderGlyph<uint16>(dstPos, dst->pitch, srcPos, mask.pitch, w, h, color, dst->format);
 	} else if (dst->format.bytesPerPixel == 4) {
-		renderGlyph<uint32>(dstPos, dst->pitch, srcPos, glyph.image.pitch, w, h, color, dst->format);
+		if (dst->format.rLoss == 0 && dst->format.gLoss == 0 && dst->format.bLoss == 0)
+			renderGlyph888(dstPos, dst->pitch, srcPos, mask.pitch, w, h, color, dst->format);
+		else
+			renderGlyph<uint32>(dstPos, dst->pitch, srcPos, mask.pitch, w, h, color, dst->format);
+	}
+}
+
+bool TTFFont::drawStringRun(Surface *dst, const Common::String &str, int x, int y, int w, uint32 color, TextAlign align, int deltax) const {
+	RunKey key;
+	for (uint i = 0; i < str.size(); ++i)
+		key.str += (uint32)(byte)str[i];
+	key.w = w;
+	key.align = align;
+	key.deltax = deltax;
+
+	return drawRun(dst, key, x, y, color);
+}
+
+bool TTFFont::drawStringRun(Surface *dst, const Common::U32String &str, int x, int y, int w, uint32 color, TextAlign align, int deltax) const {
+	RunKey key;
+	key.str = str;
+	key.w = w;
+	key.align = align;
+	key.deltax = deltax;
+
+	return drawRun(dst, key, x, y, color);
+}
+
+uint TTFFont::RunKeyHash::operator()(const RunKey &key) const {
+	uint hash = key.w * 31 + key.align * 7 + key.deltax;
+	for (uint i = 0; i < key.str.size(); ++i)
+		hash = hash * 33 + key.str[i];
+	return hash;
+}
+
+bool TTFFont::drawRun(Surface *dst, const RunKey &key, int x, int y, uint32 color) const {
+	RunMap::iterator i = _runMap.find(key);
+	if (i != _runMap.end()) {
+		// Move the run to the front of the LRU list
+		Run *run = *i->_value;
+		_runs.erase(i->_value);
+		_runs.push_front(run);
+		i->_value = _runs.begin();
+
+		blendRun(dst, *run, x, y, color);
+		return true;
+	}
+
+	const uint hash = RunKeyHash()(key);
+	uint &recent = _recentRuns[hash % kRecentRunCount];
+	if (recent != hash) {
+		recent = hash;
+		return false;
+	}
+
+	Run *run = new Run();
+	run->key = key;
+	buildRun(*run);
+	blendRun(dst, *run, x, y, color);
+
+	// Runs which would push out lots of others are not kept. This also
+	// covers long texts which are only drawn once.
+	const uint32 size = run->getCacheSize();
+	if (size > kRunCacheSize / 8) {
+		run->mask.free();
+		delete run;
+		return true;
+	}
+
+	evictRuns(kRunCacheSize - size);
+	_runs.push_front(run);
+	_runMap[key] = _runs.begin();
+	_runCacheSize += size;
+	return true;
+}
+
+void TTFFont::blendRun(Surface *dst, const Run &run, int x, int y, uint32 color) const {
+	x += run.xOffset;
+	y += run.yOffset;
+	drawMask(dst, run.mask, x, y, color);
+
+	// The overlaps go through drawMask as well, so that they are blended
+	// exactly like the glyphs are
+	for (uint i = 0; i < run.overlaps.size(); ++i) {
+		uint8 coverage = run.overlaps[i].coverage;
+		Surface pixel;
+		pixel.init(1, 1, 1, &coverage, PixelFormat::createFormatCLUT8());
+		drawMask(dst, pixel, x + run.overlaps[i].x, y + run.overlaps[i].y, color);
+	}
+}
+
+void TTFFont::buildRun(Run &run) const {
+	// We follow the logic of drawStringImpl in graphics/font.cpp here, with
+	// the string drawn at (0, 0).
+	Common::Array<GlyphPlacement> placements;
+	Common::Rect bounds;
+
+	const Common::U32String &str = run.key.str;
+	const int leftX = 0, rightX = run.key.w;
+	const int width = getStringWidth(str);
+
+	int x = 0;
+	if (run.key.align == kTextAlignCenter)
+		x = (run.key.w - width) / 2;
+	else if (run.key.align == kTextAlignRight)
+		x = run.key.w - width;
+	x += run.key.deltax;
+
+	uint32 last = 0;
+	for (uint i = 0; i < str.size(); ++i) {
+		const uint32 cur = str[i];
+		x += getKerningOffset(last, cur);
+		last = cur;
+
+		Common::Rect charBox = getBoundingBox(cur);
+		if (x + charBox.right > rightX)
+			break;
+
+		GlyphCache::const_iterator glyphEntry = _glyphs.find(cur);
+		if (x + charBox.right >= leftX && glyphEntry != _glyphs.end() && !charBox.isEmpty()) {
+			const Glyph &glyph = glyphEntry->_value;
+
+			GlyphPlacement placement;
+			placement.image = glyph.image;
+			placement.x = x + glyph.xOffset;
+			placement.y = glyph.yOffset;
+			placements.push_back(placement);
+
+			charBox.translate(x, 0);
+			if (bounds.isEmpty())
+				bounds = charBox;
+			else
+				bounds.extend(charBox);
+		}
+
+		x += getCharWidth(cur);
+	}
+
+	run.xOffset = bounds.left;
+	run.yOffset = bounds.top;
+	run.mask.create(bounds.width(), bounds.height(), PixelFormat::createFormatCLUT8());
+
+	// Count how many glyphs cover each pixel of the mask first
+	Surface covers;
+	covers.create(bounds.width(), bounds.height(), PixelFormat::createFormatCLUT8());
+
+	for (uint i = 0; i < placements.size(); ++i) {
+		const Surface &image = placements[i].image;
+
+		for (int cy = 0; cy < image.h; ++cy) {
+			const uint8 *src = (const uint8 *)image.getBasePtr(0, cy);
+			uint8 *dst = (uint8 *)covers.getBasePtr(placements[i].x - bounds.left, placements[i].y - bounds.top + cy);
+
+			for (int cx = 0; cx < image.w; ++cx) {
+				if (src[cx] && dst[cx] < 2)
+					++dst[cx];
+			}
+		}
+	}
+
+	for (uint i = 0; i < placements.size(); ++i) {
+		const Surface &image = placements[i].image;
+		const int maskX = placements[i].x - bounds.left;
+		const int maskY = placements[i].y - bounds.top;
+
+		for (int cy = 0; cy < image.h; ++cy) {
+			const uint8 *src = (const uint8 *)image.getBasePtr(0, cy);
+			const uint8 *count = (const uint8 *)covers.getBasePtr(maskX, maskY + cy);
+			uint8 *dst = (uint8 *)run.mask.getBasePtr(maskX, maskY + cy);
+
+			for (int cx = 0; cx < image.w; ++cx) {
+				if (!src[cx])
+					continue;
+
+				if (count[cx] == 1) {
+					dst[cx] = src[cx];
+				} else {
+					RunOverlap overlap;
+					overlap.x = maskX + cx;
+					overlap.y = maskY + cy;
+					overlap.coverage = src[cx];
+					run.overlaps.push_back(overlap);
+				}
+			}
+		}
 	}
+
+	covers.free();
+}
+
+void TTFFont::evictRuns(uint32 maxSize) const {
+	while (_runCacheSize > maxSize && !_runs.empty()) {
+		Run *run = _runs.back();
+		_runs.pop_back();
+		_runMap.erase(run->key);
+		_runCacheSize -= run->getCacheSize();
+
+		run->mask.free();
+		delete run;
+	}
+}
+
+Surface TTFFont::allocateGlyphImage(int w, int h) const {
+	Surface image;
+	if (!w || !h) {
+		image.init(w, h, w, nullptr, PixelFormat::createFormatCLUT8());
+		return image;
+	}
+
+	// Start a new row when the glyph does not fit on the current one, and a
+	// new page when the row does not fit on the current page.
+	if (!_atlasPages.empty() && _atlasX + w > _atlasPages.back().w) {
+		_atlasX = 0;
+		_atlasY += _atlasRowHeight;
+		_atlasRowHeight = 0;
+	}
+
+	if (_atlasPages.empty() || _atlasY + h > _atlasPages.back().h || w > _atlasPages.back().w) {
+		Surface page;
+		page.create(MAX<int>(w, kAtlasPageSize), MAX<int>(h, kAtlasPageSize), PixelFormat::createFormatCLUT8());
+		_atlasPages.push_back(page);
+
+		_atlasX = 0;
+		_atlasY = 0;
+		_atlasRowHeight = 0;
+	}
+
+	image = _atlasPages.back().getSubArea(Common::Rect(_atlasX, _atlasY, _atlasX + w, _atlasY + h));
+	_atlasX += w;
+	_atlasRowHeight = MAX(_atlasRowHeight, h);
+	return image;
 }
 
 bool TTFFont::cacheGlyph(Glyph &glyph, uint32 chr) const {
@@ -594,7 +990,13 @@ bool TTFFont::cacheGlyph(Glyph &glyph, uint32 chr) const {
 	glyph.advance = ftCeil26_6(_face->glyph->advance.x);
 
 	const FT_Bitmap &bitmap = _face->glyph->bitmap;
-	glyph.image.create(bitmap.width, bitmap.rows, PixelFormat::createFormatCLUT8());
+	if (bitmap.pixel_mode != FT_PIXEL_MODE_MONO && bitmap.pixel_mode != FT_PIXEL_MODE_GRAY) {
+		warning("TTFFont::cacheGlyph: Unsupported pixel mode %d", bitmap.pixel_mode);
+		return false;
+	}
+
+	// The atlas pages are cleared when they are allocated.
+	glyph.image = allocateGlyphImage(bitmap.width, bitmap.rows);
 
 	const uint8 *src = bitmap.buffer;
 	int srcPitch = bitmap.pitch;
@@ -604,7 +1006,6 @@ bool TTFFont::cacheGlyph(Glyph &glyph, uint32 chr) const {
 	}
 
 	uint8 *dst = (uint8 *)glyph.image.getPixels();
-	memset(dst, 0, glyph.image.h * glyph.image.pitch);
 
 	switch (bitmap.pixel_mode) {
 	case FT_PIXEL_MODE_MONO:
@@ -617,12 +1018,12 @@ bool TTFFont::cacheGlyph(Glyph &glyph, uint32 chr) const {
 					mask = *curSrc++;
 
 				if (mask & 0x80)
-					*dst = 255;
+					dst[x] = 255;
 
 				mask <<= 1;
-				++dst;
 			}
 
+			dst += glyph.image.pitch;
 			src += srcPitch;
 		}
 		break;
@@ -634,11 +1035,6 @@ bool TTFFont::cacheGlyph(Glyph &glyph, uint32 chr) const {
 			src += srcPitch;
 		}
 		break;
-
-	default:
-		warning("TTFFont::cacheGlyph: Unsupported pixel mode %d", bitmap.pixel_mode);
-		glyph.image.free();
-		return false;
 	}
 
 	return true;
@@ -26,6 +26,7 @@ MODULE_OBJS := \
 	pixelformat.o \
 	primitives.o \
 	scaler.o \
+	scaler/hq_rules.o \
 	scaler/thumbnail_intern.o \
 	screen.o \
 	sjis.o \
@@ -33,11 +34,13 @@ MODULE_OBJS := \
 	transform_struct.o \
 	transform_tools.o \
 	transparent_surface.o \
+	transparent_surface_simd.o \
 	thumbnail.o \
 	VectorRenderer.o \
 	VectorRendererSpec.o \
 	wincursor.o \
-	yuv_to_rgb.o
+	yuv_to_rgb.o \
+	yuv_to_rgb_simd.o
 
 ifdef USE_SCALERS
 MODULE_OBJS += \
@@ -58,7 +61,8 @@ endif
 ifdef USE_HQ_SCALERS
 MODULE_OBJS += \
 	scaler/hq2x.o \
-	scaler/hq3x.o
+	scaler/hq3x.o \
+	scaler/hq_simd.o
 
 ifdef USE_NASM
 MODULE_OBJS += \
@@ -26,6 +26,11 @@
 #include "common/scummsys.h"
 #include "graphics/surface.h"
 
+/**
+ * Init the scaler subsystem for the given bit format: 555, 565 or 8888
+ * (see Graphics::ColorMasks). All the scalers take and produce pixels of
+ * that format.
+ */
 extern void InitScalers(uint32 BitFormat);
 extern void DestroyScalers();
 
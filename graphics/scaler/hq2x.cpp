@@ -21,6 +21,8 @@
  */
 
 #include "graphics/scaler/intern.h"
+#include "graphics/scaler/hq_simd.h"
+#include "common/util.h"
 
 #ifdef USE_NASM
 // Assembly version of HQ2x
@@ -35,11 +37,7 @@ void hq2x_16(const byte *, byte *, uint32, uint32, uint32, uint32);
 
 }
 
-void HQ2x(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch, int width, int height) {
-	hq2x_16(srcPtr, dstPtr, width, height, srcPitch, dstPitch);
-}
-
-#else
+#endif
 
 #define PIXEL00_0	*(q) = w5;
 #define PIXEL00_10	*(q) = interpolate16_3_1<ColorMask >(w5, w1);
@@ -93,23 +91,30 @@ void HQ2x(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch,
 #define PIXEL11_90	*(q+1+nextlineDst) = interpolate16_2_3_3<ColorMask >(w5, w6, w8);
 #define PIXEL11_100	*(q+1+nextlineDst) = interpolate16_14_1_1<ColorMask >(w5, w6, w8);
 
-extern "C" uint32   *RGBtoYUV;
-#define YUV(x)	RGBtoYUV[w ## x]
+// Whether two direct neighbours differ from each other, see hq_simd.h
+#define DIFF_2_6	(code & kHQDiff26)
+#define DIFF_4_2	(code & kHQDiff42)
+#define DIFF_6_8	(code & kHQDiff68)
+#define DIFF_8_4	(code & kHQDiff84)
 
 /*
  * The HQ2x high quality 2x graphics filter.
  * Original author Maxim Stepin (see http://www.hiend3d.com/hq2x.html).
- * Adapted for ScummVM to 16 bit output and optimized by Max Horn.
+ * Adapted for ScummVM to 16 and 32 bit output and optimized by Max Horn.
  */
 template<typename ColorMask>
 static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch, int width, int height) {
 	int w1, w2, w3, w4, w5, w6, w7, w8, w9;
 
-	const uint32 nextlineSrc = srcPitch / sizeof(uint16);
-	const uint16 *p = (const uint16 *)srcPtr;
+	typedef typename ColorMask::PixelType Pixel;
+
+	const uint32 nextlineSrc = srcPitch / sizeof(Pixel);
+	const Pixel *p = (const Pixel *)srcPtr;
 
-	const uint32 nextlineDst = dstPitch / sizeof(uint16);
-	uint16 *q = (uint16 *)dstPtr;
+	uint16 codes[kHQMaxClassifyWidth];
+
+	const uint32 nextlineDst = dstPitch / sizeof(Pixel);
+	Pixel *q = (Pixel *)dstPtr;
 
 	//	 +----+----+----+
 	//	 |    |    |    |
@@ -132,25 +137,23 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 		w8 = *(p + nextlineSrc);
 
 		int tmpWidth = width;
+		int run = 0, runWidth = 0;
 		while (tmpWidth--) {
+			// Classify the next run of pixels
+			if (run == runWidth) {
+				runWidth = MIN<int>(tmpWidth + 1, kHQMaxClassifyWidth);
+				classifyHQRun(p, nextlineSrc, codes, runWidth);
+				run = 0;
+			}
+			const int code = codes[run++];
+
 			p++;
 
 			w3 = *(p - nextlineSrc);
 			w6 = *(p);
 			w9 = *(p + nextlineSrc);
 
-			int pattern = 0;
-			const int yuv5 = YUV(5);
-			if (w5 != w1 && diffYUV(yuv5, YUV(1))) pattern |= 0x0001;
-			if (w5 != w2 && diffYUV(yuv5, YUV(2))) pattern |= 0x0002;
-			if (w5 != w3 && diffYUV(yuv5, YUV(3))) pattern |= 0x0004;
-			if (w5 != w4 && diffYUV(yuv5, YUV(4))) pattern |= 0x0008;
-			if (w5 != w6 && diffYUV(yuv5, YUV(6))) pattern |= 0x0010;
-			if (w5 != w7 && diffYUV(yuv5, YUV(7))) pattern |= 0x0020;
-			if (w5 != w8 && diffYUV(yuv5, YUV(8))) pattern |= 0x0040;
-			if (w5 != w9 && diffYUV(yuv5, YUV(9))) pattern |= 0x0080;
-
-			switch (pattern) {
+			switch (code & kHQPatternMask) {
 			case 0:
 			case 1:
 			case 4:
@@ -283,7 +286,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 18:
 			case 50:
 				PIXEL00_22
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL01_10
 				} else {
 					PIXEL01_20
@@ -296,7 +299,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL00_20
 				PIXEL01_22
 				PIXEL10_21
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL11_10
 				} else {
 					PIXEL11_20
@@ -306,7 +309,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 76:
 				PIXEL00_21
 				PIXEL01_20
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL10_10
 				} else {
 					PIXEL10_20
@@ -315,7 +318,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 10:
 			case 138:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_10
 				} else {
 					PIXEL00_20
@@ -371,7 +374,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 22:
 			case 54:
 				PIXEL00_22
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL01_0
 				} else {
 					PIXEL01_20
@@ -384,7 +387,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL00_20
 				PIXEL01_22
 				PIXEL10_21
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL11_0
 				} else {
 					PIXEL11_20
@@ -394,7 +397,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 108:
 				PIXEL00_21
 				PIXEL01_20
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL10_0
 				} else {
 					PIXEL10_20
@@ -403,7 +406,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 11:
 			case 139:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_0
 				} else {
 					PIXEL00_20
@@ -414,7 +417,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 19:
 			case 51:
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL00_11
 					PIXEL01_10
 				} else {
@@ -427,7 +430,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 146:
 			case 178:
 				PIXEL00_22
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL01_10
 					PIXEL11_12
 				} else {
@@ -439,7 +442,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 84:
 			case 85:
 				PIXEL00_20
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL01_11
 					PIXEL11_10
 				} else {
@@ -452,7 +455,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 113:
 				PIXEL00_20
 				PIXEL01_22
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL10_12
 					PIXEL11_10
 				} else {
@@ -464,7 +467,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 204:
 				PIXEL00_21
 				PIXEL01_20
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL10_10
 					PIXEL11_11
 				} else {
@@ -474,7 +477,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 73:
 			case 77:
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL00_12
 					PIXEL10_10
 				} else {
@@ -486,7 +489,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 42:
 			case 170:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_10
 					PIXEL10_11
 				} else {
@@ -498,7 +501,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 14:
 			case 142:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_10
 					PIXEL01_12
 				} else {
@@ -558,12 +561,12 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 26:
 			case 31:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_0
 				} else {
 					PIXEL00_20
 				}
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL01_0
 				} else {
 					PIXEL01_20
@@ -574,13 +577,13 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 82:
 			case 214:
 				PIXEL00_22
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL01_0
 				} else {
 					PIXEL01_20
 				}
 				PIXEL10_21
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL11_0
 				} else {
 					PIXEL11_20
@@ -590,12 +593,12 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 248:
 				PIXEL00_21
 				PIXEL01_22
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL10_0
 				} else {
 					PIXEL10_20
 				}
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL11_0
 				} else {
 					PIXEL11_20
@@ -603,13 +606,13 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 74:
 			case 107:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_0
 				} else {
 					PIXEL00_20
 				}
 				PIXEL01_21
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL10_0
 				} else {
 					PIXEL10_20
@@ -617,7 +620,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL11_22
 				break;
 			case 27:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_0
 				} else {
 					PIXEL00_20
@@ -628,7 +631,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 86:
 				PIXEL00_22
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL01_0
 				} else {
 					PIXEL01_20
@@ -640,7 +643,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL00_21
 				PIXEL01_22
 				PIXEL10_10
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL11_0
 				} else {
 					PIXEL11_20
@@ -649,7 +652,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 106:
 				PIXEL00_10
 				PIXEL01_21
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL10_0
 				} else {
 					PIXEL10_20
@@ -658,7 +661,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 30:
 				PIXEL00_10
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL01_0
 				} else {
 					PIXEL01_20
@@ -670,7 +673,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL00_22
 				PIXEL01_10
 				PIXEL10_21
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL11_0
 				} else {
 					PIXEL11_20
@@ -679,7 +682,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 120:
 				PIXEL00_21
 				PIXEL01_22
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL10_0
 				} else {
 					PIXEL10_20
@@ -687,7 +690,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL11_10
 				break;
 			case 75:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_0
 				} else {
 					PIXEL00_20
@@ -769,12 +772,12 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL11_12
 				break;
 			case 58:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_10
 				} else {
 					PIXEL00_70
 				}
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL01_10
 				} else {
 					PIXEL01_70
@@ -784,13 +787,13 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 83:
 				PIXEL00_11
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL01_10
 				} else {
 					PIXEL01_70
 				}
 				PIXEL10_21
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL11_10
 				} else {
 					PIXEL11_70
@@ -799,25 +802,25 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 92:
 				PIXEL00_21
 				PIXEL01_11
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL10_10
 				} else {
 					PIXEL10_70
 				}
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL11_10
 				} else {
 					PIXEL11_70
 				}
 				break;
 			case 202:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_10
 				} else {
 					PIXEL00_70
 				}
 				PIXEL01_21
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL10_10
 				} else {
 					PIXEL10_70
@@ -825,13 +828,13 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL11_11
 				break;
 			case 78:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_10
 				} else {
 					PIXEL00_70
 				}
 				PIXEL01_12
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL10_10
 				} else {
 					PIXEL10_70
@@ -839,12 +842,12 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL11_22
 				break;
 			case 154:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_10
 				} else {
 					PIXEL00_70
 				}
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL01_10
 				} else {
 					PIXEL01_70
@@ -854,13 +857,13 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 114:
 				PIXEL00_22
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL01_10
 				} else {
 					PIXEL01_70
 				}
 				PIXEL10_12
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL11_10
 				} else {
 					PIXEL11_70
@@ -869,34 +872,34 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 89:
 				PIXEL00_12
 				PIXEL01_22
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL10_10
 				} else {
 					PIXEL10_70
 				}
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL11_10
 				} else {
 					PIXEL11_70
 				}
 				break;
 			case 90:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_10
 				} else {
 					PIXEL00_70
 				}
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL01_10
 				} else {
 					PIXEL01_70
 				}
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL10_10
 				} else {
 					PIXEL10_70
 				}
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL11_10
 				} else {
 					PIXEL11_70
@@ -904,7 +907,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 55:
 			case 23:
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL00_11
 					PIXEL01_0
 				} else {
@@ -917,7 +920,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 182:
 			case 150:
 				PIXEL00_22
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL01_0
 					PIXEL11_12
 				} else {
@@ -929,7 +932,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 213:
 			case 212:
 				PIXEL00_20
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL01_11
 					PIXEL11_0
 				} else {
@@ -942,7 +945,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 240:
 				PIXEL00_20
 				PIXEL01_22
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL10_12
 					PIXEL11_0
 				} else {
@@ -954,7 +957,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 232:
 				PIXEL00_21
 				PIXEL01_20
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL10_0
 					PIXEL11_11
 				} else {
@@ -964,7 +967,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 109:
 			case 105:
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL00_12
 					PIXEL10_0
 				} else {
@@ -976,7 +979,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 171:
 			case 43:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_0
 					PIXEL10_11
 				} else {
@@ -988,7 +991,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 143:
 			case 15:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_0
 					PIXEL01_12
 				} else {
@@ -1001,7 +1004,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 124:
 				PIXEL00_21
 				PIXEL01_11
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL10_0
 				} else {
 					PIXEL10_20
@@ -1009,7 +1012,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL11_10
 				break;
 			case 203:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_0
 				} else {
 					PIXEL00_20
@@ -1020,7 +1023,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 62:
 				PIXEL00_10
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL01_0
 				} else {
 					PIXEL01_20
@@ -1032,7 +1035,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL00_11
 				PIXEL01_10
 				PIXEL10_21
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL11_0
 				} else {
 					PIXEL11_20
@@ -1040,7 +1043,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 118:
 				PIXEL00_22
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL01_0
 				} else {
 					PIXEL01_20
@@ -1052,7 +1055,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL00_12
 				PIXEL01_22
 				PIXEL10_10
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL11_0
 				} else {
 					PIXEL11_20
@@ -1061,7 +1064,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 110:
 				PIXEL00_10
 				PIXEL01_12
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL10_0
 				} else {
 					PIXEL10_20
@@ -1069,7 +1072,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL11_22
 				break;
 			case 155:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_0
 				} else {
 					PIXEL00_20
@@ -1129,24 +1132,24 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 220:
 				PIXEL00_21
 				PIXEL01_11
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL10_10
 				} else {
 					PIXEL10_70
 				}
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL11_0
 				} else {
 					PIXEL11_20
 				}
 				break;
 			case 158:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_10
 				} else {
 					PIXEL00_70
 				}
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL01_0
 				} else {
 					PIXEL01_20
@@ -1155,13 +1158,13 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL11_12
 				break;
 			case 234:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_10
 				} else {
 					PIXEL00_70
 				}
 				PIXEL01_21
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL10_0
 				} else {
 					PIXEL10_20
@@ -1170,25 +1173,25 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 242:
 				PIXEL00_22
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL01_10
 				} else {
 					PIXEL01_70
 				}
 				PIXEL10_12
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL11_0
 				} else {
 					PIXEL11_20
 				}
 				break;
 			case 59:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_0
 				} else {
 					PIXEL00_20
 				}
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL01_10
 				} else {
 					PIXEL01_70
@@ -1199,12 +1202,12 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 121:
 				PIXEL00_12
 				PIXEL01_22
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL10_0
 				} else {
 					PIXEL10_20
 				}
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL11_10
 				} else {
 					PIXEL11_70
@@ -1212,26 +1215,26 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 87:
 				PIXEL00_11
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL01_0
 				} else {
 					PIXEL01_20
 				}
 				PIXEL10_21
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL11_10
 				} else {
 					PIXEL11_70
 				}
 				break;
 			case 79:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_0
 				} else {
 					PIXEL00_20
 				}
 				PIXEL01_12
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL10_10
 				} else {
 					PIXEL10_70
@@ -1239,88 +1242,88 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL11_22
 				break;
 			case 122:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_10
 				} else {
 					PIXEL00_70
 				}
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL01_10
 				} else {
 					PIXEL01_70
 				}
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL10_0
 				} else {
 					PIXEL10_20
 				}
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL11_10
 				} else {
 					PIXEL11_70
 				}
 				break;
 			case 94:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_10
 				} else {
 					PIXEL00_70
 				}
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL01_0
 				} else {
 					PIXEL01_20
 				}
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL10_10
 				} else {
 					PIXEL10_70
 				}
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL11_10
 				} else {
 					PIXEL11_70
 				}
 				break;
 			case 218:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_10
 				} else {
 					PIXEL00_70
 				}
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL01_10
 				} else {
 					PIXEL01_70
 				}
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL10_10
 				} else {
 					PIXEL10_70
 				}
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL11_0
 				} else {
 					PIXEL11_20
 				}
 				break;
 			case 91:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_0
 				} else {
 					PIXEL00_20
 				}
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL01_10
 				} else {
 					PIXEL01_70
 				}
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL10_10
 				} else {
 					PIXEL10_70
 				}
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL11_10
 				} else {
 					PIXEL11_70
@@ -1351,12 +1354,12 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL11_12
 				break;
 			case 186:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_10
 				} else {
 					PIXEL00_70
 				}
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL01_10
 				} else {
 					PIXEL01_70
@@ -1366,13 +1369,13 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 115:
 				PIXEL00_11
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL01_10
 				} else {
 					PIXEL01_70
 				}
 				PIXEL10_12
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL11_10
 				} else {
 					PIXEL11_70
@@ -1381,25 +1384,25 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 93:
 				PIXEL00_12
 				PIXEL01_11
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL10_10
 				} else {
 					PIXEL10_70
 				}
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL11_10
 				} else {
 					PIXEL11_70
 				}
 				break;
 			case 206:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_10
 				} else {
 					PIXEL00_70
 				}
 				PIXEL01_12
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL10_10
 				} else {
 					PIXEL10_70
@@ -1410,7 +1413,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 201:
 				PIXEL00_12
 				PIXEL01_20
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL10_10
 				} else {
 					PIXEL10_70
@@ -1419,7 +1422,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 174:
 			case 46:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_10
 				} else {
 					PIXEL00_70
@@ -1431,7 +1434,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 179:
 			case 147:
 				PIXEL00_11
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL01_10
 				} else {
 					PIXEL01_70
@@ -1444,7 +1447,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL00_20
 				PIXEL01_11
 				PIXEL10_12
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL11_10
 				} else {
 					PIXEL11_70
@@ -1464,12 +1467,12 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 126:
 				PIXEL00_10
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL01_0
 				} else {
 					PIXEL01_20
 				}
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL10_0
 				} else {
 					PIXEL10_20
@@ -1477,21 +1480,21 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL11_10
 				break;
 			case 219:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_0
 				} else {
 					PIXEL00_20
 				}
 				PIXEL01_10
 				PIXEL10_10
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL11_0
 				} else {
 					PIXEL11_20
 				}
 				break;
 			case 125:
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL00_12
 					PIXEL10_0
 				} else {
@@ -1503,7 +1506,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 221:
 				PIXEL00_12
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL01_11
 					PIXEL11_0
 				} else {
@@ -1513,7 +1516,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL10_10
 				break;
 			case 207:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_0
 					PIXEL01_12
 				} else {
@@ -1526,7 +1529,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 238:
 				PIXEL00_10
 				PIXEL01_12
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL10_0
 					PIXEL11_11
 				} else {
@@ -1536,7 +1539,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 190:
 				PIXEL00_10
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL01_0
 					PIXEL11_12
 				} else {
@@ -1546,7 +1549,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL10_11
 				break;
 			case 187:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_0
 					PIXEL10_11
 				} else {
@@ -1559,7 +1562,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 243:
 				PIXEL00_11
 				PIXEL01_10
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL10_12
 					PIXEL11_0
 				} else {
@@ -1568,7 +1571,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				}
 				break;
 			case 119:
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL00_11
 					PIXEL01_0
 				} else {
@@ -1582,7 +1585,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 233:
 				PIXEL00_12
 				PIXEL01_20
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL10_0
 				} else {
 					PIXEL10_100
@@ -1591,7 +1594,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 175:
 			case 47:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_0
 				} else {
 					PIXEL00_100
@@ -1603,7 +1606,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 183:
 			case 151:
 				PIXEL00_11
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL01_0
 				} else {
 					PIXEL01_100
@@ -1616,7 +1619,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL00_20
 				PIXEL01_11
 				PIXEL10_12
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL11_0
 				} else {
 					PIXEL11_100
@@ -1625,25 +1628,25 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 250:
 				PIXEL00_10
 				PIXEL01_10
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL10_0
 				} else {
 					PIXEL10_20
 				}
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL11_0
 				} else {
 					PIXEL11_20
 				}
 				break;
 			case 123:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_0
 				} else {
 					PIXEL00_20
 				}
 				PIXEL01_10
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL10_0
 				} else {
 					PIXEL10_20
@@ -1651,12 +1654,12 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL11_10
 				break;
 			case 95:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_0
 				} else {
 					PIXEL00_20
 				}
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL01_0
 				} else {
 					PIXEL01_20
@@ -1666,13 +1669,13 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 222:
 				PIXEL00_10
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL01_0
 				} else {
 					PIXEL01_20
 				}
 				PIXEL10_10
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL11_0
 				} else {
 					PIXEL11_20
@@ -1681,12 +1684,12 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 252:
 				PIXEL00_21
 				PIXEL01_11
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL10_0
 				} else {
 					PIXEL10_20
 				}
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL11_0
 				} else {
 					PIXEL11_100
@@ -1695,25 +1698,25 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 249:
 				PIXEL00_12
 				PIXEL01_22
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL10_0
 				} else {
 					PIXEL10_100
 				}
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL11_0
 				} else {
 					PIXEL11_20
 				}
 				break;
 			case 235:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_0
 				} else {
 					PIXEL00_20
 				}
 				PIXEL01_21
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL10_0
 				} else {
 					PIXEL10_100
@@ -1721,13 +1724,13 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL11_11
 				break;
 			case 111:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_0
 				} else {
 					PIXEL00_100
 				}
 				PIXEL01_12
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL10_0
 				} else {
 					PIXEL10_20
@@ -1735,12 +1738,12 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL11_22
 				break;
 			case 63:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_0
 				} else {
 					PIXEL00_100
 				}
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL01_0
 				} else {
 					PIXEL01_20
@@ -1749,12 +1752,12 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL11_21
 				break;
 			case 159:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_0
 				} else {
 					PIXEL00_20
 				}
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL01_0
 				} else {
 					PIXEL01_100
@@ -1764,13 +1767,13 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 215:
 				PIXEL00_11
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL01_0
 				} else {
 					PIXEL01_100
 				}
 				PIXEL10_21
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL11_0
 				} else {
 					PIXEL11_20
@@ -1778,13 +1781,13 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 246:
 				PIXEL00_22
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL01_0
 				} else {
 					PIXEL01_20
 				}
 				PIXEL10_12
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL11_0
 				} else {
 					PIXEL11_100
@@ -1792,17 +1795,17 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 254:
 				PIXEL00_10
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL01_0
 				} else {
 					PIXEL01_20
 				}
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL10_0
 				} else {
 					PIXEL10_20
 				}
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL11_0
 				} else {
 					PIXEL11_100
@@ -1811,43 +1814,43 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 253:
 				PIXEL00_12
 				PIXEL01_11
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL10_0
 				} else {
 					PIXEL10_100
 				}
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL11_0
 				} else {
 					PIXEL11_100
 				}
 				break;
 			case 251:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_0
 				} else {
 					PIXEL00_20
 				}
 				PIXEL01_10
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL10_0
 				} else {
 					PIXEL10_100
 				}
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL11_0
 				} else {
 					PIXEL11_20
 				}
 				break;
 			case 239:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_0
 				} else {
 					PIXEL00_100
 				}
 				PIXEL01_12
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL10_0
 				} else {
 					PIXEL10_100
@@ -1855,17 +1858,17 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL11_11
 				break;
 			case 127:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_0
 				} else {
 					PIXEL00_100
 				}
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL01_0
 				} else {
 					PIXEL01_20
 				}
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL10_0
 				} else {
 					PIXEL10_20
@@ -1873,12 +1876,12 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL11_10
 				break;
 			case 191:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_0
 				} else {
 					PIXEL00_100
 				}
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL01_0
 				} else {
 					PIXEL01_100
@@ -1887,18 +1890,18 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL11_12
 				break;
 			case 223:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_0
 				} else {
 					PIXEL00_20
 				}
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL01_0
 				} else {
 					PIXEL01_100
 				}
 				PIXEL10_10
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL11_0
 				} else {
 					PIXEL11_20
@@ -1906,35 +1909,35 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 247:
 				PIXEL00_11
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL01_0
 				} else {
 					PIXEL01_100
 				}
 				PIXEL10_12
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL11_0
 				} else {
 					PIXEL11_100
 				}
 				break;
 			case 255:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_0
 				} else {
 					PIXEL00_100
 				}
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL01_0
 				} else {
 					PIXEL01_100
 				}
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL10_0
 				} else {
 					PIXEL10_100
 				}
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL11_0
 				} else {
 					PIXEL11_100
@@ -1959,10 +1962,19 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 
 void HQ2x(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch, int width, int height) {
 	extern int gBitFormat;
+	if (gBitFormat == 8888) {
+		HQ2x_implementation<Graphics::ColorMasks<8888> >(srcPtr, srcPitch, dstPtr, dstPitch, width, height);
+		return;
+	}
+
+#ifdef USE_NASM
+	// The assembly version only handles 16 bit pixels
+	hq2x_16(srcPtr, dstPtr, width, height, srcPitch, dstPitch);
+#else
 	if (gBitFormat == 565)
 		HQ2x_implementation<Graphics::ColorMasks<565> >(srcPtr, srcPitch, dstPtr, dstPitch, width, height);
 	else
 		HQ2x_implementation<Graphics::ColorMasks<555> >(srcPtr, srcPitch, dstPtr, dstPitch, width, height);
+#endif
 }
 
-#endif // Assembly version
@@ -21,6 +21,8 @@
  */
 
 #include "graphics/scaler/intern.h"
+#include "graphics/scaler/hq_simd.h"
+#include "common/util.h"
 
 #ifdef USE_NASM
 // Assembly version of HQ3x
@@ -36,11 +38,7 @@ void hq3x_16(const byte *, byte *, uint32, uint32, uint32, uint32);
 
 }
 
-void HQ3x(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch, int width, int height) {
-	hq3x_16(srcPtr, dstPtr, width, height, srcPitch, dstPitch);
-}
-
-#else
+#endif
 
 #define PIXEL00_1M  *(q) = interpolate16_3_1<ColorMask >(w5, w1);
 #define PIXEL00_1U  *(q) = interpolate16_3_1<ColorMask >(w5, w2);
@@ -96,24 +94,31 @@ void HQ3x(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch,
 #define PIXEL22_5   *(q+2+nextlineDst2) = interpolate16_1_1<ColorMask >(w6, w8);
 #define PIXEL22_C   *(q+2+nextlineDst2) = w5;
 
-extern "C" uint32   *RGBtoYUV;
-#define YUV(x)	RGBtoYUV[w ## x]
+// Whether two direct neighbours differ from each other, see hq_simd.h
+#define DIFF_2_6	(code & kHQDiff26)
+#define DIFF_4_2	(code & kHQDiff42)
+#define DIFF_6_8	(code & kHQDiff68)
+#define DIFF_8_4	(code & kHQDiff84)
 
 /*
  * The HQ3x high quality 3x graphics filter.
  * Original author Maxim Stepin (see http://www.hiend3d.com/hq3x.html).
- * Adapted for ScummVM to 16 bit output and optimized by Max Horn.
+ * Adapted for ScummVM to 16 and 32 bit output and optimized by Max Horn.
  */
 template<typename ColorMask>
 static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch, int width, int height) {
 	int  w1, w2, w3, w4, w5, w6, w7, w8, w9;
 
-	const uint32 nextlineSrc = srcPitch / sizeof(uint16);
-	const uint16 *p = (const uint16 *)srcPtr;
+	typedef typename ColorMask::PixelType Pixel;
+
+	const uint32 nextlineSrc = srcPitch / sizeof(Pixel);
+	const Pixel *p = (const Pixel *)srcPtr;
 
-	const uint32 nextlineDst = dstPitch / sizeof(uint16);
+	uint16 codes[kHQMaxClassifyWidth];
+
+	const uint32 nextlineDst = dstPitch / sizeof(Pixel);
 	const uint32 nextlineDst2 = 2 * nextlineDst;
-	uint16 *q = (uint16 *)dstPtr;
+	Pixel *q = (Pixel *)dstPtr;
 
 	//	 +----+----+----+
 	//	 |    |    |    |
@@ -136,25 +141,23 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 		w8 = *(p + nextlineSrc);
 
 		int tmpWidth = width;
+		int run = 0, runWidth = 0;
 		while (tmpWidth--) {
+			// Classify the next run of pixels
+			if (run == runWidth) {
+				runWidth = MIN<int>(tmpWidth + 1, kHQMaxClassifyWidth);
+				classifyHQRun(p, nextlineSrc, codes, runWidth);
+				run = 0;
+			}
+			const int code = codes[run++];
+
 			p++;
 
 			w3 = *(p - nextlineSrc);
 			w6 = *(p);
 			w9 = *(p + nextlineSrc);
 
-			int pattern = 0;
-			const int yuv5 = YUV(5);
-			if (w5 != w1 && diffYUV(yuv5, YUV(1))) pattern |= 0x0001;
-			if (w5 != w2 && diffYUV(yuv5, YUV(2))) pattern |= 0x0002;
-			if (w5 != w3 && diffYUV(yuv5, YUV(3))) pattern |= 0x0004;
-			if (w5 != w4 && diffYUV(yuv5, YUV(4))) pattern |= 0x0008;
-			if (w5 != w6 && diffYUV(yuv5, YUV(6))) pattern |= 0x0010;
-			if (w5 != w7 && diffYUV(yuv5, YUV(7))) pattern |= 0x0020;
-			if (w5 != w8 && diffYUV(yuv5, YUV(8))) pattern |= 0x0040;
-			if (w5 != w9 && diffYUV(yuv5, YUV(9))) pattern |= 0x0080;
-
-			switch (pattern) {
+			switch (code & kHQPatternMask) {
 			case 0:
 			case 1:
 			case 4:
@@ -352,7 +355,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 18:
 			case 50:
 				PIXEL00_1M
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL01_C
 					PIXEL02_1M
 					PIXEL12_C
@@ -375,7 +378,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL10_1
 				PIXEL11
 				PIXEL20_1M
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL12_C
 					PIXEL21_C
 					PIXEL22_1M
@@ -392,7 +395,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL02_2
 				PIXEL11
 				PIXEL12_1
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL10_C
 					PIXEL20_1M
 					PIXEL21_C
@@ -405,7 +408,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 10:
 			case 138:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_1M
 					PIXEL01_C
 					PIXEL10_C
@@ -498,7 +501,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 22:
 			case 54:
 				PIXEL00_1M
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL01_C
 					PIXEL02_C
 					PIXEL12_C
@@ -521,7 +524,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL10_1
 				PIXEL11
 				PIXEL20_1M
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL12_C
 					PIXEL21_C
 					PIXEL22_C
@@ -538,7 +541,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL02_2
 				PIXEL11
 				PIXEL12_1
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL10_C
 					PIXEL20_C
 					PIXEL21_C
@@ -551,7 +554,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 11:
 			case 139:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_C
 					PIXEL01_C
 					PIXEL10_C
@@ -569,7 +572,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 19:
 			case 51:
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL00_1L
 					PIXEL01_C
 					PIXEL02_1M
@@ -588,7 +591,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 146:
 			case 178:
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL01_C
 					PIXEL02_1M
 					PIXEL12_C
@@ -607,7 +610,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 84:
 			case 85:
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL02_1U
 					PIXEL12_C
 					PIXEL21_C
@@ -626,7 +629,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 112:
 			case 113:
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL12_C
 					PIXEL20_1L
 					PIXEL21_C
@@ -645,7 +648,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 200:
 			case 204:
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL10_C
 					PIXEL20_1M
 					PIXEL21_C
@@ -664,7 +667,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 73:
 			case 77:
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL00_1U
 					PIXEL10_C
 					PIXEL20_1M
@@ -683,7 +686,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 42:
 			case 170:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_1M
 					PIXEL01_C
 					PIXEL10_C
@@ -702,7 +705,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 14:
 			case 142:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_1M
 					PIXEL01_C
 					PIXEL02_1R
@@ -809,7 +812,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 26:
 			case 31:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_C
 					PIXEL10_C
 				} else {
@@ -817,7 +820,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 					PIXEL10_3
 				}
 				PIXEL01_C
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL02_C
 					PIXEL12_C
 				} else {
@@ -832,7 +835,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 82:
 			case 214:
 				PIXEL00_1M
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL01_C
 					PIXEL02_C
 				} else {
@@ -843,7 +846,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL11
 				PIXEL12_C
 				PIXEL20_1M
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL21_C
 					PIXEL22_C
 				} else {
@@ -857,7 +860,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL01_1
 				PIXEL02_1M
 				PIXEL11
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL10_C
 					PIXEL20_C
 				} else {
@@ -865,7 +868,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 					PIXEL20_4
 				}
 				PIXEL21_C
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL12_C
 					PIXEL22_C
 				} else {
@@ -875,7 +878,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 74:
 			case 107:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_C
 					PIXEL01_C
 				} else {
@@ -886,7 +889,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL10_C
 				PIXEL11
 				PIXEL12_1
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL20_C
 					PIXEL21_C
 				} else {
@@ -896,7 +899,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL22_1M
 				break;
 			case 27:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_C
 					PIXEL01_C
 					PIXEL10_C
@@ -914,7 +917,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 86:
 				PIXEL00_1M
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL01_C
 					PIXEL02_C
 					PIXEL12_C
@@ -936,7 +939,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL10_C
 				PIXEL11
 				PIXEL20_1M
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL12_C
 					PIXEL21_C
 					PIXEL22_C
@@ -952,7 +955,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL02_1M
 				PIXEL11
 				PIXEL12_1
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL10_C
 					PIXEL20_C
 					PIXEL21_C
@@ -965,7 +968,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 30:
 				PIXEL00_1M
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL01_C
 					PIXEL02_C
 					PIXEL12_C
@@ -987,7 +990,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL10_1
 				PIXEL11
 				PIXEL20_1M
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL12_C
 					PIXEL21_C
 					PIXEL22_C
@@ -1003,7 +1006,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL02_1M
 				PIXEL11
 				PIXEL12_C
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL10_C
 					PIXEL20_C
 					PIXEL21_C
@@ -1015,7 +1018,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL22_1M
 				break;
 			case 75:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_C
 					PIXEL01_C
 					PIXEL10_C
@@ -1164,13 +1167,13 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL22_1D
 				break;
 			case 58:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_1M
 				} else {
 					PIXEL00_2
 				}
 				PIXEL01_C
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL02_1M
 				} else {
 					PIXEL02_2
@@ -1185,7 +1188,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 83:
 				PIXEL00_1L
 				PIXEL01_C
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL02_1M
 				} else {
 					PIXEL02_2
@@ -1195,7 +1198,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL12_C
 				PIXEL20_1M
 				PIXEL21_C
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL22_1M
 				} else {
 					PIXEL22_2
@@ -1208,20 +1211,20 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL10_C
 				PIXEL11
 				PIXEL12_C
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL20_1M
 				} else {
 					PIXEL20_2
 				}
 				PIXEL21_C
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL22_1M
 				} else {
 					PIXEL22_2
 				}
 				break;
 			case 202:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_1M
 				} else {
 					PIXEL00_2
@@ -1231,7 +1234,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL10_C
 				PIXEL11
 				PIXEL12_1
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL20_1M
 				} else {
 					PIXEL20_2
@@ -1240,7 +1243,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL22_1R
 				break;
 			case 78:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_1M
 				} else {
 					PIXEL00_2
@@ -1250,7 +1253,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL10_C
 				PIXEL11
 				PIXEL12_1
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL20_1M
 				} else {
 					PIXEL20_2
@@ -1259,13 +1262,13 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL22_1M
 				break;
 			case 154:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_1M
 				} else {
 					PIXEL00_2
 				}
 				PIXEL01_C
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL02_1M
 				} else {
 					PIXEL02_2
@@ -1280,7 +1283,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 114:
 				PIXEL00_1M
 				PIXEL01_C
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL02_1M
 				} else {
 					PIXEL02_2
@@ -1290,7 +1293,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL12_C
 				PIXEL20_1L
 				PIXEL21_C
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL22_1M
 				} else {
 					PIXEL22_2
@@ -1303,26 +1306,26 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL10_C
 				PIXEL11
 				PIXEL12_C
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL20_1M
 				} else {
 					PIXEL20_2
 				}
 				PIXEL21_C
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL22_1M
 				} else {
 					PIXEL22_2
 				}
 				break;
 			case 90:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_1M
 				} else {
 					PIXEL00_2
 				}
 				PIXEL01_C
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL02_1M
 				} else {
 					PIXEL02_2
@@ -1330,13 +1333,13 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL10_C
 				PIXEL11
 				PIXEL12_C
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL20_1M
 				} else {
 					PIXEL20_2
 				}
 				PIXEL21_C
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL22_1M
 				} else {
 					PIXEL22_2
@@ -1344,7 +1347,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 55:
 			case 23:
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL00_1L
 					PIXEL01_C
 					PIXEL02_C
@@ -1363,7 +1366,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 182:
 			case 150:
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL01_C
 					PIXEL02_C
 					PIXEL12_C
@@ -1382,7 +1385,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 213:
 			case 212:
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL02_1U
 					PIXEL12_C
 					PIXEL21_C
@@ -1401,7 +1404,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 241:
 			case 240:
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL12_C
 					PIXEL20_1L
 					PIXEL21_C
@@ -1420,7 +1423,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 236:
 			case 232:
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL10_C
 					PIXEL20_C
 					PIXEL21_C
@@ -1439,7 +1442,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 109:
 			case 105:
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL00_1U
 					PIXEL10_C
 					PIXEL20_C
@@ -1458,7 +1461,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 171:
 			case 43:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_C
 					PIXEL01_C
 					PIXEL10_C
@@ -1477,7 +1480,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 143:
 			case 15:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_C
 					PIXEL01_C
 					PIXEL02_1R
@@ -1500,7 +1503,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL02_1U
 				PIXEL11
 				PIXEL12_C
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL10_C
 					PIXEL20_C
 					PIXEL21_C
@@ -1512,7 +1515,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL22_1M
 				break;
 			case 203:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_C
 					PIXEL01_C
 					PIXEL10_C
@@ -1530,7 +1533,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 62:
 				PIXEL00_1M
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL01_C
 					PIXEL02_C
 					PIXEL12_C
@@ -1552,7 +1555,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL10_1
 				PIXEL11
 				PIXEL20_1M
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL12_C
 					PIXEL21_C
 					PIXEL22_C
@@ -1564,7 +1567,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 118:
 				PIXEL00_1M
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL01_C
 					PIXEL02_C
 					PIXEL12_C
@@ -1586,7 +1589,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL10_C
 				PIXEL11
 				PIXEL20_1M
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL12_C
 					PIXEL21_C
 					PIXEL22_C
@@ -1602,7 +1605,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL02_1R
 				PIXEL11
 				PIXEL12_1
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL10_C
 					PIXEL20_C
 					PIXEL21_C
@@ -1614,7 +1617,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL22_1M
 				break;
 			case 155:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_C
 					PIXEL01_C
 					PIXEL10_C
@@ -1724,12 +1727,12 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL02_1U
 				PIXEL10_C
 				PIXEL11
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL20_1M
 				} else {
 					PIXEL20_2
 				}
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL12_C
 					PIXEL21_C
 					PIXEL22_C
@@ -1740,12 +1743,12 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				}
 				break;
 			case 158:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_1M
 				} else {
 					PIXEL00_2
 				}
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL01_C
 					PIXEL02_C
 					PIXEL12_C
@@ -1761,7 +1764,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL22_1D
 				break;
 			case 234:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_1M
 				} else {
 					PIXEL00_2
@@ -1770,7 +1773,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL02_1M
 				PIXEL11
 				PIXEL12_1
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL10_C
 					PIXEL20_C
 					PIXEL21_C
@@ -1784,7 +1787,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 242:
 				PIXEL00_1M
 				PIXEL01_C
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL02_1M
 				} else {
 					PIXEL02_2
@@ -1792,7 +1795,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL10_1
 				PIXEL11
 				PIXEL20_1L
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL12_C
 					PIXEL21_C
 					PIXEL22_C
@@ -1803,7 +1806,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				}
 				break;
 			case 59:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_C
 					PIXEL01_C
 					PIXEL10_C
@@ -1812,7 +1815,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 					PIXEL01_3
 					PIXEL10_3
 				}
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL02_1M
 				} else {
 					PIXEL02_2
@@ -1829,7 +1832,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL02_1M
 				PIXEL11
 				PIXEL12_C
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL10_C
 					PIXEL20_C
 					PIXEL21_C
@@ -1838,7 +1841,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 					PIXEL20_4
 					PIXEL21_3
 				}
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL22_1M
 				} else {
 					PIXEL22_2
@@ -1846,7 +1849,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 87:
 				PIXEL00_1L
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL01_C
 					PIXEL02_C
 					PIXEL12_C
@@ -1859,14 +1862,14 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL11
 				PIXEL20_1M
 				PIXEL21_C
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL22_1M
 				} else {
 					PIXEL22_2
 				}
 				break;
 			case 79:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_C
 					PIXEL01_C
 					PIXEL10_C
@@ -1878,7 +1881,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL02_1R
 				PIXEL11
 				PIXEL12_1
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL20_1M
 				} else {
 					PIXEL20_2
@@ -1887,20 +1890,20 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL22_1M
 				break;
 			case 122:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_1M
 				} else {
 					PIXEL00_2
 				}
 				PIXEL01_C
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL02_1M
 				} else {
 					PIXEL02_2
 				}
 				PIXEL11
 				PIXEL12_C
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL10_C
 					PIXEL20_C
 					PIXEL21_C
@@ -1909,19 +1912,19 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 					PIXEL20_4
 					PIXEL21_3
 				}
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL22_1M
 				} else {
 					PIXEL22_2
 				}
 				break;
 			case 94:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_1M
 				} else {
 					PIXEL00_2
 				}
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL01_C
 					PIXEL02_C
 					PIXEL12_C
@@ -1932,38 +1935,38 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				}
 				PIXEL10_C
 				PIXEL11
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL20_1M
 				} else {
 					PIXEL20_2
 				}
 				PIXEL21_C
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL22_1M
 				} else {
 					PIXEL22_2
 				}
 				break;
 			case 218:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_1M
 				} else {
 					PIXEL00_2
 				}
 				PIXEL01_C
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL02_1M
 				} else {
 					PIXEL02_2
 				}
 				PIXEL10_C
 				PIXEL11
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL20_1M
 				} else {
 					PIXEL20_2
 				}
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL12_C
 					PIXEL21_C
 					PIXEL22_C
@@ -1974,7 +1977,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				}
 				break;
 			case 91:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_C
 					PIXEL01_C
 					PIXEL10_C
@@ -1983,20 +1986,20 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 					PIXEL01_3
 					PIXEL10_3
 				}
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL02_1M
 				} else {
 					PIXEL02_2
 				}
 				PIXEL11
 				PIXEL12_C
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL20_1M
 				} else {
 					PIXEL20_2
 				}
 				PIXEL21_C
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL22_1M
 				} else {
 					PIXEL22_2
@@ -2047,13 +2050,13 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL22_1D
 				break;
 			case 186:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_1M
 				} else {
 					PIXEL00_2
 				}
 				PIXEL01_C
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL02_1M
 				} else {
 					PIXEL02_2
@@ -2068,7 +2071,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 115:
 				PIXEL00_1L
 				PIXEL01_C
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL02_1M
 				} else {
 					PIXEL02_2
@@ -2078,7 +2081,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL12_C
 				PIXEL20_1L
 				PIXEL21_C
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL22_1M
 				} else {
 					PIXEL22_2
@@ -2091,20 +2094,20 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL10_C
 				PIXEL11
 				PIXEL12_C
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL20_1M
 				} else {
 					PIXEL20_2
 				}
 				PIXEL21_C
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL22_1M
 				} else {
 					PIXEL22_2
 				}
 				break;
 			case 206:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_1M
 				} else {
 					PIXEL00_2
@@ -2114,7 +2117,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL10_C
 				PIXEL11
 				PIXEL12_1
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL20_1M
 				} else {
 					PIXEL20_2
@@ -2130,7 +2133,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL10_C
 				PIXEL11
 				PIXEL12_1
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL20_1M
 				} else {
 					PIXEL20_2
@@ -2140,7 +2143,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 174:
 			case 46:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_1M
 				} else {
 					PIXEL00_2
@@ -2158,7 +2161,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 147:
 				PIXEL00_1L
 				PIXEL01_C
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL02_1M
 				} else {
 					PIXEL02_2
@@ -2180,7 +2183,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL12_C
 				PIXEL20_1L
 				PIXEL21_C
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL22_1M
 				} else {
 					PIXEL22_2
@@ -2210,7 +2213,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 126:
 				PIXEL00_1M
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL01_C
 					PIXEL02_C
 					PIXEL12_C
@@ -2220,7 +2223,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 					PIXEL12_3
 				}
 				PIXEL11
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL10_C
 					PIXEL20_C
 					PIXEL21_C
@@ -2232,7 +2235,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL22_1M
 				break;
 			case 219:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_C
 					PIXEL01_C
 					PIXEL10_C
@@ -2244,7 +2247,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL02_1M
 				PIXEL11
 				PIXEL20_1M
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL12_C
 					PIXEL21_C
 					PIXEL22_C
@@ -2255,7 +2258,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				}
 				break;
 			case 125:
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL00_1U
 					PIXEL10_C
 					PIXEL20_C
@@ -2273,7 +2276,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL22_1M
 				break;
 			case 221:
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL02_1U
 					PIXEL12_C
 					PIXEL21_C
@@ -2291,7 +2294,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL20_1M
 				break;
 			case 207:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_C
 					PIXEL01_C
 					PIXEL02_1R
@@ -2309,7 +2312,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL22_1R
 				break;
 			case 238:
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL10_C
 					PIXEL20_C
 					PIXEL21_C
@@ -2327,7 +2330,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL12_1
 				break;
 			case 190:
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL01_C
 					PIXEL02_C
 					PIXEL12_C
@@ -2345,7 +2348,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL21_1
 				break;
 			case 187:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_C
 					PIXEL01_C
 					PIXEL10_C
@@ -2363,7 +2366,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL22_1D
 				break;
 			case 243:
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL12_C
 					PIXEL20_1L
 					PIXEL21_C
@@ -2381,7 +2384,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL11
 				break;
 			case 119:
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL00_1L
 					PIXEL01_C
 					PIXEL02_C
@@ -2406,7 +2409,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL10_C
 				PIXEL11
 				PIXEL12_1
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL20_C
 				} else {
 					PIXEL20_2
@@ -2416,7 +2419,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 175:
 			case 47:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_C
 				} else {
 					PIXEL00_2
@@ -2434,7 +2437,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 151:
 				PIXEL00_1L
 				PIXEL01_C
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL02_C
 				} else {
 					PIXEL02_2
@@ -2456,7 +2459,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL12_C
 				PIXEL20_1L
 				PIXEL21_C
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL22_C
 				} else {
 					PIXEL22_2
@@ -2467,7 +2470,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL01_C
 				PIXEL02_1M
 				PIXEL11
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL10_C
 					PIXEL20_C
 				} else {
@@ -2475,7 +2478,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 					PIXEL20_4
 				}
 				PIXEL21_C
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL12_C
 					PIXEL22_C
 				} else {
@@ -2484,7 +2487,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				}
 				break;
 			case 123:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_C
 					PIXEL01_C
 				} else {
@@ -2495,7 +2498,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL10_C
 				PIXEL11
 				PIXEL12_C
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL20_C
 					PIXEL21_C
 				} else {
@@ -2505,7 +2508,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL22_1M
 				break;
 			case 95:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_C
 					PIXEL10_C
 				} else {
@@ -2513,7 +2516,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 					PIXEL10_3
 				}
 				PIXEL01_C
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL02_C
 					PIXEL12_C
 				} else {
@@ -2527,7 +2530,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 222:
 				PIXEL00_1M
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL01_C
 					PIXEL02_C
 				} else {
@@ -2538,7 +2541,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL11
 				PIXEL12_C
 				PIXEL20_1M
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL21_C
 					PIXEL22_C
 				} else {
@@ -2552,7 +2555,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL02_1U
 				PIXEL11
 				PIXEL12_C
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL10_C
 					PIXEL20_C
 				} else {
@@ -2560,7 +2563,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 					PIXEL20_4
 				}
 				PIXEL21_C
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL22_C
 				} else {
 					PIXEL22_2
@@ -2572,13 +2575,13 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL02_1M
 				PIXEL10_C
 				PIXEL11
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL20_C
 				} else {
 					PIXEL20_2
 				}
 				PIXEL21_C
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL12_C
 					PIXEL22_C
 				} else {
@@ -2587,7 +2590,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				}
 				break;
 			case 235:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_C
 					PIXEL01_C
 				} else {
@@ -2598,7 +2601,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL10_C
 				PIXEL11
 				PIXEL12_1
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL20_C
 				} else {
 					PIXEL20_2
@@ -2607,7 +2610,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL22_1R
 				break;
 			case 111:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_C
 				} else {
 					PIXEL00_2
@@ -2617,7 +2620,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL10_C
 				PIXEL11
 				PIXEL12_1
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL20_C
 					PIXEL21_C
 				} else {
@@ -2627,13 +2630,13 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL22_1M
 				break;
 			case 63:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_C
 				} else {
 					PIXEL00_2
 				}
 				PIXEL01_C
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL02_C
 					PIXEL12_C
 				} else {
@@ -2647,7 +2650,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL22_1M
 				break;
 			case 159:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_C
 					PIXEL10_C
 				} else {
@@ -2655,7 +2658,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 					PIXEL10_3
 				}
 				PIXEL01_C
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL02_C
 				} else {
 					PIXEL02_2
@@ -2669,7 +2672,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 215:
 				PIXEL00_1L
 				PIXEL01_C
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL02_C
 				} else {
 					PIXEL02_2
@@ -2678,7 +2681,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL11
 				PIXEL12_C
 				PIXEL20_1M
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL21_C
 					PIXEL22_C
 				} else {
@@ -2688,7 +2691,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 246:
 				PIXEL00_1M
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL01_C
 					PIXEL02_C
 				} else {
@@ -2700,7 +2703,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL12_C
 				PIXEL20_1L
 				PIXEL21_C
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL22_C
 				} else {
 					PIXEL22_2
@@ -2708,7 +2711,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				break;
 			case 254:
 				PIXEL00_1M
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL01_C
 					PIXEL02_C
 				} else {
@@ -2716,14 +2719,14 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 					PIXEL02_4
 				}
 				PIXEL11
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL10_C
 					PIXEL20_C
 				} else {
 					PIXEL10_3
 					PIXEL20_4
 				}
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL12_C
 					PIXEL21_C
 					PIXEL22_C
@@ -2740,20 +2743,20 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL10_C
 				PIXEL11
 				PIXEL12_C
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL20_C
 				} else {
 					PIXEL20_2
 				}
 				PIXEL21_C
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL22_C
 				} else {
 					PIXEL22_2
 				}
 				break;
 			case 251:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_C
 					PIXEL01_C
 				} else {
@@ -2762,7 +2765,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				}
 				PIXEL02_1M
 				PIXEL11
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL10_C
 					PIXEL20_C
 					PIXEL21_C
@@ -2771,7 +2774,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 					PIXEL20_2
 					PIXEL21_3
 				}
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL12_C
 					PIXEL22_C
 				} else {
@@ -2780,7 +2783,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				}
 				break;
 			case 239:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_C
 				} else {
 					PIXEL00_2
@@ -2790,7 +2793,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL10_C
 				PIXEL11
 				PIXEL12_1
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL20_C
 				} else {
 					PIXEL20_2
@@ -2799,7 +2802,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL22_1R
 				break;
 			case 127:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_C
 					PIXEL01_C
 					PIXEL10_C
@@ -2808,7 +2811,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 					PIXEL01_3
 					PIXEL10_3
 				}
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL02_C
 					PIXEL12_C
 				} else {
@@ -2816,7 +2819,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 					PIXEL12_3
 				}
 				PIXEL11
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL20_C
 					PIXEL21_C
 				} else {
@@ -2826,13 +2829,13 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL22_1M
 				break;
 			case 191:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_C
 				} else {
 					PIXEL00_2
 				}
 				PIXEL01_C
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL02_C
 				} else {
 					PIXEL02_2
@@ -2845,14 +2848,14 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL22_1D
 				break;
 			case 223:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_C
 					PIXEL10_C
 				} else {
 					PIXEL00_4
 					PIXEL10_3
 				}
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL01_C
 					PIXEL02_C
 					PIXEL12_C
@@ -2863,7 +2866,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				}
 				PIXEL11
 				PIXEL20_1M
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL21_C
 					PIXEL22_C
 				} else {
@@ -2874,7 +2877,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			case 247:
 				PIXEL00_1L
 				PIXEL01_C
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL02_C
 				} else {
 					PIXEL02_2
@@ -2884,20 +2887,20 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL12_C
 				PIXEL20_1L
 				PIXEL21_C
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL22_C
 				} else {
 					PIXEL22_2
 				}
 				break;
 			case 255:
-				if (diffYUV(YUV(4), YUV(2))) {
+				if (DIFF_4_2) {
 					PIXEL00_C
 				} else {
 					PIXEL00_2
 				}
 				PIXEL01_C
-				if (diffYUV(YUV(2), YUV(6))) {
+				if (DIFF_2_6) {
 					PIXEL02_C
 				} else {
 					PIXEL02_2
@@ -2905,13 +2908,13 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 				PIXEL10_C
 				PIXEL11
 				PIXEL12_C
-				if (diffYUV(YUV(8), YUV(4))) {
+				if (DIFF_8_4) {
 					PIXEL20_C
 				} else {
 					PIXEL20_2
 				}
 				PIXEL21_C
-				if (diffYUV(YUV(6), YUV(8))) {
+				if (DIFF_6_8) {
 					PIXEL22_C
 				} else {
 					PIXEL22_2
@@ -2936,10 +2939,19 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 
 void HQ3x(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch, int width, int height) {
 	extern int gBitFormat;
+	if (gBitFormat == 8888) {
+		HQ3x_implementation<Graphics::ColorMasks<8888> >(srcPtr, srcPitch, dstPtr, dstPitch, width, height);
+		return;
+	}
+
+#ifdef USE_NASM
+	// The assembly version only handles 16 bit pixels
+	hq3x_16(srcPtr, dstPtr, width, height, srcPitch, dstPitch);
+#else
 	if (gBitFormat == 565)
 		HQ3x_implementation<Graphics::ColorMasks<565> >(srcPtr, srcPitch, dstPtr, dstPitch, width, height);
 	else
 		HQ3x_implementation<Graphics::ColorMasks<555> >(srcPtr, srcPitch, dstPtr, dstPitch, width, height);
+#endif
 }
 
-#endif // Assembly version
@@ -0,0 +1,150 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "graphics/scaler/hq_rules.h"
+
+const byte g_hqWeights[16][3] = {
+	{ 0, 0, 0 },
+	{ 0, 1, 1 },
+	{ 0, 2, 0 },
+	{ 0, 0, 4 },
+	{ 0, 2, 2 },
+	{ 0, 4, 0 },
+	{ 4, 0, 0 },
+	{ 0, 2, 4 },
+	{ 0, 4, 2 },
+	{ 0, 4, 4 },
+	{ 4, 0, 4 },
+	{ 4, 4, 0 },
+	{ 0, 6, 6 },
+	{ 0, 12, 0 },
+	{ 0, 7, 7 },
+	{ 0, 8, 8 }
+};
+
+// The rules follow the switch statements in graphics/scaler/hq2x.cpp and
+// graphics/scaler/hq3x.cpp. test/graphics/hq_rules.h checks them against the
+// scalers.
+const HQRule g_hq2xCornerRules[256] = {
+	{ 0, 9, 9 }, { 0, 9, 9 }, { 0, 10, 10 }, { 0, 3, 3 }, { 0, 9, 9 }, { 0, 9, 9 }, { 0, 10, 10 }, { 0, 3, 3 },
+	{ 0, 11, 11 }, { 0, 5, 5 }, { kHQRuleDiff42, 9, 6 }, { kHQRuleDiff42, 9, 0 }, { 0, 11, 11 }, { 0, 5, 5 }, { kHQRuleDiff42, 12, 6 }, { kHQRuleDiff42, 12, 0 },
+	{ 0, 9, 9 }, { 0, 9, 9 }, { 0, 10, 10 }, { kHQRuleDiff26, 8, 3 }, { 0, 9, 9 }, { 0, 9, 9 }, { 0, 10, 10 }, { kHQRuleDiff26, 8, 3 },
+	{ 0, 11, 11 }, { 0, 5, 5 }, { kHQRuleDiff42, 9, 0 }, { kHQRuleDiff42, 9, 0 }, { 0, 11, 11 }, { 0, 5, 5 }, { 0, 6, 6 }, { kHQRuleDiff42, 9, 0 },
+	{ 0, 9, 9 }, { 0, 9, 9 }, { 0, 10, 10 }, { 0, 3, 3 }, { 0, 9, 9 }, { 0, 9, 9 }, { 0, 10, 10 }, { 0, 3, 3 },
+	{ 0, 11, 11 }, { 0, 5, 5 }, { kHQRuleDiff42, 12, 6 }, { kHQRuleDiff42, 12, 0 }, { 0, 11, 11 }, { 0, 5, 5 }, { kHQRuleDiff42, 4, 6 }, { kHQRuleDiff42, 1, 0 },
+	{ 0, 9, 9 }, { 0, 9, 9 }, { 0, 10, 10 }, { kHQRuleDiff26, 8, 3 }, { 0, 9, 9 }, { 0, 9, 9 }, { 0, 10, 10 }, { kHQRuleDiff26, 8, 3 },
+	{ 0, 11, 11 }, { 0, 5, 5 }, { kHQRuleDiff42, 4, 6 }, { kHQRuleDiff42, 9, 0 }, { 0, 11, 11 }, { 0, 5, 5 }, { 0, 6, 6 }, { kHQRuleDiff42, 1, 0 },
+	{ 0, 9, 9 }, { 0, 9, 9 }, { 0, 10, 10 }, { 0, 3, 3 }, { 0, 9, 9 }, { 0, 9, 9 }, { 0, 10, 10 }, { 0, 3, 3 },
+	{ 0, 11, 11 }, { kHQRuleDiff84, 7, 5 }, { kHQRuleDiff42, 9, 0 }, { kHQRuleDiff42, 9, 0 }, { 0, 11, 11 }, { kHQRuleDiff84, 7, 5 }, { kHQRuleDiff42, 4, 6 }, { kHQRuleDiff42, 9, 0 },
+	{ 0, 9, 9 }, { 0, 9, 9 }, { 0, 10, 10 }, { 0, 3, 3 }, { 0, 9, 9 }, { 0, 9, 9 }, { 0, 10, 10 }, { 0, 3, 3 },
+	{ 0, 11, 11 }, { 0, 5, 5 }, { kHQRuleDiff42, 4, 6 }, { kHQRuleDiff42, 9, 0 }, { 0, 11, 11 }, { 0, 5, 5 }, { kHQRuleDiff42, 4, 6 }, { kHQRuleDiff42, 9, 0 },
+	{ 0, 9, 9 }, { 0, 9, 9 }, { 0, 10, 10 }, { 0, 3, 3 }, { 0, 9, 9 }, { 0, 9, 9 }, { 0, 10, 10 }, { 0, 3, 3 },
+	{ 0, 11, 11 }, { kHQRuleDiff84, 7, 5 }, { 0, 6, 6 }, { kHQRuleDiff42, 9, 0 }, { 0, 11, 11 }, { kHQRuleDiff84, 7, 5 }, { 0, 6, 6 }, { kHQRuleDiff42, 1, 0 },
+	{ 0, 9, 9 }, { 0, 9, 9 }, { 0, 10, 10 }, { 0, 3, 3 }, { 0, 9, 9 }, { 0, 9, 9 }, { 0, 10, 10 }, { kHQRuleDiff26, 8, 3 },
+	{ 0, 11, 11 }, { 0, 5, 5 }, { kHQRuleDiff42, 4, 6 }, { kHQRuleDiff42, 9, 0 }, { 0, 11, 11 }, { kHQRuleDiff84, 7, 5 }, { 0, 6, 6 }, { kHQRuleDiff42, 1, 0 },
+	{ 0, 9, 9 }, { 0, 9, 9 }, { 0, 10, 10 }, { 0, 3, 3 }, { 0, 9, 9 }, { 0, 9, 9 }, { 0, 10, 10 }, { 0, 3, 3 },
+	{ 0, 11, 11 }, { 0, 5, 5 }, { kHQRuleDiff42, 9, 6 }, { kHQRuleDiff42, 9, 0 }, { 0, 11, 11 }, { 0, 5, 5 }, { kHQRuleDiff42, 12, 6 }, { kHQRuleDiff42, 12, 0 },
+	{ 0, 9, 9 }, { 0, 9, 9 }, { 0, 10, 10 }, { 0, 3, 3 }, { 0, 9, 9 }, { 0, 9, 9 }, { 0, 10, 10 }, { 0, 3, 3 },
+	{ 0, 11, 11 }, { 0, 5, 5 }, { kHQRuleDiff42, 4, 6 }, { kHQRuleDiff42, 9, 0 }, { 0, 11, 11 }, { 0, 5, 5 }, { kHQRuleDiff42, 4, 6 }, { kHQRuleDiff42, 9, 0 },
+	{ 0, 9, 9 }, { 0, 9, 9 }, { 0, 10, 10 }, { 0, 3, 3 }, { 0, 9, 9 }, { 0, 9, 9 }, { 0, 10, 10 }, { 0, 3, 3 },
+	{ 0, 11, 11 }, { 0, 5, 5 }, { kHQRuleDiff42, 12, 6 }, { kHQRuleDiff42, 12, 0 }, { 0, 11, 11 }, { 0, 5, 5 }, { kHQRuleDiff42, 4, 6 }, { kHQRuleDiff42, 1, 0 },
+	{ 0, 9, 9 }, { 0, 9, 9 }, { 0, 10, 10 }, { 0, 3, 3 }, { 0, 9, 9 }, { 0, 9, 9 }, { 0, 10, 10 }, { 0, 3, 3 },
+	{ 0, 11, 11 }, { 0, 5, 5 }, { kHQRuleDiff42, 4, 6 }, { kHQRuleDiff42, 12, 0 }, { 0, 11, 11 }, { 0, 5, 5 }, { 0, 6, 6 }, { kHQRuleDiff42, 1, 0 },
+	{ 0, 9, 9 }, { 0, 9, 9 }, { 0, 10, 10 }, { 0, 3, 3 }, { 0, 9, 9 }, { 0, 9, 9 }, { 0, 10, 10 }, { 0, 3, 3 },
+	{ 0, 11, 11 }, { 0, 5, 5 }, { kHQRuleDiff42, 4, 6 }, { kHQRuleDiff42, 9, 0 }, { 0, 11, 11 }, { 0, 5, 5 }, { kHQRuleDiff42, 4, 6 }, { kHQRuleDiff42, 12, 0 },
+	{ 0, 9, 9 }, { 0, 9, 9 }, { 0, 10, 10 }, { 0, 3, 3 }, { 0, 9, 9 }, { 0, 9, 9 }, { 0, 10, 10 }, { 0, 3, 3 },
+	{ 0, 11, 11 }, { 0, 5, 5 }, { kHQRuleDiff42, 4, 6 }, { kHQRuleDiff42, 9, 0 }, { 0, 11, 11 }, { 0, 5, 5 }, { 0, 6, 6 }, { kHQRuleDiff42, 9, 0 },
+	{ 0, 9, 9 }, { 0, 9, 9 }, { 0, 10, 10 }, { 0, 3, 3 }, { 0, 9, 9 }, { 0, 9, 9 }, { 0, 10, 10 }, { 0, 3, 3 },
+	{ 0, 11, 11 }, { 0, 5, 5 }, { kHQRuleDiff42, 4, 6 }, { kHQRuleDiff42, 9, 0 }, { 0, 11, 11 }, { 0, 5, 5 }, { 0, 6, 6 }, { kHQRuleDiff42, 1, 0 },
+	{ 0, 9, 9 }, { 0, 9, 9 }, { 0, 10, 10 }, { 0, 3, 3 }, { 0, 9, 9 }, { 0, 9, 9 }, { 0, 10, 10 }, { 0, 3, 3 },
+	{ 0, 11, 11 }, { 0, 5, 5 }, { 0, 6, 6 }, { kHQRuleDiff42, 9, 0 }, { 0, 11, 11 }, { 0, 5, 5 }, { 0, 6, 6 }, { kHQRuleDiff42, 1, 0 }
+};
+
+const HQRule g_hq3xCornerRules[256] = {
+	{ 0, 9, 9 }, { 0, 9, 9 }, { 0, 6, 6 }, { 0, 3, 3 }, { 0, 9, 9 }, { 0, 9, 9 }, { 0, 6, 6 }, { 0, 3, 3 },
+	{ 0, 6, 6 }, { 0, 5, 5 }, { kHQRuleDiff42, 14, 6 }, { kHQRuleDiff42, 14, 0 }, { 0, 6, 6 }, { 0, 5, 5 }, { kHQRuleDiff42, 15, 6 }, { kHQRuleDiff42, 15, 0 },
+	{ 0, 9, 9 }, { 0, 9, 9 }, { 0, 6, 6 }, { kHQRuleDiff26, 9, 3 }, { 0, 9, 9 }, { 0, 9, 9 }, { 0, 6, 6 }, { kHQRuleDiff26, 9, 3 },
+	{ 0, 6, 6 }, { 0, 5, 5 }, { kHQRuleDiff42, 14, 0 }, { kHQRuleDiff42, 14, 0 }, { 0, 6, 6 }, { 0, 5, 5 }, { 0, 6, 6 }, { kHQRuleDiff42, 14, 0 },
+	{ 0, 9, 9 }, { 0, 9, 9 }, { 0, 6, 6 }, { 0, 3, 3 }, { 0, 9, 9 }, { 0, 9, 9 }, { 0, 6, 6 }, { 0, 3, 3 },
+	{ 0, 6, 6 }, { 0, 5, 5 }, { kHQRuleDiff42, 15, 6 }, { kHQRuleDiff42, 15, 0 }, { 0, 6, 6 }, { 0, 5, 5 }, { kHQRuleDiff42, 9, 6 }, { kHQRuleDiff42, 9, 0 },
+	{ 0, 9, 9 }, { 0, 9, 9 }, { 0, 6, 6 }, { kHQRuleDiff26, 9, 3 }, { 0, 9, 9 }, { 0, 9, 9 }, { 0, 6, 6 }, { kHQRuleDiff26, 9, 3 },
+	{ 0, 6, 6 }, { 0, 5, 5 }, { kHQRuleDiff42, 9, 6 }, { kHQRuleDiff42, 14, 0 }, { 0, 6, 6 }, { 0, 5, 5 }, { 0, 6, 6 }, { kHQRuleDiff42, 9, 0 },
+	{ 0, 9, 9 }, { 0, 9, 9 }, { 0, 6, 6 }, { 0, 3, 3 }, { 0, 9, 9 }, { 0, 9, 9 }, { 0, 6, 6 }, { 0, 3, 3 },
+	{ 0, 6, 6 }, { kHQRuleDiff84, 9, 5 }, { kHQRuleDiff42, 14, 0 }, { kHQRuleDiff42, 14, 0 }, { 0, 6, 6 }, { kHQRuleDiff84, 9, 5 }, { kHQRuleDiff42, 9, 6 }, { kHQRuleDiff42, 14, 0 },
+	{ 0, 9, 9 }, { 0, 9, 9 }, { 0, 6, 6 }, { 0, 3, 3 }, { 0, 9, 9 }, { 0, 9, 9 }, { 0, 6, 6 }, { 0, 3, 3 },
+	{ 0, 6, 6 }, { 0, 5, 5 }, { kHQRuleDiff42, 9, 6 }, { kHQRuleDiff42, 14, 0 }, { 0, 6, 6 }, { 0, 5, 5 }, { kHQRuleDiff42, 9, 6 }, { kHQRuleDiff42, 14, 0 },
+	{ 0, 9, 9 }, { 0, 9, 9 }, { 0, 6, 6 }, { 0, 3, 3 }, { 0, 9, 9 }, { 0, 9, 9 }, { 0, 6, 6 }, { 0, 3, 3 },
+	{ 0, 6, 6 }, { kHQRuleDiff84, 9, 5 }, { 0, 6, 6 }, { kHQRuleDiff42, 14, 0 }, { 0, 6, 6 }, { kHQRuleDiff84, 9, 5 }, { 0, 6, 6 }, { kHQRuleDiff42, 9, 0 },
+	{ 0, 9, 9 }, { 0, 9, 9 }, { 0, 6, 6 }, { 0, 3, 3 }, { 0, 9, 9 }, { 0, 9, 9 }, { 0, 6, 6 }, { kHQRuleDiff26, 9, 3 },
+	{ 0, 6, 6 }, { 0, 5, 5 }, { kHQRuleDiff42, 9, 6 }, { kHQRuleDiff42, 14, 0 }, { 0, 6, 6 }, { kHQRuleDiff84, 9, 5 }, { 0, 6, 6 }, { kHQRuleDiff42, 9, 0 },
+	{ 0, 9, 9 }, { 0, 9, 9 }, { 0, 6, 6 }, { 0, 3, 3 }, { 0, 9, 9 }, { 0, 9, 9 }, { 0, 6, 6 }, { 0, 3, 3 },
+	{ 0, 6, 6 }, { 0, 5, 5 }, { kHQRuleDiff42, 14, 6 }, { kHQRuleDiff42, 14, 0 }, { 0, 6, 6 }, { 0, 5, 5 }, { kHQRuleDiff42, 15, 6 }, { kHQRuleDiff42, 15, 0 },
+	{ 0, 9, 9 }, { 0, 9, 9 }, { 0, 6, 6 }, { 0, 3, 3 }, { 0, 9, 9 }, { 0, 9, 9 }, { 0, 6, 6 }, { 0, 3, 3 },
+	{ 0, 6, 6 }, { 0, 5, 5 }, { kHQRuleDiff42, 9, 6 }, { kHQRuleDiff42, 14, 0 }, { 0, 6, 6 }, { 0, 5, 5 }, { kHQRuleDiff42, 9, 6 }, { kHQRuleDiff42, 14, 0 },
+	{ 0, 9, 9 }, { 0, 9, 9 }, { 0, 6, 6 }, { 0, 3, 3 }, { 0, 9, 9 }, { 0, 9, 9 }, { 0, 6, 6 }, { 0, 3, 3 },
+	{ 0, 6, 6 }, { 0, 5, 5 }, { kHQRuleDiff42, 15, 6 }, { kHQRuleDiff42, 15, 0 }, { 0, 6, 6 }, { 0, 5, 5 }, { kHQRuleDiff42, 9, 6 }, { kHQRuleDiff42, 9, 0 },
+	{ 0, 9, 9 }, { 0, 9, 9 }, { 0, 6, 6 }, { 0, 3, 3 }, { 0, 9, 9 }, { 0, 9, 9 }, { 0, 6, 6 }, { 0, 3, 3 },
+	{ 0, 6, 6 }, { 0, 5, 5 }, { kHQRuleDiff42, 9, 6 }, { kHQRuleDiff42, 15, 0 }, { 0, 6, 6 }, { 0, 5, 5 }, { 0, 6, 6 }, { kHQRuleDiff42, 9, 0 },
+	{ 0, 9, 9 }, { 0, 9, 9 }, { 0, 6, 6 }, { 0, 3, 3 }, { 0, 9, 9 }, { 0, 9, 9 }, { 0, 6, 6 }, { 0, 3, 3 },
+	{ 0, 6, 6 }, { 0, 5, 5 }, { kHQRuleDiff42, 9, 6 }, { kHQRuleDiff42, 14, 0 }, { 0, 6, 6 }, { 0, 5, 5 }, { kHQRuleDiff42, 9, 6 }, { kHQRuleDiff42, 15, 0 },
+	{ 0, 9, 9 }, { 0, 9, 9 }, { 0, 6, 6 }, { 0, 3, 3 }, { 0, 9, 9 }, { 0, 9, 9 }, { 0, 6, 6 }, { 0, 3, 3 },
+	{ 0, 6, 6 }, { 0, 5, 5 }, { kHQRuleDiff42, 9, 6 }, { kHQRuleDiff42, 14, 0 }, { 0, 6, 6 }, { 0, 5, 5 }, { 0, 6, 6 }, { kHQRuleDiff42, 14, 0 },
+	{ 0, 9, 9 }, { 0, 9, 9 }, { 0, 6, 6 }, { 0, 3, 3 }, { 0, 9, 9 }, { 0, 9, 9 }, { 0, 6, 6 }, { 0, 3, 3 },
+	{ 0, 6, 6 }, { 0, 5, 5 }, { kHQRuleDiff42, 9, 6 }, { kHQRuleDiff42, 14, 0 }, { 0, 6, 6 }, { 0, 5, 5 }, { 0, 6, 6 }, { kHQRuleDiff42, 9, 0 },
+	{ 0, 9, 9 }, { 0, 9, 9 }, { 0, 6, 6 }, { 0, 3, 3 }, { 0, 9, 9 }, { 0, 9, 9 }, { 0, 6, 6 }, { 0, 3, 3 },
+	{ 0, 6, 6 }, { 0, 5, 5 }, { 0, 6, 6 }, { kHQRuleDiff42, 14, 0 }, { 0, 6, 6 }, { 0, 5, 5 }, { 0, 6, 6 }, { kHQRuleDiff42, 9, 0 }
+};
+
+const HQRule g_hq3xEdgeRules[256] = {
+	{ 0, 5, 5 }, { 0, 5, 5 }, { 0, 0, 0 }, { 0, 0, 0 }, { 0, 5, 5 }, { 0, 5, 5 }, { 0, 0, 0 }, { 0, 0, 0 },
+	{ 0, 5, 5 }, { 0, 5, 5 }, { kHQRuleDiff42, 2, 0 }, { kHQRuleDiff42, 2, 0 }, { 0, 5, 5 }, { 0, 5, 5 }, { kHQRuleDiff42, 13, 0 }, { kHQRuleDiff42, 13, 0 },
+	{ 0, 5, 5 }, { 0, 5, 5 }, { kHQRuleDiff26, 2, 0 }, { kHQRuleDiff26, 13, 0 }, { 0, 5, 5 }, { 0, 5, 5 }, { kHQRuleDiff26, 2, 0 }, { kHQRuleDiff26, 13, 0 },
+	{ 0, 5, 5 }, { 0, 5, 5 }, { 0, 0, 0 }, { kHQRuleDiff42, 2, 0 }, { 0, 5, 5 }, { 0, 5, 5 }, { kHQRuleDiff26, 2, 0 }, { 0, 0, 0 },
+	{ 0, 5, 5 }, { 0, 5, 5 }, { 0, 0, 0 }, { 0, 0, 0 }, { 0, 5, 5 }, { 0, 5, 5 }, { 0, 0, 0 }, { 0, 0, 0 },
+	{ 0, 5, 5 }, { 0, 5, 5 }, { kHQRuleDiff42, 5, 0 }, { kHQRuleDiff42, 5, 0 }, { 0, 5, 5 }, { 0, 5, 5 }, { 0, 0, 0 }, { 0, 0, 0 },
+	{ 0, 5, 5 }, { 0, 5, 5 }, { kHQRuleDiff26, 2, 0 }, { kHQRuleDiff26, 13, 0 }, { 0, 5, 5 }, { 0, 5, 5 }, { kHQRuleDiff26, 2, 0 }, { kHQRuleDiff26, 13, 0 },
+	{ 0, 5, 5 }, { 0, 5, 5 }, { 0, 0, 0 }, { kHQRuleDiff42, 2, 0 }, { 0, 5, 5 }, { 0, 5, 5 }, { kHQRuleDiff26, 2, 0 }, { 0, 0, 0 },
+	{ 0, 5, 5 }, { 0, 5, 5 }, { 0, 0, 0 }, { 0, 0, 0 }, { 0, 5, 5 }, { 0, 5, 5 }, { 0, 0, 0 }, { 0, 0, 0 },
+	{ 0, 5, 5 }, { 0, 5, 5 }, { kHQRuleDiff42, 2, 0 }, { kHQRuleDiff42, 2, 0 }, { 0, 5, 5 }, { 0, 5, 5 }, { 0, 0, 0 }, { kHQRuleDiff42, 2, 0 },
+	{ 0, 5, 5 }, { 0, 5, 5 }, { kHQRuleDiff26, 2, 0 }, { 0, 0, 0 }, { 0, 5, 5 }, { 0, 5, 5 }, { kHQRuleDiff26, 2, 0 }, { kHQRuleDiff26, 2, 0 },
+	{ 0, 5, 5 }, { 0, 5, 5 }, { 0, 0, 0 }, { kHQRuleDiff42, 2, 0 }, { 0, 5, 5 }, { 0, 5, 5 }, { kHQRuleDiff26, 2, 0 }, { 0, 0, 0 },
+	{ 0, 5, 5 }, { 0, 5, 5 }, { 0, 0, 0 }, { 0, 0, 0 }, { 0, 5, 5 }, { 0, 5, 5 }, { 0, 0, 0 }, { 0, 0, 0 },
+	{ 0, 5, 5 }, { 0, 5, 5 }, { 0, 0, 0 }, { kHQRuleDiff42, 2, 0 }, { 0, 5, 5 }, { 0, 5, 5 }, { 0, 0, 0 }, { 0, 0, 0 },
+	{ 0, 5, 5 }, { 0, 5, 5 }, { 0, 0, 0 }, { 0, 0, 0 }, { 0, 5, 5 }, { 0, 5, 5 }, { kHQRuleDiff26, 2, 0 }, { kHQRuleDiff26, 13, 0 },
+	{ 0, 5, 5 }, { 0, 5, 5 }, { 0, 0, 0 }, { kHQRuleDiff42, 2, 0 }, { 0, 5, 5 }, { 0, 5, 5 }, { kHQRuleDiff26, 2, 0 }, { kHQRuleDiff42, 2, 0 },
+	{ 0, 5, 5 }, { 0, 5, 5 }, { 0, 0, 0 }, { 0, 0, 0 }, { 0, 5, 5 }, { 0, 5, 5 }, { 0, 0, 0 }, { 0, 0, 0 },
+	{ 0, 5, 5 }, { 0, 5, 5 }, { kHQRuleDiff42, 2, 0 }, { kHQRuleDiff42, 2, 0 }, { 0, 5, 5 }, { 0, 5, 5 }, { kHQRuleDiff42, 13, 0 }, { kHQRuleDiff42, 13, 0 },
+	{ 0, 5, 5 }, { 0, 5, 5 }, { kHQRuleDiff26, 5, 0 }, { 0, 0, 0 }, { 0, 5, 5 }, { 0, 5, 5 }, { kHQRuleDiff26, 5, 0 }, { 0, 0, 0 },
+	{ 0, 5, 5 }, { 0, 5, 5 }, { 0, 0, 0 }, { kHQRuleDiff42, 2, 0 }, { 0, 5, 5 }, { 0, 5, 5 }, { kHQRuleDiff26, 2, 0 }, { 0, 0, 0 },
+	{ 0, 5, 5 }, { 0, 5, 5 }, { 0, 0, 0 }, { 0, 0, 0 }, { 0, 5, 5 }, { 0, 5, 5 }, { 0, 0, 0 }, { 0, 0, 0 },
+	{ 0, 5, 5 }, { 0, 5, 5 }, { kHQRuleDiff42, 5, 0 }, { kHQRuleDiff42, 5, 0 }, { 0, 5, 5 }, { 0, 5, 5 }, { 0, 0, 0 }, { 0, 0, 0 },
+	{ 0, 5, 5 }, { 0, 5, 5 }, { kHQRuleDiff26, 5, 0 }, { 0, 0, 0 }, { 0, 5, 5 }, { 0, 5, 5 }, { kHQRuleDiff26, 5, 0 }, { 0, 0, 0 },
+	{ 0, 5, 5 }, { 0, 5, 5 }, { 0, 0, 0 }, { kHQRuleDiff42, 5, 0 }, { 0, 5, 5 }, { 0, 5, 5 }, { kHQRuleDiff26, 5, 0 }, { 0, 0, 0 },
+	{ 0, 5, 5 }, { 0, 5, 5 }, { 0, 0, 0 }, { 0, 0, 0 }, { 0, 5, 5 }, { 0, 5, 5 }, { 0, 0, 0 }, { 0, 0, 0 },
+	{ 0, 5, 5 }, { 0, 5, 5 }, { 0, 0, 0 }, { kHQRuleDiff42, 2, 0 }, { 0, 5, 5 }, { 0, 5, 5 }, { 0, 0, 0 }, { kHQRuleDiff42, 13, 0 },
+	{ 0, 5, 5 }, { 0, 5, 5 }, { 0, 0, 0 }, { 0, 0, 0 }, { 0, 5, 5 }, { 0, 5, 5 }, { kHQRuleDiff26, 2, 0 }, { 0, 0, 0 },
+	{ 0, 5, 5 }, { 0, 5, 5 }, { 0, 0, 0 }, { kHQRuleDiff42, 2, 0 }, { 0, 5, 5 }, { 0, 5, 5 }, { kHQRuleDiff26, 2, 0 }, { kHQRuleDiff26, 2, 0 },
+	{ 0, 5, 5 }, { 0, 5, 5 }, { 0, 0, 0 }, { 0, 0, 0 }, { 0, 5, 5 }, { 0, 5, 5 }, { 0, 0, 0 }, { 0, 0, 0 },
+	{ 0, 5, 5 }, { 0, 5, 5 }, { 0, 0, 0 }, { kHQRuleDiff42, 2, 0 }, { 0, 5, 5 }, { 0, 5, 5 }, { 0, 0, 0 }, { 0, 0, 0 },
+	{ 0, 5, 5 }, { 0, 5, 5 }, { 0, 0, 0 }, { 0, 0, 0 }, { 0, 5, 5 }, { 0, 5, 5 }, { kHQRuleDiff26, 2, 0 }, { 0, 0, 0 },
+	{ 0, 5, 5 }, { 0, 5, 5 }, { 0, 0, 0 }, { kHQRuleDiff42, 2, 0 }, { 0, 5, 5 }, { 0, 5, 5 }, { kHQRuleDiff26, 2, 0 }, { 0, 0, 0 }
+};
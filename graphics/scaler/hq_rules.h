@@ -0,0 +1,87 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef GRAPHICS_SCALER_HQ_RULES_H
+#define GRAPHICS_SCALER_HQ_RULES_H
+
+#include "common/scummsys.h"
+
+/**
+ * The interpolation rules of the HQ2x and HQ3x scalers as tables, for
+ * implementations which cannot run the switch statements of
+ * graphics/scaler/hq2x.cpp and graphics/scaler/hq3x.cpp, like shaders.
+ *
+ * The tables cover w5 in the top left corner of the output block and, for
+ * HQ3x, at its top edge. The other output pixels use the same rules on the
+ * neighbourhood rotated or mirrored accordingly.
+ */
+
+/**
+ * Differences between the direct neighbours, numbered like the pixels
+ * around the source pixel w5:
+ *
+ *   w1 w2 w3
+ *   w4 w5 w6
+ *   w7 w8 w9
+ */
+enum {
+	kHQRuleDiff26 = 1 << 0,
+	kHQRuleDiff42 = 1 << 1,
+	kHQRuleDiff68 = 1 << 2,
+	kHQRuleDiff84 = 1 << 3
+};
+
+/**
+ * The weights of the corner neighbour w1, the vertical neighbour w2 and the
+ * horizontal neighbour w4 in 16ths. w5 gets the remaining weight.
+ */
+extern const byte g_hqWeights[16][3];
+
+/**
+ * A rule of the HQ scalers for one pattern. The pattern has a bit set for
+ * each neighbour which differs from w5, from w1 in bit 0 to w9 in bit 7.
+ * The weights depend on at most one difference between direct neighbours.
+ */
+struct HQRule {
+	byte diff;
+	byte weights;
+	byte weightsIfDiff;
+};
+
+/** The rules for w5 in the top left corner of the HQ2x output block. */
+extern const HQRule g_hq2xCornerRules[256];
+
+/** The rules for w5 in the top left corner of the HQ3x output block. */
+extern const HQRule g_hq3xCornerRules[256];
+
+/** The rules for w5 at the top edge of the HQ3x output block. */
+extern const HQRule g_hq3xEdgeRules[256];
+
+/**
+ * Returns the weights of a rule for the given differences between the
+ * direct neighbours, a combination of the kHQRuleDiff values.
+ */
+inline const byte *getHQRuleWeights(const HQRule &rule, uint diffs) {
+	return g_hqWeights[(diffs & rule.diff) ? rule.weightsIfDiff : rule.weights];
+}
+
+#endif
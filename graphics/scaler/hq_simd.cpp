@@ -0,0 +1,362 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "graphics/scaler/hq_simd.h"
+#include "graphics/scaler/intern.h"
+#include "common/simd.h"
+
+extern "C" uint32 *RGBtoYUV;
+
+/*
+ * The classification works on rows of YUV values: the row above, the row
+ * of the pixels and the row below, each starting one pixel left of the
+ * run. For 16 bit pixels they are taken from the RGBtoYUV table, for 32 bit
+ * pixels they are computed on the fly with the same formula.
+ *
+ * The Y, U and V values are at most 191, so they never overflow into each
+ * other. Comparing two YUV values with diffYUV() therefore is the same as
+ * taking the absolute difference of each byte, and checking whether any
+ * of them exceeds the thresholds Y 48, U 7 and V 6.
+ */
+
+typedef uint32 YUVRows[3][kHQMaxClassifyWidth + 2];
+
+static const uint32 kYUVThresholds = 0x00300706;
+
+static inline void fillYUVRows(const uint16 *src, uint32 nextlineSrc, YUVRows &yuv, int width) {
+	for (int row = 0; row < 3; ++row) {
+		const uint16 *p = src + (row - 1) * (int)nextlineSrc - 1;
+		for (int i = 0; i < width + 2; ++i)
+			yuv[row][i] = RGBtoYUV[p[i]];
+	}
+}
+
+static inline void fillYUVRows(const uint32 *src, uint32 nextlineSrc, YUVRows &yuv, int width) {
+	for (int row = 0; row < 3; ++row) {
+		const uint32 *p = src + (row - 1) * (int)nextlineSrc - 1;
+		for (int i = 0; i < width + 2; ++i) {
+			const int r = (p[i] >> Graphics::ColorMasks<8888>::kRedShift) & 0xFF;
+			const int g = (p[i] >> Graphics::ColorMasks<8888>::kGreenShift) & 0xFF;
+			const int b = (p[i] >> Graphics::ColorMasks<8888>::kBlueShift) & 0xFF;
+
+			const int Y = (r + g + b) >> 2;
+			const int u = 128 + ((r - b) >> 2);
+			const int v = 128 + ((-r + 2 * g - b) >> 3);
+			yuv[row][i] = (Y << 16) | (u << 8) | v;
+		}
+	}
+}
+
+static inline uint16 classifyPixel(const YUVRows &yuv, int i) {
+	// The neighbours w1 to w9, as in the scalers
+	const int y1 = yuv[0][i], y2 = yuv[0][i + 1], y3 = yuv[0][i + 2];
+	const int y4 = yuv[1][i], y5 = yuv[1][i + 1], y6 = yuv[1][i + 2];
+	const int y7 = yuv[2][i], y8 = yuv[2][i + 1], y9 = yuv[2][i + 2];
+
+	uint16 code = 0;
+	if (y5 != y1 && diffYUV(y5, y1)) code |= 0x0001;
+	if (y5 != y2 && diffYUV(y5, y2)) code |= 0x0002;
+	if (y5 != y3 && diffYUV(y5, y3)) code |= 0x0004;
+	if (y5 != y4 && diffYUV(y5, y4)) code |= 0x0008;
+	if (y5 != y6 && diffYUV(y5, y6)) code |= 0x0010;
+	if (y5 != y7 && diffYUV(y5, y7)) code |= 0x0020;
+	if (y5 != y8 && diffYUV(y5, y8)) code |= 0x0040;
+	if (y5 != y9 && diffYUV(y5, y9)) code |= 0x0080;
+
+	if (y2 != y6 && diffYUV(y2, y6)) code |= kHQDiff26;
+	if (y4 != y2 && diffYUV(y4, y2)) code |= kHQDiff42;
+	if (y6 != y8 && diffYUV(y6, y8)) code |= kHQDiff68;
+	if (y8 != y4 && diffYUV(y8, y4)) code |= kHQDiff84;
+	return code;
+}
+
+template<typename Pixel>
+static void classifyScalar(const Pixel *src, uint32 nextlineSrc, uint16 *codes, int width) {
+	YUVRows yuv;
+	fillYUVRows(src, nextlineSrc, yuv, width);
+
+	for (int i = 0; i < width; ++i)
+		codes[i] = classifyPixel(yuv, i);
+}
+
+#ifdef SCUMMVM_SIMD_X86
+
+/**
+ * Returns bit in the lanes where the YUV values differ, 0 elsewhere.
+ */
+SIMD_TARGET("sse2")
+static inline __m128i diffYUVSSE2(__m128i a, __m128i b, __m128i thresholds, __m128i bit) {
+	const __m128i diff = _mm_or_si128(_mm_subs_epu8(a, b), _mm_subs_epu8(b, a));
+	const __m128i same = _mm_cmpeq_epi32(_mm_subs_epu8(diff, thresholds), _mm_setzero_si128());
+	return _mm_andnot_si128(same, bit);
+}
+
+template<typename Pixel>
+SIMD_TARGET("sse2")
+static void classifySSE2(const Pixel *src, uint32 nextlineSrc, uint16 *codes, int width) {
+	YUVRows yuv;
+	fillYUVRows(src, nextlineSrc, yuv, width);
+
+	const __m128i thresholds = _mm_set1_epi32(kYUVThresholds);
+	int i = 0;
+
+	// 4 pixels per iteration
+	for (; i + 4 <= width; i += 4) {
+		const __m128i y1 = _mm_loadu_si128((const __m128i *)&yuv[0][i]);
+		const __m128i y2 = _mm_loadu_si128((const __m128i *)&yuv[0][i + 1]);
+		const __m128i y3 = _mm_loadu_si128((const __m128i *)&yuv[0][i + 2]);
+		const __m128i y4 = _mm_loadu_si128((const __m128i *)&yuv[1][i]);
+		const __m128i y5 = _mm_loadu_si128((const __m128i *)&yuv[1][i + 1]);
+		const __m128i y6 = _mm_loadu_si128((const __m128i *)&yuv[1][i + 2]);
+		const __m128i y7 = _mm_loadu_si128((const __m128i *)&yuv[2][i]);
+		const __m128i y8 = _mm_loadu_si128((const __m128i *)&yuv[2][i + 1]);
+		const __m128i y9 = _mm_loadu_si128((const __m128i *)&yuv[2][i + 2]);
+
+		__m128i code = diffYUVSSE2(y5, y1, thresholds, _mm_set1_epi32(0x0001));
+		code = _mm_or_si128(code, diffYUVSSE2(y5, y2, thresholds, _mm_set1_epi32(0x0002)));
+		code = _mm_or_si128(code, diffYUVSSE2(y5, y3, thresholds, _mm_set1_epi32(0x0004)));
+		code = _mm_or_si128(code, diffYUVSSE2(y5, y4, thresholds, _mm_set1_epi32(0x0008)));
+		code = _mm_or_si128(code, diffYUVSSE2(y5, y6, thresholds, _mm_set1_epi32(0x0010)));
+		code = _mm_or_si128(code, diffYUVSSE2(y5, y7, thresholds, _mm_set1_epi32(0x0020)));
+		code = _mm_or_si128(code, diffYUVSSE2(y5, y8, thresholds, _mm_set1_epi32(0x0040)));
+		code = _mm_or_si128(code, diffYUVSSE2(y5, y9, thresholds, _mm_set1_epi32(0x0080)));
+		code = _mm_or_si128(code, diffYUVSSE2(y2, y6, thresholds, _mm_set1_epi32(kHQDiff26)));
+		code = _mm_or_si128(code, diffYUVSSE2(y4, y2, thresholds, _mm_set1_epi32(kHQDiff42)));
+		code = _mm_or_si128(code, diffYUVSSE2(y6, y8, thresholds, _mm_set1_epi32(kHQDiff68)));
+		code = _mm_or_si128(code, diffYUVSSE2(y8, y4, thresholds, _mm_set1_epi32(kHQDiff84)));
+
+		_mm_storel_epi64((__m128i *)&codes[i], _mm_packs_epi32(code, code));
+	}
+
+	for (; i < width; ++i)
+		codes[i] = classifyPixel(yuv, i);
+}
+
+SIMD_TARGET("avx2")
+static inline __m256i diffYUVAVX2(__m256i a, __m256i b, __m256i thresholds, __m256i bit) {
+	const __m256i diff = _mm256_or_si256(_mm256_subs_epu8(a, b), _mm256_subs_epu8(b, a));
+	const __m256i same = _mm256_cmpeq_epi32(_mm256_subs_epu8(diff, thresholds), _mm256_setzero_si256());
+	return _mm256_andnot_si256(same, bit);
+}
+
+SIMD_TARGET("avx2")
+static void fillYUVRowsAVX2(const uint16 *src, uint32 nextlineSrc, YUVRows &yuv, int width) {
+	// Look up the YUV values 8 at a time
+	for (int row = 0; row < 3; ++row) {
+		const uint16 *p = src + (row - 1) * (int)nextlineSrc - 1;
+		int i = 0;
+		for (; i + 8 <= width + 2; i += 8) {
+			const __m256i colors = _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i *)&p[i]));
+			_mm256_storeu_si256((__m256i *)&yuv[row][i], _mm256_i32gather_epi32((const int *)RGBtoYUV, colors, 4));
+		}
+		for (; i < width + 2; ++i)
+			yuv[row][i] = RGBtoYUV[p[i]];
+	}
+}
+
+SIMD_TARGET("avx2")
+static void fillYUVRowsAVX2(const uint32 *src, uint32 nextlineSrc, YUVRows &yuv, int width) {
+	fillYUVRows(src, nextlineSrc, yuv, width);
+}
+
+template<typename Pixel>
+SIMD_TARGET("avx2")
+static void classifyAVX2(const Pixel *src, uint32 nextlineSrc, uint16 *codes, int width) {
+	YUVRows yuv;
+	fillYUVRowsAVX2(src, nextlineSrc, yuv, width);
+
+	const __m256i thresholds = _mm256_set1_epi32(kYUVThresholds);
+	int i = 0;
+
+	// 8 pixels per iteration
+	for (; i + 8 <= width; i += 8) {
+		const __m256i y1 = _mm256_loadu_si256((const __m256i *)&yuv[0][i]);
+		const __m256i y2 = _mm256_loadu_si256((const __m256i *)&yuv[0][i + 1]);
+		const __m256i y3 = _mm256_loadu_si256((const __m256i *)&yuv[0][i + 2]);
+		const __m256i y4 = _mm256_loadu_si256((const __m256i *)&yuv[1][i]);
+		const __m256i y5 = _mm256_loadu_si256((const __m256i *)&yuv[1][i + 1]);
+		const __m256i y6 = _mm256_loadu_si256((const __m256i *)&yuv[1][i + 2]);
+		const __m256i y7 = _mm256_loadu_si256((const __m256i *)&yuv[2][i]);
+		const __m256i y8 = _mm256_loadu_si256((const __m256i *)&yuv[2][i + 1]);
+		const __m256i y9 = _mm256_loadu_si256((const __m256i *)&yuv[2][i + 2]);
+
+		__m256i code = diffYUVAVX2(y5, y1, thresholds, _mm256_set1_epi32(0x0001));
+		code = _mm256_or_si256(code, diffYUVAVX2(y5, y2, thresholds, _mm256_set1_epi32(0x0002)));
+		code = _mm256_or_si256(code, diffYUVAVX2(y5, y3, thresholds, _mm256_set1_epi32(0x0004)));
+		code = _mm256_or_si256(code, diffYUVAVX2(y5, y4, thresholds, _mm256_set1_epi32(0x0008)));
+		code = _mm256_or_si256(code, diffYUVAVX2(y5, y6, thresholds, _mm256_set1_epi32(0x0010)));
+		code = _mm256_or_si256(code, diffYUVAVX2(y5, y7, thresholds, _mm256_set1_epi32(0x0020)));
+		code = _mm256_or_si256(code, diffYUVAVX2(y5, y8, thresholds, _mm256_set1_epi32(0x0040)));
+		code = _mm256_or_si256(code, diffYUVAVX2(y5, y9, thresholds, _mm256_set1_epi32(0x0080)));
+		code = _mm256_or_si256(code, diffYUVAVX2(y2, y6, thresholds, _mm256_set1_epi32(kHQDiff26)));
+		code = _mm256_or_si256(code, diffYUVAVX2(y4, y2, thresholds, _mm256_set1_epi32(kHQDiff42)));
+		code = _mm256_or_si256(code, diffYUVAVX2(y6, y8, thresholds, _mm256_set1_epi32(kHQDiff68)));
+		code = _mm256_or_si256(code, diffYUVAVX2(y8, y4, thresholds, _mm256_set1_epi32(kHQDiff84)));
+
+		const __m128i packed = _mm_packs_epi32(_mm256_castsi256_si128(code), _mm256_extracti128_si256(code, 1));
+		_mm_storeu_si128((__m128i *)&codes[i], packed);
+	}
+
+	for (; i < width; ++i)
+		codes[i] = classifyPixel(yuv, i);
+}
+
+#endif // SCUMMVM_SIMD_X86
+
+#ifdef SCUMMVM_SIMD_NEON
+
+/**
+ * Returns bit in the lanes where the YUV values differ, 0 elsewhere.
+ */
+static inline uint32x4_t diffYUVNEON(uint32x4_t a, uint32x4_t b, uint8x16_t thresholds, uint32x4_t bit) {
+	const uint8x16_t diff = vqsubq_u8(vabdq_u8(vreinterpretq_u8_u32(a), vreinterpretq_u8_u32(b)), thresholds);
+	const uint32x4_t differs = vreinterpretq_u32_u8(diff);
+	return vandq_u32(vtstq_u32(differs, differs), bit);
+}
+
+template<typename Pixel>
+static void classifyNEON(const Pixel *src, uint32 nextlineSrc, uint16 *codes, int width) {
+	YUVRows yuv;
+	fillYUVRows(src, nextlineSrc, yuv, width);
+
+	const uint8x16_t thresholds = vreinterpretq_u8_u32(vdupq_n_u32(kYUVThresholds));
+	int i = 0;
+
+	// 4 pixels per iteration
+	for (; i + 4 <= width; i += 4) {
+		const uint32x4_t y1 = vld1q_u32(&yuv[0][i]);
+		const uint32x4_t y2 = vld1q_u32(&yuv[0][i + 1]);
+		const uint32x4_t y3 = vld1q_u32(&yuv[0][i + 2]);
+		const uint32x4_t y4 = vld1q_u32(&yuv[1][i]);
+		const uint32x4_t y5 = vld1q_u32(&yuv[1][i + 1]);
+		const uint32x4_t y6 = vld1q_u32(&yuv[1][i + 2]);
+		const uint32x4_t y7 = vld1q_u32(&yuv[2][i]);
+		const uint32x4_t y8 = vld1q_u32(&yuv[2][i + 1]);
+		const uint32x4_t y9 = vld1q_u32(&yuv[2][i + 2]);
+
+		uint32x4_t code = diffYUVNEON(y5, y1, thresholds, vdupq_n_u32(0x0001));
+		code = vorrq_u32(code, diffYUVNEON(y5, y2, thresholds, vdupq_n_u32(0x0002)));
+		code = vorrq_u32(code, diffYUVNEON(y5, y3, thresholds, vdupq_n_u32(0x0004)));
+		code = vorrq_u32(code, diffYUVNEON(y5, y4, thresholds, vdupq_n_u32(0x0008)));
+		code = vorrq_u32(code, diffYUVNEON(y5, y6, thresholds, vdupq_n_u32(0x0010)));
+		code = vorrq_u32(code, diffYUVNEON(y5, y7, thresholds, vdupq_n_u32(0x0020)));
+		code = vorrq_u32(code, diffYUVNEON(y5, y8, thresholds, vdupq_n_u32(0x0040)));
+		code = vorrq_u32(code, diffYUVNEON(y5, y9, thresholds, vdupq_n_u32(0x0080)));
+		code = vorrq_u32(code, diffYUVNEON(y2, y6, thresholds, vdupq_n_u32(kHQDiff26)));
+		code = vorrq_u32(code, diffYUVNEON(y4, y2, thresholds, vdupq_n_u32(kHQDiff42)));
+		code = vorrq_u32(code, diffYUVNEON(y6, y8, thresholds, vdupq_n_u32(kHQDiff68)));
+		code = vorrq_u32(code, diffYUVNEON(y8, y4, thresholds, vdupq_n_u32(kHQDiff84)));
+
+		vst1_u16(&codes[i], vmovn_u32(code));
+	}
+
+	for (; i < width; ++i)
+		codes[i] = classifyPixel(yuv, i);
+}
+
+#endif // SCUMMVM_SIMD_NEON
+
+template<typename Pixel>
+struct ClassifyProc {
+	typedef void (*Type)(const Pixel *src, uint32 nextlineSrc, uint16 *codes, int width);
+};
+
+template<typename Pixel>
+static typename ClassifyProc<Pixel>::Type getClassifyProc(HQKernel kernel) {
+	switch (kernel) {
+	case kHQKernelScalar:
+		return classifyScalar<Pixel>;
+
+#ifdef SCUMMVM_SIMD_X86
+	case kHQKernelSSE2:
+		if (Common::hasSSE2())
+			return classifySSE2<Pixel>;
+		break;
+
+	case kHQKernelAVX2:
+		if (Common::hasAVX2())
+			return classifyAVX2<Pixel>;
+		break;
+#endif
+
+#ifdef SCUMMVM_SIMD_NEON
+	case kHQKernelNEON:
+		return classifyNEON<Pixel>;
+#endif
+
+	default:
+		break;
+	}
+
+	return 0;
+}
+
+HQClassifyProc getHQClassifyProc(HQKernel kernel) {
+	return getClassifyProc<uint16>(kernel);
+}
+
+HQClassify32Proc getHQClassify32Proc(HQKernel kernel) {
+	return getClassifyProc<uint32>(kernel);
+}
+
+const char *getHQKernelName(HQKernel kernel) {
+	static const char *const names[kHQKernelCount] = {
+		"scalar",
+		"SSE2",
+		"AVX2",
+		"NEON"
+	};
+
+	assert(kernel >= 0 && kernel < kHQKernelCount);
+	return names[kernel];
+}
+
+HQKernel getBestHQKernel() {
+	static int bestKernel = -1;
+
+	if (bestKernel < 0) {
+		int kernel = kHQKernelCount - 1;
+		while (kernel > kHQKernelScalar && !getHQClassifyProc((HQKernel)kernel))
+			--kernel;
+		bestKernel = kernel;
+	}
+
+	return (HQKernel)bestKernel;
+}
+
+HQClassifyProc getBestHQClassifyProc() {
+	static HQClassifyProc proc = 0;
+
+	if (!proc)
+		proc = getHQClassifyProc(getBestHQKernel());
+
+	return proc;
+}
+
+HQClassify32Proc getBestHQClassify32Proc() {
+	static HQClassify32Proc proc = 0;
+
+	if (!proc)
+		proc = getHQClassify32Proc(getBestHQKernel());
+
+	return proc;
+}
@@ -0,0 +1,117 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef GRAPHICS_SCALER_HQ_SIMD_H
+#define GRAPHICS_SCALER_HQ_SIMD_H
+
+#include "common/scummsys.h"
+
+/**
+ * The HQ2x and HQ3x scalers pick the interpolation of each pixel based on
+ * which of its neighbours differ noticeably from it in YUV space. This
+ * classification is done up front for a run of pixels, with vectorized
+ * code where available.
+ *
+ * Each pixel gets a code: the low 8 bits are the pattern of neighbours
+ * which differ from the center pixel (w1 to w9 without w5, in the bit
+ * order of the scalers), the kHQDiff bits tell which pairs of direct
+ * neighbours differ from each other.
+ */
+enum {
+	kHQPatternMask = 0x00FF,
+	kHQDiff26      = 0x0100,
+	kHQDiff42      = 0x0200,
+	kHQDiff68      = 0x0400,
+	kHQDiff84      = 0x0800
+};
+
+/** The maximum number of pixels classified in one go. */
+enum {
+	kHQMaxClassifyWidth = 256
+};
+
+/**
+ * Classifies a run of pixels of a 16 bit surface.
+ *
+ * @param src         the first pixel; the line above and below and one
+ *                    pixel left and right of the run are read as well
+ * @param nextlineSrc the pitch of the surface, in pixels
+ * @param codes       receives one code per pixel
+ * @param width       the number of pixels, at most kHQMaxClassifyWidth
+ */
+typedef void (*HQClassifyProc)(const uint16 *src, uint32 nextlineSrc, uint16 *codes, int width);
+
+/**
+ * Classifies a run of pixels of a 32 bit surface, in the 8888 format of
+ * Graphics::ColorMasks. The parameters are the same as for HQClassifyProc.
+ */
+typedef void (*HQClassify32Proc)(const uint32 *src, uint32 nextlineSrc, uint16 *codes, int width);
+
+/**
+ * The available implementations of the classification.
+ */
+enum HQKernel {
+	kHQKernelScalar = 0,
+	kHQKernelSSE2,
+	kHQKernelAVX2,
+	kHQKernelNEON,
+
+	kHQKernelCount
+};
+
+/**
+ * Returns the given implementation of the classification, or 0 if it is
+ * not available either in this build or on the CPU we are running on.
+ */
+HQClassifyProc getHQClassifyProc(HQKernel kernel);
+HQClassify32Proc getHQClassify32Proc(HQKernel kernel);
+
+/**
+ * Returns the name of the given implementation, for debug output.
+ */
+const char *getHQKernelName(HQKernel kernel);
+
+/**
+ * Returns the fastest implementation usable on this machine. The detection
+ * is only done once.
+ */
+HQKernel getBestHQKernel();
+
+/**
+ * Returns the fastest classification.
+ */
+HQClassifyProc getBestHQClassifyProc();
+HQClassify32Proc getBestHQClassify32Proc();
+
+/**
+ * Classifies a run of pixels with the fastest implementation for the
+ * pixel type.
+ */
+inline void classifyHQRun(const uint16 *src, uint32 nextlineSrc, uint16 *codes, int width) {
+	getBestHQClassifyProc()(src, nextlineSrc, codes, width);
+}
+
+inline void classifyHQRun(const uint32 *src, uint32 nextlineSrc, uint16 *codes, int width) {
+	getBestHQClassify32Proc()(src, nextlineSrc, codes, width);
+}
+
+#endif
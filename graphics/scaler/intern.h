@@ -179,6 +179,79 @@ static inline unsigned interpolate16_1_1_1_1(unsigned p1, unsigned p2, unsigned
 	return ((p1+p2+p3+p4) - lowbits) >> 2;
 }
 
+/**
+ * Interpolate up to four 32 bit pixels with the given weights, which must
+ * add up to 1 << shift. The channels are interpolated in 16 bit lanes, the
+ * red and blue channels in one go and the alpha and green channels in
+ * another. Like the 16 bit code above, the result is rounded down.
+ */
+template<int w1, int w2, int w3, int w4, int shift>
+static inline uint32 interpolate32Channels(uint32 p1, uint32 p2, uint32 p3, uint32 p4) {
+	const uint32 rb = ((p1 & 0x00FF00FF) * w1 + (p2 & 0x00FF00FF) * w2
+	                 + (p3 & 0x00FF00FF) * w3 + (p4 & 0x00FF00FF) * w4) >> shift;
+	const uint32 ag = (((p1 >> 8) & 0x00FF00FF) * w1 + ((p2 >> 8) & 0x00FF00FF) * w2
+	                 + ((p3 >> 8) & 0x00FF00FF) * w3 + ((p4 >> 8) & 0x00FF00FF) * w4) >> shift;
+	return (rb & 0x00FF00FF) | ((ag & 0x00FF00FF) << 8);
+}
+
+// 32 bit versions of the interpolation functions above. The bit tricks of
+// the 16 bit code would overflow the alpha channel, so they are not used.
+
+template<>
+inline unsigned interpolate16_1_1<Graphics::ColorMasks<8888> >(unsigned p1, unsigned p2) {
+	return interpolate32Channels<1, 1, 0, 0, 1>(p1, p2, 0, 0);
+}
+
+template<>
+inline unsigned interpolate16_3_1<Graphics::ColorMasks<8888> >(unsigned p1, unsigned p2) {
+	return interpolate32Channels<3, 1, 0, 0, 2>(p1, p2, 0, 0);
+}
+
+template<>
+inline unsigned interpolate16_5_3<Graphics::ColorMasks<8888> >(unsigned p1, unsigned p2) {
+	return interpolate32Channels<5, 3, 0, 0, 3>(p1, p2, 0, 0);
+}
+
+template<>
+inline unsigned interpolate16_7_1<Graphics::ColorMasks<8888> >(unsigned p1, unsigned p2) {
+	return interpolate32Channels<7, 1, 0, 0, 3>(p1, p2, 0, 0);
+}
+
+template<>
+inline unsigned interpolate16_2_1_1<Graphics::ColorMasks<8888> >(unsigned p1, unsigned p2, unsigned p3) {
+	return interpolate32Channels<2, 1, 1, 0, 2>(p1, p2, p3, 0);
+}
+
+template<>
+inline unsigned interpolate16_5_2_1<Graphics::ColorMasks<8888> >(unsigned p1, unsigned p2, unsigned p3) {
+	return interpolate32Channels<5, 2, 1, 0, 3>(p1, p2, p3, 0);
+}
+
+template<>
+inline unsigned interpolate16_6_1_1<Graphics::ColorMasks<8888> >(unsigned p1, unsigned p2, unsigned p3) {
+	return interpolate32Channels<6, 1, 1, 0, 3>(p1, p2, p3, 0);
+}
+
+template<>
+inline unsigned interpolate16_2_3_3<Graphics::ColorMasks<8888> >(unsigned p1, unsigned p2, unsigned p3) {
+	return interpolate32Channels<2, 3, 3, 0, 3>(p1, p2, p3, 0);
+}
+
+template<>
+inline unsigned interpolate16_2_7_7<Graphics::ColorMasks<8888> >(unsigned p1, unsigned p2, unsigned p3) {
+	return interpolate32Channels<2, 7, 7, 0, 4>(p1, p2, p3, 0);
+}
+
+template<>
+inline unsigned interpolate16_14_1_1<Graphics::ColorMasks<8888> >(unsigned p1, unsigned p2, unsigned p3) {
+	return interpolate32Channels<14, 1, 1, 0, 4>(p1, p2, p3, 0);
+}
+
+template<>
+inline unsigned interpolate16_1_1_1_1<Graphics::ColorMasks<8888> >(unsigned p1, unsigned p2, unsigned p3, unsigned p4) {
+	return interpolate32Channels<1, 1, 1, 1, 2>(p1, p2, p3, p4);
+}
+
 /**
  * Compare two YUV values (encoded 8-8-8) and check if they differ by more than
  * a certain hard coded threshold. Used by the hq scaler family.
@@ -0,0 +1,536 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "graphics/transparent_surface_simd.h"
+
+#include "common/textconsole.h"
+#include "common/simd.h"
+
+// The vector kernels assume the in memory byte order A, B, G, R of the
+// pixels which TransparentSurface uses on little endian machines.
+#ifdef SCUMM_LITTLE_ENDIAN
+
+#ifdef SCUMMVM_SIMD_X86
+#define GRAPHICS_BLEND_X86
+#endif
+
+#ifdef SCUMMVM_SIMD_NEON
+#define GRAPHICS_BLEND_NEON
+#endif
+
+#endif // SCUMM_LITTLE_ENDIAN
+
+namespace Graphics {
+
+#if defined(GRAPHICS_BLEND_X86) || defined(GRAPHICS_BLEND_NEON)
+
+/*
+ * The vector kernels widen the pixels to 16 bit lanes, two pixels per 128
+ * bits, and redo the integer math of the scalar kernels lane by lane. The
+ * scalar code has a few quirks which have to be reproduced exactly:
+ *
+ * - Divisions by 256 are a mulhi by 256, so x >> 8 and (x * c) >> 16
+ *   become the same operation with a per channel multiplier.
+ * - With a color modulation, the alpha and subtractive kernels always
+ *   write the pixel, even for fully transparent source pixels.
+ * - The subtractive kernel ignores the alpha modulation.
+ * - The modulated alpha kernel stores the sum of two bytes into a byte,
+ *   which wraps around.
+ * - The modulated subtractive kernel multiplies four bytes in a signed
+ *   int, which wraps around for large values.
+ */
+
+struct BlendParams {
+	uint16 ca[8];      ///< The alpha modulation in all lanes
+	uint16 mul[8];     ///< Per channel multiplier, 0 for the alpha lanes
+	uint16 sel255[8];  ///< All bits set for the channels modulated with 255
+};
+
+static void initBlendParams(BlendParams &params, TSpriteBlendMode mode, bool colorMod, uint32 color) {
+	const uint16 ca = (color >> 24) & 0xFF;
+	// Lane order is A, B, G, R like the pixels in memory
+	const uint16 mods[4] = { 0, (uint16)(color & 0xFF), (uint16)((color >> 8) & 0xFF), (uint16)((color >> 16) & 0xFF) };
+
+	for (int i = 0; i < 8; ++i) {
+		const int channel = i & 3;
+		const uint16 mod = colorMod ? mods[channel] : 255;
+
+		params.ca[i] = ca;
+		params.sel255[i] = (channel != 0 && mod == 255) ? 0xFFFF : 0;
+
+		if (channel == 0)
+			params.mul[i] = 0;
+		else if (mode == BLEND_ADDITIVE || mode == BLEND_MULTIPLY)
+			params.mul[i] = (mod == 255) ? 256 : mod;
+		else
+			params.mul[i] = mod;
+	}
+}
+
+static BlendBlitProc getScalarBlendProc(TSpriteBlendMode mode) {
+	switch (mode) {
+	case BLEND_ADDITIVE:
+		return doBlitAdditiveBlend;
+	case BLEND_SUBTRACTIVE:
+		return doBlitSubtractiveBlend;
+	case BLEND_MULTIPLY:
+		return doBlitMultiplyBlend;
+	default:
+		return doBlitAlphaBlend;
+	}
+}
+
+#endif
+
+#ifdef GRAPHICS_BLEND_X86
+
+/**
+ * Blends the two pixels in 16 bit lanes, as in the scalar kernels.
+ */
+template<TSpriteBlendMode kMode, bool kColorMod>
+SIMD_TARGET("sse2")
+static inline __m128i blendPixelsSSE2(__m128i in, __m128i out, __m128i ca, __m128i mul, __m128i sel255) {
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i c255 = _mm_set1_epi16(255);
+	const __m128i alphaMask = _mm_set_epi16(0, 0, 0, -1, 0, 0, 0, -1);
+	const __m128i alpha255 = _mm_and_si128(alphaMask, c255);
+
+	__m128i a = _mm_shufflehi_epi16(_mm_shufflelo_epi16(in, 0), 0);
+	const __m128i transparent = _mm_cmpeq_epi16(a, zero);
+	if (kColorMod && kMode != BLEND_SUBTRACTIVE)
+		a = _mm_srli_epi16(_mm_mullo_epi16(a, ca), 8);
+
+	__m128i res;
+	if (kMode == BLEND_ADDITIVE) {
+		const __m128i t = _mm_mulhi_epu16(_mm_mullo_epi16(in, a), mul);
+		return _mm_min_epi16(_mm_add_epi16(out, t), c255);
+	} else if (kMode == BLEND_MULTIPLY) {
+		const __m128i t = _mm_mulhi_epu16(_mm_mullo_epi16(in, a), mul);
+		res = _mm_srli_epi16(_mm_mullo_epi16(out, t), 8);
+		res = _mm_or_si128(_mm_andnot_si128(alphaMask, res), _mm_and_si128(alphaMask, out));
+		if (kColorMod)
+			return res;
+	} else if (kMode == BLEND_SUBTRACTIVE) {
+		const __m128i t = _mm_mulhi_epu16(_mm_mullo_epi16(in, out), _mm_andnot_si128(alphaMask, a));
+		res = _mm_sub_epi16(out, t);
+		if (!kColorMod)
+			return res;
+
+		// Channels modulated with anything but 255 compute the full product
+		// of four bytes in 32 bits, and shift it arithmetically
+		const __m128i p = _mm_mullo_epi16(in, mul);
+		const __m128i q = _mm_mullo_epi16(out, a);
+		const __m128i lo = _mm_mullo_epi16(p, q);
+		const __m128i hi = _mm_mulhi_epu16(p, q);
+		const __m128i byteMask = _mm_set1_epi32(0xFF);
+		__m128i d0 = _mm_sub_epi32(_mm_unpacklo_epi16(out, zero), _mm_srai_epi32(_mm_unpacklo_epi16(lo, hi), 24));
+		__m128i d1 = _mm_sub_epi32(_mm_unpackhi_epi16(out, zero), _mm_srai_epi32(_mm_unpackhi_epi16(lo, hi), 24));
+		d0 = _mm_and_si128(_mm_andnot_si128(_mm_srai_epi32(d0, 31), d0), byteMask);
+		d1 = _mm_and_si128(_mm_andnot_si128(_mm_srai_epi32(d1, 31), d1), byteMask);
+		res = _mm_or_si128(_mm_and_si128(sel255, res), _mm_andnot_si128(sel255, _mm_packs_epi32(d0, d1)));
+		return _mm_or_si128(_mm_andnot_si128(alphaMask, res), alpha255);
+	} else {
+		if (kColorMod) {
+			const __m128i t0 = _mm_srli_epi16(_mm_mullo_epi16(out, _mm_sub_epi16(c255, a)), 8);
+			const __m128i t1 = _mm_mulhi_epu16(_mm_mullo_epi16(in, a), mul);
+			res = _mm_and_si128(_mm_add_epi16(t0, t1), c255);
+			return _mm_or_si128(_mm_andnot_si128(alphaMask, res), alpha255);
+		}
+
+		res = _mm_add_epi16(_mm_mullo_epi16(in, a), _mm_mullo_epi16(out, _mm_sub_epi16(c255, a)));
+		res = _mm_or_si128(_mm_andnot_si128(alphaMask, _mm_srli_epi16(res, 8)), alpha255);
+	}
+
+	// Fully transparent pixels leave the target alone
+	return _mm_or_si128(_mm_and_si128(transparent, out), _mm_andnot_si128(transparent, res));
+}
+
+template<TSpriteBlendMode kMode, bool kColorMod>
+SIMD_TARGET("sse2")
+static void blendRowsSSE2(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep, uint32 color) {
+	BlendParams params;
+	initBlendParams(params, kMode, kColorMod, color);
+	const __m128i ca = _mm_loadu_si128((const __m128i *)params.ca);
+	const __m128i mul = _mm_loadu_si128((const __m128i *)params.mul);
+	const __m128i sel255 = _mm_loadu_si128((const __m128i *)params.sel255);
+	const __m128i zero = _mm_setzero_si128();
+
+	for (uint32 i = 0; i < height; i++) {
+		byte *in = ino;
+		byte *out = outo;
+		uint32 j = 0;
+
+		// 4 pixels per iteration
+		for (; j + 4 <= width; j += 4) {
+			__m128i src;
+			if (inStep > 0)
+				src = _mm_loadu_si128((const __m128i *)in);
+			else
+				src = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *)(in - 12)), 0x1B);
+			const __m128i dst = _mm_loadu_si128((const __m128i *)out);
+
+			const __m128i lo = blendPixelsSSE2<kMode, kColorMod>(_mm_unpacklo_epi8(src, zero), _mm_unpacklo_epi8(dst, zero), ca, mul, sel255);
+			const __m128i hi = blendPixelsSSE2<kMode, kColorMod>(_mm_unpackhi_epi8(src, zero), _mm_unpackhi_epi8(dst, zero), ca, mul, sel255);
+			_mm_storeu_si128((__m128i *)out, _mm_packus_epi16(lo, hi));
+
+			in += 4 * inStep;
+			out += 16;
+		}
+
+		if (j < width)
+			getScalarBlendProc(kMode)(in, out, width - j, 1, pitch, inStep, inoStep, color);
+
+		outo += pitch;
+		ino += inoStep;
+	}
+}
+
+template<TSpriteBlendMode kMode>
+SIMD_TARGET("sse2")
+static void blendSSE2(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep, uint32 color) {
+	if (inStep != 4 && inStep != -4)
+		getScalarBlendProc(kMode)(ino, outo, width, height, pitch, inStep, inoStep, color);
+	else if (color == 0xFFFFFFFF)
+		blendRowsSSE2<kMode, false>(ino, outo, width, height, pitch, inStep, inoStep, color);
+	else
+		blendRowsSSE2<kMode, true>(ino, outo, width, height, pitch, inStep, inoStep, color);
+}
+
+template<TSpriteBlendMode kMode, bool kColorMod>
+SIMD_TARGET("avx2")
+static inline __m256i blendPixelsAVX2(__m256i in, __m256i out, __m256i ca, __m256i mul, __m256i sel255) {
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i c255 = _mm256_set1_epi16(255);
+	const __m256i alphaMask = _mm256_set_epi16(0, 0, 0, -1, 0, 0, 0, -1, 0, 0, 0, -1, 0, 0, 0, -1);
+	const __m256i alpha255 = _mm256_and_si256(alphaMask, c255);
+
+	__m256i a = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(in, 0), 0);
+	const __m256i transparent = _mm256_cmpeq_epi16(a, zero);
+	if (kColorMod && kMode != BLEND_SUBTRACTIVE)
+		a = _mm256_srli_epi16(_mm256_mullo_epi16(a, ca), 8);
+
+	__m256i res;
+	if (kMode == BLEND_ADDITIVE) {
+		const __m256i t = _mm256_mulhi_epu16(_mm256_mullo_epi16(in, a), mul);
+		return _mm256_min_epi16(_mm256_add_epi16(out, t), c255);
+	} else if (kMode == BLEND_MULTIPLY) {
+		const __m256i t = _mm256_mulhi_epu16(_mm256_mullo_epi16(in, a), mul);
+		res = _mm256_srli_epi16(_mm256_mullo_epi16(out, t), 8);
+		res = _mm256_or_si256(_mm256_andnot_si256(alphaMask, res), _mm256_and_si256(alphaMask, out));
+		if (kColorMod)
+			return res;
+	} else if (kMode == BLEND_SUBTRACTIVE) {
+		const __m256i t = _mm256_mulhi_epu16(_mm256_mullo_epi16(in, out), _mm256_andnot_si256(alphaMask, a));
+		res = _mm256_sub_epi16(out, t);
+		if (!kColorMod)
+			return res;
+
+		const __m256i p = _mm256_mullo_epi16(in, mul);
+		const __m256i q = _mm256_mullo_epi16(out, a);
+		const __m256i lo = _mm256_mullo_epi16(p, q);
+		const __m256i hi = _mm256_mulhi_epu16(p, q);
+		const __m256i byteMask = _mm256_set1_epi32(0xFF);
+		__m256i d0 = _mm256_sub_epi32(_mm256_unpacklo_epi16(out, zero), _mm256_srai_epi32(_mm256_unpacklo_epi16(lo, hi), 24));
+		__m256i d1 = _mm256_sub_epi32(_mm256_unpackhi_epi16(out, zero), _mm256_srai_epi32(_mm256_unpackhi_epi16(lo, hi), 24));
+		d0 = _mm256_and_si256(_mm256_max_epi32(d0, zero), byteMask);
+		d1 = _mm256_and_si256(_mm256_max_epi32(d1, zero), byteMask);
+		res = _mm256_blendv_epi8(_mm256_packs_epi32(d0, d1), res, sel255);
+		return _mm256_or_si256(_mm256_andnot_si256(alphaMask, res), alpha255);
+	} else {
+		if (kColorMod) {
+			const __m256i t0 = _mm256_srli_epi16(_mm256_mullo_epi16(out, _mm256_sub_epi16(c255, a)), 8);
+			const __m256i t1 = _mm256_mulhi_epu16(_mm256_mullo_epi16(in, a), mul);
+			res = _mm256_and_si256(_mm256_add_epi16(t0, t1), c255);
+			return _mm256_or_si256(_mm256_andnot_si256(alphaMask, res), alpha255);
+		}
+
+		res = _mm256_add_epi16(_mm256_mullo_epi16(in, a), _mm256_mullo_epi16(out, _mm256_sub_epi16(c255, a)));
+		res = _mm256_or_si256(_mm256_andnot_si256(alphaMask, _mm256_srli_epi16(res, 8)), alpha255);
+	}
+
+	return _mm256_blendv_epi8(res, out, transparent);
+}
+
+template<TSpriteBlendMode kMode, bool kColorMod>
+SIMD_TARGET("avx2")
+static void blendRowsAVX2(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep, uint32 color) {
+	BlendParams params;
+	initBlendParams(params, kMode, kColorMod, color);
+	const __m256i ca = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)params.ca));
+	const __m256i mul = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)params.mul));
+	const __m256i sel255 = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)params.sel255));
+	const __m256i reverse = _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0);
+	const __m256i zero = _mm256_setzero_si256();
+
+	for (uint32 i = 0; i < height; i++) {
+		byte *in = ino;
+		byte *out = outo;
+		uint32 j = 0;
+
+		// 8 pixels per iteration. Unpacking and packing both operate on
+		// the two 128 bit lanes separately, so the pixel order is preserved.
+		for (; j + 8 <= width; j += 8) {
+			__m256i src;
+			if (inStep > 0)
+				src = _mm256_loadu_si256((const __m256i *)in);
+			else
+				src = _mm256_permutevar8x32_epi32(_mm256_loadu_si256((const __m256i *)(in - 28)), reverse);
+			const __m256i dst = _mm256_loadu_si256((const __m256i *)out);
+
+			const __m256i lo = blendPixelsAVX2<kMode, kColorMod>(_mm256_unpacklo_epi8(src, zero), _mm256_unpacklo_epi8(dst, zero), ca, mul, sel255);
+			const __m256i hi = blendPixelsAVX2<kMode, kColorMod>(_mm256_unpackhi_epi8(src, zero), _mm256_unpackhi_epi8(dst, zero), ca, mul, sel255);
+			_mm256_storeu_si256((__m256i *)out, _mm256_packus_epi16(lo, hi));
+
+			in += 8 * inStep;
+			out += 32;
+		}
+
+		if (j < width)
+			blendRowsSSE2<kMode, kColorMod>(in, out, width - j, 1, pitch, inStep, inoStep, color);
+
+		outo += pitch;
+		ino += inoStep;
+	}
+}
+
+template<TSpriteBlendMode kMode>
+SIMD_TARGET("avx2")
+static void blendAVX2(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep, uint32 color) {
+	if (inStep != 4 && inStep != -4)
+		getScalarBlendProc(kMode)(ino, outo, width, height, pitch, inStep, inoStep, color);
+	else if (color == 0xFFFFFFFF)
+		blendRowsAVX2<kMode, false>(ino, outo, width, height, pitch, inStep, inoStep, color);
+	else
+		blendRowsAVX2<kMode, true>(ino, outo, width, height, pitch, inStep, inoStep, color);
+}
+
+#endif // GRAPHICS_BLEND_X86
+
+#ifdef GRAPHICS_BLEND_NEON
+
+static inline uint16x8_t mulhiNEON(uint16x8_t a, uint16x8_t b) {
+	const uint32x4_t lo = vmull_u16(vget_low_u16(a), vget_low_u16(b));
+	const uint32x4_t hi = vmull_u16(vget_high_u16(a), vget_high_u16(b));
+	return vcombine_u16(vshrn_n_u32(lo, 16), vshrn_n_u32(hi, 16));
+}
+
+static inline int32x4_t subtractProductNEON(uint16x4_t out, uint16x4_t p, uint16x4_t q) {
+	const int32x4_t t = vshrq_n_s32(vreinterpretq_s32_u32(vmull_u16(p, q)), 24);
+	const int32x4_t d = vsubq_s32(vreinterpretq_s32_u32(vmovl_u16(out)), t);
+	return vandq_s32(vmaxq_s32(d, vdupq_n_s32(0)), vdupq_n_s32(0xFF));
+}
+
+/**
+ * Blends the two pixels in 16 bit lanes, as in the scalar kernels.
+ */
+template<TSpriteBlendMode kMode, bool kColorMod>
+static inline uint16x8_t blendPixelsNEON(uint16x8_t in, uint16x8_t out, uint16x8_t ca, uint16x8_t mul, uint16x8_t sel255) {
+	static const uint16 alphaLanes[8] = { 0xFFFF, 0, 0, 0, 0xFFFF, 0, 0, 0 };
+	const uint16x8_t alphaMask = vld1q_u16(alphaLanes);
+	const uint16x8_t c255 = vdupq_n_u16(255);
+	const uint16x8_t alpha255 = vandq_u16(alphaMask, c255);
+
+	uint16x8_t a = vcombine_u16(vdup_lane_u16(vget_low_u16(in), 0), vdup_lane_u16(vget_high_u16(in), 0));
+	const uint16x8_t transparent = vceqq_u16(a, vdupq_n_u16(0));
+	if (kColorMod && kMode != BLEND_SUBTRACTIVE)
+		a = vshrq_n_u16(vmulq_u16(a, ca), 8);
+
+	uint16x8_t res;
+	if (kMode == BLEND_ADDITIVE) {
+		const uint16x8_t t = mulhiNEON(vmulq_u16(in, a), mul);
+		return vminq_u16(vaddq_u16(out, t), c255);
+	} else if (kMode == BLEND_MULTIPLY) {
+		const uint16x8_t t = mulhiNEON(vmulq_u16(in, a), mul);
+		res = vbslq_u16(alphaMask, out, vshrq_n_u16(vmulq_u16(out, t), 8));
+		if (kColorMod)
+			return res;
+	} else if (kMode == BLEND_SUBTRACTIVE) {
+		const uint16x8_t t = mulhiNEON(vmulq_u16(in, out), vbicq_u16(a, alphaMask));
+		res = vsubq_u16(out, t);
+		if (!kColorMod)
+			return res;
+
+		// Channels modulated with anything but 255 compute the full product
+		// of four bytes in 32 bits, and shift it arithmetically
+		const uint16x8_t p = vmulq_u16(in, mul);
+		const uint16x8_t q = vmulq_u16(out, a);
+		const int32x4_t d0 = subtractProductNEON(vget_low_u16(out), vget_low_u16(p), vget_low_u16(q));
+		const int32x4_t d1 = subtractProductNEON(vget_high_u16(out), vget_high_u16(p), vget_high_u16(q));
+		const uint16x8_t d = vcombine_u16(vmovn_u32(vreinterpretq_u32_s32(d0)), vmovn_u32(vreinterpretq_u32_s32(d1)));
+		res = vbslq_u16(sel255, res, d);
+		return vbslq_u16(alphaMask, alpha255, res);
+	} else {
+		if (kColorMod) {
+			const uint16x8_t t0 = vshrq_n_u16(vmulq_u16(out, vsubq_u16(c255, a)), 8);
+			const uint16x8_t t1 = mulhiNEON(vmulq_u16(in, a), mul);
+			res = vandq_u16(vaddq_u16(t0, t1), c255);
+			return vbslq_u16(alphaMask, alpha255, res);
+		}
+
+		res = vaddq_u16(vmulq_u16(in, a), vmulq_u16(out, vsubq_u16(c255, a)));
+		res = vbslq_u16(alphaMask, alpha255, vshrq_n_u16(res, 8));
+	}
+
+	// Fully transparent pixels leave the target alone
+	return vbslq_u16(transparent, out, res);
+}
+
+template<TSpriteBlendMode kMode, bool kColorMod>
+static void blendRowsNEON(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep, uint32 color) {
+	BlendParams params;
+	initBlendParams(params, kMode, kColorMod, color);
+	const uint16x8_t ca = vld1q_u16(params.ca);
+	const uint16x8_t mul = vld1q_u16(params.mul);
+	const uint16x8_t sel255 = vld1q_u16(params.sel255);
+
+	for (uint32 i = 0; i < height; i++) {
+		byte *in = ino;
+		byte *out = outo;
+		uint32 j = 0;
+
+		// 4 pixels per iteration
+		for (; j + 4 <= width; j += 4) {
+			uint8x16_t src;
+			if (inStep > 0) {
+				src = vld1q_u8(in);
+			} else {
+				const uint32x4_t rev = vrev64q_u32(vreinterpretq_u32_u8(vld1q_u8(in - 12)));
+				src = vreinterpretq_u8_u32(vcombine_u32(vget_high_u32(rev), vget_low_u32(rev)));
+			}
+			const uint8x16_t dst = vld1q_u8(out);
+
+			const uint16x8_t lo = blendPixelsNEON<kMode, kColorMod>(vmovl_u8(vget_low_u8(src)), vmovl_u8(vget_low_u8(dst)), ca, mul, sel255);
+			const uint16x8_t hi = blendPixelsNEON<kMode, kColorMod>(vmovl_u8(vget_high_u8(src)), vmovl_u8(vget_high_u8(dst)), ca, mul, sel255);
+			vst1q_u8(out, vcombine_u8(vqmovn_u16(lo), vqmovn_u16(hi)));
+
+			in += 4 * inStep;
+			out += 16;
+		}
+
+		if (j < width)
+			getScalarBlendProc(kMode)(in, out, width - j, 1, pitch, inStep, inoStep, color);
+
+		outo += pitch;
+		ino += inoStep;
+	}
+}
+
+template<TSpriteBlendMode kMode>
+static void blendNEON(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep, uint32 color) {
+	if (inStep != 4 && inStep != -4)
+		getScalarBlendProc(kMode)(ino, outo, width, height, pitch, inStep, inoStep, color);
+	else if (color == 0xFFFFFFFF)
+		blendRowsNEON<kMode, false>(ino, outo, width, height, pitch, inStep, inoStep, color);
+	else
+		blendRowsNEON<kMode, true>(ino, outo, width, height, pitch, inStep, inoStep, color);
+}
+
+#endif // GRAPHICS_BLEND_NEON
+
+BlendBlitProc getBlendBlitProc(BlendKernel kernel, TSpriteBlendMode mode) {
+	if (mode < BLEND_NORMAL || mode >= NUM_BLEND_MODES)
+		return 0;
+
+	switch (kernel) {
+	case kBlendKernelScalar: {
+		static const BlendBlitProc procs[NUM_BLEND_MODES] = {
+			doBlitAlphaBlend, doBlitAdditiveBlend, doBlitSubtractiveBlend, doBlitMultiplyBlend
+		};
+		return procs[mode];
+	}
+
+#ifdef GRAPHICS_BLEND_X86
+	case kBlendKernelSSE2:
+		if (Common::hasSSE2()) {
+			static const BlendBlitProc procs[NUM_BLEND_MODES] = {
+				blendSSE2<BLEND_NORMAL>, blendSSE2<BLEND_ADDITIVE>, blendSSE2<BLEND_SUBTRACTIVE>, blendSSE2<BLEND_MULTIPLY>
+			};
+			return procs[mode];
+		}
+		break;
+
+	case kBlendKernelAVX2:
+		if (Common::hasAVX2()) {
+			static const BlendBlitProc procs[NUM_BLEND_MODES] = {
+				blendAVX2<BLEND_NORMAL>, blendAVX2<BLEND_ADDITIVE>, blendAVX2<BLEND_SUBTRACTIVE>, blendAVX2<BLEND_MULTIPLY>
+			};
+			return procs[mode];
+		}
+		break;
+#endif
+
+#ifdef GRAPHICS_BLEND_NEON
+	case kBlendKernelNEON: {
+		static const BlendBlitProc procs[NUM_BLEND_MODES] = {
+			blendNEON<BLEND_NORMAL>, blendNEON<BLEND_ADDITIVE>, blendNEON<BLEND_SUBTRACTIVE>, blendNEON<BLEND_MULTIPLY>
+		};
+		return procs[mode];
+	}
+#endif
+
+	default:
+		break;
+	}
+
+	return 0;
+}
+
+const char *getBlendKernelName(BlendKernel kernel) {
+	static const char *const names[kBlendKernelCount] = {
+		"scalar",
+		"SSE2",
+		"AVX2",
+		"NEON"
+	};
+
+	assert(kernel >= 0 && kernel < kBlendKernelCount);
+	return names[kernel];
+}
+
+BlendKernel getBestBlendKernel() {
+	static int bestKernel = -1;
+
+	if (bestKernel < 0) {
+		int kernel = kBlendKernelCount - 1;
+		while (kernel > kBlendKernelScalar && !getBlendBlitProc((BlendKernel)kernel, BLEND_NORMAL))
+			--kernel;
+		bestKernel = kernel;
+	}
+
+	return (BlendKernel)bestKernel;
+}
+
+BlendBlitProc getBestBlendBlitProc(TSpriteBlendMode mode) {
+	static BlendBlitProc procs[NUM_BLEND_MODES] = { 0, 0, 0, 0 };
+
+	// Like the blend path of TransparentSurface::blit() always did, refuse
+	// modes without a kernel instead of blending them some other way
+	if (mode < BLEND_NORMAL || mode >= NUM_BLEND_MODES)
+		error("getBestBlendBlitProc: Unsupported blend mode %d", mode);
+
+	if (!procs[mode])
+		procs[mode] = getBlendBlitProc(getBestBlendKernel(), mode);
+
+	return procs[mode];
+}
+
+} // End of namespace Graphics
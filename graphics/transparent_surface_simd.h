@@ -0,0 +1,83 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef GRAPHICS_TRANSPARENT_SURFACE_SIMD_H
+#define GRAPHICS_TRANSPARENT_SURFACE_SIMD_H
+
+#include "graphics/transform_struct.h"
+
+namespace Graphics {
+
+/**
+ * Signature of a TransparentSurface blend kernel.
+ *
+ * Blends a block of 32 bit pixels onto the target, see the doBlit*()
+ * functions in transparent_surface.cpp for the parameters. All kernels for
+ * one blend mode must produce bit identical results.
+ */
+typedef void (*BlendBlitProc)(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep, uint32 color);
+
+/**
+ * The available implementations of the blend kernels.
+ */
+enum BlendKernel {
+	kBlendKernelScalar = 0,
+	kBlendKernelSSE2,
+	kBlendKernelAVX2,
+	kBlendKernelNEON,
+
+	kBlendKernelCount
+};
+
+/**
+ * Returns the kernel of the given implementation for the given blend mode,
+ * or 0 if it is not available either in this build or on the CPU we are
+ * running on. The scalar kernels are always available.
+ */
+BlendBlitProc getBlendBlitProc(BlendKernel kernel, TSpriteBlendMode mode);
+
+/**
+ * Returns the name of the given kernel, for debug output.
+ */
+const char *getBlendKernelName(BlendKernel kernel);
+
+/**
+ * Returns the fastest kernel usable on this machine. The detection is only
+ * done once.
+ */
+BlendKernel getBestBlendKernel();
+
+/**
+ * Returns the fastest kernel for the given blend mode. Errors out for
+ * BLEND_UNKNOWN and other modes without a kernel.
+ */
+BlendBlitProc getBestBlendBlitProc(TSpriteBlendMode mode);
+
+// The scalar kernels, defined in transparent_surface.cpp
+void doBlitAlphaBlend(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep, uint32 color);
+void doBlitAdditiveBlend(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep, uint32 color);
+void doBlitSubtractiveBlend(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep, uint32 color);
+void doBlitMultiplyBlend(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep, uint32 color);
+
+} // End of namespace Graphics
+
+#endif
@@ -46,6 +46,18 @@ namespace Graphics {
 
 class YUVToRGBLookup;
 
+/**
+ * The available implementations of the YUV to RGB conversions.
+ */
+enum YUVToRGBKernel {
+	kYUVToRGBKernelScalar = 0, ///< The lookup tables
+	kYUVToRGBKernelSSE2,
+	kYUVToRGBKernelAVX2,
+	kYUVToRGBKernelNEON,
+
+	kYUVToRGBKernelCount
+};
+
 class YUVToRGBManager : public Common::Singleton<YUVToRGBManager> {
 public:
 	/** The scale of the luminance values */
@@ -105,6 +117,23 @@ public:
 	 */
 	void convert410(Graphics::Surface *dst, LuminanceScale scale, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch);
 
+	/**
+	 * Select the implementation used by convert444() and convert420().
+	 *
+	 * By default, the fastest one available on this machine is used. All of
+	 * them produce the same output. convert410() always uses the lookup
+	 * tables.
+	 *
+	 * @param kernel the implementation to use
+	 * @return false if the implementation is not available
+	 */
+	bool setKernel(YUVToRGBKernel kernel);
+
+	/**
+	 * Return the implementation used by convert444() and convert420().
+	 */
+	YUVToRGBKernel getKernel() const { return _kernel; }
+
 private:
 	friend class Common::Singleton<SingletonBaseType>;
 	YUVToRGBManager();
@@ -113,6 +142,7 @@ private:
 	const YUVToRGBLookup *getLookup(Graphics::PixelFormat format, LuminanceScale scale);
 
 	YUVToRGBLookup *_lookup;
+	YUVToRGBKernel _kernel;
 	int16 _colorTab[4 * 256]; // 2048 bytes
 };
 
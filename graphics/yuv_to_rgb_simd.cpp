@@ -0,0 +1,542 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "graphics/yuv_to_rgb_simd.h"
+
+#include "common/endian.h"
+#include "common/simd.h"
+#include "common/textconsole.h"
+
+namespace Graphics {
+
+#if defined(SCUMMVM_SIMD_X86) || defined(SCUMMVM_SIMD_NEON)
+
+/*
+ * The lookup tables of YUVToRGBManager add three terms to the luminance:
+ *
+ *   R = Y + trunc( 0.419 / 0.299 * (V - 128))
+ *   G = Y + trunc(-0.299 / 0.419 * (V - 128)) + trunc(-0.114 / 0.331 * (U - 128))
+ *   B = Y + trunc( 0.587 / 0.331 * (U - 128))
+ *
+ * and then clip the sums to [0, 255], or to [16, 235] followed by a
+ * stretch to [0, 255] for the ITU luminance scale.
+ *
+ * The vector kernels compute the same in 16 bit lanes. With the chroma
+ * scaled by 4, the high half of the product with the factors below is
+ * floor(factor * chroma). For negative products, trunc() is one more than
+ * that, as none of them is an integer. The factors were checked to give
+ * the table values for all chroma values. The ITU stretch (x * 255 / 219)
+ * is done in the same way, with the value scaled by 4. To save a few
+ * operations per pixel, the luminance and the chroma terms are scaled
+ * before they are added up in that case, and the luminance is offset by
+ * -16 so the clipping range starts at 0.
+ */
+enum {
+	kCrRFactor = 22938,  //  0.419 / 0.299 * 16384
+	kCrGFactor = -11702, // -0.299 / 0.419 * 16384
+	kCbGFactor = -5643,  // -0.114 / 0.331 * 16384
+	kCbBFactor = 29055,  //  0.587 / 0.331 * 16384
+	kITUFactor = 19078   //  255 / 219 * 16384
+};
+
+#define YUV_ROW_PROCS(name) { \
+	{ { name<uint16, false, false>, name<uint16, false, true> }, { name<uint16, true, false>, name<uint16, true, true> } }, \
+	{ { name<uint32, false, false>, name<uint32, false, true> }, { name<uint32, true, false>, name<uint32, true, true> } } \
+}
+
+typedef YUVToRGBRowProc RowProcTable[2][2][2];
+
+/**
+ * How to build pixels out of 8 bit channels in 16 bit lanes, like
+ * PixelFormat::RGBToColor() does. 32 bit pixels are built as two 16 bit
+ * words, the channels are shifted out of the word they do not belong to.
+ * Formats with a channel across both words are left to the tables.
+ */
+struct PixelPack {
+	int loss[3];     ///< Loss of the R, G and B channels
+	int shift[2][3]; ///< Shift of the channels within the low and high words
+	uint16 alpha[2]; ///< Alpha bits of the low and high words
+};
+
+static bool initPixelPack(PixelPack &pack, const PixelFormat &format, uint bytesPerPixel) {
+	const int losses[3] = { format.rLoss, format.gLoss, format.bLoss };
+	const int shifts[3] = { format.rShift, format.gShift, format.bShift };
+	const uint32 alpha = (0xFF >> format.aLoss) << format.aShift;
+
+	for (int i = 0; i < 3; ++i) {
+		const int top = shifts[i] + 8 - losses[i];
+		if (bytesPerPixel == 2 && top > 16)
+			return false;
+		if (shifts[i] < 16 && top > 16)
+			return false;
+
+		pack.loss[i] = losses[i];
+		pack.shift[0][i] = shifts[i] < 16 ? shifts[i] : 16;
+		pack.shift[1][i] = shifts[i] < 16 ? 16 : shifts[i] - 16;
+	}
+
+	pack.alpha[0] = alpha & 0xFFFF;
+	pack.alpha[1] = alpha >> 16;
+	return true;
+}
+
+#endif
+
+#ifdef SCUMMVM_SIMD_X86
+
+/**
+ * Computes the chroma terms of eight pixels, see above.
+ */
+template<bool kITU>
+SIMD_TARGET("sse2")
+static inline void chromaTermsSSE2(__m128i u, __m128i v, __m128i &crR, __m128i &crbG, __m128i &cbB) {
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i cu = _mm_sub_epi16(u, _mm_set1_epi16(128));
+	const __m128i cv = _mm_sub_epi16(v, _mm_set1_epi16(128));
+	const __m128i cu4 = _mm_slli_epi16(cu, 2);
+	const __m128i cv4 = _mm_slli_epi16(cv, 2);
+
+	// Subtracting the comparison masks adds one to the negative products
+	crR = _mm_sub_epi16(_mm_mulhi_epi16(cv4, _mm_set1_epi16(kCrRFactor)), _mm_cmplt_epi16(cv, zero));
+	cbB = _mm_sub_epi16(_mm_mulhi_epi16(cu4, _mm_set1_epi16(kCbBFactor)), _mm_cmplt_epi16(cu, zero));
+	crbG = _mm_add_epi16(_mm_sub_epi16(_mm_mulhi_epi16(cv4, _mm_set1_epi16(kCrGFactor)), _mm_cmpgt_epi16(cv, zero)),
+	                     _mm_sub_epi16(_mm_mulhi_epi16(cu4, _mm_set1_epi16(kCbGFactor)), _mm_cmpgt_epi16(cu, zero)));
+
+	if (kITU) {
+		crR = _mm_slli_epi16(crR, 2);
+		crbG = _mm_slli_epi16(crbG, 2);
+		cbB = _mm_slli_epi16(cbB, 2);
+	}
+}
+
+template<bool kITU>
+SIMD_TARGET("sse2")
+static inline __m128i luminanceSSE2(__m128i y) {
+	return kITU ? _mm_slli_epi16(_mm_sub_epi16(y, _mm_set1_epi16(16)), 2) : y;
+}
+
+/**
+ * Clips the sums of luminance and chroma terms like the lookup tables.
+ */
+template<bool kITU>
+SIMD_TARGET("sse2")
+static inline __m128i clipSSE2(__m128i x) {
+	if (kITU) {
+		x = _mm_min_epi16(_mm_max_epi16(x, _mm_setzero_si128()), _mm_set1_epi16(219 * 4));
+		return _mm_mulhi_epu16(x, _mm_set1_epi16(kITUFactor));
+	}
+
+	return _mm_min_epi16(_mm_max_epi16(x, _mm_setzero_si128()), _mm_set1_epi16(255));
+}
+
+/**
+ * Shift counts for PixelFormat::RGBToColor() on 8 bit channels, see
+ * PixelPack.
+ */
+struct PixelPackSSE2 {
+	__m128i rLoss, gLoss, bLoss;
+	__m128i rShift[2], gShift[2], bShift[2];
+	__m128i alpha[2];
+
+	SIMD_TARGET("sse2")
+	explicit PixelPackSSE2(const PixelPack &pack) {
+		rLoss = _mm_cvtsi32_si128(pack.loss[0]);
+		gLoss = _mm_cvtsi32_si128(pack.loss[1]);
+		bLoss = _mm_cvtsi32_si128(pack.loss[2]);
+		for (int i = 0; i < 2; ++i) {
+			rShift[i] = _mm_cvtsi32_si128(pack.shift[i][0]);
+			gShift[i] = _mm_cvtsi32_si128(pack.shift[i][1]);
+			bShift[i] = _mm_cvtsi32_si128(pack.shift[i][2]);
+			alpha[i] = _mm_set1_epi16((int16)pack.alpha[i]);
+		}
+	}
+};
+
+SIMD_TARGET("sse2")
+static inline __m128i packWordSSE2(__m128i r, __m128i g, __m128i b, const PixelPackSSE2 &pack, int word) {
+	__m128i pix = _mm_or_si128(pack.alpha[word], _mm_sll_epi16(r, pack.rShift[word]));
+	pix = _mm_or_si128(pix, _mm_sll_epi16(g, pack.gShift[word]));
+	return _mm_or_si128(pix, _mm_sll_epi16(b, pack.bShift[word]));
+}
+
+template<typename PixelInt, bool kITU>
+SIMD_TARGET("sse2")
+static inline void storePixelsSSE2(byte *dst, __m128i y, __m128i crR, __m128i crbG, __m128i cbB, const PixelPackSSE2 &pack) {
+	const __m128i r = _mm_srl_epi16(clipSSE2<kITU>(_mm_add_epi16(y, crR)), pack.rLoss);
+	const __m128i g = _mm_srl_epi16(clipSSE2<kITU>(_mm_add_epi16(y, crbG)), pack.gLoss);
+	const __m128i b = _mm_srl_epi16(clipSSE2<kITU>(_mm_add_epi16(y, cbB)), pack.bLoss);
+
+	const __m128i lo = packWordSSE2(r, g, b, pack, 0);
+	if (sizeof(PixelInt) == 2) {
+		_mm_storeu_si128((__m128i *)dst, lo);
+	} else {
+		const __m128i hi = packWordSSE2(r, g, b, pack, 1);
+		_mm_storeu_si128((__m128i *)dst, _mm_unpacklo_epi16(lo, hi));
+		_mm_storeu_si128((__m128i *)(dst + 16), _mm_unpackhi_epi16(lo, hi));
+	}
+}
+
+template<typename PixelInt, bool kITU, bool kHalfChroma>
+SIMD_TARGET("sse2")
+static int convertRowSSE2(byte *dst, int dstPitch, const byte *ySrc, int yPitch, const byte *uSrc, const byte *vSrc, int width, const PixelFormat &format) {
+	PixelPack scalarPack;
+	if (!initPixelPack(scalarPack, format, sizeof(PixelInt)))
+		return 0;
+
+	const PixelPackSSE2 pack(scalarPack);
+	const __m128i zero = _mm_setzero_si128();
+
+	// 8 pixels per iteration
+	int x = 0;
+	for (; x + 8 <= width; x += 8) {
+		__m128i u, v;
+		if (kHalfChroma) {
+			u = _mm_cvtsi32_si128(READ_LE_UINT32(uSrc + x / 2));
+			v = _mm_cvtsi32_si128(READ_LE_UINT32(vSrc + x / 2));
+			u = _mm_unpacklo_epi8(u, u);
+			v = _mm_unpacklo_epi8(v, v);
+		} else {
+			u = _mm_loadl_epi64((const __m128i *)(uSrc + x));
+			v = _mm_loadl_epi64((const __m128i *)(vSrc + x));
+		}
+
+		__m128i crR, crbG, cbB;
+		chromaTermsSSE2<kITU>(_mm_unpacklo_epi8(u, zero), _mm_unpacklo_epi8(v, zero), crR, crbG, cbB);
+
+		const __m128i y0 = luminanceSSE2<kITU>(_mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(ySrc + x)), zero));
+		storePixelsSSE2<PixelInt, kITU>(dst + x * sizeof(PixelInt), y0, crR, crbG, cbB, pack);
+
+		if (kHalfChroma) {
+			const __m128i y1 = luminanceSSE2<kITU>(_mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(ySrc + yPitch + x)), zero));
+			storePixelsSSE2<PixelInt, kITU>(dst + dstPitch + x * sizeof(PixelInt), y1, crR, crbG, cbB, pack);
+		}
+	}
+
+	return x;
+}
+
+template<bool kITU>
+SIMD_TARGET("avx2")
+static inline void chromaTermsAVX2(__m256i u, __m256i v, __m256i &crR, __m256i &crbG, __m256i &cbB) {
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i cu = _mm256_sub_epi16(u, _mm256_set1_epi16(128));
+	const __m256i cv = _mm256_sub_epi16(v, _mm256_set1_epi16(128));
+	const __m256i cu4 = _mm256_slli_epi16(cu, 2);
+	const __m256i cv4 = _mm256_slli_epi16(cv, 2);
+
+	crR = _mm256_sub_epi16(_mm256_mulhi_epi16(cv4, _mm256_set1_epi16(kCrRFactor)), _mm256_cmpgt_epi16(zero, cv));
+	cbB = _mm256_sub_epi16(_mm256_mulhi_epi16(cu4, _mm256_set1_epi16(kCbBFactor)), _mm256_cmpgt_epi16(zero, cu));
+	crbG = _mm256_add_epi16(_mm256_sub_epi16(_mm256_mulhi_epi16(cv4, _mm256_set1_epi16(kCrGFactor)), _mm256_cmpgt_epi16(cv, zero)),
+	                        _mm256_sub_epi16(_mm256_mulhi_epi16(cu4, _mm256_set1_epi16(kCbGFactor)), _mm256_cmpgt_epi16(cu, zero)));
+
+	if (kITU) {
+		crR = _mm256_slli_epi16(crR, 2);
+		crbG = _mm256_slli_epi16(crbG, 2);
+		cbB = _mm256_slli_epi16(cbB, 2);
+	}
+}
+
+template<bool kITU>
+SIMD_TARGET("avx2")
+static inline __m256i luminanceAVX2(__m256i y) {
+	return kITU ? _mm256_slli_epi16(_mm256_sub_epi16(y, _mm256_set1_epi16(16)), 2) : y;
+}
+
+template<bool kITU>
+SIMD_TARGET("avx2")
+static inline __m256i clipAVX2(__m256i x) {
+	if (kITU) {
+		x = _mm256_min_epi16(_mm256_max_epi16(x, _mm256_setzero_si256()), _mm256_set1_epi16(219 * 4));
+		return _mm256_mulhi_epu16(x, _mm256_set1_epi16(kITUFactor));
+	}
+
+	return _mm256_min_epi16(_mm256_max_epi16(x, _mm256_setzero_si256()), _mm256_set1_epi16(255));
+}
+
+SIMD_TARGET("avx2")
+static inline __m256i packWordAVX2(__m256i r, __m256i g, __m256i b, const PixelPackSSE2 &pack, int word) {
+	__m256i pix = _mm256_or_si256(_mm256_broadcastsi128_si256(pack.alpha[word]), _mm256_sll_epi16(r, pack.rShift[word]));
+	pix = _mm256_or_si256(pix, _mm256_sll_epi16(g, pack.gShift[word]));
+	return _mm256_or_si256(pix, _mm256_sll_epi16(b, pack.bShift[word]));
+}
+
+template<typename PixelInt, bool kITU>
+SIMD_TARGET("avx2")
+static inline void storePixelsAVX2(byte *dst, __m256i y, __m256i crR, __m256i crbG, __m256i cbB, const PixelPackSSE2 &pack) {
+	const __m256i r = _mm256_srl_epi16(clipAVX2<kITU>(_mm256_add_epi16(y, crR)), pack.rLoss);
+	const __m256i g = _mm256_srl_epi16(clipAVX2<kITU>(_mm256_add_epi16(y, crbG)), pack.gLoss);
+	const __m256i b = _mm256_srl_epi16(clipAVX2<kITU>(_mm256_add_epi16(y, cbB)), pack.bLoss);
+
+	const __m256i lo = packWordAVX2(r, g, b, pack, 0);
+	if (sizeof(PixelInt) == 2) {
+		_mm256_storeu_si256((__m256i *)dst, lo);
+	} else {
+		// The unpacks work within 128 bit lanes, so the halves have to be
+		// put back in order
+		const __m256i hi = packWordAVX2(r, g, b, pack, 1);
+		const __m256i p0 = _mm256_unpacklo_epi16(lo, hi);
+		const __m256i p1 = _mm256_unpackhi_epi16(lo, hi);
+		_mm256_storeu_si256((__m256i *)dst, _mm256_permute2x128_si256(p0, p1, 0x20));
+		_mm256_storeu_si256((__m256i *)(dst + 32), _mm256_permute2x128_si256(p0, p1, 0x31));
+	}
+}
+
+template<typename PixelInt, bool kITU, bool kHalfChroma>
+SIMD_TARGET("avx2")
+static int convertRowAVX2(byte *dst, int dstPitch, const byte *ySrc, int yPitch, const byte *uSrc, const byte *vSrc, int width, const PixelFormat &format) {
+	PixelPack scalarPack;
+	if (!initPixelPack(scalarPack, format, sizeof(PixelInt)))
+		return 0;
+
+	const PixelPackSSE2 pack(scalarPack);
+
+	// 16 pixels per iteration
+	int x = 0;
+	for (; x + 16 <= width; x += 16) {
+		__m128i u, v;
+		if (kHalfChroma) {
+			u = _mm_loadl_epi64((const __m128i *)(uSrc + x / 2));
+			v = _mm_loadl_epi64((const __m128i *)(vSrc + x / 2));
+			u = _mm_unpacklo_epi8(u, u);
+			v = _mm_unpacklo_epi8(v, v);
+		} else {
+			u = _mm_loadu_si128((const __m128i *)(uSrc + x));
+			v = _mm_loadu_si128((const __m128i *)(vSrc + x));
+		}
+
+		__m256i crR, crbG, cbB;
+		chromaTermsAVX2<kITU>(_mm256_cvtepu8_epi16(u), _mm256_cvtepu8_epi16(v), crR, crbG, cbB);
+
+		const __m256i y0 = luminanceAVX2<kITU>(_mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)(ySrc + x))));
+		storePixelsAVX2<PixelInt, kITU>(dst + x * sizeof(PixelInt), y0, crR, crbG, cbB, pack);
+
+		if (kHalfChroma) {
+			const __m256i y1 = luminanceAVX2<kITU>(_mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)(ySrc + yPitch + x))));
+			storePixelsAVX2<PixelInt, kITU>(dst + dstPitch + x * sizeof(PixelInt), y1, crR, crbG, cbB, pack);
+		}
+	}
+
+	// Finish with SSE2, the tables are much slower
+	const int chromaX = kHalfChroma ? x / 2 : x;
+	return x + convertRowSSE2<PixelInt, kITU, kHalfChroma>(dst + x * sizeof(PixelInt), dstPitch, ySrc + x, yPitch,
+	                                                       uSrc + chromaX, vSrc + chromaX, width - x, format);
+}
+
+#endif // SCUMMVM_SIMD_X86
+
+#ifdef SCUMMVM_SIMD_NEON
+
+template<bool kITU>
+static inline void chromaTermsNEON(int16x8_t u, int16x8_t v, int16x8_t &crR, int16x8_t &crbG, int16x8_t &cbB) {
+	const int16x8_t zero = vdupq_n_s16(0);
+	const int16x8_t cu = vsubq_s16(u, vdupq_n_s16(128));
+	const int16x8_t cv = vsubq_s16(v, vdupq_n_s16(128));
+	// The doubling multiply only needs the chroma scaled by 2
+	const int16x8_t cu2 = vshlq_n_s16(cu, 1);
+	const int16x8_t cv2 = vshlq_n_s16(cv, 1);
+
+	crR = vsubq_s16(vqdmulhq_s16(cv2, vdupq_n_s16(kCrRFactor)), vreinterpretq_s16_u16(vcltq_s16(cv, zero)));
+	cbB = vsubq_s16(vqdmulhq_s16(cu2, vdupq_n_s16(kCbBFactor)), vreinterpretq_s16_u16(vcltq_s16(cu, zero)));
+	crbG = vaddq_s16(vsubq_s16(vqdmulhq_s16(cv2, vdupq_n_s16(kCrGFactor)), vreinterpretq_s16_u16(vcgtq_s16(cv, zero))),
+	                 vsubq_s16(vqdmulhq_s16(cu2, vdupq_n_s16(kCbGFactor)), vreinterpretq_s16_u16(vcgtq_s16(cu, zero))));
+
+	// Like for the chroma, the ITU stretch only needs a scale of 2
+	if (kITU) {
+		crR = vshlq_n_s16(crR, 1);
+		crbG = vshlq_n_s16(crbG, 1);
+		cbB = vshlq_n_s16(cbB, 1);
+	}
+}
+
+template<bool kITU>
+static inline int16x8_t luminanceNEON(int16x8_t y) {
+	return kITU ? vshlq_n_s16(vsubq_s16(y, vdupq_n_s16(16)), 1) : y;
+}
+
+template<bool kITU>
+static inline uint16x8_t clipNEON(int16x8_t x) {
+	if (kITU) {
+		x = vminq_s16(vmaxq_s16(x, vdupq_n_s16(0)), vdupq_n_s16(219 * 2));
+		return vreinterpretq_u16_s16(vqdmulhq_s16(x, vdupq_n_s16(kITUFactor)));
+	}
+
+	return vreinterpretq_u16_s16(vminq_s16(vmaxq_s16(x, vdupq_n_s16(0)), vdupq_n_s16(255)));
+}
+
+/**
+ * Shift counts for PixelFormat::RGBToColor() on 8 bit channels, see
+ * PixelPack. Negative shift counts shift to the right.
+ */
+struct PixelPackNEON {
+	int16x8_t rLoss, gLoss, bLoss;
+	int16x8_t rShift[2], gShift[2], bShift[2];
+	uint16x8_t alpha[2];
+
+	explicit PixelPackNEON(const PixelPack &pack) {
+		rLoss = vdupq_n_s16(-pack.loss[0]);
+		gLoss = vdupq_n_s16(-pack.loss[1]);
+		bLoss = vdupq_n_s16(-pack.loss[2]);
+		for (int i = 0; i < 2; ++i) {
+			rShift[i] = vdupq_n_s16(pack.shift[i][0]);
+			gShift[i] = vdupq_n_s16(pack.shift[i][1]);
+			bShift[i] = vdupq_n_s16(pack.shift[i][2]);
+			alpha[i] = vdupq_n_u16(pack.alpha[i]);
+		}
+	}
+};
+
+static inline uint16x8_t packWordNEON(uint16x8_t r, uint16x8_t g, uint16x8_t b, const PixelPackNEON &pack, int word) {
+	uint16x8_t pix = vorrq_u16(pack.alpha[word], vshlq_u16(r, pack.rShift[word]));
+	pix = vorrq_u16(pix, vshlq_u16(g, pack.gShift[word]));
+	return vorrq_u16(pix, vshlq_u16(b, pack.bShift[word]));
+}
+
+template<typename PixelInt, bool kITU>
+static inline void storePixelsNEON(byte *dst, int16x8_t y, int16x8_t crR, int16x8_t crbG, int16x8_t cbB, const PixelPackNEON &pack) {
+	const uint16x8_t r = vshlq_u16(clipNEON<kITU>(vaddq_s16(y, crR)), pack.rLoss);
+	const uint16x8_t g = vshlq_u16(clipNEON<kITU>(vaddq_s16(y, crbG)), pack.gLoss);
+	const uint16x8_t b = vshlq_u16(clipNEON<kITU>(vaddq_s16(y, cbB)), pack.bLoss);
+
+	const uint16x8_t lo = packWordNEON(r, g, b, pack, 0);
+	if (sizeof(PixelInt) == 2) {
+		vst1q_u16((uint16 *)dst, lo);
+	} else {
+		uint16x8x2_t pix;
+		pix.val[0] = lo;
+		pix.val[1] = packWordNEON(r, g, b, pack, 1);
+		vst2q_u16((uint16 *)dst, pix);
+	}
+}
+
+template<typename PixelInt, bool kITU, bool kHalfChroma>
+static int convertRowNEON(byte *dst, int dstPitch, const byte *ySrc, int yPitch, const byte *uSrc, const byte *vSrc, int width, const PixelFormat &format) {
+	PixelPack scalarPack;
+	if (!initPixelPack(scalarPack, format, sizeof(PixelInt)))
+		return 0;
+
+	const PixelPackNEON pack(scalarPack);
+
+	// 8 pixels per iteration
+	int x = 0;
+	for (; x + 8 <= width; x += 8) {
+		uint8x8_t u, v;
+		if (kHalfChroma) {
+			u = vreinterpret_u8_u32(vdup_n_u32(READ_LE_UINT32(uSrc + x / 2)));
+			v = vreinterpret_u8_u32(vdup_n_u32(READ_LE_UINT32(vSrc + x / 2)));
+			u = vzip_u8(u, u).val[0];
+			v = vzip_u8(v, v).val[0];
+		} else {
+			u = vld1_u8(uSrc + x);
+			v = vld1_u8(vSrc + x);
+		}
+
+		int16x8_t crR, crbG, cbB;
+		chromaTermsNEON<kITU>(vreinterpretq_s16_u16(vmovl_u8(u)), vreinterpretq_s16_u16(vmovl_u8(v)), crR, crbG, cbB);
+
+		const int16x8_t y0 = luminanceNEON<kITU>(vreinterpretq_s16_u16(vmovl_u8(vld1_u8(ySrc + x))));
+		storePixelsNEON<PixelInt, kITU>(dst + x * sizeof(PixelInt), y0, crR, crbG, cbB, pack);
+
+		if (kHalfChroma) {
+			const int16x8_t y1 = luminanceNEON<kITU>(vreinterpretq_s16_u16(vmovl_u8(vld1_u8(ySrc + yPitch + x))));
+			storePixelsNEON<PixelInt, kITU>(dst + dstPitch + x * sizeof(PixelInt), y1, crR, crbG, cbB, pack);
+		}
+	}
+
+	return x;
+}
+
+#endif // SCUMMVM_SIMD_NEON
+
+YUVToRGBRowProc getYUVToRGBRowProc(YUVToRGBKernel kernel, int bytesPerPixel, YUVToRGBManager::LuminanceScale scale, bool halfChroma) {
+	if (bytesPerPixel != 2 && bytesPerPixel != 4)
+		return 0;
+
+#if defined(SCUMMVM_SIMD_X86) || defined(SCUMMVM_SIMD_NEON)
+	const int wide = (bytesPerPixel == 4) ? 1 : 0;
+	const int itu = (scale == YUVToRGBManager::kScaleITU) ? 1 : 0;
+	const int half = halfChroma ? 1 : 0;
+#endif
+
+	switch (kernel) {
+#ifdef SCUMMVM_SIMD_X86
+	case kYUVToRGBKernelSSE2:
+		if (Common::hasSSE2()) {
+			static const RowProcTable procs = YUV_ROW_PROCS(convertRowSSE2);
+			return procs[wide][itu][half];
+		}
+		break;
+
+	case kYUVToRGBKernelAVX2:
+		if (Common::hasAVX2()) {
+			static const RowProcTable procs = YUV_ROW_PROCS(convertRowAVX2);
+			return procs[wide][itu][half];
+		}
+		break;
+#endif
+
+#ifdef SCUMMVM_SIMD_NEON
+	case kYUVToRGBKernelNEON: {
+		static const RowProcTable procs = YUV_ROW_PROCS(convertRowNEON);
+		return procs[wide][itu][half];
+	}
+#endif
+
+	default:
+		break;
+	}
+
+	return 0;
+}
+
+bool isYUVToRGBKernelAvailable(YUVToRGBKernel kernel) {
+	if (kernel == kYUVToRGBKernelScalar)
+		return true;
+
+	return getYUVToRGBRowProc(kernel, 4, YUVToRGBManager::kScaleFull, false) != 0;
+}
+
+const char *getYUVToRGBKernelName(YUVToRGBKernel kernel) {
+	static const char *const names[kYUVToRGBKernelCount] = {
+		"scalar",
+		"SSE2",
+		"AVX2",
+		"NEON"
+	};
+
+	assert(kernel >= 0 && kernel < kYUVToRGBKernelCount);
+	return names[kernel];
+}
+
+YUVToRGBKernel getBestYUVToRGBKernel() {
+	static int bestKernel = -1;
+
+	if (bestKernel < 0) {
+		int kernel = kYUVToRGBKernelCount - 1;
+		while (kernel > kYUVToRGBKernelScalar && !isYUVToRGBKernelAvailable((YUVToRGBKernel)kernel))
+			--kernel;
+		bestKernel = kernel;
+	}
+
+	return (YUVToRGBKernel)bestKernel;
+}
+
+} // End of namespace Graphics
@@ -0,0 +1,85 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef GRAPHICS_YUV_TO_RGB_SIMD_H
+#define GRAPHICS_YUV_TO_RGB_SIMD_H
+
+#include "graphics/yuv_to_rgb.h"
+
+namespace Graphics {
+
+/**
+ * Signature of a vectorized YUV to RGB row converter.
+ *
+ * Converts the pixels of a row from the start, in blocks of the vector
+ * width, and returns how many pixels were converted. The caller converts
+ * the rest with the lookup tables. The result must be bit identical to the
+ * lookup tables of YUVToRGBManager.
+ *
+ * The converters for YUV420 do two rows at once, which share the chroma
+ * values. The second row is at dst + dstPitch and ySrc + yPitch. The
+ * converters for YUV444 ignore the pitches.
+ *
+ * @param dst      the destination row
+ * @param dstPitch the pitch of the destination
+ * @param ySrc     the y values of the row
+ * @param yPitch   the pitch of the y values
+ * @param uSrc     the u values of the row, one per pixel or one per two pixels
+ * @param vSrc     the v values of the row, like uSrc
+ * @param width    the number of pixels in the row
+ * @param format   the pixel format of the destination
+ * @return the number of pixels converted in each row, always an even number
+ */
+typedef int (*YUVToRGBRowProc)(byte *dst, int dstPitch, const byte *ySrc, int yPitch, const byte *uSrc, const byte *vSrc, int width, const PixelFormat &format);
+
+/**
+ * Returns the row converter of the given implementation, or 0 if there is
+ * none either in this build or on the CPU we are running on. There is no
+ * row converter for kYUVToRGBKernelScalar, which stands for the lookup
+ * tables.
+ *
+ * @param kernel        the implementation
+ * @param bytesPerPixel the size of the destination pixels, 2 or 4
+ * @param scale         the scale of the luminance values
+ * @param halfChroma    whether there is one chroma value per two pixels
+ */
+YUVToRGBRowProc getYUVToRGBRowProc(YUVToRGBKernel kernel, int bytesPerPixel, YUVToRGBManager::LuminanceScale scale, bool halfChroma);
+
+/**
+ * Returns whether the given implementation can be used on this machine.
+ */
+bool isYUVToRGBKernelAvailable(YUVToRGBKernel kernel);
+
+/**
+ * Returns the name of the given implementation, for debug output.
+ */
+const char *getYUVToRGBKernelName(YUVToRGBKernel kernel);
+
+/**
+ * Returns the fastest implementation usable on this machine. The detection
+ * is only done once.
+ */
+YUVToRGBKernel getBestYUVToRGBKernel();
+
+} // End of namespace Graphics
+
+#endif
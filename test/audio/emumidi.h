@@ -0,0 +1,243 @@
+#include <cxxtest/TestSuite.h>
+
+#include "audio/softsynth/emumidi.h"
+
+#include "test/system.h"
+
+/**
+ * A soft synth whose output is the number of the sample frame, and which
+ * remembers the sample frame at which each message is played. Events from
+ * deferEvent() are timestamped, or go through the default of
+ * MidiDriver_Emulated.
+ */
+class RenderAheadTestSynth : public MidiDriver_Emulated {
+public:
+	RenderAheadTestSynth(uint renderAheadMs, bool timestamps) : MidiDriver_Emulated(0), _renderAheadMs(renderAheadMs), _timestamps(timestamps), _position(0) {}
+
+	int open() {
+		MidiDriver_Emulated::open();
+		startRenderAhead(_renderAheadMs);
+		return 0;
+	}
+
+	void close() {
+		setTimerCallback(0, 0);
+		stopRenderAhead();
+	}
+
+	void send(uint32 b) {
+		if (deferEvent(b, 0, 0))
+			return;
+		record(b, _position);
+	}
+
+	void sysEx(const byte *msg, uint16 length) {
+		if (deferEvent(0, msg, length))
+			return;
+		record(0xF0, _position);
+	}
+
+	MidiChannel *allocateChannel() { return 0; }
+	MidiChannel *getPercussionChannel() { return 0; }
+
+	bool isStereo() const { return false; }
+	int getRate() const { return 8000; }
+
+	Common::Array<uint32> _messages;
+	Common::Array<uint32> _positions;
+
+protected:
+	void generateSamples(int16 *buf, int len) {
+		for (int i = 0; i < len; ++i)
+			buf[i] = (int16)((_position + i) & 0x7FFF);
+		_position += len;
+	}
+
+	void playDeferredEvent(uint32 b, const byte *msg, uint16 length, uint32 offset) {
+		if (!_timestamps)
+			MidiDriver_Emulated::playDeferredEvent(b, msg, length, offset);
+		else
+			record(length ? 0xF0 : b, _position + offset);
+	}
+
+private:
+	void record(uint32 b, uint32 position) {
+		_messages.push_back(b);
+		_positions.push_back(position);
+	}
+
+	const uint _renderAheadMs;
+	const bool _timestamps;
+	uint32 _position;
+};
+
+class EmulatedMidiTestSuite : public CxxTest::TestSuite
+{
+private:
+	OSystem *_oldSystem;
+	TestSystem *_system;
+
+	enum {
+		// 100 ms at 8000 Hz
+		kRenderAheadMs = 100,
+		kRenderAheadFrames = 800,
+		// The player callback is called every 4 ms
+		kFramesPerTick = 32,
+		// Frames read by each mixer callback
+		kMixerFrames = 100
+	};
+
+	// One mixer callback, without the timer
+	static void mix(RenderAheadTestSynth &synth, int frames) {
+		int16 buffer[kMixerFrames];
+		synth.readBuffer(buffer, frames);
+	}
+
+	// Play like the mixer, with a timer callback after each mixer callback
+	void play(RenderAheadTestSynth &synth, int frames, Common::Array<int16> *output = 0) {
+		while (frames > 0) {
+			int16 buffer[kMixerFrames];
+			const int count = MIN<int>(frames, kMixerFrames);
+			synth.readBuffer(buffer, count);
+			if (output) {
+				for (int i = 0; i < count; ++i)
+					output->push_back(buffer[i]);
+			}
+			_system->fireTimer();
+			frames -= count;
+		}
+	}
+
+	static void playerProc(void *param) {
+		RenderAheadTestSynth *synth = (RenderAheadTestSynth *)param;
+		synth->send(0x7F3C90);
+	}
+
+public:
+	void setUp() {
+		_oldSystem = g_system;
+		_system = new TestSystem();
+		g_system = _system;
+	}
+
+	void tearDown() {
+		delete _system;
+		g_system = _oldSystem;
+	}
+
+	void test_player_events() {
+		RenderAheadTestSynth synth(kRenderAheadMs, true);
+		synth.setTimerCallback(&synth, playerProc);
+		synth.open();
+
+		Common::Array<int16> output;
+		play(synth, 2000, &output);
+
+		// The output is not changed by rendering ahead
+		TS_ASSERT_EQUALS(output.size(), 2000u);
+		for (uint i = 0; i < output.size(); ++i)
+			TS_ASSERT_EQUALS(output[i], (int16)i);
+
+		// The player callback is still called at each tick of the output,
+		// and its events are played right away
+		TS_ASSERT_LESS_THAN(2000u / kFramesPerTick, synth._positions.size());
+		for (uint i = 0; i < synth._positions.size(); ++i)
+			TS_ASSERT_EQUALS(synth._positions[i], i * kFramesPerTick);
+
+		synth.close();
+	}
+
+	void test_other_thread_events() {
+		for (int timestamps = 0; timestamps < 2; ++timestamps) {
+			RenderAheadTestSynth synth(kRenderAheadMs, timestamps);
+			synth.open();
+
+			// Events from other threads are played the render ahead time
+			// after the frame which is being played, keeping their spacing.
+			// The mixer has taken some of the rendered frames each time,
+			// so that is not where rendering is.
+			play(synth, 300);
+			mix(synth, 100);
+			synth.send(0x7F3C90);
+			_system->fireTimer();
+			mix(synth, 30);
+			synth.send(0x003C80);
+			static const byte reset[] = { 0xF0, 0x41, 0x10, 0x16, 0x12, 0x7F, 0x00, 0x00, 0x01, 0xF7 };
+			synth.sysEx(reset, sizeof(reset));
+			play(synth, 1500);
+
+			TS_ASSERT_EQUALS(synth._messages.size(), 3u);
+			TS_ASSERT_EQUALS(synth._messages[0], 0x7F3C90u);
+			TS_ASSERT_EQUALS(synth._positions[0], 400u + kRenderAheadFrames);
+			TS_ASSERT_EQUALS(synth._messages[1], 0x003C80u);
+			TS_ASSERT_EQUALS(synth._positions[1], 430u + kRenderAheadFrames);
+			TS_ASSERT_EQUALS(synth._messages[2], 0xF0u);
+			TS_ASSERT_EQUALS(synth._positions[2], 430u + kRenderAheadFrames);
+
+			synth.close();
+		}
+	}
+
+	void test_events_keep_order() {
+		RenderAheadTestSynth synth(kRenderAheadMs, true);
+		synth.setTimerCallback(&synth, playerProc);
+		synth.open();
+
+		for (int i = 0; i < 20; ++i) {
+			mix(synth, 70);
+			synth.send(0x003C80);
+			_system->fireTimer();
+		}
+		play(synth, 1000);
+
+		// Events of the player and of other threads are played in the
+		// order of their sample frames
+		uint deferred = 0;
+		for (uint i = 0; i < synth._messages.size(); ++i) {
+			if (i)
+				TS_ASSERT_LESS_THAN_EQUALS(synth._positions[i - 1], synth._positions[i]);
+			if (synth._messages[i] == 0x003C80u) {
+				TS_ASSERT_EQUALS(synth._positions[i], 70u * (deferred + 1) + kRenderAheadFrames);
+				++deferred;
+			}
+		}
+		TS_ASSERT_EQUALS(deferred, 20u);
+
+		synth.close();
+	}
+
+	void test_underrun() {
+		RenderAheadTestSynth synth(kRenderAheadMs, true);
+		synth.open();
+
+		// Without the timer, the mixer gets what was rendered when
+		// opening, and then silence
+		int16 buffer[kRenderAheadFrames + 100];
+		synth.readBuffer(buffer, ARRAYSIZE(buffer));
+		TS_ASSERT_EQUALS(buffer[kRenderAheadFrames - 1], (int16)(kRenderAheadFrames - 1));
+		TS_ASSERT_EQUALS(buffer[kRenderAheadFrames], 0);
+		TS_ASSERT_EQUALS(buffer[kRenderAheadFrames + 99], 0);
+
+		// Once the timer catches up, the output goes on where it stopped
+		_system->fireTimer();
+		synth.readBuffer(buffer, 1);
+		TS_ASSERT_EQUALS(buffer[0], (int16)kRenderAheadFrames);
+
+		synth.close();
+	}
+
+	void test_without_render_ahead() {
+		RenderAheadTestSynth synth(0, true);
+		synth.open();
+
+		// Everything is played right away
+		int16 buffer[300];
+		synth.readBuffer(buffer, ARRAYSIZE(buffer));
+		synth.send(0x7F3C90);
+		TS_ASSERT_EQUALS(synth._positions.size(), 1u);
+		TS_ASSERT_EQUALS(synth._positions[0], 300u);
+		TS_ASSERT(!_system->fireTimer());
+
+		synth.close();
+	}
+};
@@ -0,0 +1,340 @@
+#include <cxxtest/TestSuite.h>
+
+#include "audio/audiostream.h"
+#include "audio/midicache.h"
+#include "audio/midiparser.h"
+#include "audio/mixer_intern.h"
+#include "audio/softsynth/emumidi.h"
+
+#include "common/hashmap.h"
+#include "common/hash-str.h"
+#include "common/memstream.h"
+
+#include "backends/fs/abstract-fs.h"
+
+#include "test/system.h"
+
+typedef Common::HashMap<Common::String, Common::Array<byte> > MidiCacheTestFiles;
+
+/** A file in a MidiCacheTestDirectory. */
+class MidiCacheTestFile : public AbstractFSNode {
+public:
+	MidiCacheTestFile(MidiCacheTestFiles &files, const Common::String &name) : _files(files), _name(name) {}
+
+	bool exists() const { return _files.contains(_name); }
+	Common::String getName() const { return _name; }
+	Common::String getPath() const { return "/cache/" + _name; }
+	bool isDirectory() const { return false; }
+	bool isReadable() const { return exists(); }
+	bool isWritable() const { return true; }
+	AbstractFSNode *getChild(const Common::String &name) const { return 0; }
+	AbstractFSNode *getParent() const { return 0; }
+	bool getChildren(AbstractFSList &list, ListMode mode, bool hidden) const { return false; }
+
+	Common::SeekableReadStream *createReadStream() {
+		const Common::Array<byte> &data = _files[_name];
+		byte *copy = (byte *)malloc(data.size());
+		memcpy(copy, data.begin(), data.size());
+		return new Common::MemoryReadStream(copy, data.size(), DisposeAfterUse::YES);
+	}
+
+	/** Stores what was written when it is deleted, like a real file. */
+	class WriteStream : public Common::MemoryWriteStreamDynamic {
+	public:
+		WriteStream(MidiCacheTestFiles &files, const Common::String &name) : Common::MemoryWriteStreamDynamic(DisposeAfterUse::YES), _files(files), _name(name) {}
+
+		~WriteStream() {
+			Common::Array<byte> &data = _files[_name];
+			data.resize(size());
+			if (size())
+				memcpy(data.begin(), getData(), size());
+		}
+
+	private:
+		MidiCacheTestFiles &_files;
+		const Common::String _name;
+	};
+
+	Common::WriteStream *createWriteStream() { return new WriteStream(_files, _name); }
+	bool create(bool isDirectoryFlag) { return false; }
+
+private:
+	MidiCacheTestFiles &_files;
+	const Common::String _name;
+};
+
+/** A directory whose files are kept in memory. */
+class MidiCacheTestDirectory : public AbstractFSNode {
+public:
+	MidiCacheTestDirectory(MidiCacheTestFiles &files) : _files(files) {}
+
+	bool exists() const { return true; }
+	Common::String getName() const { return "cache"; }
+	Common::String getPath() const { return "/cache"; }
+	bool isDirectory() const { return true; }
+	bool isReadable() const { return true; }
+	bool isWritable() const { return true; }
+	AbstractFSNode *getChild(const Common::String &name) const { return new MidiCacheTestFile(_files, name); }
+	AbstractFSNode *getParent() const { return 0; }
+	bool getChildren(AbstractFSList &list, ListMode mode, bool hidden) const { return false; }
+	Common::SeekableReadStream *createReadStream() { return 0; }
+	Common::WriteStream *createWriteStream() { return 0; }
+	bool create(bool isDirectoryFlag) { return false; }
+
+private:
+	MidiCacheTestFiles &_files;
+};
+
+/**
+ * A soft synth whose output is the number of the last note played, and
+ * silence once that note is off.
+ */
+class MidiCacheTestSynth : public MidiDriver_Emulated {
+public:
+	MidiCacheTestSynth(Audio::Mixer *mixer, bool failOpen = false) : MidiDriver_Emulated(mixer), _failOpen(failOpen), _note(0) {}
+
+	int open() {
+		if (_failOpen)
+			return MERR_DEVICE_NOT_AVAILABLE;
+
+		MidiDriver_Emulated::open();
+		_mixer->playStream(Audio::Mixer::kPlainSoundType, &_mixerSoundHandle, this, -1, Audio::Mixer::kMaxChannelVolume, 0, DisposeAfterUse::NO, true);
+		return 0;
+	}
+
+	void close() {
+		_mixer->stopHandle(_mixerSoundHandle);
+	}
+
+	void send(uint32 b) {
+		const byte note = (b >> 8) & 0x7F;
+		if ((b & 0xF0) == 0x90 && (b >> 16) & 0x7F)
+			_note = note;
+		else if ((b & 0xE0) == 0x80 && note == _note)
+			_note = 0;
+	}
+
+	MidiChannel *allocateChannel() { return 0; }
+	MidiChannel *getPercussionChannel() { return 0; }
+
+	bool isStereo() const { return false; }
+	int getRate() const { return 8000; }
+
+protected:
+	void generateSamples(int16 *buf, int len) {
+		for (int i = 0; i < len; ++i)
+			buf[i] = _note * 100;
+	}
+
+private:
+	const bool _failOpen;
+	byte _note;
+};
+
+/** A TestSystem with a mixer. */
+class MidiCacheTestSystem : public TestSystem {
+public:
+	MidiCacheTestSystem() : _mixer(0) {}
+
+	~MidiCacheTestSystem() {
+		delete _mixer;
+	}
+
+	// The mixer needs the system to be installed as g_system
+	void createMixer() {
+		_mixer = new Audio::MixerImpl(this, 22050);
+		_mixer->setReady(true);
+	}
+
+	Audio::Mixer *getMixer() { return _mixer; }
+
+private:
+	Audio::MixerImpl *_mixer;
+};
+
+class MidiRenderCacheTestSuite : public CxxTest::TestSuite
+{
+private:
+	OSystem *_oldSystem;
+	MidiCacheTestSystem *_system;
+
+	// Format 0, one track, 96 ticks per quarter note at the default
+	// tempo, i.e. 5208 microseconds per tick. The note of the track is
+	// given, so that tracks can tell their renderings apart.
+	static void makeSong(byte *song, byte note) {
+		static const byte data[] = {
+			'M', 'T', 'h', 'd', 0, 0, 0, 6, 0, 0, 0, 1, 0, 96,
+			'M', 'T', 'r', 'k', 0, 0, 0, 12,
+			0x00, 0x90, 60, 100,
+			0x60, 0x80, 60, 0,
+			0x00, 0xFF, 0x2F, 0x00
+		};
+		memcpy(song, data, sizeof(data));
+		song[24] = song[28] = note;
+	}
+
+	enum {
+		kSongSize = 34,
+		// The whole timer calls are bounded, as a failing cache might
+		// never finish
+		kMaxTimerCalls = 1000
+	};
+
+	static Common::FSNode makeDirectory(MidiCacheTestFiles &files) {
+		return AbstractFSNode::makeFSNode(new MidiCacheTestDirectory(files));
+	}
+
+	void renderAll(Audio::MidiRenderCache &cache) {
+		for (int i = 0; i < kMaxTimerCalls && cache.isRendering(); ++i)
+			_system->fireTimer();
+	}
+
+	// Reads all of a stream, which must be at most maxSamples long
+	static Common::Array<int16> readAll(Audio::AudioStream &stream, int maxSamples) {
+		Common::Array<int16> samples(maxSamples);
+		int total = 0;
+		while (total < maxSamples && !stream.endOfData()) {
+			const int read = stream.readBuffer(&samples[total], MIN(512, maxSamples - total));
+			if (read <= 0)
+				break;
+			total += read;
+		}
+		samples.resize(total);
+		return samples;
+	}
+
+public:
+	void setUp() {
+		_oldSystem = g_system;
+		_system = new MidiCacheTestSystem();
+		g_system = _system;
+		_system->createMixer();
+	}
+
+	// The mutexes of the mixer are deleted through g_system
+	void tearDown() {
+		delete _system;
+		g_system = _oldSystem;
+	}
+
+	void test_render_and_open() {
+		MidiCacheTestFiles files;
+		Audio::MidiRenderCache cache(makeDirectory(files));
+
+		byte song[kSongSize];
+		makeSong(song, 60);
+
+		TS_ASSERT(!cache.open(song, sizeof(song), 0, "synth1"));
+		cache.queue(MidiParser::createParser_SMF(), new MidiCacheTestSynth(_system->getMixer()), song, sizeof(song), 0, "synth1");
+		TS_ASSERT(cache.isRendering());
+		renderAll(cache);
+		TS_ASSERT(!cache.isRendering());
+		TS_ASSERT_EQUALS(files.size(), 1u);
+
+		Audio::SeekableAudioStream *stream = cache.open(song, sizeof(song), 0, "synth1");
+		TS_ASSERT(stream);
+		if (!stream)
+			return;
+		TS_ASSERT_EQUALS(stream->getRate(), 8000);
+		TS_ASSERT(!stream->isStereo());
+
+		// The note plays for 96 ticks, then the synth has to stay silent
+		// for at least half a second before the rendering ends
+		const Common::Array<int16> samples = readAll(*stream, 8000 * 4);
+		const int noteLength = 96 * 5208 * 8 / 1000;
+		TS_ASSERT_LESS_THAN(noteLength + 4000, (int)samples.size());
+		TS_ASSERT_LESS_THAN((int)samples.size(), noteLength + 4000 + 1024 + 1);
+
+		int sounding = 0;
+		for (uint i = 0; i < samples.size(); ++i) {
+			if (samples[i] == 6000)
+				++sounding;
+			else
+				TS_ASSERT_EQUALS(samples[i], 0);
+		}
+		TS_ASSERT_DELTA(sounding, noteLength, 40);
+		TS_ASSERT_EQUALS(samples[0], 6000);
+
+		// A seekable stream, so it can be looped
+		TS_ASSERT(stream->rewind());
+		TS_ASSERT_EQUALS(readAll(*stream, 8000 * 4).size(), samples.size());
+		delete stream;
+
+		// Rendered tracks are not queued again
+		cache.queue(MidiParser::createParser_SMF(), new MidiCacheTestSynth(_system->getMixer()), song, sizeof(song), 0, "synth1");
+		TS_ASSERT(!cache.isRendering());
+	}
+
+	void test_keys() {
+		MidiCacheTestFiles files;
+		Audio::MidiRenderCache cache(makeDirectory(files));
+
+		byte song[kSongSize], otherSong[kSongSize];
+		makeSong(song, 60);
+		makeSong(otherSong, 40);
+
+		// The same track is only rendered once, even if queued twice
+		cache.queue(MidiParser::createParser_SMF(), new MidiCacheTestSynth(_system->getMixer()), song, sizeof(song), 0, "synth1");
+		cache.queue(MidiParser::createParser_SMF(), new MidiCacheTestSynth(_system->getMixer()), song, sizeof(song), 0, "synth1");
+		cache.queue(MidiParser::createParser_SMF(), new MidiCacheTestSynth(_system->getMixer()), otherSong, sizeof(otherSong), 0, "synth1");
+		cache.queue(MidiParser::createParser_SMF(), new MidiCacheTestSynth(_system->getMixer()), song, sizeof(song), 0, "synth2");
+		renderAll(cache);
+		TS_ASSERT_EQUALS(files.size(), 3u);
+
+		Audio::SeekableAudioStream *stream = cache.open(otherSong, sizeof(otherSong), 0, "synth1");
+		TS_ASSERT(stream);
+		if (stream) {
+			int16 sample = 0;
+			stream->readBuffer(&sample, 1);
+			TS_ASSERT_EQUALS(sample, 4000);
+			delete stream;
+		}
+
+		// Each device has its own renderings
+		stream = cache.open(song, sizeof(song), 0, "synth2");
+		TS_ASSERT(stream);
+		delete stream;
+		TS_ASSERT(!cache.open(otherSong, sizeof(otherSong), 0, "synth2"));
+	}
+
+	void test_interrupted() {
+		MidiCacheTestFiles files;
+		byte song[kSongSize];
+		makeSong(song, 60);
+
+		// Start rendering, but stop the cache half way through
+		{
+			Audio::MidiRenderCache cache(makeDirectory(files));
+			cache.queue(MidiParser::createParser_SMF(), new MidiCacheTestSynth(_system->getMixer()), song, sizeof(song), 0, "synth1");
+			_system->fireTimer();
+			TS_ASSERT(cache.isRendering());
+		}
+		TS_ASSERT_EQUALS(files.size(), 1u);
+
+		// The partial file is ignored and rendered again
+		Audio::MidiRenderCache cache(makeDirectory(files));
+		TS_ASSERT(!cache.open(song, sizeof(song), 0, "synth1"));
+		cache.queue(MidiParser::createParser_SMF(), new MidiCacheTestSynth(_system->getMixer()), song, sizeof(song), 0, "synth1");
+		renderAll(cache);
+
+		Audio::SeekableAudioStream *stream = cache.open(song, sizeof(song), 0, "synth1");
+		TS_ASSERT(stream);
+		delete stream;
+	}
+
+	void test_failed() {
+		MidiCacheTestFiles files;
+		Audio::MidiRenderCache cache(makeDirectory(files));
+
+		byte song[kSongSize];
+		makeSong(song, 60);
+
+		// A track whose driver can not be opened is not tried again
+		cache.queue(MidiParser::createParser_SMF(), new MidiCacheTestSynth(_system->getMixer(), true), song, sizeof(song), 0, "synth1");
+		renderAll(cache);
+		TS_ASSERT(!cache.open(song, sizeof(song), 0, "synth1"));
+		cache.queue(MidiParser::createParser_SMF(), new MidiCacheTestSynth(_system->getMixer()), song, sizeof(song), 0, "synth1");
+		TS_ASSERT(!cache.isRendering());
+		TS_ASSERT_EQUALS(files.size(), 0u);
+	}
+};
@@ -0,0 +1,105 @@
+#include <cxxtest/TestSuite.h>
+
+#include "audio/midiparser.h"
+#include "audio/softsynth/emumidi.h"
+
+class MidiParserTestSuite : public CxxTest::TestSuite
+{
+private:
+	/**
+	 * Emulated driver which renders nothing, but remembers the sample
+	 * position at which each message arrives. It runs at 1 MHz, so sample
+	 * positions are microseconds.
+	 */
+	class RecordingDriver : public MidiDriver_Emulated {
+	public:
+		RecordingDriver() : MidiDriver_Emulated(0), _position(0) {}
+
+		int open() { return MidiDriver_Emulated::open(); }
+		void close() {}
+		void send(uint32 b) {
+			// Only note messages, the parser also sends resets
+			if ((b & 0xE0) != 0x80)
+				return;
+
+			_messages.push_back(b);
+			_positions.push_back(_position);
+		}
+		MidiChannel *allocateChannel() { return 0; }
+		MidiChannel *getPercussionChannel() { return 0; }
+
+		bool isStereo() const { return false; }
+		int getRate() const { return 1000000; }
+
+		Common::Array<uint32> _messages;
+		Common::Array<uint32> _positions;
+
+	protected:
+		void generateSamples(int16 *buf, int len) {
+			memset(buf, 0, len * sizeof(int16));
+			_position += len;
+		}
+
+	private:
+		uint32 _position;
+	};
+
+	// Format 0, one track, 96 ticks per quarter note at the default
+	// tempo, i.e. 5208 microseconds per tick
+	static void runSong(RecordingDriver &driver, bool timestamps) {
+		static const byte song[] = {
+			'M', 'T', 'h', 'd', 0, 0, 0, 6, 0, 0, 0, 1, 0, 96,
+			'M', 'T', 'r', 'k', 0, 0, 0, 16,
+			0x00, 0x90, 60, 100,
+			0x03, 0x90, 64, 100,
+			0x0A, 0x80, 60, 0,
+			0x00, 0x80, 64, 0,
+			0x00, 0xFF, 0x2F, 0x00
+		};
+		byte data[sizeof(song)];
+		memcpy(data, song, sizeof(song));
+
+		MidiParser *parser = MidiParser::createParser_SMF();
+		parser->property(MidiParser::mpTimestampEvents, timestamps);
+		parser->setMidiDriver(&driver);
+		parser->setTimerRate(driver.getBaseTempo());
+		TS_ASSERT(parser->loadMusic(data, sizeof(data)));
+
+		driver.open();
+		driver.setTimerCallback(parser, MidiParser::timerCallback);
+
+		int16 buffer[1000];
+		for (int i = 0; i < 100; ++i)
+			driver.readBuffer(buffer, ARRAYSIZE(buffer));
+
+		driver.setTimerCallback(0, 0);
+		parser->unloadMusic();
+		delete parser;
+	}
+
+public:
+	void test_timer_granularity() {
+		RecordingDriver driver;
+		runSong(driver, false);
+
+		// Without timestamps, events are sent at the 4 ms timer ticks
+		TS_ASSERT_EQUALS(driver._messages.size(), 4u);
+		TS_ASSERT_EQUALS(driver._positions[1], 12000u);
+		TS_ASSERT_EQUALS(driver._positions[2], 64000u);
+	}
+
+	void test_timestamp_events() {
+		RecordingDriver driver;
+		runSong(driver, true);
+
+		TS_ASSERT_EQUALS(driver._messages.size(), 4u);
+		TS_ASSERT_EQUALS(driver._messages[0], 0x643C90u);
+		TS_ASSERT_EQUALS(driver._positions[0], 0u);
+		TS_ASSERT_EQUALS(driver._messages[1], 0x644090u);
+		TS_ASSERT_EQUALS(driver._positions[1], 3u * 5208);
+		TS_ASSERT_EQUALS(driver._messages[2], 0x003C80u);
+		TS_ASSERT_EQUALS(driver._positions[2], 13u * 5208);
+		TS_ASSERT_EQUALS(driver._messages[3], 0x004080u);
+		TS_ASSERT_EQUALS(driver._positions[3], 13u * 5208);
+	}
+};
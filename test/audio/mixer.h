@@ -0,0 +1,245 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/atomic.h"
+
+#include "audio/audiostream.h"
+#include "audio/mixer_intern.h"
+
+#include "test/system.h"
+
+/**
+ * An endless stream which counts its reads, and notices reads after it has
+ * been marked as stopped. Reads can be made slow, so that the audio thread
+ * is most likely inside one when the sound gets stopped.
+ */
+class StopTestStream : public Audio::AudioStream {
+public:
+	StopTestStream(bool *deleted = 0, uint readDelay = 0) : _deleted(deleted), _readDelay(readDelay), _reads(0), _stopped(0), _readAfterStop(0) {}
+	~StopTestStream() {
+		if (_deleted)
+			*_deleted = true;
+	}
+
+	int readBuffer(int16 *buffer, const int numSamples) {
+		checkStopped();
+		for (int i = 0; i < numSamples; ++i)
+			buffer[i] = 1000;
+		Common::atomicStore(&_reads, Common::atomicLoad(&_reads) + 1);
+#ifdef POSIX
+		if (_readDelay)
+			TestThread::sleep(_readDelay);
+#endif
+		checkStopped();
+		return numSamples;
+	}
+
+	bool isStereo() const { return false; }
+	int getRate() const { return 22050; }
+	bool endOfData() const { return false; }
+
+	uint32 getReads() const { return Common::atomicLoad(&_reads); }
+	void markStopped() { Common::atomicStore(&_stopped, 1); }
+	bool wasReadAfterStop() const { return Common::atomicLoad(&_readAfterStop) != 0; }
+
+private:
+	void checkStopped() {
+		if (Common::atomicLoad(&_stopped))
+			Common::atomicStore(&_readAfterStop, 1);
+	}
+
+	bool *_deleted;
+	const uint _readDelay;
+	volatile uint32 _reads;
+	volatile uint32 _stopped;
+	volatile uint32 _readAfterStop;
+};
+
+class MixerTestSuite : public CxxTest::TestSuite
+{
+private:
+	OSystem *_oldSystem;
+	TestSystem *_system;
+	Audio::MixerImpl *_mixer;
+
+	enum {
+		kSoundId = 7,
+		kFrames = 256
+	};
+
+	int16 _buffer[kFrames * 2];
+
+	void mix() {
+		_mixer->mixCallback((byte *)_buffer, sizeof(_buffer));
+	}
+
+	void play(StopTestStream *stream, Audio::SoundHandle *handle, DisposeAfterUse::Flag dispose = DisposeAfterUse::NO) {
+		_mixer->playStream(Audio::Mixer::kSFXSoundType, handle, stream, kSoundId,
+		                   Audio::Mixer::kMaxChannelVolume, 0, dispose, false, false);
+	}
+
+#ifdef POSIX
+	struct AudioThread {
+		Audio::MixerImpl *mixer;
+		volatile uint32 quit;
+		volatile uint32 callbacks;
+	};
+
+	static void audioThreadProc(void *param) {
+		AudioThread *audio = (AudioThread *)param;
+		int16 buffer[kFrames * 2];
+		while (!Common::atomicLoad(&audio->quit)) {
+			audio->mixer->mixCallback((byte *)buffer, sizeof(buffer));
+			Common::atomicStore(&audio->callbacks, Common::atomicLoad(&audio->callbacks) + 1);
+			TestThread::yield();
+		}
+	}
+#endif
+
+public:
+	// The mutex of the mixer is deleted through g_system
+	void setUp() {
+		_oldSystem = g_system;
+		_system = new TestSystem();
+		g_system = _system;
+
+		_mixer = new Audio::MixerImpl(_system, 22050);
+		_mixer->setReady(true);
+	}
+
+	void tearDown() {
+		delete _mixer;
+		delete _system;
+		g_system = _oldSystem;
+	}
+
+	void test_stop_without_audio_thread() {
+		// Without callbacks, the stopping thread removes the channels itself
+		bool deleted = false;
+		Audio::SoundHandle handle;
+		play(new StopTestStream(&deleted), &handle, DisposeAfterUse::YES);
+		TS_ASSERT(_mixer->isSoundHandleActive(handle));
+
+		_mixer->stopHandle(handle);
+		TS_ASSERT(deleted);
+		TS_ASSERT(!_mixer->isSoundHandleActive(handle));
+
+		// Including channels which never got mixed, and after mixing
+		StopTestStream stream;
+		play(&stream, &handle);
+		mix();
+		TS_ASSERT_EQUALS(stream.getReads(), 1u);
+		_mixer->stopID(kSoundId);
+		stream.markStopped();
+		mix();
+		TS_ASSERT(!stream.wasReadAfterStop());
+		TS_ASSERT(!_mixer->isSoundIDActive(kSoundId));
+	}
+
+	void test_slot_reuse() {
+		// Stopped channels give back their slots, so this never runs out
+		for (int i = 0; i < 100; ++i) {
+			Audio::SoundHandle handles[3];
+			StopTestStream streams[3];
+			for (int j = 0; j < 3; ++j)
+				play(&streams[j], &handles[j]);
+			if (i & 1)
+				mix();
+			_mixer->stopHandle(handles[0]);
+			_mixer->stopAll();
+			for (int j = 0; j < 3; ++j)
+				TS_ASSERT(!_mixer->isSoundHandleActive(handles[j]));
+		}
+	}
+
+	void test_settings() {
+		StopTestStream stream;
+		Audio::SoundHandle handle;
+		play(&stream, &handle);
+
+		mix();
+		TS_ASSERT_DIFFERS(_buffer[0], 0);
+
+		// Volume and pause changes take effect at the next callback
+		_mixer->setChannelVolume(handle, 0);
+		mix();
+		TS_ASSERT_EQUALS(_buffer[0], 0);
+		_mixer->setChannelVolume(handle, Audio::Mixer::kMaxChannelVolume);
+
+		_mixer->pauseHandle(handle, true);
+		const uint32 reads = stream.getReads();
+		mix();
+		TS_ASSERT_EQUALS(stream.getReads(), reads);
+		TS_ASSERT_EQUALS(_buffer[0], 0);
+
+		_mixer->pauseHandle(handle, false);
+		mix();
+		TS_ASSERT_EQUALS(stream.getReads(), reads + 1);
+		TS_ASSERT_DIFFERS(_buffer[0], 0);
+
+		_mixer->stopHandle(handle);
+	}
+
+	void test_elapsed_time() {
+		StopTestStream stream;
+		Audio::SoundHandle handle;
+		play(&stream, &handle);
+		TS_ASSERT_EQUALS(_mixer->getElapsedTime(handle).totalNumberOfFrames(), 0);
+
+		// The position is the one at the start of the last callback, plus
+		// the time since then. A time stamp of 0 means not mixed yet.
+		_system->delayMillis(2);
+		for (int i = 0; i < 4; ++i)
+			mix();
+		const Audio::Timestamp elapsed = _mixer->getElapsedTime(handle);
+		TS_ASSERT_LESS_THAN_EQUALS(Audio::Timestamp(0, 3 * kFrames, 22050), elapsed);
+		TS_ASSERT_LESS_THAN(elapsed, Audio::Timestamp(0, 3 * kFrames, 22050).addMsecs(1000));
+
+		_mixer->stopHandle(handle);
+	}
+
+// The stopping of sounds while mixing needs a thread, which the tests only
+// have on POSIX
+#ifdef POSIX
+	void test_stop_while_mixing() {
+		AudioThread audio;
+		audio.mixer = _mixer;
+		audio.quit = 0;
+		audio.callbacks = 0;
+		TestThread *thread = new TestThread(audioThreadProc, &audio);
+
+		for (int i = 0; i < 60; ++i) {
+			StopTestStream *stream = new StopTestStream(0, 500);
+			Audio::SoundHandle handle;
+			play(stream, &handle);
+
+			// Stop the sound while the audio thread is mixing it
+			while (!stream->getReads())
+				TestThread::yield();
+
+			switch (i % 3) {
+			case 0:
+				_mixer->stopHandle(handle);
+				break;
+			case 1:
+				_mixer->stopID(kSoundId);
+				break;
+			default:
+				_mixer->stopAll();
+				break;
+			}
+			stream->markStopped();
+			TS_ASSERT(!_mixer->isSoundHandleActive(handle));
+
+			// The audio thread has let go of the stream
+			const uint32 callbacks = Common::atomicLoad(&audio.callbacks);
+			while (Common::atomicLoad(&audio.callbacks) - callbacks < 2)
+				TestThread::yield();
+			TS_ASSERT(!stream->wasReadAfterStop());
+			delete stream;
+		}
+
+		Common::atomicStore(&audio.quit, 1);
+		delete thread;
+	}
+#endif
+};
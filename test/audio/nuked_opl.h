@@ -0,0 +1,126 @@
+#include <cxxtest/TestSuite.h>
+
+#include "audio/softsynth/opl/nuked.h"
+
+class NukedOplTestSuite : public CxxTest::TestSuite
+{
+#ifndef DISABLE_NUKED_OPL
+private:
+	enum {
+		kSteps = 400,
+		kMaxBlock = 256
+	};
+
+	static uint32 nextRandom(uint32 &seed) {
+		seed = seed * 1103515245 + 12345;
+		return seed >> 16;
+	}
+
+	// Writes a random register, biased towards the ones which make
+	// sounds audible: key on, short attack and high output levels.
+	static void randomWrite(uint32 &seed, OPL::NUKED::Bit16u &reg, OPL::NUKED::Bit8u &val, bool opl3) {
+		static const uint8 slotRegs[] = { 0x20, 0x40, 0x60, 0x80, 0xE0 };
+		static const uint8 slotOffsets[] = { 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x10, 0x11, 0x12, 0x13, 0x14, 0x15 };
+
+		const uint32 type = nextRandom(seed) % 16;
+		const uint32 high = (opl3 && (nextRandom(seed) & 1)) ? 0x100 : 0;
+		val = (OPL::NUKED::Bit8u)nextRandom(seed);
+
+		if (type < 5) {
+			reg = slotRegs[type] + slotOffsets[nextRandom(seed) % ARRAYSIZE(slotOffsets)];
+			if (slotRegs[type] == 0x40)
+				val &= 0x9F;
+			else if (slotRegs[type] == 0x60)
+				val |= 0xA0;
+		} else if (type < 8) {
+			reg = 0xA0 + nextRandom(seed) % 9;
+		} else if (type < 12) {
+			reg = 0xB0 + nextRandom(seed) % 9;
+			val |= 0x20;
+		} else if (type < 14) {
+			reg = 0xC0 + nextRandom(seed) % 9;
+		} else if (type == 14) {
+			reg = 0xBD;
+			if (high)
+				reg = opl3 ? 0x104 : 0x08;
+		} else {
+			reg = 0xB0 + nextRandom(seed) % 9;
+			val &= ~0x20;
+		}
+
+		reg |= high;
+	}
+
+	// Renders the same random register log through the scalar and the
+	// vectorized emulator and compares the output sample by sample.
+	void compare(OPL::NUKED::Bit8u impl, uint32 seed, bool opl3, uint32 rate) {
+		OPL::NUKED::opl3_chip *refChip = new OPL::NUKED::opl3_chip;
+		OPL::NUKED::opl3_chip *vecChip = new OPL::NUKED::opl3_chip;
+		OPL::NUKED::opl3_vector *vec = new OPL::NUKED::opl3_vector;
+		OPL::NUKED::Bit16s ref[kMaxBlock * 2], res[kMaxBlock * 2];
+
+		OPL::NUKED::OPL3_Reset(refChip, rate);
+		OPL::NUKED::OPL3_Reset(vecChip, rate);
+		OPL::NUKED::OPL3_VectorReset(vec, vecChip);
+		TS_ASSERT(OPL::NUKED::OPL3_VectorSetImpl(vec, impl));
+
+		if (opl3) {
+			OPL::NUKED::OPL3_WriteReg(refChip, 0x105, 0x01);
+			OPL::NUKED::OPL3_VectorWriteReg(vec, 0x105, 0x01);
+		}
+
+		for (int step = 0; step < kSteps; ++step) {
+			const int writes = nextRandom(seed) % 4;
+			for (int i = 0; i < writes; ++i) {
+				OPL::NUKED::Bit16u reg;
+				OPL::NUKED::Bit8u val;
+				randomWrite(seed, reg, val, opl3);
+				OPL::NUKED::OPL3_WriteRegBuffered(refChip, reg, val);
+				OPL::NUKED::OPL3_VectorWriteRegBuffered(vec, reg, val);
+			}
+
+			const uint32 len = 1 + nextRandom(seed) % kMaxBlock;
+			OPL::NUKED::OPL3_GenerateStream(refChip, ref, len);
+			OPL::NUKED::OPL3_VectorGenerateStream(vec, res, len);
+
+			if (memcmp(ref, res, len * 2 * sizeof(ref[0])) != 0) {
+				TS_FAIL("Vectorized Nuked OPL output differs from the scalar one");
+				break;
+			}
+		}
+
+		delete vec;
+		delete vecChip;
+		delete refChip;
+	}
+
+	void compareAll(OPL::NUKED::Bit8u impl) {
+		if (!OPL::NUKED::OPL3_VectorSupported(impl))
+			return;
+
+		compare(impl, 1, false, 49716);
+		compare(impl, 2, true, 49716);
+		compare(impl, 3, true, 44100);
+		compare(impl, 4, false, 22050);
+	}
+#endif
+
+public:
+	void test_vector_scalar() {
+#ifndef DISABLE_NUKED_OPL
+		compareAll(OPL::NUKED::vector_impl_scalar);
+#endif
+	}
+
+	void test_vector_sse2() {
+#ifndef DISABLE_NUKED_OPL
+		compareAll(OPL::NUKED::vector_impl_sse2);
+#endif
+	}
+
+	void test_vector_avx2() {
+#ifndef DISABLE_NUKED_OPL
+		compareAll(OPL::NUKED::vector_impl_avx2);
+#endif
+	}
+};
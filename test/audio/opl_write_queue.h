@@ -0,0 +1,149 @@
+#include <cxxtest/TestSuite.h>
+
+#include "audio/fmopl.h"
+#include "audio/mixer_intern.h"
+
+#include "test/system.h"
+
+// EmulatedOPL takes its rate from the mixer and stops its channel there
+class OplTestSystem : public TestSystem {
+public:
+	OplTestSystem() : _mixer(0) {}
+
+	~OplTestSystem() {
+		delete _mixer;
+	}
+
+	// The mixer needs g_system for its mutexes, so it is created once the
+	// system is installed
+	Audio::Mixer *getMixer() {
+		if (!_mixer)
+			_mixer = new Audio::MixerImpl(this, 11025);
+		return _mixer;
+	}
+
+private:
+	Audio::MixerImpl *_mixer;
+};
+
+/**
+ * An "emulator" whose output is the value last written to register 1, so
+ * the samples show exactly where each write took effect.
+ */
+class LevelOPL : public OPL::EmulatedOPL {
+public:
+	LevelOPL() : _level(0) {}
+	~LevelOPL() { stop(); }
+
+	bool init() { return true; }
+	void reset() { _level = 0; }
+	void write(int a, int v) {}
+	byte read(int a) { return 0; }
+	void writeReg(int r, int v) {
+		if (r == 1)
+			_level = v;
+	}
+	bool isStereo() const { return false; }
+
+protected:
+	void generateSamples(int16 *buffer, int numSamples) {
+		for (int i = 0; i < numSamples; ++i)
+			buffer[i] = _level;
+	}
+
+private:
+	int16 _level;
+};
+
+class OplWriteQueueTestSuite : public CxxTest::TestSuite {
+private:
+	OSystem *_oldSystem;
+	OplTestSystem *_system;
+
+	// Renders the given number of samples in blocks of odd sizes
+	static void render(LevelOPL &opl, Common::Array<int16> &output, uint samples) {
+		const uint start = output.size();
+		output.resize(start + samples);
+
+		uint pos = 0, block = 1;
+		while (pos < samples) {
+			block = MIN<uint>(block * 3 + 2, samples - pos);
+			if (block > 300)
+				block = 37;
+			opl.readBuffer(&output[start + pos], block);
+			pos += block;
+		}
+	}
+
+public:
+	void setUp() {
+		_oldSystem = g_system;
+		_system = new OplTestSystem();
+		g_system = _system;
+	}
+
+	void tearDown() {
+		// The mixer needs g_system to delete its mutexes
+		delete _system;
+		g_system = _oldSystem;
+	}
+
+	void test_write_timing() {
+		LevelOPL opl;
+		opl.setCallbackFrequency(250);
+
+		// In order, with two writes at the same position, and one which
+		// would overtake the previous one and is delayed to its position
+		opl.writeRegAt(10, 1, 1);
+		opl.writeRegAt(100, 1, 2);
+		opl.writeRegAt(100, 1, 3);
+		opl.writeRegAt(1000, 1, 4);
+		opl.writeRegAt(500, 1, 5);
+		opl.writeRegAt(1500, 2, 6);
+
+		Common::Array<int16> output;
+		render(opl, output, 2000);
+		TS_ASSERT_EQUALS(opl.getSamplePosition(), 2000u);
+
+		for (uint i = 0; i < output.size(); ++i) {
+			const int16 expected = i < 10 ? 0 : i < 100 ? 1 : i < 1000 ? 3 : 5;
+			if (output[i] != expected) {
+				TS_FAIL(Common::String::format("Sample %d is %d instead of %d", i, output[i], expected).c_str());
+				break;
+			}
+		}
+
+		// Writes for positions which were rendered already take effect at
+		// the start of the next block
+		opl.writeRegAt(1200, 1, 7);
+		render(opl, output, 10);
+		TS_ASSERT_EQUALS(output[2000], 7);
+	}
+
+	// The queue never runs empty here, and the ring buffer wraps around
+	// many times without losing or reordering writes
+	void test_queue_never_empty() {
+		LevelOPL opl;
+		opl.setCallbackFrequency(250);
+
+		Common::Array<int16> output;
+		uint32 next = 5;
+		for (int i = 0; i < 2000; ++i) {
+			// Keep about 20 writes pending, 3 samples apart
+			while (next < opl.getSamplePosition() + 60) {
+				opl.writeRegAt(next, 1, (next / 3) & 0xFF);
+				next += 3;
+			}
+			render(opl, output, 7);
+		}
+
+		// Every sample shows the last write before or at its position
+		for (uint i = 5; i < output.size(); ++i) {
+			const int16 expected = ((i - 5) / 3 * 3 + 5) / 3 & 0xFF;
+			if (output[i] != expected) {
+				TS_FAIL(Common::String::format("Sample %d is %d instead of %d", i, output[i], expected).c_str());
+				break;
+			}
+		}
+	}
+};
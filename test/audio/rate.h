@@ -0,0 +1,215 @@
+#include <cxxtest/TestSuite.h>
+
+#include "audio/rate.h"
+#include "audio/mixer_intern.h"
+#include "audio/audiostream.h"
+#include "audio/decoders/raw.h"
+
+#include "common/memstream.h"
+
+#include "helper.h"
+
+#include "test/system.h"
+
+class RateTestSuite : public CxxTest::TestSuite
+{
+private:
+	OSystem *_oldSystem;
+	TestSystem *_system;
+
+	static Audio::AudioStream *makeConstantStream(int16 value, int samples, int rate) {
+		int16 *data = (int16 *)malloc(samples * sizeof(int16));
+		for (int i = 0; i < samples; ++i)
+			WRITE_UINT16(&data[i], value);
+
+		return Audio::makeRawStream(new Common::MemoryReadStream((const byte *)data, samples * sizeof(int16), DisposeAfterUse::YES), rate,
+		                            Audio::FLAG_16BITS
+#ifdef SCUMM_LITTLE_ENDIAN
+		                            | Audio::FLAG_LITTLE_ENDIAN
+#endif
+		                            );
+	}
+
+	void sincDCTemplate(int inRate, int outRate) {
+		const int inSamples = inRate / 10;
+		Audio::AudioStream *stream = makeConstantStream(10000, inSamples, inRate);
+		Audio::RateConverter *converter = Audio::makeRateConverter(inRate, outRate, false, false, Audio::kResamplingSinc);
+
+		const int outSamples = outRate / 10;
+		int16 *out = new int16[outSamples * 2];
+		memset(out, 0, outSamples * 2 * sizeof(int16));
+
+		const int res = converter->flow(*stream, out, outSamples, Audio::Mixer::kMaxMixerVolume, Audio::Mixer::kMaxMixerVolume);
+
+		// The output lasts as long as the input, the filter does not hold
+		// any samples back at the end of the input
+		TS_ASSERT_EQUALS(res, (int)(((int64)inSamples * outRate + inRate - 1) / inRate));
+		TS_ASSERT(!converter->hasPendingOutput());
+
+		// After the filter has settled, a constant input has to stay
+		// constant until the filter reaches the end of the input
+		const int tail = outRate / 200;
+		for (int i = outSamples / 20; i < res - tail; ++i) {
+			TS_ASSERT_LESS_THAN_EQUALS(ABS(out[i * 2] - 10000), 2);
+			TS_ASSERT_EQUALS(out[i * 2], out[i * 2 + 1]);
+		}
+
+		// Up to the last input sample, the output stays above half the
+		// input level, and only falls off after it
+		const int last = (int)((int64)(inSamples - 1) * outRate / inRate);
+		double tailEnergy = 0;
+		for (int i = res - tail; i < res; ++i) {
+			if (i <= last)
+				TS_ASSERT_LESS_THAN(5000, out[i * 2]);
+			tailEnergy += (double)out[i * 2] * out[i * 2];
+		}
+		TS_ASSERT_LESS_THAN(0.8 * tail * 10000.0 * 10000.0, tailEnergy);
+
+		delete[] out;
+		delete converter;
+		delete stream;
+	}
+
+	void accumulateTemplate(int inRate, int outRate, bool stereo, bool reverseStereo, Audio::ResamplingMode mode) {
+		const int outSamples = 1000;
+		const Audio::st_volume_t volL = 100, volR = 200;
+
+		int16 *sine;
+		Audio::SeekableAudioStream *stream = createSineStream<int16>(inRate, 1, &sine, false, stereo);
+		delete[] sine;
+		Audio::RateConverter *converter = Audio::makeRateConverter(inRate, outRate, stereo, reverseStereo, mode);
+
+		int16 *ref = new int16[outSamples * 2];
+		memset(ref, 0, outSamples * 2 * sizeof(int16));
+		TS_ASSERT_EQUALS(converter->flow(*stream, ref, outSamples, Audio::Mixer::kMaxMixerVolume, Audio::Mixer::kMaxMixerVolume), outSamples);
+
+		// Start over with the same converter settings
+		delete converter;
+		stream->rewind();
+		converter = Audio::makeRateConverter(inRate, outRate, stereo, reverseStereo, mode);
+
+		int32 *out = new int32[outSamples * 2];
+		for (int i = 0; i < outSamples * 2; ++i)
+			out[i] = 1;
+		TS_ASSERT_EQUALS(converter->flowAccumulate(*stream, out, outSamples, volL, volR), outSamples);
+
+		for (int i = 0; i < outSamples; ++i) {
+			TS_ASSERT_EQUALS(out[i * 2 + 0], 1 + ref[i * 2 + 0] * (reverseStereo ? volR : volL));
+			TS_ASSERT_EQUALS(out[i * 2 + 1], 1 + ref[i * 2 + 1] * (reverseStereo ? volL : volR));
+		}
+
+		delete[] out;
+		delete[] ref;
+		delete converter;
+		delete stream;
+	}
+
+public:
+	// The sinc filter banks are shared, guarded by a mutex
+	void setUp() {
+		_oldSystem = g_system;
+		_system = new TestSystem();
+		g_system = _system;
+	}
+
+	void tearDown() {
+		g_system = _oldSystem;
+		delete _system;
+	}
+
+	void test_flow_accumulate() {
+		accumulateTemplate(22050, 22050, false, false, Audio::kResamplingLinear);
+		accumulateTemplate(22050, 22050, true, true, Audio::kResamplingLinear);
+		accumulateTemplate(44100, 22050, true, false, Audio::kResamplingLinear);
+		accumulateTemplate(11025, 22050, true, true, Audio::kResamplingLinear);
+		accumulateTemplate(11025, 48000, true, true, Audio::kResamplingSinc);
+		accumulateTemplate(11025, 48000, false, false, Audio::kResamplingSinc);
+	}
+
+	void test_sinc_dc_upsample() {
+		sincDCTemplate(11025, 44100);
+		sincDCTemplate(11025, 48000);
+		sincDCTemplate(22050, 48000);
+	}
+
+	void test_sinc_dc_downsample() {
+		sincDCTemplate(48000, 22050);
+	}
+
+	void test_sinc_odd_ratio() {
+		// Needs more phases than are precomputed
+		sincDCTemplate(22222, 44100);
+	}
+
+	void test_sinc_shared_banks() {
+		// Converters with the same ratio share their filter bank, which
+		// has to outlive each of them and survive being dropped and
+		// built again
+		for (int i = 0; i < 3; ++i) {
+			Audio::RateConverter *first = Audio::makeRateConverter(11025, 44100, false, false, Audio::kResamplingSinc);
+			sincDCTemplate(11025, 44100);
+			sincDCTemplate(22050, 88200);
+			delete first;
+
+			// More unused banks than are kept
+			static const int rates[] = { 8000, 11000, 16000, 22000, 32000, 37800 };
+			for (int j = 0; j < ARRAYSIZE(rates); ++j)
+				sincDCTemplate(rates[j], 44100);
+			sincDCTemplate(11025, 44100);
+		}
+	}
+
+	void test_sinc_mixer_tail() {
+		// The mixer keeps a channel until its converter has returned the
+		// end of the sound
+		Audio::MixerImpl mixer(g_system, 44100);
+		mixer.setResamplingMode(Audio::kResamplingSinc);
+		mixer.setReady(true);
+
+		const int inSamples = 1000;
+		Audio::SoundHandle handle;
+		mixer.playStream(Audio::Mixer::kPlainSoundType, &handle, makeConstantStream(10000, inSamples, 11025),
+		                 -1, Audio::Mixer::kMaxChannelVolume, 0, DisposeAfterUse::YES, false, false);
+
+		int16 buffer[512 * 2];
+		int frames = 0;
+		for (int i = 0; i < 20 && mixer.isSoundHandleActive(handle); ++i) {
+			memset(buffer, 0, sizeof(buffer));
+			mixer.mixCallback((byte *)buffer, sizeof(buffer));
+
+			for (int j = 0; j < 512; ++j) {
+				if (buffer[j * 2] != 0)
+					++frames;
+			}
+		}
+
+		TS_ASSERT(!mixer.isSoundHandleActive(handle));
+		TS_ASSERT_EQUALS(frames, inSamples * 4);
+	}
+
+	void test_sinc_sine_upsample() {
+		// Upsample a sine from 11025 to 44100 Hz and compare it to the
+		// same sine generated at 44100 Hz directly.
+		int16 *sine11k;
+		Audio::SeekableAudioStream *stream = createSineStream<int16>(11025, 1, &sine11k, false, false);
+		int16 *sine44k = createSine<int16>(44100, 1);
+		delete[] sine11k;
+		Audio::RateConverter *converter = Audio::makeRateConverter(11025, 44100, false, false, Audio::kResamplingSinc);
+
+		const int outSamples = 44100 / 2;
+		int16 *out = new int16[outSamples * 2];
+		memset(out, 0, outSamples * 2 * sizeof(int16));
+
+		TS_ASSERT_EQUALS(converter->flow(*stream, out, outSamples, Audio::Mixer::kMaxMixerVolume, Audio::Mixer::kMaxMixerVolume), outSamples);
+
+		// The sine created by createSine has a frequency of 1 Hz, which is
+		// far below the cutoff, so the error has to be tiny.
+		for (int i = 100; i < outSamples; ++i)
+			TS_ASSERT_LESS_THAN_EQUALS(ABS(out[i * 2] - sine44k[i]), 64);
+
+		delete[] out;
+		free(sine44k);
+		delete converter;
+		delete stream;
+	}
+};
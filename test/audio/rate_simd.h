@@ -0,0 +1,158 @@
+#include <cxxtest/TestSuite.h>
+
+#include "audio/rate.h"
+#include "audio/rate_simd.h"
+#include "audio/mixer.h"
+#include "audio/audiostream.h"
+#include "audio/decoders/raw.h"
+
+#include "common/memstream.h"
+
+class RateSimdTestSuite : public CxxTest::TestSuite
+{
+private:
+	enum {
+		kMaxPairs = 37
+	};
+
+	static void fillSamples(int16 *buf, int count, uint32 seed) {
+		for (int i = 0; i < count; ++i) {
+			seed = seed * 1103515245 + 12345;
+			buf[i] = (int16)(seed >> 16);
+		}
+
+		// Make sure the extremes get covered
+		buf[0] = -32768;
+		buf[1] = 32767;
+		buf[2] = -1;
+		buf[3] = 1;
+	}
+
+	void checkKernel(Audio::MixStereoProc proc, Audio::st_volume_t volL, Audio::st_volume_t volR) {
+		int16 in[kMaxPairs * 2], out[kMaxPairs * 2];
+		int16 ref[kMaxPairs * 2], res[kMaxPairs * 2];
+
+		Audio::MixStereoProc scalar = Audio::getMixStereoProc(Audio::kMixKernelScalar);
+
+		fillSamples(in, kMaxPairs * 2, 1);
+		fillSamples(out, kMaxPairs * 2, 2);
+
+		// Every length up to kMaxPairs, to cover all the tail handling
+		for (int len = 0; len <= kMaxPairs; ++len) {
+			memcpy(ref, out, sizeof(out));
+			memcpy(res, out, sizeof(out));
+
+			scalar(ref, in, len, volL, volR);
+			proc(res, in, len, volL, volR);
+
+			TS_ASSERT_EQUALS(memcmp(ref, res, sizeof(ref)), 0);
+		}
+	}
+
+public:
+	void test_scalar_kernel() {
+		int16 in[4] = { 100, -100, 32767, -32768 };
+		int16 out[4] = { 0, 0, 32767, -32768 };
+
+		Audio::getMixStereoProc(Audio::kMixKernelScalar)(out, in, 2, 128, 256);
+
+		TS_ASSERT_EQUALS(out[0], 50);
+		TS_ASSERT_EQUALS(out[1], -100);
+		TS_ASSERT_EQUALS(out[2], 32767);
+		TS_ASSERT_EQUALS(out[3], -32768);
+	}
+
+	void test_kernels_bit_exact() {
+		static const Audio::st_volume_t volumes[] = { 0, 1, 17, 127, 128, 255, 256, 1000 };
+
+		for (int kernel = 0; kernel < Audio::kMixKernelCount; ++kernel) {
+			Audio::MixStereoProc proc = Audio::getMixStereoProc((Audio::MixKernel)kernel);
+			if (!proc)
+				continue;
+
+			for (int l = 0; l < ARRAYSIZE(volumes); ++l)
+				for (int r = 0; r < ARRAYSIZE(volumes); ++r)
+					checkKernel(proc, volumes[l], volumes[r]);
+		}
+	}
+
+	void test_accumulate_kernels_bit_exact() {
+		static const Audio::st_volume_t volumes[] = { 0, 1, 128, 256, 1000 };
+
+		int16 in[kMaxPairs * 2];
+		int32 ref[kMaxPairs * 2], res[kMaxPairs * 2];
+
+		fillSamples(in, kMaxPairs * 2, 4);
+
+		Audio::AccumulateStereoProc scalar = Audio::getAccumulateStereoProc(Audio::kMixKernelScalar);
+
+		for (int kernel = 0; kernel < Audio::kMixKernelCount; ++kernel) {
+			Audio::AccumulateStereoProc proc = Audio::getAccumulateStereoProc((Audio::MixKernel)kernel);
+			if (!proc)
+				continue;
+
+			for (int v = 0; v < ARRAYSIZE(volumes); ++v) {
+				for (int len = 0; len <= kMaxPairs; ++len) {
+					for (int i = 0; i < kMaxPairs * 2; ++i)
+						ref[i] = res[i] = i * 1000 - 30000;
+
+					scalar(ref, in, len, volumes[v], volumes[ARRAYSIZE(volumes) - 1 - v]);
+					proc(res, in, len, volumes[v], volumes[ARRAYSIZE(volumes) - 1 - v]);
+
+					TS_ASSERT_EQUALS(memcmp(ref, res, sizeof(ref)), 0);
+				}
+			}
+		}
+	}
+
+	void test_dot_product_kernels_bit_exact() {
+		int16 samples[64], coeffs[64];
+
+		fillSamples(samples, ARRAYSIZE(samples), 3);
+
+		// Keep the sum of the absolute coefficients below 65536, as required
+		for (int i = 0; i < ARRAYSIZE(coeffs); ++i)
+			coeffs[i] = (int16)(((i * 37) % 2047) - 1023);
+
+		Audio::DotProductProc scalar = Audio::getDotProductProc(Audio::kMixKernelScalar);
+
+		for (int kernel = 0; kernel < Audio::kMixKernelCount; ++kernel) {
+			Audio::DotProductProc proc = Audio::getDotProductProc((Audio::MixKernel)kernel);
+			if (!proc)
+				continue;
+
+			for (uint len = 8; len <= ARRAYSIZE(samples); len += 8)
+				TS_ASSERT_EQUALS(proc(samples, coeffs, len), scalar(samples, coeffs, len));
+		}
+	}
+
+	void test_best_kernel_available() {
+		TS_ASSERT(Audio::getMixStereoProc(Audio::getBestMixKernel()) != 0);
+	}
+
+	void test_copy_converter_reverse_stereo() {
+		static const int16 data[8] = { 1000, -2000, 3000, -4000, 32767, -32768, 256, -256 };
+
+		Audio::AudioStream *stream = Audio::makeRawStream(
+			new Common::MemoryReadStream((const byte *)data, sizeof(data)), 22050,
+			Audio::FLAG_16BITS | Audio::FLAG_STEREO
+#ifdef SCUMM_LITTLE_ENDIAN
+			| Audio::FLAG_LITTLE_ENDIAN
+#endif
+			);
+		Audio::RateConverter *converter = Audio::makeRateConverter(22050, 22050, true, true);
+
+		int16 out[8];
+		memset(out, 0, sizeof(out));
+
+		TS_ASSERT_EQUALS(converter->flow(*stream, out, 4, 128, 256), 4);
+
+		for (int i = 0; i < 4; ++i) {
+			TS_ASSERT_EQUALS(out[i * 2 + 1], (data[i * 2] * 128) / Audio::Mixer::kMaxMixerVolume);
+			TS_ASSERT_EQUALS(out[i * 2], data[i * 2 + 1]);
+		}
+
+		delete converter;
+		delete stream;
+	}
+};
@@ -0,0 +1,162 @@
+#include <cxxtest/TestSuite.h>
+
+#include "audio/soundcache.h"
+#include "audio/audiostream.h"
+#include "audio/decoders/raw.h"
+
+#include "common/archive.h"
+#include "common/memstream.h"
+
+#include "test/system.h"
+
+class SoundCacheTestSuite : public CxxTest::TestSuite
+{
+private:
+	enum {
+		kSoundSize = 1000
+	};
+
+	/** Archive whose members are all the same 8 bit sound. */
+	class SoundArchive : public Common::Archive {
+	public:
+		SoundArchive() : _opened(0) {
+			for (int i = 0; i < kSoundSize; ++i)
+				_data[i] = (byte)(i * 7);
+		}
+
+		bool hasFile(const Common::String &name) const { return true; }
+		int listMembers(Common::ArchiveMemberList &list) const { return 0; }
+
+		const Common::ArchiveMemberPtr getMember(const Common::String &name) const {
+			return Common::ArchiveMemberPtr(new Common::GenericArchiveMember(name, this));
+		}
+
+		Common::SeekableReadStream *createReadStreamForMember(const Common::String &name) const {
+			++_opened;
+			return new Common::MemoryReadStream(_data, kSoundSize);
+		}
+
+		byte _data[kSoundSize];
+		mutable int _opened;
+	};
+
+	OSystem *_oldSystem;
+	TestSystem *_system;
+
+	static Audio::SeekableAudioStream *makeSoundStream(Common::SeekableReadStream *stream, DisposeAfterUse::Flag disposeAfterUse) {
+		return Audio::makeRawStream(stream, 11025, Audio::FLAG_UNSIGNED, disposeAfterUse);
+	}
+
+	static bool checkSound(Audio::SeekableAudioStream *stream, const SoundArchive &archive) {
+		int16 buffer[kSoundSize + 10];
+		const int count = stream->readBuffer(buffer, ARRAYSIZE(buffer));
+		bool equal = (count == kSoundSize) && stream->endOfData();
+
+		for (int i = 0; i < count && equal; ++i)
+			equal = (buffer[i] == (int16)((archive._data[i] ^ 0x80) << 8));
+
+		delete stream;
+		return equal;
+	}
+
+public:
+	// The sounds have mutexes for their reference counts
+	void setUp() {
+		_oldSystem = g_system;
+		_system = new TestSystem();
+		g_system = _system;
+	}
+
+	void tearDown() {
+		g_system = _oldSystem;
+		delete _system;
+	}
+
+	void test_hit_miss() {
+		SoundArchive archive;
+		Audio::DecodedSoundCache cache(10 * kSoundSize * 2);
+
+		TS_ASSERT(checkSound(cache.createStream(archive, "sfx.zip", "click.raw", makeSoundStream), archive));
+		TS_ASSERT(checkSound(cache.createStream(archive, "sfx.zip", "click.raw", makeSoundStream), archive));
+		TS_ASSERT(checkSound(cache.createStream(archive, "sfx.zip", "CLICK.RAW", makeSoundStream), archive));
+
+		TS_ASSERT_EQUALS(archive._opened, 1);
+		TS_ASSERT_EQUALS(cache.getMisses(), 1u);
+		TS_ASSERT_EQUALS(cache.getHits(), 2u);
+		TS_ASSERT_EQUALS(cache.getSize(), (uint32)kSoundSize * 2);
+	}
+
+	void test_archive_names() {
+		SoundArchive first, second, third;
+		Audio::DecodedSoundCache cache(10 * kSoundSize * 2);
+
+		// Archives are told apart by their names, not their addresses
+		delete cache.createStream(first, "sfx.zip", "click.raw", makeSoundStream);
+		delete cache.createStream(second, "sfx.zip", "click.raw", makeSoundStream);
+		delete cache.createStream(third, "voice.zip", "click.raw", makeSoundStream);
+		delete cache.createStream(third, "sfx.zip:", "click.raw", makeSoundStream);
+
+		TS_ASSERT_EQUALS(first._opened, 1);
+		TS_ASSERT_EQUALS(second._opened, 0);
+		TS_ASSERT_EQUALS(third._opened, 2);
+		TS_ASSERT_EQUALS(cache.getHits(), 1u);
+	}
+
+	void test_seek() {
+		SoundArchive archive;
+		Audio::DecodedSoundCache cache(10 * kSoundSize * 2);
+
+		delete cache.createStream(archive, "sfx.zip", "click.raw", makeSoundStream);
+		Audio::SeekableAudioStream *stream = cache.createStream(archive, "sfx.zip", "click.raw", makeSoundStream);
+
+		TS_ASSERT_EQUALS(stream->getLength().totalNumberOfFrames(), (int)kSoundSize);
+		TS_ASSERT(stream->seek(Audio::Timestamp(0, 100, 11025)));
+
+		int16 sample;
+		TS_ASSERT_EQUALS(stream->readBuffer(&sample, 1), 1);
+		TS_ASSERT_EQUALS(sample, (int16)((archive._data[100] ^ 0x80) << 8));
+
+		TS_ASSERT(stream->rewind());
+		TS_ASSERT(checkSound(stream, archive));
+	}
+
+	void test_lru_eviction() {
+		SoundArchive archive;
+		Audio::DecodedSoundCache cache(2 * kSoundSize * 2);
+
+		delete cache.createStream(archive, "sfx.zip", "a.raw", makeSoundStream);
+		delete cache.createStream(archive, "sfx.zip", "b.raw", makeSoundStream);
+		delete cache.createStream(archive, "sfx.zip", "a.raw", makeSoundStream);
+		// Evicts b, which was used least recently
+		delete cache.createStream(archive, "sfx.zip", "c.raw", makeSoundStream);
+		TS_ASSERT_EQUALS(archive._opened, 3);
+
+		delete cache.createStream(archive, "sfx.zip", "a.raw", makeSoundStream);
+		TS_ASSERT_EQUALS(archive._opened, 3);
+		delete cache.createStream(archive, "sfx.zip", "b.raw", makeSoundStream);
+		TS_ASSERT_EQUALS(archive._opened, 4);
+
+		TS_ASSERT_EQUALS(cache.getSize(), (uint32)kSoundSize * 2 * 2);
+	}
+
+	void test_stream_outlives_cache() {
+		SoundArchive archive;
+		Audio::SeekableAudioStream *stream;
+		{
+			Audio::DecodedSoundCache cache(10 * kSoundSize * 2);
+			stream = cache.createStream(archive, "sfx.zip", "click.raw", makeSoundStream);
+		}
+
+		TS_ASSERT(checkSound(stream, archive));
+	}
+
+	void test_too_large() {
+		SoundArchive archive;
+		Audio::DecodedSoundCache cache(kSoundSize);
+
+		TS_ASSERT(checkSound(cache.createStream(archive, "sfx.zip", "click.raw", makeSoundStream), archive));
+		TS_ASSERT(checkSound(cache.createStream(archive, "sfx.zip", "click.raw", makeSoundStream), archive));
+		TS_ASSERT_EQUALS(archive._opened, 2);
+		TS_ASSERT_EQUALS(cache.getSize(), 0u);
+	}
+};
@@ -0,0 +1,239 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "test/benchmark/benchmark.h"
+
+#include "audio/softsynth/opl/dbopl.h"
+#include "audio/softsynth/opl/nuked.h"
+
+#include "common/array.h"
+#include "common/str.h"
+
+namespace Benchmark {
+
+enum {
+	kOplRate = 44100,
+	kSongSeconds = 30,
+	kTicksPerSecond = 70,
+	kOplChunk = 512
+};
+
+struct OplWrite {
+	uint32 frame;
+	uint16 reg;
+	uint8 val;
+};
+
+typedef Common::Array<OplWrite> OplLog;
+
+static void addWrite(OplLog &log, uint32 frame, uint16 reg, uint8 val) {
+	OplWrite write;
+	write.frame = frame;
+	write.reg = reg;
+	write.val = val;
+	log.push_back(write);
+}
+
+/**
+ * Builds the register log of a simple AdLib song: six melodic channels with
+ * different instruments, vibrato and tremolo, plus the rhythm section.
+ */
+static void buildSongLog(OplLog &log) {
+	static const uint8 slotOffsets[9] = { 0x00, 0x01, 0x02, 0x08, 0x09, 0x0A, 0x10, 0x11, 0x12 };
+	// 0x20, 0x40, 0x60, 0x80, 0xE0 for modulator and carrier, then 0xC0
+	static const uint8 instruments[6][11] = {
+		{ 0x21, 0x21, 0x1A, 0x00, 0xF2, 0xF2, 0x45, 0x76, 0x00, 0x00, 0x0E },
+		{ 0x31, 0x21, 0x15, 0x00, 0xDD, 0x56, 0x13, 0x26, 0x01, 0x00, 0x08 },
+		{ 0xE1, 0x61, 0x23, 0x02, 0x71, 0x82, 0xAE, 0x9E, 0x00, 0x00, 0x0A },
+		{ 0x01, 0x11, 0x4F, 0x00, 0xF1, 0xD2, 0x53, 0x74, 0x00, 0x00, 0x06 },
+		{ 0xC1, 0xC2, 0x12, 0x03, 0xF8, 0xF5, 0x2F, 0x38, 0x02, 0x01, 0x0C },
+		{ 0x07, 0x12, 0x4F, 0x00, 0xF2, 0xF2, 0x60, 0x72, 0x00, 0x00, 0x08 }
+	};
+	static const uint16 noteFreqs[12] = { 0x157, 0x16B, 0x181, 0x198, 0x1B0, 0x1CA, 0x1E5, 0x202, 0x220, 0x241, 0x263, 0x287 };
+	static const uint8 melody[16] = { 0, 4, 7, 12, 7, 4, 2, 5, 9, 14, 9, 5, 4, 7, 11, 16 };
+
+	addWrite(log, 0, 0x01, 0x20);
+	addWrite(log, 0, 0xBD, 0xE0);
+
+	for (int ch = 0; ch < 9; ++ch) {
+		const uint8 *inst = instruments[ch % 6];
+		for (int op = 0; op < 2; ++op) {
+			const uint8 offset = slotOffsets[ch] + op * 3;
+			addWrite(log, 0, 0x20 + offset, inst[0 + op]);
+			addWrite(log, 0, 0x40 + offset, inst[2 + op]);
+			addWrite(log, 0, 0x60 + offset, inst[4 + op]);
+			addWrite(log, 0, 0x80 + offset, inst[6 + op]);
+			addWrite(log, 0, 0xE0 + offset, inst[8 + op]);
+		}
+		addWrite(log, 0, 0xC0 + ch, inst[10]);
+	}
+
+	// Rhythm section frequencies
+	addWrite(log, 0, 0xA6, 0x57);
+	addWrite(log, 0, 0xB6, 0x09);
+	addWrite(log, 0, 0xA7, 0x03);
+	addWrite(log, 0, 0xB7, 0x0A);
+	addWrite(log, 0, 0xA8, 0x57);
+	addWrite(log, 0, 0xB8, 0x09);
+
+	const uint32 ticks = kSongSeconds * kTicksPerSecond;
+	for (uint32 tick = 0; tick < ticks; ++tick) {
+		const uint32 frame = (uint64)tick * kOplRate / kTicksPerSecond;
+
+		for (int ch = 0; ch < 6; ++ch) {
+			const int length = 4 + ch * 2;
+			if ((tick % length) != 0)
+				continue;
+
+			const uint32 step = tick / length + ch * 3;
+			const int note = melody[step % 16] + (ch % 3) * 5;
+			const int block = 2 + ch / 2 + note / 12;
+			const uint16 freq = noteFreqs[note % 12];
+
+			addWrite(log, frame, 0xB0 + ch, (block << 2) | (freq >> 8));
+			addWrite(log, frame, 0xA0 + ch, freq & 0xFF);
+			addWrite(log, frame, 0xB0 + ch, 0x20 | (block << 2) | (freq >> 8));
+		}
+
+		if ((tick % 6) == 0) {
+			// Bass drum on every beat, hi-hat and snare alternating
+			const uint8 drums = 0x10 | (((tick / 6) & 1) ? 0x08 : 0x01) | (((tick / 6) % 4) == 3 ? 0x02 : 0x00);
+			addWrite(log, frame, 0xBD, 0xE0);
+			addWrite(log, frame, 0xBD, 0xE0 | drums);
+		}
+	}
+}
+
+/**
+ * Minimal common interface to the raw emulator cores, so they can be used
+ * without a running mixer. The MAME core is left out, it needs an OSystem
+ * for its random source.
+ */
+class OplCore {
+public:
+	virtual ~OplCore() {}
+	virtual void writeReg(int reg, int val) = 0;
+	/** Renders mono frames for DOSBox, stereo frames for Nuked. */
+	virtual void generate(int16 *buffer, int frames) = 0;
+};
+
+#ifndef DISABLE_DOSBOX_OPL
+class DOSBoxCore : public OplCore {
+public:
+	DOSBoxCore() {
+		OPL::DOSBox::DBOPL::InitTables();
+		_chip.Setup(kOplRate);
+	}
+
+	void writeReg(int reg, int val) { _chip.WriteReg(reg, val); }
+
+	void generate(int16 *buffer, int frames) {
+		int32 temp[kOplChunk];
+		_chip.GenerateBlock2(frames, temp);
+		for (int i = 0; i < frames; ++i)
+			buffer[i] = temp[i];
+	}
+
+private:
+	OPL::DOSBox::DBOPL::Chip _chip;
+};
+#endif
+
+#ifndef DISABLE_NUKED_OPL
+class NukedCore : public OplCore {
+public:
+	NukedCore() { OPL::NUKED::OPL3_Reset(&_chip, kOplRate); }
+
+	void writeReg(int reg, int val) { OPL::NUKED::OPL3_WriteRegBuffered(&_chip, reg, val); }
+	void generate(int16 *buffer, int frames) { OPL::NUKED::OPL3_GenerateStream(&_chip, buffer, frames); }
+
+private:
+	OPL::NUKED::opl3_chip _chip;
+};
+
+class NukedVectorCore : public OplCore {
+public:
+	NukedVectorCore(OPL::NUKED::Bit8u impl) {
+		OPL::NUKED::OPL3_Reset(&_chip, kOplRate);
+		OPL::NUKED::OPL3_VectorReset(&_vector, &_chip);
+		OPL::NUKED::OPL3_VectorSetImpl(&_vector, impl);
+	}
+
+	void writeReg(int reg, int val) { OPL::NUKED::OPL3_VectorWriteRegBuffered(&_vector, reg, val); }
+	void generate(int16 *buffer, int frames) { OPL::NUKED::OPL3_VectorGenerateStream(&_vector, buffer, frames); }
+
+private:
+	OPL::NUKED::opl3_chip _chip;
+	OPL::NUKED::opl3_vector _vector;
+};
+#endif
+
+static void benchmarkCore(const char *name, OplCore *core, const OplLog &log) {
+	int16 buffer[kOplChunk * 2];
+	const uint32 totalFrames = kSongSeconds * kOplRate;
+	uint32 frame = 0;
+	uint next = 0;
+
+	Timer timer;
+	while (frame < totalFrames) {
+		while (next < log.size() && log[next].frame <= frame) {
+			core->writeReg(log[next].reg, log[next].val);
+			++next;
+		}
+
+		uint32 frames = MIN<uint32>(kOplChunk, totalFrames - frame);
+		if (next < log.size())
+			frames = MIN<uint32>(frames, log[next].frame - frame);
+
+		core->generate(buffer, frames);
+		frame += frames;
+	}
+	const double seconds = timer.elapsed();
+
+	report(name, seconds, totalFrames, "sample");
+	delete core;
+}
+
+void runAudioOplBenchmarks() {
+	section("OPL emulators, AdLib song at 44100 Hz");
+
+	OplLog log;
+	buildSongLog(log);
+
+#ifndef DISABLE_DOSBOX_OPL
+	benchmarkCore("DOSBox", new DOSBoxCore(), log);
+#endif
+#ifndef DISABLE_NUKED_OPL
+	benchmarkCore("Nuked", new NukedCore(), log);
+
+	static const char *const implNames[OPL::NUKED::vector_impl_count] = { "scalar", "SSE2", "AVX2" };
+	for (OPL::NUKED::Bit8u impl = 0; impl < OPL::NUKED::vector_impl_count; ++impl) {
+		if (!OPL::NUKED::OPL3_VectorSupported(impl))
+			continue;
+
+		const Common::String name = Common::String::format("Nuked vectorized (%s)", implNames[impl]);
+		benchmarkCore(name.c_str(), new NukedVectorCore(impl), log);
+	}
+#endif
+}
+
+} // End of namespace Benchmark
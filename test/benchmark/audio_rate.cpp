@@ -0,0 +1,107 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+
+#include "test/benchmark/benchmark.h"
+
+#include "audio/audiostream.h"
+#include "audio/mixer.h"
+#include "audio/rate.h"
+#include "audio/rate_simd.h"
+#include "audio/decoders/raw.h"
+
+#include "common/endian.h"
+#include "common/memstream.h"
+#include "common/str.h"
+
+namespace Benchmark {
+
+enum {
+	kInputSeconds = 4,
+	kOutputChunk = 1024
+};
+
+static Audio::AudioStream *makeNoiseStream(uint rate, bool stereo) {
+	const uint samples = rate * kInputSeconds * (stereo ? 2 : 1);
+	int16 *data = (int16 *)malloc(samples * sizeof(int16));
+
+	uint32 seed = 1;
+	for (uint i = 0; i < samples; ++i) {
+		seed = seed * 1103515245 + 12345;
+		WRITE_UINT16(&data[i], (seed >> 16) & 0xFFFF);
+	}
+
+	return Audio::makeRawStream(new Common::MemoryReadStream((const byte *)data, samples * sizeof(int16), DisposeAfterUse::YES),
+	                            rate, Audio::FLAG_16BITS | (stereo ? Audio::FLAG_STEREO : 0)
+#ifdef SCUMM_LITTLE_ENDIAN
+	                            | Audio::FLAG_LITTLE_ENDIAN
+#endif
+	                            );
+}
+
+static void benchmarkConverter(uint inRate, uint outRate, bool stereo, Audio::ResamplingMode mode) {
+	Audio::AudioStream *stream = makeNoiseStream(inRate, stereo);
+	Audio::RateConverter *converter = Audio::makeRateConverter(inRate, outRate, stereo, false, mode);
+
+	int16 buffer[kOutputChunk * 2];
+	double frames = 0;
+
+	Timer timer;
+	while (true) {
+		const int res = converter->flow(*stream, buffer, kOutputChunk, Audio::Mixer::kMaxMixerVolume / 2, Audio::Mixer::kMaxMixerVolume);
+		frames += res;
+		if (res < kOutputChunk)
+			break;
+	}
+	const double seconds = timer.elapsed();
+
+	const Common::String name = Common::String::format("%s %5u -> %5u Hz %s", mode == Audio::kResamplingSinc ? "sinc  " : "linear",
+	                                                   inRate, outRate, stereo ? "stereo" : "mono");
+	report(name.c_str(), seconds, frames, "frame");
+
+	delete converter;
+	delete stream;
+}
+
+void runAudioRateBenchmarks() {
+	static const uint rates[][2] = {
+		{ 11025, 44100 },
+		{ 11025, 48000 },
+		{ 22050, 44100 },
+		{ 22050, 48000 },
+		{ 44100, 48000 },
+		{ 48000, 44100 },
+		{ 44100, 44100 }
+	};
+
+	section(Common::String::format("Rate converters (%s mix kernel), cost per output frame:",
+	                               Audio::getMixKernelName(Audio::getBestMixKernel())).c_str());
+
+	for (int mode = Audio::kResamplingLinear; mode <= Audio::kResamplingSinc; ++mode) {
+		for (int i = 0; i < ARRAYSIZE(rates); ++i) {
+			benchmarkConverter(rates[i][0], rates[i][1], false, (Audio::ResamplingMode)mode);
+			benchmarkConverter(rates[i][0], rates[i][1], true, (Audio::ResamplingMode)mode);
+		}
+	}
+}
+
+} // End of namespace Benchmark
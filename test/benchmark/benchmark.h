@@ -0,0 +1,83 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef TEST_BENCHMARK_BENCHMARK_H
+#define TEST_BENCHMARK_BENCHMARK_H
+
+#include "common/scummsys.h"
+
+/**
+ * Simple micro benchmarks for performance critical code, run with
+ * 'make bench'. Unlike the unit tests these do not verify anything, they
+ * only report how long some piece of code takes per unit of work.
+ */
+namespace Benchmark {
+
+/**
+ * Returns the processor time used by the benchmark process so far, in
+ * seconds.
+ */
+double getProcessorTime();
+
+/**
+ * Measures the processor time spent between construction (or the last
+ * restart()) and the call to elapsed().
+ */
+class Timer {
+public:
+	Timer() { restart(); }
+
+	void restart() { _start = getProcessorTime(); }
+
+	/** Returns the processor time spent, in seconds. */
+	double elapsed() const { return getProcessorTime() - _start; }
+
+private:
+	double _start;
+};
+
+/**
+ * Prints one benchmark result line.
+ *
+ * @param name    what has been measured
+ * @param seconds time the measured code took
+ * @param units   number of units of work done in that time
+ * @param unit    name of the unit of work (e.g. "frame")
+ */
+void report(const char *name, double seconds, double units, const char *unit);
+
+/**
+ * Prints a section header.
+ */
+void section(const char *name);
+
+// The individual benchmark suites
+void runAudioRateBenchmarks();
+void runAudioOplBenchmarks();
+void runGraphicsBlitBenchmarks();
+void runGraphicsScalerBenchmarks();
+void runGraphicsTextBenchmarks();
+void runGraphicsYUVBenchmarks();
+
+} // End of namespace Benchmark
+
+#endif
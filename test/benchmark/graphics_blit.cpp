@@ -0,0 +1,92 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "test/benchmark/benchmark.h"
+
+#include "graphics/transparent_surface_simd.h"
+
+#include "common/str.h"
+
+namespace Benchmark {
+
+enum {
+	kSpriteWidth = 320,
+	kSpriteHeight = 200,
+	kSpritePitch = kSpriteWidth * 4,
+	kBlitCount = 200
+};
+
+static void benchmarkBlend(Graphics::BlendKernel kernel, Graphics::TSpriteBlendMode mode, uint32 color, bool flip, byte *sprite, byte *target) {
+	Graphics::BlendBlitProc proc = Graphics::getBlendBlitProc(kernel, mode);
+	byte *ino = sprite + (flip ? kSpritePitch - 4 : 0);
+	const int32 inStep = flip ? -4 : 4;
+
+	Timer timer;
+	for (int i = 0; i < kBlitCount; ++i)
+		proc(ino, target, kSpriteWidth, kSpriteHeight, kSpritePitch, inStep, kSpritePitch, color);
+	const double seconds = timer.elapsed();
+
+	static const char *const modeNames[Graphics::NUM_BLEND_MODES] = { "alpha", "additive", "subtractive", "multiply" };
+	const Common::String name = Common::String::format("%-6s %-11s %s%s", Graphics::getBlendKernelName(kernel), modeNames[mode],
+	                                                   color == 0xFFFFFFFF ? "plain" : "colormod", flip ? ", flipped" : "");
+	report(name.c_str(), seconds, (double)kBlitCount * kSpriteWidth * kSpriteHeight, "pixel");
+}
+
+void runGraphicsBlitBenchmarks() {
+	byte *sprite = (byte *)malloc(kSpritePitch * kSpriteHeight);
+	byte *target = (byte *)malloc(kSpritePitch * kSpriteHeight);
+
+	// A sprite with soft edges: a mix of transparent, opaque and
+	// translucent pixels like anti-aliased game graphics
+	uint32 seed = 1;
+	for (int i = 0; i < kSpritePitch * kSpriteHeight; ++i) {
+		seed = seed * 1103515245 + 12345;
+		sprite[i] = (seed >> 16) & 0xFF;
+		target[i] = (seed >> 24) & 0xFF;
+	}
+	for (int i = 0; i < kSpriteWidth * kSpriteHeight; ++i) {
+		const int x = i % kSpriteWidth;
+		if (x < kSpriteWidth / 4)
+			sprite[i * 4] = 0;
+		else if (x >= kSpriteWidth / 2)
+			sprite[i * 4] = 255;
+	}
+
+	section(Common::String::format("TransparentSurface blend kernels (best: %s), cost per pixel:",
+	                               Graphics::getBlendKernelName(Graphics::getBestBlendKernel())).c_str());
+
+	for (int mode = Graphics::BLEND_NORMAL; mode < Graphics::NUM_BLEND_MODES; ++mode) {
+		for (int kernel = Graphics::kBlendKernelScalar; kernel < Graphics::kBlendKernelCount; ++kernel) {
+			if (!Graphics::getBlendBlitProc((Graphics::BlendKernel)kernel, (Graphics::TSpriteBlendMode)mode))
+				continue;
+
+			benchmarkBlend((Graphics::BlendKernel)kernel, (Graphics::TSpriteBlendMode)mode, 0xFFFFFFFF, false, sprite, target);
+			benchmarkBlend((Graphics::BlendKernel)kernel, (Graphics::TSpriteBlendMode)mode, 0xC0FF8040, false, sprite, target);
+			benchmarkBlend((Graphics::BlendKernel)kernel, (Graphics::TSpriteBlendMode)mode, 0xFFFFFFFF, true, sprite, target);
+		}
+	}
+
+	free(target);
+	free(sprite);
+}
+
+} // End of namespace Benchmark
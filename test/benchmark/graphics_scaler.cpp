@@ -0,0 +1,141 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "test/benchmark/benchmark.h"
+
+#include "graphics/colormasks.h"
+#include "graphics/scaler.h"
+#include "graphics/scaler/hq_simd.h"
+
+#include "common/str.h"
+#include "common/util.h"
+
+namespace Benchmark {
+
+#ifdef USE_HQ_SCALERS
+
+enum {
+	kScreenWidth = 320,
+	kScreenHeight = 200,
+	// One pixel of border on each side, as in the SDL backend
+	kScreenPitch = kScreenWidth + 2,
+	kScalerFrames = 50
+};
+
+/**
+ * Fills the screen with blocky, dithered content, so the scalers see a
+ * mix of flat areas and edges.
+ */
+static void fillScreen(uint16 *screen) {
+	uint32 seed = 1;
+	for (int y = 0; y < kScreenHeight + 2; ++y) {
+		for (int x = 0; x < kScreenPitch; ++x) {
+			seed = seed * 1103515245 + 12345;
+			const uint16 block = (uint16)(((x / 8) * 0x0841 + (y / 8) * 0x1803) & 0xFFFF);
+			screen[y * kScreenPitch + x] = ((seed >> 16) & 3) ? block : (uint16)(block ^ 0x7BEF);
+		}
+	}
+}
+
+/**
+ * Converts the screen to the 8888 format, for the 32 bit scalers.
+ */
+static void convertScreen(const uint16 *screen, uint32 *screen32) {
+	const Graphics::PixelFormat format = Graphics::createPixelFormat<565>();
+	const Graphics::PixelFormat format32 = Graphics::createPixelFormat<8888>();
+
+	for (int i = 0; i < kScreenPitch * (kScreenHeight + 2); ++i) {
+		uint8 r, g, b;
+		format.colorToRGB(screen[i], r, g, b);
+		screen32[i] = format32.RGBToColor(r, g, b);
+	}
+}
+
+static void benchmarkScaler(const char *name, ScalerProc *scaler, int scale, const void *screen, int bytesPerPixel) {
+	uint8 *output = (uint8 *)malloc(kScreenWidth * scale * kScreenHeight * scale * bytesPerPixel);
+	const uint8 *src = (const uint8 *)screen + (kScreenPitch + 1) * bytesPerPixel;
+
+	Timer timer;
+	for (int i = 0; i < kScalerFrames; ++i)
+		scaler(src, kScreenPitch * bytesPerPixel, output, kScreenWidth * scale * bytesPerPixel, kScreenWidth, kScreenHeight);
+	const double seconds = timer.elapsed();
+
+	report(name, seconds, kScalerFrames, "frame");
+	free(output);
+}
+
+static void benchmarkClassify(HQKernel kernel, const uint16 *screen) {
+	HQClassifyProc classify = getHQClassifyProc(kernel);
+	uint16 codes[kHQMaxClassifyWidth];
+
+	Timer timer;
+	for (int i = 0; i < kScalerFrames; ++i) {
+		for (int y = 0; y < kScreenHeight; ++y) {
+			const uint16 *src = screen + (y + 1) * kScreenPitch + 1;
+			for (int x = 0; x < kScreenWidth; x += kHQMaxClassifyWidth)
+				classify(src + x, kScreenPitch, codes, MIN<int>(kScreenWidth - x, kHQMaxClassifyWidth));
+		}
+	}
+	const double seconds = timer.elapsed();
+
+	const Common::String name = Common::String::format("HQ classification (%s)", getHQKernelName(kernel));
+	report(name.c_str(), seconds, kScalerFrames, "frame");
+}
+
+#endif
+
+void runGraphicsScalerBenchmarks() {
+#ifdef USE_HQ_SCALERS
+	uint16 *screen = (uint16 *)malloc(kScreenPitch * (kScreenHeight + 2) * sizeof(uint16));
+	fillScreen(screen);
+	InitScalers(565);
+
+	section(Common::String::format("HQ scalers (%s classification), 320x200 RGB565, cost per frame:",
+	                               getHQKernelName(getBestHQKernel())).c_str());
+
+	for (int kernel = kHQKernelScalar; kernel < kHQKernelCount; ++kernel) {
+		if (getHQClassifyProc((HQKernel)kernel))
+			benchmarkClassify((HQKernel)kernel, screen);
+	}
+
+	benchmarkScaler("HQ2x", HQ2x, 2, screen, 2);
+	benchmarkScaler("HQ3x", HQ3x, 3, screen, 2);
+
+	uint32 *screen32 = (uint32 *)malloc(kScreenPitch * (kScreenHeight + 2) * sizeof(uint32));
+	convertScreen(screen, screen32);
+	InitScalers(8888);
+
+	section("Scalers, 320x200 ARGB8888, cost per frame:");
+	benchmarkScaler("Normal2x", Normal2x, 2, screen32, 4);
+	benchmarkScaler("AdvMame2x", AdvMame2x, 2, screen32, 4);
+	benchmarkScaler("2xSaI", _2xSaI, 2, screen32, 4);
+	benchmarkScaler("TV2x", TV2x, 2, screen32, 4);
+	benchmarkScaler("HQ2x", HQ2x, 2, screen32, 4);
+	benchmarkScaler("HQ3x", HQ3x, 3, screen32, 4);
+
+	DestroyScalers();
+	free(screen32);
+	free(screen);
+#endif
+}
+
+} // End of namespace Benchmark
@@ -0,0 +1,166 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+// Allow reading the font with stdio
+#define FORBIDDEN_SYMBOL_EXCEPTION_FILE
+#define FORBIDDEN_SYMBOL_EXCEPTION_fopen
+#define FORBIDDEN_SYMBOL_EXCEPTION_fclose
+#define FORBIDDEN_SYMBOL_EXCEPTION_fread
+#define FORBIDDEN_SYMBOL_EXCEPTION_printf
+
+#include "test/benchmark/benchmark.h"
+
+#include "graphics/font.h"
+#include "graphics/fonts/ttf.h"
+#include "graphics/surface.h"
+
+#include "common/memstream.h"
+#include "common/str.h"
+
+#include <stdio.h>
+
+namespace Benchmark {
+
+#ifdef USE_FREETYPE2
+
+enum {
+	kScreenWidth = 640,
+	kScreenHeight = 480,
+	kLineHeight = 20,
+	kFrameCount = 200
+};
+
+// Typical GUI texts, one per line of the screen
+static const char *const s_texts[] = {
+	"Game Options",
+	"Add Game...",
+	"Edit Game...",
+	"Remove Game",
+	"Start",
+	"Load...",
+	"Global Options...",
+	"About...",
+	"Quit",
+	"The Secret of Monkey Island (CD/DOS/English)",
+	"Beneath a Steel Sky (CD/DOS/English)",
+	"Broken Sword: The Shadow of the Templars",
+	"Graphics mode:",
+	"Render mode:",
+	"Aspect ratio correction",
+	"Fullscreen mode",
+	"Music volume:",
+	"SFX volume:",
+	"Speech volume:",
+	"Subtitle speed:"
+};
+
+static Graphics::Font *loadFont(int size) {
+	const char *path = BENCH_SRCDIR "/gui/themes/fonts/FreeSans.ttf";
+	FILE *file = fopen(path, "rb");
+	if (!file) {
+		printf("  %s not found, skipped\n", path);
+		return 0;
+	}
+
+	static byte data[1024 * 1024];
+	const uint length = fread(data, 1, sizeof(data), file);
+	fclose(file);
+
+	Common::MemoryReadStream stream(data, length);
+	return Graphics::loadTTFFont(stream, size);
+}
+
+// Draws a text like drawString does for fonts which do not draw whole runs
+static void drawCharByChar(const Graphics::Font &font, Graphics::Surface &screen, const Common::String &str, int x, int y, int w, uint32 color) {
+	const int rightX = x + w;
+	// Only needed for the alignment, but drawString always measures
+	font.getStringWidth(str);
+
+	uint32 last = 0;
+	for (uint i = 0; i < str.size(); ++i) {
+		const uint32 cur = (byte)str[i];
+		x += font.getKerningOffset(last, cur);
+		last = cur;
+
+		if (x + font.getBoundingBox(cur).right > rightX)
+			break;
+		font.drawChar(&screen, cur, x, y, color);
+		x += font.getCharWidth(cur);
+	}
+}
+
+static void benchmarkText(const Graphics::Font &font, Graphics::Surface &screen, int mode) {
+	static const char *const modeNames[] = {
+		"drawChar per character",
+		"drawString, same texts",
+		"drawString, changing texts"
+	};
+
+	uint32 strings = 0;
+	Timer timer;
+	for (int frame = 0; frame < kFrameCount; ++frame) {
+		for (int i = 0; i < ARRAYSIZE(s_texts); ++i) {
+			const int y = i * kLineHeight;
+			const uint32 color = screen.format.RGBToColor(255, 255, 255);
+
+			if (mode == 0) {
+				drawCharByChar(font, screen, s_texts[i], 10, y, kScreenWidth - 20, color);
+			} else if (mode == 1) {
+				font.drawString(&screen, s_texts[i], 10, y, kScreenWidth - 20, color, Graphics::kTextAlignLeft, 0, false);
+			} else {
+				// Like a timer or a score, which is a new string every frame
+				const Common::String text = Common::String::format("%s %d", s_texts[i], frame);
+				font.drawString(&screen, text, 10, y, kScreenWidth - 20, color, Graphics::kTextAlignLeft, 0, false);
+			}
+			++strings;
+		}
+	}
+	const double seconds = timer.elapsed();
+
+	report(modeNames[mode], seconds, strings, "string");
+}
+
+void runGraphicsTextBenchmarks() {
+	Graphics::Font *font = loadFont(14);
+	section("TTF text rendering, 14pt on 32 bpp, cost per string:");
+	if (!font)
+		return;
+
+	Graphics::Surface screen;
+	screen.create(kScreenWidth, kScreenHeight, Graphics::PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0));
+
+	for (int mode = 0; mode < 3; ++mode)
+		benchmarkText(*font, screen, mode);
+
+	screen.free();
+	delete font;
+}
+
+#else
+
+void runGraphicsTextBenchmarks() {
+	section("TTF text rendering: FreeType2 support disabled, skipped");
+}
+
+#endif
+
+} // End of namespace Benchmark
@@ -0,0 +1,97 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "test/benchmark/benchmark.h"
+
+#include "graphics/surface.h"
+#include "graphics/yuv_to_rgb.h"
+#include "graphics/yuv_to_rgb_simd.h"
+
+#include "common/str.h"
+#include "common/util.h"
+
+namespace Benchmark {
+
+enum {
+	kFrameWidth = 640,
+	kFrameHeight = 480,
+	kFrameCount = 50
+};
+
+static void benchmarkYUV(Graphics::YUVToRGBKernel kernel, const Graphics::PixelFormat &format, bool is420, const byte *y, const byte *u, const byte *v) {
+	Graphics::Surface surface;
+	surface.create(kFrameWidth, kFrameHeight, format);
+	YUVToRGBMan.setKernel(kernel);
+
+	Timer timer;
+	for (int i = 0; i < kFrameCount; ++i) {
+		if (is420)
+			YUVToRGBMan.convert420(&surface, Graphics::YUVToRGBManager::kScaleITU, y, u, v, kFrameWidth, kFrameHeight, kFrameWidth, kFrameWidth / 2);
+		else
+			YUVToRGBMan.convert444(&surface, Graphics::YUVToRGBManager::kScaleITU, y, u, v, kFrameWidth, kFrameHeight, kFrameWidth, kFrameWidth);
+	}
+	const double seconds = timer.elapsed();
+
+	const Common::String name = Common::String::format("%-6s %s to %d bpp, 640x480", Graphics::getYUVToRGBKernelName(kernel),
+	                                                   is420 ? "YUV420" : "YUV444", format.bytesPerPixel * 8);
+	report(name.c_str(), seconds, kFrameCount, "frame");
+	surface.free();
+}
+
+void runGraphicsYUVBenchmarks() {
+	byte *y = (byte *)malloc(kFrameWidth * kFrameHeight);
+	byte *u = (byte *)malloc(kFrameWidth * kFrameHeight);
+	byte *v = (byte *)malloc(kFrameWidth * kFrameHeight);
+
+	uint32 seed = 1;
+	for (int i = 0; i < kFrameWidth * kFrameHeight; ++i) {
+		seed = seed * 1103515245 + 12345;
+		y[i] = (seed >> 16) & 0xFF;
+		u[i] = (seed >> 20) & 0xFF;
+		v[i] = (seed >> 24) & 0xFF;
+	}
+
+	section(Common::String::format("YUV to RGB conversion (best: %s), cost per frame:",
+	                               Graphics::getYUVToRGBKernelName(Graphics::getBestYUVToRGBKernel())).c_str());
+
+	const Graphics::PixelFormat formats[] = {
+		Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0),
+		Graphics::PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0)
+	};
+
+	for (int is420 = 1; is420 >= 0; --is420) {
+		for (uint i = 0; i < ARRAYSIZE(formats); ++i) {
+			for (int kernel = Graphics::kYUVToRGBKernelScalar; kernel < Graphics::kYUVToRGBKernelCount; ++kernel) {
+				if (Graphics::isYUVToRGBKernelAvailable((Graphics::YUVToRGBKernel)kernel))
+					benchmarkYUV((Graphics::YUVToRGBKernel)kernel, formats[i], is420, y, u, v);
+			}
+		}
+	}
+
+	YUVToRGBMan.setKernel(Graphics::getBestYUVToRGBKernel());
+
+	free(v);
+	free(u);
+	free(y);
+}
+
+} // End of namespace Benchmark
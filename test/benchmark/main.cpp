@@ -0,0 +1,71 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+
+// Allow use of stuff in <time.h> and printf
+#define FORBIDDEN_SYMBOL_EXCEPTION_time_h
+#define FORBIDDEN_SYMBOL_EXCEPTION_printf
+#define FORBIDDEN_SYMBOL_EXCEPTION_FILE
+#define FORBIDDEN_SYMBOL_EXCEPTION_stdout
+
+#include "test/benchmark/benchmark.h"
+#include "test/system.h"
+
+#include <time.h>
+
+namespace Benchmark {
+
+double getProcessorTime() {
+	return (double)clock() / CLOCKS_PER_SEC;
+}
+
+void report(const char *name, double seconds, double units, const char *unit) {
+	if (units <= 0) {
+		printf("  %-48s (no %ss processed)\n", name, unit);
+		return;
+	}
+
+	printf("  %-48s %12.2f ns/%s %14.0f %ss/s\n", name, seconds * 1e9 / units, unit,
+	       seconds > 0 ? units / seconds : 0.0, unit);
+	fflush(stdout);
+}
+
+void section(const char *name) {
+	printf("%s\n", name);
+}
+
+} // End of namespace Benchmark
+
+int main(int argc, char *argv[]) {
+	// Some of the code needs mutexes
+	TestSystem system;
+	g_system = &system;
+
+	Benchmark::runAudioRateBenchmarks();
+	Benchmark::runAudioOplBenchmarks();
+	Benchmark::runGraphicsBlitBenchmarks();
+	Benchmark::runGraphicsScalerBenchmarks();
+	Benchmark::runGraphicsTextBenchmarks();
+	Benchmark::runGraphicsYUVBenchmarks();
+
+	return 0;
+}
@@ -0,0 +1,216 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/dirindex.h"
+#include "common/fs.h"
+#include "common/memstream.h"
+
+#include "backends/fs/abstract-fs.h"
+
+/**
+ * A directory of the given number of files and subdirectories, or one of
+ * its entries. It counts how often the backend is asked for a listing.
+ */
+class IndexTestFSNode : public AbstractFSNode {
+public:
+	IndexTestFSNode(const Common::String &path, bool isDirectory, int files, int directories, bool hasStamp, uint32 &stamp, uint &listings)
+		: _path(path), _isDirectory(isDirectory), _files(files), _directories(directories), _hasStamp(hasStamp),
+		  _stamp(stamp), _listings(listings) {}
+
+	bool exists() const { return true; }
+	Common::String getName() const { return Common::lastPathComponent(_path, '/'); }
+	Common::String getPath() const { return _path; }
+	bool isDirectory() const { return _isDirectory; }
+	bool isReadable() const { return true; }
+	bool isWritable() const { return false; }
+
+	AbstractFSNode *getChild(const Common::String &name) const {
+		return new IndexTestFSNode(_path + "/" + name, name.hasPrefix("dir"), 0, 0, _hasStamp, _stamp, _listings);
+	}
+
+	AbstractFSNode *getParent() const { return 0; }
+
+	bool getChildren(AbstractFSList &list, ListMode mode, bool hidden) const {
+		++_listings;
+		if (mode != Common::FSNode::kListDirectoriesOnly) {
+			for (int i = 0; i < _files; ++i)
+				list.push_back(getChild(Common::String::format("file%d", i)));
+		}
+		if (mode != Common::FSNode::kListFilesOnly) {
+			for (int i = 0; i < _directories; ++i)
+				list.push_back(getChild(Common::String::format("dir%d", i)));
+		}
+		return true;
+	}
+
+	bool getDirectoryStamp(uint32 &stamp) const {
+		if (!_isDirectory || !_hasStamp)
+			return false;
+		stamp = _stamp;
+		return true;
+	}
+
+	Common::SeekableReadStream *createReadStream() { return 0; }
+	Common::WriteStream *createWriteStream() { return 0; }
+	bool create(bool isDirectoryFlag) { return false; }
+
+private:
+	const Common::String _path;
+	const bool _isDirectory;
+	const int _files, _directories;
+	const bool _hasStamp;
+	uint32 &_stamp;
+	uint &_listings;
+};
+
+class DirectoryIndexTestSuite : public CxxTest::TestSuite {
+private:
+	static Common::DirectoryIndex::EntryList makeEntries(const char *prefix, int count) {
+		Common::DirectoryIndex::EntryList entries;
+		for (int i = 0; i < count; ++i) {
+			Common::DirectoryIndex::Entry entry;
+			entry.name = Common::String::format("%s%d", prefix, i);
+			entry.isDirectory = (i % 3) == 0;
+			entries.push_back(entry);
+		}
+		return entries;
+	}
+
+	static bool equals(const Common::DirectoryIndex::EntryList *a, const Common::DirectoryIndex::EntryList &b) {
+		if (!a || a->size() != b.size())
+			return false;
+		for (uint i = 0; i < b.size(); ++i) {
+			if ((*a)[i].name != b[i].name || (*a)[i].isDirectory != b[i].isDirectory)
+				return false;
+		}
+		return true;
+	}
+
+	// Save the index and load it into another one
+	static bool reload(Common::DirectoryIndex &from, Common::DirectoryIndex &to) {
+		Common::MemoryWriteStreamDynamic out(DisposeAfterUse::YES);
+		if (!from.saveToStream(out))
+			return false;
+		Common::MemoryReadStream in(out.getData(), out.size());
+		return to.loadFromStream(in);
+	}
+
+public:
+	void test_find() {
+		Common::DirectoryIndex index;
+		const Common::DirectoryIndex::EntryList entries = makeEntries("file", 10);
+
+		TS_ASSERT(!index.find("/games/monkey", false, 1000));
+		index.store("/games/monkey", false, 1000, entries);
+		TS_ASSERT(index.isModified());
+
+		TS_ASSERT(equals(index.find("/games/monkey", false, 1000), entries));
+		// Another stamp means the directory changed
+		TS_ASSERT(!index.find("/games/monkey", false, 1001));
+		// Listings with hidden entries are separate
+		TS_ASSERT(!index.find("/games/monkey", true, 1000));
+		TS_ASSERT(!index.find("/games/MONKEY", false, 1000));
+
+		TS_ASSERT_EQUALS(index.getHits(), 1u);
+		TS_ASSERT_EQUALS(index.getMisses(), 4u);
+
+		index.store("/games/monkey", false, 1001, makeEntries("other", 2));
+		TS_ASSERT(equals(index.find("/games/monkey", false, 1001), makeEntries("other", 2)));
+		TS_ASSERT_EQUALS(index.getSize(), 1u);
+	}
+
+	void test_save_load() {
+		Common::DirectoryIndex index;
+		index.store("/games/monkey", false, 1000, makeEntries("file", 10));
+		index.store("/games/monkey", true, 1000, makeEntries(".file", 11));
+		index.store("/games/empty", false, 2000, Common::DirectoryIndex::EntryList());
+
+		Common::DirectoryIndex loaded;
+		TS_ASSERT(reload(index, loaded));
+		TS_ASSERT(!index.isModified());
+		TS_ASSERT(!loaded.isModified());
+		TS_ASSERT_EQUALS(loaded.getSize(), 3u);
+		TS_ASSERT(equals(loaded.find("/games/monkey", false, 1000), makeEntries("file", 10)));
+		TS_ASSERT(equals(loaded.find("/games/monkey", true, 1000), makeEntries(".file", 11)));
+		TS_ASSERT(equals(loaded.find("/games/empty", false, 2000), Common::DirectoryIndex::EntryList()));
+	}
+
+	void test_invalid_data() {
+		Common::DirectoryIndex index;
+		index.store("/games/monkey", false, 1000, makeEntries("file", 10));
+
+		Common::MemoryWriteStreamDynamic out(DisposeAfterUse::YES);
+		TS_ASSERT(index.saveToStream(out));
+
+		// Truncated data is rejected as a whole
+		Common::DirectoryIndex loaded;
+		loaded.store("/games/old", false, 1, makeEntries("file", 1));
+		Common::MemoryReadStream truncated(out.getData(), out.size() - 3);
+		TS_ASSERT(!loaded.loadFromStream(truncated));
+		TS_ASSERT_EQUALS(loaded.getSize(), 0u);
+	}
+
+	// Lists the node in the given mode, returning the names of the children
+	static Common::String list(const Common::FSNode &node, Common::FSNode::ListMode mode) {
+		Common::FSList children;
+		if (!node.getChildren(children, mode, false))
+			return "failed";
+
+		Common::String names;
+		for (Common::FSList::const_iterator i = children.begin(); i != children.end(); ++i)
+			names += i->getName() + (i->isDirectory() ? "/ " : " ");
+		return names;
+	}
+
+	void test_indexed_children() {
+		uint32 stamp = 1000;
+		uint listings = 0;
+		Common::FSNode node = AbstractFSNode::makeFSNode(new IndexTestFSNode("/games/monkey", true, 2, 1, true, stamp, listings));
+
+		Common::DirectoryIndex index;
+		Common::DirectoryIndex::setActive(&index);
+
+		// The first listing asks the backend for everything and stores it,
+		// the following ones in any mode are served from the index
+		TS_ASSERT_EQUALS(list(node, Common::FSNode::kListFilesOnly), "file0 file1 ");
+		TS_ASSERT_EQUALS(listings, 1u);
+		TS_ASSERT_EQUALS(index.getSize(), 1u);
+		TS_ASSERT_EQUALS(list(node, Common::FSNode::kListDirectoriesOnly), "dir0/ ");
+		TS_ASSERT_EQUALS(list(node, Common::FSNode::kListAll), "file0 file1 dir0/ ");
+		TS_ASSERT_EQUALS(listings, 1u);
+		TS_ASSERT_EQUALS(index.getHits(), 2u);
+
+		// The listed children are complete nodes
+		Common::FSList children;
+		TS_ASSERT(node.getChildren(children, Common::FSNode::kListDirectoriesOnly, false));
+		TS_ASSERT_EQUALS(children.size(), 1u);
+		TS_ASSERT_EQUALS(children[0].getPath(), "/games/monkey/dir0");
+
+		// A changed directory is listed by the backend again
+		stamp = 1001;
+		TS_ASSERT_EQUALS(list(node, Common::FSNode::kListAll), "file0 file1 dir0/ ");
+		TS_ASSERT_EQUALS(listings, 2u);
+		TS_ASSERT_EQUALS(list(node, Common::FSNode::kListFilesOnly), "file0 file1 ");
+		TS_ASSERT_EQUALS(listings, 2u);
+
+		Common::DirectoryIndex::setActive(0);
+	}
+
+	void test_unstamped_children() {
+		uint32 stamp = 1000;
+		uint listings = 0;
+		Common::FSNode node = AbstractFSNode::makeFSNode(new IndexTestFSNode("/games/monkey", true, 2, 1, false, stamp, listings));
+
+		Common::DirectoryIndex index;
+		Common::DirectoryIndex::setActive(&index);
+
+		// Without a stamp, the backend lists the directory every time, in
+		// the requested mode
+		TS_ASSERT_EQUALS(list(node, Common::FSNode::kListDirectoriesOnly), "dir0/ ");
+		TS_ASSERT_EQUALS(list(node, Common::FSNode::kListFilesOnly), "file0 file1 ");
+		TS_ASSERT_EQUALS(listings, 2u);
+		TS_ASSERT_EQUALS(index.getSize(), 0u);
+		TS_ASSERT_EQUALS(index.getMisses(), 0u);
+
+		Common::DirectoryIndex::setActive(0);
+	}
+};
@@ -0,0 +1,158 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/lrustore.h"
+#include "common/memstream.h"
+
+// Stores numbers, which are always valid
+class TestLRUStore : public Common::PersistentLRUStore<uint32> {
+public:
+	TestLRUStore(uint maxItems) : Common::PersistentLRUStore<uint32>(MKTAG('T', 'E', 'S', 'T'), 1, maxItems) {}
+
+	int find(const Common::String &key) {
+		Item *item = lookUp(key);
+		if (!item) {
+			miss();
+			return -1;
+		}
+		return hit(*item);
+	}
+
+	void store(const Common::String &key, uint32 value) {
+		insert(key, value);
+	}
+
+protected:
+	void writeValue(Common::WriteStream &stream, const uint32 &value) const {
+		stream.writeUint32LE(value);
+	}
+
+	bool readValue(Common::SeekableReadStream &stream, uint32 &value) const {
+		value = stream.readUint32LE();
+		return value != 0xDEADBEEF;
+	}
+};
+
+class PersistentLRUStoreTestSuite : public CxxTest::TestSuite {
+private:
+	// Save the store and load it into another one
+	static bool reload(TestLRUStore &from, TestLRUStore &to) {
+		Common::MemoryWriteStreamDynamic out(DisposeAfterUse::YES);
+		if (!from.saveToStream(out))
+			return false;
+		Common::MemoryReadStream in(out.getData(), out.size());
+		return to.loadFromStream(in);
+	}
+
+public:
+	void test_save_load() {
+		TestLRUStore store(16);
+		store.store("one", 1);
+		store.store("two", 2);
+		TS_ASSERT(store.isModified());
+		TS_ASSERT_EQUALS(store.find("one"), 1);
+		TS_ASSERT_EQUALS(store.find("three"), -1);
+		TS_ASSERT_EQUALS(store.getHits(), 1u);
+		TS_ASSERT_EQUALS(store.getMisses(), 1u);
+
+		TestLRUStore loaded(16);
+		TS_ASSERT(reload(store, loaded));
+		TS_ASSERT(!store.isModified());
+		TS_ASSERT(!loaded.isModified());
+		TS_ASSERT_EQUALS(loaded.getSize(), 2u);
+		TS_ASSERT_EQUALS(loaded.find("one"), 1);
+		TS_ASSERT_EQUALS(loaded.find("two"), 2);
+
+		loaded.clear();
+		TS_ASSERT(loaded.isModified());
+		TS_ASSERT_EQUALS(loaded.getSize(), 0u);
+	}
+
+	void test_invalid_data() {
+		TestLRUStore store(16);
+		store.store("one", 1);
+		store.store("two", 0xDEADBEEF);
+
+		Common::MemoryWriteStreamDynamic out(DisposeAfterUse::YES);
+		TS_ASSERT(store.saveToStream(out));
+
+		// Values which fail to load reject the data as a whole
+		TestLRUStore loaded(16);
+		loaded.store("old", 1);
+		Common::MemoryReadStream damaged(out.getData(), out.size());
+		TS_ASSERT(!loaded.loadFromStream(damaged));
+		TS_ASSERT_EQUALS(loaded.getSize(), 0u);
+
+		// Just like truncated data
+		store.store("two", 2);
+		Common::MemoryWriteStreamDynamic out2(DisposeAfterUse::YES);
+		TS_ASSERT(store.saveToStream(out2));
+		Common::MemoryReadStream truncated(out2.getData(), out2.size() - 3);
+		TS_ASSERT(!loaded.loadFromStream(truncated));
+		TS_ASSERT_EQUALS(loaded.getSize(), 0u);
+
+		const byte wrongTag[] = { 'T', 'E', 'S', 'X', 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
+		Common::MemoryReadStream wrongTagStream(wrongTag, sizeof(wrongTag));
+		TS_ASSERT(!loaded.loadFromStream(wrongTagStream));
+
+		const byte wrongVersion[] = { 'T', 'E', 'S', 'T', 9, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
+		Common::MemoryReadStream wrongVersionStream(wrongVersion, sizeof(wrongVersion));
+		TS_ASSERT(!loaded.loadFromStream(wrongVersionStream));
+	}
+
+	void test_drop_unused() {
+		TestLRUStore first(4);
+		for (int i = 0; i < 4; ++i)
+			first.store(Common::String::format("old%d", i), i);
+
+		// In the next run, two of the old values get used again and two new
+		// ones are added
+		TestLRUStore second(4);
+		TS_ASSERT(reload(first, second));
+		TS_ASSERT_EQUALS(second.find("old1"), 1);
+		TS_ASSERT_EQUALS(second.find("old3"), 3);
+		for (int i = 0; i < 2; ++i)
+			second.store(Common::String::format("new%d", i), 10 + i);
+
+		TestLRUStore third(4);
+		TS_ASSERT(reload(second, third));
+		TS_ASSERT_EQUALS(third.getSize(), 4u);
+		TS_ASSERT_EQUALS(third.find("old1"), 1);
+		TS_ASSERT_EQUALS(third.find("old3"), 3);
+		TS_ASSERT_EQUALS(third.find("new0"), 10);
+		TS_ASSERT_EQUALS(third.find("new1"), 11);
+		TS_ASSERT_EQUALS(third.find("old0"), -1);
+
+		// A lower limit applies to the loaded values as well
+		TestLRUStore smaller(2);
+		TS_ASSERT(reload(third, smaller));
+		TS_ASSERT_EQUALS(smaller.getSize(), 2u);
+		TS_ASSERT_EQUALS(smaller.find("new0"), 10);
+		TS_ASSERT_EQUALS(smaller.find("new1"), 11);
+	}
+
+	void test_bounded_store() {
+		// The limit also holds within a single run
+		TestLRUStore store(8);
+		store.store("kept", 1);
+		for (int i = 0; i < 100; ++i) {
+			TS_ASSERT_EQUALS(store.find("kept"), 1);
+			store.store(Common::String::format("other%d", i), i);
+			TS_ASSERT_LESS_THAN_EQUALS(store.getSize(), 8u);
+		}
+
+		TS_ASSERT_EQUALS(store.find("kept"), 1);
+		TS_ASSERT_EQUALS(store.find("other99"), 99);
+		TS_ASSERT_EQUALS(store.find("other98"), 98);
+		TS_ASSERT_EQUALS(store.find("other0"), -1);
+
+		// Replacing a value does not drop any
+		const uint32 size = store.getSize();
+		store.store("other99", 100);
+		TS_ASSERT_EQUALS(store.getSize(), size);
+		TS_ASSERT_EQUALS(store.find("other99"), 100);
+
+		TestLRUStore empty(0);
+		empty.store("kept", 1);
+		TS_ASSERT_EQUALS(empty.getSize(), 0u);
+	}
+};
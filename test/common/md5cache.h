@@ -0,0 +1,207 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/md5.h"
+#include "common/md5cache.h"
+#include "common/memstream.h"
+
+#include "backends/fs/abstract-fs.h"
+
+#include "test/system.h"
+
+/**
+ * A file whose contents depend on its path. It counts how often it is
+ * read, and has a stamp unless that is 0.
+ */
+class MD5TestFSNode : public AbstractFSNode {
+public:
+	enum {
+		kSize = 3000
+	};
+
+	MD5TestFSNode(const Common::String &path, uint32 stamp, int &reads) : _path(path), _stamp(stamp), _reads(reads) {}
+
+	static byte *makeData(const Common::String &path) {
+		byte *data = (byte *)malloc(kSize);
+		const uint seed = Common::hashit(path.c_str());
+		for (uint i = 0; i < kSize; ++i)
+			data[i] = (byte)((i * 31 + seed) >> 2);
+		return data;
+	}
+
+	bool exists() const { return true; }
+	Common::String getName() const { return Common::lastPathComponent(_path, '/'); }
+	Common::String getPath() const { return _path; }
+	bool isDirectory() const { return false; }
+	bool isReadable() const { return true; }
+	bool isWritable() const { return false; }
+	AbstractFSNode *getChild(const Common::String &name) const { return 0; }
+	AbstractFSNode *getParent() const { return 0; }
+	bool getChildren(AbstractFSList &list, ListMode mode, bool hidden) const { return false; }
+
+	bool getFileStamp(uint32 &size, uint32 &stamp) const {
+		size = kSize;
+		stamp = _stamp;
+		return _stamp != 0;
+	}
+
+	// Each node is only read by one job at a time
+	Common::SeekableReadStream *createReadStream() {
+		++_reads;
+		return new Common::MemoryReadStream(makeData(_path), kSize, DisposeAfterUse::YES);
+	}
+
+	Common::WriteStream *createWriteStream() { return 0; }
+	bool create(bool isDirectoryFlag) { return false; }
+
+private:
+	const Common::String _path;
+	const uint32 _stamp;
+	int &_reads;
+};
+
+class MD5CacheTestSuite : public CxxTest::TestSuite {
+private:
+	OSystem *_oldSystem;
+	TestSystem *_system;
+
+	enum {
+		kFileCount = 24
+	};
+
+	static Common::String expectedMD5(const Common::String &path, uint32 length) {
+		Common::MemoryReadStream stream(MD5TestFSNode::makeData(path), MD5TestFSNode::kSize, DisposeAfterUse::YES);
+		return Common::computeStreamMD5AsString(stream, length);
+	}
+
+	// Files with stamps, except every fourth
+	static Common::Array<Common::FileMD5> makeFiles(int *reads) {
+		Common::Array<Common::FileMD5> files(kFileCount);
+		for (int i = 0; i < kFileCount; ++i) {
+			const Common::String path = Common::String::format("/games/file%d", i);
+			files[i].node = AbstractFSNode::makeFSNode(new MD5TestFSNode(path, (i % 4) ? 1000 : 0, reads[i]));
+		}
+		return files;
+	}
+
+	static bool checkFiles(const Common::Array<Common::FileMD5> &files, uint32 length) {
+		for (uint i = 0; i < files.size(); ++i) {
+			if (files[i].size != MD5TestFSNode::kSize || files[i].md5 != expectedMD5(files[i].node.getPath(), length))
+				return false;
+		}
+		return true;
+	}
+
+	// Save the cache and load it into another one
+	static bool reload(Common::MD5Cache &from, Common::MD5Cache &to) {
+		Common::MemoryWriteStreamDynamic out(DisposeAfterUse::YES);
+		if (!from.saveToStream(out))
+			return false;
+		Common::MemoryReadStream in(out.getData(), out.size());
+		return to.loadFromStream(in);
+	}
+
+	static bool found(Common::MD5Cache &cache, const char *path, uint32 length, uint32 size, uint32 stamp, const char *md5) {
+		const Common::String *stored = cache.find(path, length, size, stamp);
+		return stored && *stored == md5;
+	}
+
+public:
+	void setUp() {
+		_oldSystem = g_system;
+		_system = new TestSystem();
+		g_system = _system;
+	}
+
+	void tearDown() {
+		g_system = _oldSystem;
+		delete _system;
+	}
+
+	void test_find() {
+		Common::MD5Cache cache;
+
+		TS_ASSERT(!cache.find("/games/monkey/000.lfl", 5000, 8357, 1000));
+		cache.store("/games/monkey/000.lfl", 5000, 8357, 1000, "c5b8a7b1f6e2b7f5c2e0f2e9a8a6b4c3");
+		TS_ASSERT(cache.isModified());
+
+		TS_ASSERT(found(cache, "/games/monkey/000.lfl", 5000, 8357, 1000, "c5b8a7b1f6e2b7f5c2e0f2e9a8a6b4c3"));
+		// A changed file has another size or stamp
+		TS_ASSERT(!cache.find("/games/monkey/000.lfl", 5000, 8358, 1000));
+		TS_ASSERT(!cache.find("/games/monkey/000.lfl", 5000, 8357, 1001));
+		// Checksums of other lengths are separate
+		TS_ASSERT(!cache.find("/games/monkey/000.lfl", 0, 8357, 1000));
+
+		TS_ASSERT_EQUALS(cache.getHits(), 1u);
+		TS_ASSERT_EQUALS(cache.getMisses(), 4u);
+
+		cache.store("/games/monkey/000.lfl", 0, 8357, 1000, "0123456789abcdef0123456789abcdef");
+		TS_ASSERT(found(cache, "/games/monkey/000.lfl", 0, 8357, 1000, "0123456789abcdef0123456789abcdef"));
+		TS_ASSERT(found(cache, "/games/monkey/000.lfl", 5000, 8357, 1000, "c5b8a7b1f6e2b7f5c2e0f2e9a8a6b4c3"));
+		TS_ASSERT_EQUALS(cache.getSize(), 2u);
+	}
+
+	void test_save_load() {
+		Common::MD5Cache cache;
+		cache.store("/games/monkey/000.lfl", 5000, 8357, 1000, "c5b8a7b1f6e2b7f5c2e0f2e9a8a6b4c3");
+		cache.store("/games/monkey/disk01.lec", 5000, 490000, 1000, "0123456789abcdef0123456789abcdef");
+
+		Common::MD5Cache loaded;
+		TS_ASSERT(reload(cache, loaded));
+		TS_ASSERT(!cache.isModified());
+		TS_ASSERT(!loaded.isModified());
+		TS_ASSERT_EQUALS(loaded.getSize(), 2u);
+		TS_ASSERT(found(loaded, "/games/monkey/000.lfl", 5000, 8357, 1000, "c5b8a7b1f6e2b7f5c2e0f2e9a8a6b4c3"));
+		TS_ASSERT(found(loaded, "/games/monkey/disk01.lec", 5000, 490000, 1000, "0123456789abcdef0123456789abcdef"));
+	}
+
+	void test_invalid_data() {
+		Common::MD5Cache cache;
+		cache.store("/games/monkey/000.lfl", 5000, 8357, 1000, "c5b8a7b1f6e2b7f5c2e0f2e9a8a6b4c3");
+
+		Common::MemoryWriteStreamDynamic out(DisposeAfterUse::YES);
+		TS_ASSERT(cache.saveToStream(out));
+
+		// Truncated data is rejected as a whole
+		Common::MD5Cache loaded;
+		loaded.store("/games/old", 5000, 1, 1, "0123456789abcdef0123456789abcdef");
+		Common::MemoryReadStream truncated(out.getData(), out.size() - 3);
+		TS_ASSERT(!loaded.loadFromStream(truncated));
+		TS_ASSERT_EQUALS(loaded.getSize(), 0u);
+	}
+
+	void test_compute_without_cache() {
+		int reads[kFileCount] = { 0 };
+		Common::Array<Common::FileMD5> files = makeFiles(reads);
+
+		Common::computeFileMD5s(files, 1000);
+		TS_ASSERT(checkFiles(files, 1000));
+		TS_ASSERT_EQUALS(_system->getParallelJobCount(), (uint)kFileCount);
+		for (int i = 0; i < kFileCount; ++i)
+			TS_ASSERT_EQUALS(reads[i], 1);
+	}
+
+	void test_compute_cached() {
+		Common::MD5Cache cache;
+		Common::MD5Cache::setActive(&cache);
+
+		int reads[kFileCount] = { 0 };
+		Common::Array<Common::FileMD5> files = makeFiles(reads);
+		Common::computeFileMD5s(files, 1000);
+		TS_ASSERT(checkFiles(files, 1000));
+		TS_ASSERT_EQUALS(cache.getSize(), (uint)kFileCount * 3 / 4);
+
+		// Only the files without a stamp are read again, and checksums of
+		// other lengths are separate
+		Common::Array<Common::FileMD5> again = makeFiles(reads);
+		Common::computeFileMD5s(again, 1000);
+		TS_ASSERT(checkFiles(again, 1000));
+		Common::computeFileMD5s(again, 0);
+		TS_ASSERT(checkFiles(again, 0));
+
+		for (int i = 0; i < kFileCount; ++i)
+			TS_ASSERT_EQUALS(reads[i], (i % 4) ? 2 : 3);
+		TS_ASSERT_EQUALS(_system->getParallelJobCount(), (uint)kFileCount * 2 + kFileCount / 4);
+
+		Common::MD5Cache::setActive(0);
+	}
+};
@@ -104,4 +104,19 @@ class MemoryReadStreamTestSuite : public CxxTest::TestSuite {
 		ms.seek(0, SEEK_SET);
 		TS_ASSERT(!ms.eos());
 	}
+
+	void test_direct_data() {
+		byte contents[] = { 1, 2, 3, 4, 5, 6, 7 };
+		Common::MemoryReadStream ms(contents, sizeof(contents));
+
+		TS_ASSERT_EQUALS(ms.getDirectData(0, 7), contents);
+		TS_ASSERT_EQUALS(ms.getDirectData(3, 4), contents + 3);
+		TS_ASSERT_EQUALS(ms.getDirectData(7, 0), contents + 7);
+		TS_ASSERT(!ms.getDirectData(3, 5));
+		TS_ASSERT(!ms.getDirectData(8, 0));
+		TS_ASSERT(!ms.getDirectData(1, 0xFFFFFFFF));
+
+		// The position is not affected
+		TS_ASSERT_EQUALS(ms.pos(), 0);
+	}
 };
@@ -0,0 +1,177 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/archive.h"
+#include "common/memstream.h"
+
+class SearchSetTestSuite : public CxxTest::TestSuite {
+private:
+	// Archive with fixed members whose contents are the archive name
+	class TestArchive : public Common::Archive {
+	public:
+		TestArchive(const Common::String &name) : _name(name), _probes(0) {}
+
+		void addMember(const Common::String &name) { _members.push_back(name); }
+
+		virtual bool hasFile(const Common::String &name) const {
+			++_probes;
+			for (Common::List<Common::String>::const_iterator i = _members.begin(); i != _members.end(); ++i) {
+				if (i->equalsIgnoreCase(name))
+					return true;
+			}
+			return false;
+		}
+
+		virtual int listMembers(Common::ArchiveMemberList &list) const {
+			for (Common::List<Common::String>::const_iterator i = _members.begin(); i != _members.end(); ++i)
+				list.push_back(Common::ArchiveMemberPtr(new Common::GenericArchiveMember(*i, this)));
+			return _members.size();
+		}
+
+		virtual const Common::ArchiveMemberPtr getMember(const Common::String &name) const {
+			return Common::ArchiveMemberPtr(new Common::GenericArchiveMember(name, this));
+		}
+
+		virtual Common::SeekableReadStream *createReadStreamForMember(const Common::String &name) const {
+			if (!hasFile(name))
+				return nullptr;
+			return new Common::MemoryReadStream((const byte *)_name.c_str(), _name.size());
+		}
+
+		mutable uint _probes;
+
+	private:
+		const Common::String _name;
+		Common::List<Common::String> _members;
+	};
+
+	static Common::String readMember(const Common::SearchSet &set, const Common::String &name) {
+		Common::SeekableReadStream *stream = set.createReadStreamForMember(name);
+		if (!stream)
+			return Common::String();
+		Common::String contents;
+		while (stream->pos() < stream->size())
+			contents += (char)stream->readByte();
+		delete stream;
+		return contents;
+	}
+
+	// Archive serving a name it does not list, like a path into a sub
+	// directory of an FSDirectory
+	class UnlistedArchive : public TestArchive {
+	public:
+		UnlistedArchive(const Common::String &name) : TestArchive(name) {}
+
+		virtual bool hasFile(const Common::String &name) const {
+			return name == "sub/unlisted" || TestArchive::hasFile(name);
+		}
+
+		virtual Common::SeekableReadStream *createReadStreamForMember(const Common::String &name) const {
+			if (name == "sub/unlisted")
+				return new Common::MemoryReadStream((const byte *)"b", 1);
+			return TestArchive::createReadStreamForMember(name);
+		}
+	};
+
+	// Three archives, common.dat of c shadowed by a, with an unlisted name
+	// in b
+	void fill(Common::SearchSet &set, TestArchive *&a, TestArchive *&b, TestArchive *&c) {
+		a = new TestArchive("a");
+		a->addMember("common.dat");
+		a->addMember("a.dat");
+		b = new UnlistedArchive("b");
+		b->addMember("b.dat");
+		c = new TestArchive("c");
+		c->addMember("common.dat");
+		c->addMember("c.dat");
+
+		set.add("c", c, 0);
+		set.add("a", a, 10);
+		set.add("b", b, 5);
+	}
+
+	void checkLookups(Common::SearchSet &set) {
+		TS_ASSERT_EQUALS(readMember(set, "common.dat"), "a");
+		TS_ASSERT_EQUALS(readMember(set, "COMMON.DAT"), "a");
+		TS_ASSERT_EQUALS(readMember(set, "b.dat"), "b");
+		TS_ASSERT_EQUALS(readMember(set, "c.dat"), "c");
+		TS_ASSERT_EQUALS(readMember(set, "sub/unlisted"), "b");
+		TS_ASSERT(set.hasFile("a.dat"));
+		TS_ASSERT(set.hasFile("sub/unlisted"));
+		TS_ASSERT(!set.hasFile("missing.dat"));
+		TS_ASSERT(!set.createReadStreamForMember("missing.dat"));
+		TS_ASSERT(!set.getMember("missing.dat"));
+		TS_ASSERT(set.getMember("c.dat"));
+		TS_ASSERT(!set.hasFile(""));
+	}
+
+public:
+	void test_plain_lookups() {
+		Common::SearchSet set;
+		TestArchive *a, *b, *c;
+		fill(set, a, b, c);
+
+		TS_ASSERT(!set.isIndexEnabled());
+		checkLookups(set);
+		TS_ASSERT_EQUALS(set.getLookupStats().indexHits, 0u);
+		TS_ASSERT_EQUALS(set.getLookupStats().indexBuilds, 0u);
+		TS_ASSERT_EQUALS(set.getLookupStats().lookups, 11u);
+	}
+
+	void test_indexed_lookups() {
+		Common::SearchSet set;
+		TestArchive *a, *b, *c;
+		fill(set, a, b, c);
+
+		set.enableIndex(true);
+		checkLookups(set);
+		TS_ASSERT_EQUALS(set.getLookupStats().indexBuilds, 1u);
+
+		// Everything has been looked up once, so the same lookups are
+		// answered without asking the archives again
+		set.resetLookupStats();
+		a->_probes = b->_probes = c->_probes = 0;
+		TS_ASSERT(set.hasFile("c.dat"));
+		TS_ASSERT(set.hasFile("sub/unlisted"));
+		TS_ASSERT(!set.hasFile("missing.dat"));
+		TS_ASSERT_EQUALS(a->_probes + b->_probes + c->_probes, 0u);
+		TS_ASSERT_EQUALS(set.getLookupStats().lookups, 3u);
+		TS_ASSERT_EQUALS(set.getLookupStats().indexHits, 3u);
+		TS_ASSERT_EQUALS(set.getLookupStats().archiveProbes, 0u);
+
+		// Listed members only need a check of the archive serving them
+		set.invalidateIndex();
+		a->_probes = b->_probes = c->_probes = 0;
+		TS_ASSERT_EQUALS(readMember(set, "c.dat"), "c");
+		TS_ASSERT_EQUALS(a->_probes + b->_probes, 0u);
+	}
+
+	void test_index_updates() {
+		Common::SearchSet set;
+		TestArchive *a, *b, *c;
+		fill(set, a, b, c);
+		set.enableIndex(true);
+
+		TS_ASSERT_EQUALS(readMember(set, "common.dat"), "a");
+		TS_ASSERT(!set.hasFile("d.dat"));
+
+		set.setPriority("c", 20);
+		TS_ASSERT_EQUALS(readMember(set, "common.dat"), "c");
+
+		TestArchive *d = new TestArchive("d");
+		d->addMember("d.dat");
+		d->addMember("common.dat");
+		set.add("d", d, 30);
+		TS_ASSERT(set.hasFile("d.dat"));
+		TS_ASSERT_EQUALS(readMember(set, "common.dat"), "d");
+
+		set.remove("d");
+		set.remove("c");
+		TS_ASSERT(!set.hasFile("d.dat"));
+		TS_ASSERT(!set.hasFile("c.dat"));
+		TS_ASSERT_EQUALS(readMember(set, "common.dat"), "a");
+
+		set.clear();
+		TS_ASSERT(!set.hasFile("common.dat"));
+		TS_ASSERT_EQUALS(set.getLookupStats().indexBuilds, 5u);
+	}
+};
@@ -70,4 +70,40 @@ class SeekableSubReadStreamTestSuite : public CxxTest::TestSuite {
 		b = ssrs.readByte();
 		TS_ASSERT_EQUALS(b, 1);
 	}
+
+	void test_direct_data() {
+		byte contents[10] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+		Common::MemoryReadStream ms(contents, sizeof(contents));
+		Common::SeekableSubReadStream ssrs(&ms, 2, 8);
+
+		TS_ASSERT_EQUALS(ssrs.getDirectData(0, 6), contents + 2);
+		TS_ASSERT_EQUALS(ssrs.getDirectData(5, 1), contents + 7);
+		TS_ASSERT(!ssrs.getDirectData(5, 2));
+		TS_ASSERT(!ssrs.getDirectData(7, 0));
+	}
+
+	void test_safe_read_from_memory() {
+		byte contents[10] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+		Common::MemoryReadStream ms(contents, sizeof(contents));
+		Common::SafeSeekableSubReadStream a(&ms, 2, 8);
+		Common::SafeSeekableSubReadStream b(&ms, 5, 10);
+
+		// The streams do not disturb each other
+		TS_ASSERT_EQUALS(a.readByte(), 2);
+		TS_ASSERT_EQUALS(b.readByte(), 5);
+		TS_ASSERT_EQUALS(a.readByte(), 3);
+		ms.seek(0);
+		TS_ASSERT_EQUALS(b.readUint16BE(), 0x0607);
+
+		byte buffer[8];
+		TS_ASSERT_EQUALS(a.read(buffer, sizeof(buffer)), 4u);
+		TS_ASSERT_EQUALS(buffer[0], 4);
+		TS_ASSERT_EQUALS(buffer[3], 7);
+		TS_ASSERT(a.eos());
+		TS_ASSERT(!b.eos());
+
+		a.seek(-1, SEEK_END);
+		TS_ASSERT(!a.eos());
+		TS_ASSERT_EQUALS(a.readByte(), 7);
+	}
 };
@@ -0,0 +1,352 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/archive.h"
+#include "common/array.h"
+#include "common/memstream.h"
+#include "common/unzip.h"
+#include "common/zlib.h"
+
+#include "test/system.h"
+
+class UnzipTestSuite : public CxxTest::TestSuite {
+#ifdef USE_ZLIB
+private:
+	OSystem *_oldSystem;
+	TestSystem *_system;
+
+	struct Member {
+		const char *name;
+		bool deflate;
+		Common::Array<byte> data;
+	};
+
+	static Common::Array<byte> makeData(uint32 size, uint32 seed) {
+		// Compressible, but not too much so the deflated data spans many
+		// blocks
+		Common::Array<byte> data;
+		data.resize(size);
+		for (uint32 i = 0; i < size; ++i) {
+			if ((i & 63) == 0)
+				seed = seed * 1103515245 + 12345;
+			data[i] = (byte)((seed >> 16) + (i & 7));
+		}
+		return data;
+	}
+
+	// Gzip the data, then take the raw deflate data and the CRC from the
+	// gzip framing
+	static void deflate(const Common::Array<byte> &data, Common::Array<byte> &deflated, uint32 &crc) {
+		Common::MemoryWriteStreamDynamic *memory = new Common::MemoryWriteStreamDynamic(DisposeAfterUse::YES);
+		Common::WriteStream *gzip = Common::wrapCompressedWriteStream(memory);
+		gzip->write(data.begin(), data.size());
+		gzip->finalize();
+
+		const byte *gzipData = memory->getData();
+		const uint32 gzipSize = memory->size();
+		deflated.resize(gzipSize - 18);
+		memcpy(deflated.begin(), gzipData + 10, gzipSize - 18);
+		crc = READ_LE_UINT32(gzipData + gzipSize - 8);
+		delete gzip;
+	}
+
+	static void writeHeader(Common::WriteStream &out, uint32 signature, const Member &member, uint32 crc, uint32 compressedSize) {
+		out.writeUint32LE(signature);
+		if (signature == 0x02014b50)
+			out.writeUint16LE(20); // Version made by
+		out.writeUint16LE(20);     // Version needed
+		out.writeUint16LE(0);      // Flags
+		out.writeUint16LE(member.deflate ? 8 : 0);
+		out.writeUint32LE(0);      // Date and time
+		out.writeUint32LE(crc);
+		out.writeUint32LE(compressedSize);
+		out.writeUint32LE(member.data.size());
+		out.writeUint16LE(strlen(member.name));
+		out.writeUint16LE(0);      // Extra field length
+	}
+
+#ifdef POSIX
+	// Lets other threads run between a seek and the following read, where
+	// they would move the stream if it was not guarded
+	class YieldingReadStream : public Common::MemoryReadStream {
+	public:
+		YieldingReadStream(const byte *data, uint32 size) : Common::MemoryReadStream(data, size, DisposeAfterUse::YES) {}
+
+		bool seek(int32 offs, int whence = SEEK_SET) {
+			const bool result = Common::MemoryReadStream::seek(offs, whence);
+			TestThread::yield();
+			return result;
+		}
+	};
+#endif
+
+	static Common::Archive *makeArchive(const Common::Array<Member> &members, bool breakCrc = false, bool yield = false) {
+		Common::MemoryWriteStreamDynamic out(DisposeAfterUse::NO);
+		Common::Array<uint32> offsets, crcs, compressedSizes;
+
+		for (uint i = 0; i < members.size(); ++i) {
+			const Member &member = members[i];
+			Common::Array<byte> deflated;
+			uint32 crc;
+			deflate(member.data, deflated, crc);
+			if (breakCrc)
+				crc ^= 1;
+
+			const Common::Array<byte> &stored = member.deflate ? deflated : member.data;
+			offsets.push_back(out.pos());
+			crcs.push_back(crc);
+			compressedSizes.push_back(stored.size());
+
+			writeHeader(out, 0x04034b50, member, crc, stored.size());
+			out.write(member.name, strlen(member.name));
+			out.write(stored.begin(), stored.size());
+		}
+
+		const uint32 centralDir = out.pos();
+		for (uint i = 0; i < members.size(); ++i) {
+			writeHeader(out, 0x02014b50, members[i], crcs[i], compressedSizes[i]);
+			out.writeUint16LE(0); // Comment length
+			out.writeUint16LE(0); // Disk number
+			out.writeUint16LE(0); // Internal attributes
+			out.writeUint32LE(0); // External attributes
+			out.writeUint32LE(offsets[i]);
+			out.write(members[i].name, strlen(members[i].name));
+		}
+
+		const uint32 centralDirEnd = out.pos();
+		out.writeUint32LE(0x06054b50);
+		out.writeUint16LE(0);
+		out.writeUint16LE(0);
+		out.writeUint16LE(members.size());
+		out.writeUint16LE(members.size());
+		out.writeUint32LE(centralDirEnd - centralDir);
+		out.writeUint32LE(centralDir);
+		out.writeUint16LE(0);
+
+#ifdef POSIX
+		if (yield)
+			return Common::makeZipArchive(new YieldingReadStream(out.getData(), out.size()));
+#endif
+		return Common::makeZipArchive(new Common::MemoryReadStream(out.getData(), out.size(), DisposeAfterUse::YES));
+	}
+
+	static void addMember(Common::Array<Member> &members, const char *name, bool deflate, uint32 size, uint32 seed) {
+		Member member;
+		member.name = name;
+		member.deflate = deflate;
+		member.data = makeData(size, seed);
+		members.push_back(member);
+	}
+
+	static Common::Array<Member> makeMembers() {
+		Common::Array<Member> members;
+		addMember(members, "small.bin", true, 1000, 1);
+		addMember(members, "deflated.bin", true, 1200 * 1024, 2);
+		addMember(members, "stored.bin", false, 300 * 1024, 3);
+		addMember(members, "huge.bin", true, 5 * 1024 * 1024 + 123, 4);
+		return members;
+	}
+
+	static bool readMatches(Common::SeekableReadStream &stream, const Common::Array<byte> &data, uint32 size) {
+		const uint32 pos = stream.pos();
+		Common::Array<byte> buffer;
+		buffer.resize(size);
+		if (stream.read(buffer.begin(), size) != size || stream.err())
+			return false;
+		return memcmp(buffer.begin(), data.begin() + pos, size) == 0;
+	}
+
+	void checkMember(Common::Archive &archive, const Member &member) {
+		Common::SeekableReadStream *stream = archive.createReadStreamForMember(member.name);
+		TS_ASSERT(stream);
+		if (!stream)
+			return;
+
+		const uint32 size = member.data.size();
+		TS_ASSERT_EQUALS((uint32)stream->size(), size);
+
+		// Sequential reads in odd sizes
+		uint32 chunk = 1;
+		while ((uint32)stream->pos() < size) {
+			chunk = MIN<uint32>(chunk * 3 + 1, size - stream->pos());
+			if (!readMatches(*stream, member.data, chunk)) {
+				TS_FAIL(Common::String::format("%s differs at %d", member.name, stream->pos()).c_str());
+				break;
+			}
+		}
+
+		byte b;
+		TS_ASSERT(!stream->eos());
+		TS_ASSERT_EQUALS(stream->read(&b, 1), 0u);
+		TS_ASSERT(stream->eos());
+		TS_ASSERT(!stream->err());
+
+		// Seeks all over the place, backwards and forwards
+		uint32 seed = 7;
+		for (int i = 0; i < 40; ++i) {
+			seed = seed * 1103515245 + 12345;
+			const uint32 pos = (seed >> 8) % size;
+			const uint32 length = MIN<uint32>(1000, size - pos);
+			TS_ASSERT(stream->seek(pos, SEEK_SET));
+			TS_ASSERT(!stream->eos());
+			if (!readMatches(*stream, member.data, length)) {
+				TS_FAIL(Common::String::format("%s differs after seeking to %d", member.name, pos).c_str());
+				break;
+			}
+		}
+
+		TS_ASSERT(stream->seek(-10, SEEK_END));
+		TS_ASSERT(readMatches(*stream, member.data, 10));
+		TS_ASSERT(stream->seek(0, SEEK_SET));
+		TS_ASSERT(readMatches(*stream, member.data, 100));
+
+		delete stream;
+	}
+
+#ifdef POSIX
+	struct ReaderThread {
+		Common::SeekableReadStream *stream;
+		const Member *member;
+		bool ok;
+	};
+
+	// Reads the whole member a few times in odd chunks, then deletes the
+	// stream, which may release the last reference to the archive stream
+	static void readerProc(void *param) {
+		ReaderThread *reader = (ReaderThread *)param;
+		const uint32 size = reader->member->data.size();
+		reader->ok = true;
+
+		for (int pass = 0; pass < 3 && reader->ok; ++pass) {
+			reader->ok = reader->stream->seek(pass * 1000, SEEK_SET);
+			while (reader->ok && (uint32)reader->stream->pos() < size) {
+				const uint32 chunk = MIN<uint32>(3000 + pass * 1111, size - reader->stream->pos());
+				reader->ok = readMatches(*reader->stream, reader->member->data, chunk);
+			}
+		}
+
+		delete reader->stream;
+	}
+#endif
+
+public:
+	void setUp() {
+		// The archive guards its stream with a mutex
+		_oldSystem = g_system;
+		_system = new TestSystem();
+		g_system = _system;
+	}
+
+	void tearDown() {
+		g_system = _oldSystem;
+		delete _system;
+	}
+
+	void test_members() {
+		const Common::Array<Member> members = makeMembers();
+		Common::Archive *archive = makeArchive(members);
+		TS_ASSERT(archive);
+		if (!archive)
+			return;
+
+		for (uint i = 0; i < members.size(); ++i)
+			checkMember(*archive, members[i]);
+
+		delete archive;
+	}
+
+	void test_independent_streams() {
+		const Common::Array<Member> members = makeMembers();
+		Common::Archive *archive = makeArchive(members);
+		TS_ASSERT(archive);
+		if (!archive)
+			return;
+
+		Common::SeekableReadStream *a = archive->createReadStreamForMember("deflated.bin");
+		Common::SeekableReadStream *b = archive->createReadStreamForMember("deflated.bin");
+		Common::SeekableReadStream *c = archive->createReadStreamForMember("stored.bin");
+
+		// The streams stay usable after the archive is gone
+		delete archive;
+
+		TS_ASSERT(a && b && c);
+		if (a && b && c) {
+			TS_ASSERT(b->seek(500 * 1024));
+			for (int i = 0; i < 50; ++i) {
+				TS_ASSERT(readMatches(*a, members[1].data, 4321));
+				TS_ASSERT(readMatches(*b, members[1].data, 1234));
+				TS_ASSERT(readMatches(*c, members[2].data, 999));
+			}
+		}
+
+		delete c;
+		delete b;
+		delete a;
+	}
+
+	// Member streams may be read and deleted on other threads, such as the
+	// audio thread, while the archive is used or deleted
+	void test_concurrent_streams() {
+#ifdef POSIX
+		const Common::Array<Member> members = makeMembers();
+		Common::Archive *archive = makeArchive(members, false, true);
+		TS_ASSERT(archive);
+		if (!archive)
+			return;
+
+		ReaderThread readers[4];
+		TestThread *threads[4];
+		const uint memberIndex[4] = { 1, 1, 2, 3 };
+		for (int i = 0; i < 4; ++i) {
+			readers[i].member = &members[memberIndex[i]];
+			readers[i].stream = archive->createReadStreamForMember(readers[i].member->name);
+			readers[i].ok = false;
+			TS_ASSERT(readers[i].stream);
+			if (!readers[i].stream)
+				return;
+		}
+
+		for (int i = 0; i < 4; ++i)
+			threads[i] = new TestThread(readerProc, &readers[i]);
+
+		// Keep using the archive meanwhile, then drop it
+		for (int i = 0; i < 20; ++i) {
+			Common::SeekableReadStream *stream = archive->createReadStreamForMember(i & 1 ? "small.bin" : "stored.bin");
+			TS_ASSERT(stream);
+			if (stream)
+				TS_ASSERT(readMatches(*stream, members[i & 1 ? 0 : 2].data, 1000));
+			delete stream;
+		}
+		delete archive;
+
+		for (int i = 0; i < 4; ++i) {
+			delete threads[i];
+			TS_ASSERT(readers[i].ok);
+		}
+#endif
+	}
+
+	void test_crc_mismatch() {
+		const Common::Array<Member> members = makeMembers();
+		Common::Archive *archive = makeArchive(members, true);
+		TS_ASSERT(archive);
+		if (!archive)
+			return;
+
+		// Small members are checked when they are opened, large ones
+		// once they have been read up to the end
+		TS_ASSERT(!archive->createReadStreamForMember("small.bin"));
+
+		Common::SeekableReadStream *stream = archive->createReadStreamForMember("deflated.bin");
+		TS_ASSERT(stream);
+		if (stream) {
+			Common::Array<byte> buffer;
+			buffer.resize(stream->size());
+			stream->read(buffer.begin(), buffer.size());
+			TS_ASSERT(stream->err());
+			delete stream;
+		}
+
+		delete archive;
+	}
+#endif
+};
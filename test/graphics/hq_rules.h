@@ -0,0 +1,153 @@
+#include <cxxtest/TestSuite.h>
+
+#include "graphics/scaler.h"
+#include "graphics/scaler/hq_rules.h"
+
+class HQRulesTestSuite : public CxxTest::TestSuite
+{
+#ifdef USE_HQ_SCALERS
+private:
+	enum {
+		kPitch = 16
+	};
+
+	// Black for w5 and three colours which differ from it and from each
+	// other, so every neighbourhood made of them has a single meaning
+	static uint32 colour(uint index) {
+		static const uint32 colours[4] = { 0xFF000000, 0xFFFF0000, 0xFF00FF00, 0xFF0000FF };
+		return colours[index];
+	}
+
+	/**
+	 * Computes an output pixel from the tables the way the HQ shader does:
+	 * the neighbourhood is rotated or mirrored so that the pixel ends up in
+	 * the top left corner or at the top edge of the block.
+	 *
+	 * @param w     the neighbourhood, w[y + 1][x + 1] being the pixel at
+	 *              offset (x, y) from w5
+	 * @param scale 2 or 3
+	 * @param subX  the column of the output pixel in the block
+	 * @param subY  the row of the output pixel in the block
+	 */
+	static uint32 applyRules(const uint32 w[3][3], int scale, int subX, int subY) {
+		const int dirX = (scale == 2) ? subX * 2 - 1 : subX - 1;
+		const int dirY = (scale == 2) ? subY * 2 - 1 : subY - 1;
+		if (dirX == 0 && dirY == 0)
+			return w[1][1];
+
+		// The neighbours w1 to w9 at the rotated offsets
+		uint32 n[10];
+		for (int y = -1; y <= 1; ++y) {
+			for (int x = -1; x <= 1; ++x) {
+				int fromX, fromY;
+				if (dirX != 0 && dirY == 0) {
+					fromX = -dirX * y;
+					fromY = x;
+				} else {
+					fromX = (dirX == 0 ? 1 : -dirX) * x;
+					fromY = -dirY * y;
+				}
+				n[(y + 1) * 3 + x + 2] = w[fromY + 1][fromX + 1];
+			}
+		}
+
+		static const int neighbours[8] = { 1, 2, 3, 4, 6, 7, 8, 9 };
+		uint pattern = 0;
+		for (int i = 0; i < 8; ++i) {
+			if (n[neighbours[i]] != n[5])
+				pattern |= 1 << i;
+		}
+
+		uint diffs = 0;
+		if (n[2] != n[6]) diffs |= kHQRuleDiff26;
+		if (n[4] != n[2]) diffs |= kHQRuleDiff42;
+		if (n[6] != n[8]) diffs |= kHQRuleDiff68;
+		if (n[8] != n[4]) diffs |= kHQRuleDiff84;
+
+		const HQRule *rules;
+		if (dirX != 0 && dirY != 0)
+			rules = (scale == 2) ? g_hq2xCornerRules : g_hq3xCornerRules;
+		else
+			rules = g_hq3xEdgeRules;
+		const byte *weights = getHQRuleWeights(rules[pattern], diffs);
+
+		uint32 result = 0xFF000000;
+		for (int shift = 0; shift < 24; shift += 8) {
+			const uint32 c = weights[0] * ((n[1] >> shift) & 0xFF)
+			               + weights[1] * ((n[2] >> shift) & 0xFF)
+			               + weights[2] * ((n[4] >> shift) & 0xFF)
+			               + (16 - weights[0] - weights[1] - weights[2]) * ((n[5] >> shift) & 0xFF);
+			result |= (c / 16) << shift;
+		}
+		return result;
+	}
+
+	// The scalers round a little differently
+	static bool isClose(uint32 a, uint32 b) {
+		for (int shift = 0; shift < 24; shift += 8) {
+			const int diff = (int)((a >> shift) & 0xFF) - (int)((b >> shift) & 0xFF);
+			if (ABS(diff) > 1)
+				return false;
+		}
+		return true;
+	}
+
+	// Compares the scaler with the tables for every neighbourhood of the
+	// four colours, which covers all patterns and differences
+	void compare(ScalerProc *scaler, int scale) {
+		InitScalers(8888);
+
+		uint32 src[3 * kPitch];
+		uint32 dst[3 * 3];
+		memset(src, 0, sizeof(src));
+
+		for (uint code = 0; code < 65536; ++code) {
+			uint32 w[3][3];
+			uint bits = code;
+			for (int i = 0; i < 9; ++i) {
+				if (i == 4) {
+					w[1][1] = colour(0);
+					continue;
+				}
+				w[i / 3][i % 3] = colour(bits & 3);
+				bits >>= 2;
+			}
+
+			for (int y = 0; y < 3; ++y) {
+				for (int x = 0; x < 3; ++x)
+					src[y * kPitch + x] = w[y][x];
+			}
+
+			scaler((const uint8 *)(src + kPitch + 1), kPitch * sizeof(uint32), (uint8 *)dst, scale * sizeof(uint32), 1, 1);
+
+			for (int subY = 0; subY < scale; ++subY) {
+				for (int subX = 0; subX < scale; ++subX) {
+					const uint32 expected = applyRules(w, scale, subX, subY);
+					const uint32 actual = dst[subY * scale + subX];
+					if (!isClose(actual, expected)) {
+						TS_FAIL(Common::String::format("HQ%dx differs at %d,%d for neighbourhood %04x: %08x instead of %08x",
+							scale, subX, subY, code, actual, expected).c_str());
+						DestroyScalers();
+						return;
+					}
+				}
+			}
+		}
+
+		DestroyScalers();
+	}
+#endif
+
+public:
+	void test_hq2x_rules() {
+#ifdef USE_HQ_SCALERS
+		compare(HQ2x, 2);
+#endif
+	}
+
+	void test_hq3x_rules() {
+#ifdef USE_HQ_SCALERS
+		compare(HQ3x, 3);
+#endif
+	}
+};
@@ -0,0 +1,136 @@
+#include <cxxtest/TestSuite.h>
+
+#include "graphics/scaler.h"
+#include "graphics/scaler/intern.h"
+#include "graphics/scaler/hq_simd.h"
+
+extern "C" uint32 *RGBtoYUV;
+
+class HQSimdTestSuite : public CxxTest::TestSuite
+{
+#ifdef USE_HQ_SCALERS
+private:
+	enum {
+		kWidth = kHQMaxClassifyWidth + 2,
+		kHeight = 8,
+		kPitch = kWidth + 7
+	};
+
+	static uint32 nextRandom(uint32 &seed) {
+		seed = seed * 1103515245 + 12345;
+		return seed >> 16;
+	}
+
+	// A few base colors with small variations, so that many neighbours
+	// are equal or close to the YUV thresholds.
+	static void fillRandom(uint16 *pixels, uint32 &seed) {
+		uint16 palette[8];
+		for (int i = 0; i < ARRAYSIZE(palette); ++i)
+			palette[i] = nextRandom(seed);
+
+		for (int i = 0; i < kPitch * kHeight; ++i) {
+			const uint32 r = nextRandom(seed);
+			pixels[i] = palette[r % 8];
+			if (r & 0x100)
+				pixels[i] ^= (r >> 9) & 0x0C63;
+		}
+	}
+
+	// The classification as originally done by the HQ scalers
+	static uint16 referenceCode(const uint16 *p, uint32 nextlineSrc) {
+		const int w[10] = { 0,
+			p[-1 - (int)nextlineSrc], p[-(int)nextlineSrc], p[1 - (int)nextlineSrc],
+			p[-1], p[0], p[1],
+			p[-1 + nextlineSrc], p[nextlineSrc], p[1 + nextlineSrc] };
+		static const int neighbours[8] = { 1, 2, 3, 4, 6, 7, 8, 9 };
+
+		uint16 code = 0;
+		for (int i = 0; i < 8; ++i) {
+			const int n = neighbours[i];
+			if (w[5] != w[n] && diffYUV(RGBtoYUV[w[5]], RGBtoYUV[w[n]]))
+				code |= 1 << i;
+		}
+
+		if (diffYUV(RGBtoYUV[w[2]], RGBtoYUV[w[6]])) code |= kHQDiff26;
+		if (diffYUV(RGBtoYUV[w[4]], RGBtoYUV[w[2]])) code |= kHQDiff42;
+		if (diffYUV(RGBtoYUV[w[6]], RGBtoYUV[w[8]])) code |= kHQDiff68;
+		if (diffYUV(RGBtoYUV[w[8]], RGBtoYUV[w[4]])) code |= kHQDiff84;
+		return code;
+	}
+
+	void compare(HQKernel kernel, int bitFormat) {
+		HQClassifyProc proc = getHQClassifyProc(kernel);
+		HQClassify32Proc proc32 = getHQClassify32Proc(kernel);
+		if (!proc || !proc32)
+			return;
+
+		InitScalers(bitFormat);
+		const Graphics::PixelFormat format = (bitFormat == 565) ? Graphics::createPixelFormat<565>() : Graphics::createPixelFormat<555>();
+		const Graphics::PixelFormat format32 = Graphics::createPixelFormat<8888>();
+
+		uint16 pixels[kPitch * kHeight];
+		uint32 pixels32[kPitch * kHeight];
+		uint16 codes[kHQMaxClassifyWidth];
+		uint16 codes32[kHQMaxClassifyWidth];
+		uint32 seed = bitFormat;
+
+		for (int width = 1; width <= kHQMaxClassifyWidth; width += (width < 40) ? 1 : 37) {
+			fillRandom(pixels, seed);
+
+			// The same picture in 32 bit gives the same YUV values
+			for (int i = 0; i < kPitch * kHeight; ++i) {
+				uint8 r, g, b;
+				format.colorToRGB(pixels[i], r, g, b);
+				pixels32[i] = format32.RGBToColor(r, g, b);
+			}
+
+			for (int y = 1; y < kHeight - 1; ++y) {
+				const int offset = y * kPitch + 1 + (width & 3);
+				proc(pixels + offset, kPitch, codes, width);
+				proc32(pixels32 + offset, kPitch, codes32, width);
+
+				for (int x = 0; x < width; ++x) {
+					if (codes[x] != referenceCode(pixels + offset + x, kPitch) || codes32[x] != codes[x]) {
+						TS_FAIL(Common::String::format("%s HQ classification differs, format %d, width %d, pixel %d",
+							getHQKernelName(kernel), bitFormat, width, x).c_str());
+						DestroyScalers();
+						return;
+					}
+				}
+			}
+		}
+
+		DestroyScalers();
+	}
+
+	void compareAll(HQKernel kernel) {
+		compare(kernel, 565);
+		compare(kernel, 555);
+	}
+#endif
+
+public:
+	void test_classify_scalar() {
+#ifdef USE_HQ_SCALERS
+		compareAll(kHQKernelScalar);
+#endif
+	}
+
+	void test_classify_sse2() {
+#ifdef USE_HQ_SCALERS
+		compareAll(kHQKernelSSE2);
+#endif
+	}
+
+	void test_classify_avx2() {
+#ifdef USE_HQ_SCALERS
+		compareAll(kHQKernelAVX2);
+#endif
+	}
+
+	void test_classify_neon() {
+#ifdef USE_HQ_SCALERS
+		compareAll(kHQKernelNEON);
+#endif
+	}
+};
@@ -0,0 +1,157 @@
+#include <cxxtest/TestSuite.h>
+
+#include "graphics/scaler.h"
+#include "graphics/colormasks.h"
+
+class Scaler32TestSuite : public CxxTest::TestSuite
+{
+#ifdef USE_SCALERS
+private:
+	enum {
+		kWidth = 32,
+		kHeight = 16,
+		kBorder = 2,
+		kSrcPitch = kWidth + 2 * kBorder,
+		kMaxScale = 3,
+		kDstPitch = kWidth * kMaxScale
+	};
+
+	struct Scaler {
+		ScalerProc *proc;
+		const char *name;
+		// The scale factor is num / den
+		int num, den;
+	};
+
+	static uint32 nextRandom(uint32 &seed) {
+		seed = seed * 1103515245 + 12345;
+		return seed >> 16;
+	}
+
+	// Picks the pixels from a small palette, so that there are plenty of
+	// equal neighbours and edges for the smarter scalers to work on.
+	static void fillRandom(uint16 *pixels, uint32 seed) {
+		uint16 palette[6];
+		for (int i = 0; i < ARRAYSIZE(palette); ++i)
+			palette[i] = nextRandom(seed);
+
+		for (int i = 0; i < kSrcPitch * (kHeight + 2 * kBorder); ++i)
+			pixels[i] = palette[nextRandom(seed) % ARRAYSIZE(palette)];
+	}
+
+	static uint32 to8888(uint16 color) {
+		uint8 r, g, b;
+		Graphics::createPixelFormat<565>().colorToRGB(color, r, g, b);
+		return Graphics::createPixelFormat<8888>().ARGBToColor(0xFF, r, g, b);
+	}
+
+	static bool channelsClose(uint16 color16, uint32 color32) {
+		uint8 r16, g16, b16, a32, r32, g32, b32;
+		Graphics::createPixelFormat<565>().colorToRGB(color16, r16, g16, b16);
+		Graphics::createPixelFormat<8888>().colorToARGB(color32, a32, r32, g32, b32);
+
+		// The 16 bit scalers round in 5 or 6 bits, so a difference of
+		// one step there is fine
+		return a32 == 0xFF && ABS(r16 - r32) <= 10 && ABS(g16 - g32) <= 10 && ABS(b16 - b32) <= 10;
+	}
+
+	// Runs the scaler on the same picture in 565 and in 8888, and checks
+	// that the results are the same but for rounding.
+	void compare(const Scaler &scaler, uint32 seed) {
+		uint16 src16[kSrcPitch * (kHeight + 2 * kBorder)];
+		uint32 src32[kSrcPitch * (kHeight + 2 * kBorder)];
+		uint16 dst16[kDstPitch * kHeight * kMaxScale];
+		uint32 dst32[kDstPitch * kHeight * kMaxScale];
+
+		fillRandom(src16, seed);
+		for (int i = 0; i < ARRAYSIZE(src16); ++i)
+			src32[i] = to8888(src16[i]);
+
+		const int offset = kBorder * kSrcPitch + kBorder;
+
+		InitScalers(565);
+		scaler.proc((const uint8 *)(src16 + offset), kSrcPitch * sizeof(uint16),
+			(uint8 *)dst16, kDstPitch * sizeof(uint16), kWidth, kHeight);
+
+		InitScalers(8888);
+		scaler.proc((const uint8 *)(src32 + offset), kSrcPitch * sizeof(uint32),
+			(uint8 *)dst32, kDstPitch * sizeof(uint32), kWidth, kHeight);
+
+		DestroyScalers();
+
+		const int dstWidth = kWidth * scaler.num / scaler.den;
+		const int dstHeight = kHeight * scaler.num / scaler.den;
+		for (int y = 0; y < dstHeight; ++y) {
+			for (int x = 0; x < dstWidth; ++x) {
+				const int i = y * kDstPitch + x;
+				if (!channelsClose(dst16[i], dst32[i])) {
+					TS_FAIL(Common::String::format("%s: 32 bit output differs at %d,%d: %04X vs %08X",
+						scaler.name, x, y, dst16[i], dst32[i]).c_str());
+					return;
+				}
+			}
+		}
+	}
+
+	void compareAll(const Scaler *scalers, int count) {
+		for (int i = 0; i < count; ++i) {
+			compare(scalers[i], 1);
+			compare(scalers[i], 2);
+		}
+	}
+#endif
+
+public:
+	void test_normal() {
+#ifdef USE_SCALERS
+		static const Scaler scalers[] = {
+			{ Normal1x, "Normal1x", 1, 1 },
+			{ Normal2x, "Normal2x", 2, 1 },
+			{ Normal3x, "Normal3x", 3, 1 },
+			{ Normal1o5x, "Normal1o5x", 3, 2 }
+		};
+		compareAll(scalers, ARRAYSIZE(scalers));
+#endif
+	}
+
+	void test_advmame() {
+#ifdef USE_SCALERS
+		static const Scaler scalers[] = {
+			{ AdvMame2x, "AdvMame2x", 2, 1 },
+			{ AdvMame3x, "AdvMame3x", 3, 1 }
+		};
+		compareAll(scalers, ARRAYSIZE(scalers));
+#endif
+	}
+
+	void test_sai() {
+#ifdef USE_SCALERS
+		static const Scaler scalers[] = {
+			{ _2xSaI, "2xSaI", 2, 1 },
+			{ Super2xSaI, "Super2xSaI", 2, 1 },
+			{ SuperEagle, "SuperEagle", 2, 1 }
+		};
+		compareAll(scalers, ARRAYSIZE(scalers));
+#endif
+	}
+
+	void test_tv_dotmatrix() {
+#ifdef USE_SCALERS
+		static const Scaler scalers[] = {
+			{ TV2x, "TV2x", 2, 1 },
+			{ DotMatrix, "DotMatrix", 2, 1 }
+		};
+		compareAll(scalers, ARRAYSIZE(scalers));
+#endif
+	}
+
+	void test_hq() {
+#ifdef USE_HQ_SCALERS
+		static const Scaler scalers[] = {
+			{ HQ2x, "HQ2x", 2, 1 },
+			{ HQ3x, "HQ3x", 3, 1 }
+		};
+		compareAll(scalers, ARRAYSIZE(scalers));
+#endif
+	}
+};
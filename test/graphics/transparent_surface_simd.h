@@ -0,0 +1,106 @@
+#include <cxxtest/TestSuite.h>
+
+#include "graphics/transparent_surface_simd.h"
+
+class TransparentSurfaceSimdTestSuite : public CxxTest::TestSuite
+{
+private:
+	enum {
+		kMaxWidth = 37,
+		kHeight = 3,
+		kPitch = kMaxWidth * 4 + 12
+	};
+
+	static uint32 nextRandom(uint32 &seed) {
+		seed = seed * 1103515245 + 12345;
+		return seed >> 16;
+	}
+
+	// Random pixels, with plenty of fully transparent, fully opaque and
+	// saturated channels, since those take special paths in the kernels.
+	static void fillRandom(byte *buffer, uint32 size, uint32 &seed) {
+		for (uint32 i = 0; i < size; ++i) {
+			const uint32 r = nextRandom(seed);
+			switch (r % 8) {
+			case 0:
+				buffer[i] = 0;
+				break;
+			case 1:
+				buffer[i] = 255;
+				break;
+			default:
+				buffer[i] = (byte)(r >> 3);
+				break;
+			}
+		}
+	}
+
+	// Blends the same random block through the scalar kernel and the
+	// given kernel, for every width and both horizontal directions.
+	void compare(Graphics::BlendKernel kernel, Graphics::TSpriteBlendMode mode, uint32 color, uint32 seed) {
+		Graphics::BlendBlitProc ref = Graphics::getBlendBlitProc(Graphics::kBlendKernelScalar, mode);
+		Graphics::BlendBlitProc proc = Graphics::getBlendBlitProc(kernel, mode);
+		if (!proc)
+			return;
+
+		byte in[kPitch * kHeight];
+		byte outRef[kPitch * kHeight], outRes[kPitch * kHeight];
+
+		for (uint32 width = 0; width <= kMaxWidth; ++width) {
+			for (int flip = 0; flip < 2; ++flip) {
+				fillRandom(in, sizeof(in), seed);
+				fillRandom(outRef, sizeof(outRef), seed);
+				memcpy(outRes, outRef, sizeof(outRef));
+
+				// Flipped blits start at the last pixel of the first row
+				const int32 inStep = flip ? -4 : 4;
+				byte *ino = flip && width ? in + (width - 1) * 4 : in;
+
+				ref(ino, outRef, width, kHeight, kPitch, inStep, kPitch, color);
+				proc(ino, outRes, width, kHeight, kPitch, inStep, kPitch, color);
+
+				if (memcmp(outRef, outRes, sizeof(outRef)) != 0) {
+					TS_FAIL(Common::String::format("%s kernel differs from the scalar one, mode %d, color %08x, width %d, flip %d",
+						Graphics::getBlendKernelName(kernel), mode, color, width, flip).c_str());
+					return;
+				}
+			}
+		}
+	}
+
+	void compareAll(Graphics::BlendKernel kernel) {
+		static const uint32 colors[] = {
+			0xFFFFFFFF, 0x80FFFFFF, 0xFF102030, 0xC0FF80FF, 0x00FFFFFF, 0x7FFF00C0, 0xFF000000
+		};
+
+		uint32 seed = 1;
+		for (int mode = Graphics::BLEND_NORMAL; mode < Graphics::NUM_BLEND_MODES; ++mode) {
+			for (uint i = 0; i < ARRAYSIZE(colors); ++i)
+				compare(kernel, (Graphics::TSpriteBlendMode)mode, colors[i], seed++);
+			for (int i = 0; i < 8; ++i)
+				compare(kernel, (Graphics::TSpriteBlendMode)mode, nextRandom(seed) | (nextRandom(seed) << 16), seed++);
+		}
+	}
+
+public:
+	void test_best_kernel() {
+		const Graphics::BlendKernel best = Graphics::getBestBlendKernel();
+		for (int mode = Graphics::BLEND_NORMAL; mode < Graphics::NUM_BLEND_MODES; ++mode) {
+			TS_ASSERT(Graphics::getBlendBlitProc(best, (Graphics::TSpriteBlendMode)mode) != 0);
+			TS_ASSERT_EQUALS(Graphics::getBestBlendBlitProc((Graphics::TSpriteBlendMode)mode),
+				Graphics::getBlendBlitProc(best, (Graphics::TSpriteBlendMode)mode));
+		}
+	}
+
+	void test_blend_sse2() {
+		compareAll(Graphics::kBlendKernelSSE2);
+	}
+
+	void test_blend_avx2() {
+		compareAll(Graphics::kBlendKernelAVX2);
+	}
+
+	void test_blend_neon() {
+		compareAll(Graphics::kBlendKernelNEON);
+	}
+};
@@ -0,0 +1,154 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/scummsys.h"
+
+#ifdef USE_FREETYPE2
+
+#include "common/stream.h"
+
+#include "graphics/font.h"
+#include "graphics/surface.h"
+#include "graphics/fonts/ttf.h"
+
+#include "test/system.h"
+
+class TTFFontTestSuite : public CxxTest::TestSuite
+{
+private:
+	enum {
+		kWidth = 160,
+		kHeight = 48,
+		// Strings are turned into runs when they are drawn a second time
+		kDrawCount = 3
+	};
+
+	struct Placement {
+		const char *str;
+		int x, y, w;
+		Graphics::TextAlign align;
+		int deltax;
+	};
+
+	static Graphics::Font *loadFont(int size) {
+		Common::SeekableReadStream *stream = openTestSourceFile("gui/themes/fonts/FreeSans.ttf");
+		if (!stream)
+			return 0;
+
+		Graphics::Font *font = Graphics::loadTTFFont(*stream, size);
+		delete stream;
+		return font;
+	}
+
+	// A background with every level of every channel, so that all blends
+	// get checked
+	static void fillBackground(Graphics::Surface &surface) {
+		for (int y = 0; y < surface.h; ++y) {
+			for (int x = 0; x < surface.w; ++x) {
+				const uint32 color = surface.format.ARGBToColor(255, (x * 7 + y) & 0xFF, (y * 11 + x * 3) & 0xFF, (x * y) & 0xFF);
+				if (surface.format.bytesPerPixel == 1)
+					*(byte *)surface.getBasePtr(x, y) = (byte)(x + y * 3);
+				else if (surface.format.bytesPerPixel == 2)
+					*(uint16 *)surface.getBasePtr(x, y) = color;
+				else
+					*(uint32 *)surface.getBasePtr(x, y) = color;
+			}
+		}
+	}
+
+	// Draws a string glyph by glyph, following drawStringImpl in
+	// graphics/font.cpp
+	static void drawCharByChar(const Graphics::Font &font, Graphics::Surface &dst, const Placement &p, uint32 color) {
+		const Common::String str(p.str);
+		const int leftX = p.x, rightX = p.x + p.w;
+		const int width = font.getStringWidth(str);
+
+		int x = p.x;
+		if (p.align == Graphics::kTextAlignCenter)
+			x = x + (p.w - width) / 2;
+		else if (p.align == Graphics::kTextAlignRight)
+			x = x + p.w - width;
+		x += p.deltax;
+
+		uint32 last = 0;
+		for (uint i = 0; i < str.size(); ++i) {
+			const uint32 cur = (byte)str[i];
+			x += font.getKerningOffset(last, cur);
+			last = cur;
+
+			if (x + font.getBoundingBox(cur).right > rightX)
+				break;
+			if (x + font.getBoundingBox(cur).right >= leftX)
+				font.drawChar(&dst, cur, x, p.y, color);
+
+			x += font.getCharWidth(cur);
+		}
+	}
+
+	void compare(const Graphics::PixelFormat &format, int size) {
+		// Glyphs which reach into their neighbours, so that their
+		// antialiased edges overlap, strings clipped by the surface and by
+		// their width, and all alignments.
+		static const Placement placements[] = {
+			{ "AVAWAYATawLTVaTo", 2, 4, kWidth - 4, Graphics::kTextAlignLeft, 0 },
+			{ "Name: ____ /\\/\\/\\", -7, 12, kWidth, Graphics::kTextAlignLeft, 0 },
+			{ "Beneath a Steel Sky", 0, -5, kWidth, Graphics::kTextAlignCenter, 3 },
+			{ "Subtitle speed:", 20, kHeight - 8, 80, Graphics::kTextAlignRight, 0 },
+			{ "The Secret of Monkey Island", 100, 20, kWidth, Graphics::kTextAlignLeft, -2 },
+			{ "Wolf ____", 30, 24, 40, Graphics::kTextAlignCenter, 0 },
+			{ "________________", 4, kHeight - 3, kWidth, Graphics::kTextAlignRight, 0 }
+		};
+
+		Graphics::Font *font = loadFont(size);
+		TS_ASSERT(font);
+		if (!font)
+			return;
+
+		const uint32 color = (format.bytesPerPixel == 1) ? 15 : format.RGBToColor(250, 230, 40);
+
+		Graphics::Surface expected, actual;
+		expected.create(kWidth, kHeight, format);
+		actual.create(kWidth, kHeight, format);
+
+		for (uint i = 0; i < ARRAYSIZE(placements); ++i) {
+			const Placement &p = placements[i];
+
+			fillBackground(expected);
+			drawCharByChar(*font, expected, p, color);
+
+			for (int pass = 0; pass < kDrawCount; ++pass) {
+				fillBackground(actual);
+				font->drawString(&actual, p.str, p.x, p.y, p.w, color, p.align, p.deltax, false);
+
+				bool same = true;
+				for (int y = 0; y < kHeight && same; ++y)
+					same = !memcmp(expected.getBasePtr(0, y), actual.getBasePtr(0, y), kWidth * format.bytesPerPixel);
+				TSM_ASSERT(p.str, same);
+			}
+		}
+
+		expected.free();
+		actual.free();
+		delete font;
+	}
+
+public:
+	void test_runs_clut8() {
+		compare(Graphics::PixelFormat::createFormatCLUT8(), 14);
+	}
+
+	void test_runs_rgb565() {
+		compare(Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0), 14);
+	}
+
+	void test_runs_argb8888() {
+		compare(Graphics::PixelFormat(4, 8, 8, 8, 8, 16, 8, 0, 24), 14);
+		compare(Graphics::PixelFormat(4, 8, 8, 8, 8, 16, 8, 0, 24), 30);
+	}
+
+	void test_runs_rgb555_32() {
+		// Takes the generic 32 bpp blend
+		compare(Graphics::PixelFormat(4, 5, 5, 5, 0, 10, 5, 0, 0), 20);
+	}
+};
+
+#endif
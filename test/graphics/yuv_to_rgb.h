@@ -0,0 +1,121 @@
+#include <cxxtest/TestSuite.h>
+
+#include "graphics/surface.h"
+#include "graphics/yuv_to_rgb.h"
+#include "graphics/yuv_to_rgb_simd.h"
+
+class YUVToRGBTestSuite : public CxxTest::TestSuite
+{
+private:
+	enum {
+		kWidth = 256,
+		kHeight = 256,
+		kPasses = 4
+	};
+
+	static uint32 nextRandom(uint32 &seed) {
+		seed = seed * 1103515245 + 12345;
+		return seed >> 16;
+	}
+
+	// Every pair of u and v values appears in the planes, with luminance
+	// values from all over the range, including the clipped ends.
+	static void fillPlanes(byte *y, byte *u, byte *v, int pass, uint32 &seed) {
+		for (int row = 0; row < kHeight; ++row) {
+			for (int x = 0; x < kWidth; ++x) {
+				const int i = row * kWidth + x;
+				y[i] = (pass == 0) ? (byte)(x * 5 + row * 3) : (byte)nextRandom(seed);
+				u[i] = x;
+				v[i] = row;
+			}
+		}
+	}
+
+	// Converts the same planes with the lookup tables and the given
+	// implementation, for a few widths to get the row tails covered.
+	void compare(Graphics::YUVToRGBKernel kernel, const Graphics::PixelFormat &format, Graphics::YUVToRGBManager::LuminanceScale scale, bool is420) {
+		static const int widths[] = { kWidth, kWidth - 2, 38, 22, 2 };
+
+		byte *y = new byte[kWidth * kHeight];
+		byte *u = new byte[kWidth * kHeight];
+		byte *v = new byte[kWidth * kHeight];
+		Graphics::Surface ref, res;
+		ref.create(kWidth, kHeight, format);
+		res.create(kWidth, kHeight, format);
+
+		uint32 seed = 1;
+		for (int pass = 0; pass < kPasses; ++pass) {
+			fillPlanes(y, u, v, pass, seed);
+
+			for (uint i = 0; i < ARRAYSIZE(widths); ++i) {
+				// Odd widths only work for 444
+				const int width = widths[i] - ((is420 || pass < 2) ? 0 : 1);
+				memset(ref.getPixels(), 0, ref.pitch * ref.h);
+				memset(res.getPixels(), 0, res.pitch * res.h);
+
+				TS_ASSERT(YUVToRGBMan.setKernel(Graphics::kYUVToRGBKernelScalar));
+				convert(&ref, scale, y, u, v, width, is420);
+				TS_ASSERT(YUVToRGBMan.setKernel(kernel));
+				convert(&res, scale, y, u, v, width, is420);
+
+				if (memcmp(ref.getPixels(), res.getPixels(), ref.pitch * ref.h) != 0) {
+					TS_FAIL(Common::String::format("%s conversion differs from the tables, %d bpp, scale %d, %s, width %d, pass %d",
+						Graphics::getYUVToRGBKernelName(kernel), format.bytesPerPixel, scale, is420 ? "420" : "444", width, pass).c_str());
+					break;
+				}
+			}
+		}
+
+		YUVToRGBMan.setKernel(Graphics::getBestYUVToRGBKernel());
+		res.free();
+		ref.free();
+		delete[] v;
+		delete[] u;
+		delete[] y;
+	}
+
+	static void convert(Graphics::Surface *dst, Graphics::YUVToRGBManager::LuminanceScale scale, const byte *y, const byte *u, const byte *v, int width, bool is420) {
+		if (is420)
+			YUVToRGBMan.convert420(dst, scale, y, u, v, width, kHeight, kWidth, kWidth);
+		else
+			YUVToRGBMan.convert444(dst, scale, y, u, v, width, kHeight, kWidth, kWidth);
+	}
+
+	void compareAll(Graphics::YUVToRGBKernel kernel) {
+		if (!Graphics::isYUVToRGBKernelAvailable(kernel))
+			return;
+
+		const Graphics::PixelFormat formats[] = {
+			Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0),
+			Graphics::PixelFormat(2, 5, 5, 5, 1, 10, 5, 0, 15),
+			Graphics::PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0),
+			Graphics::PixelFormat(4, 8, 8, 8, 0, 0, 8, 16, 0)
+		};
+
+		for (uint i = 0; i < ARRAYSIZE(formats); ++i) {
+			for (int is420 = 0; is420 < 2; ++is420) {
+				compare(kernel, formats[i], Graphics::YUVToRGBManager::kScaleFull, is420);
+				compare(kernel, formats[i], Graphics::YUVToRGBManager::kScaleITU, is420);
+			}
+		}
+	}
+
+public:
+	void test_best_kernel() {
+		TS_ASSERT(Graphics::isYUVToRGBKernelAvailable(Graphics::kYUVToRGBKernelScalar));
+		TS_ASSERT(Graphics::isYUVToRGBKernelAvailable(Graphics::getBestYUVToRGBKernel()));
+		TS_ASSERT_EQUALS(YUVToRGBMan.getKernel(), Graphics::getBestYUVToRGBKernel());
+	}
+
+	void test_yuv_sse2() {
+		compareAll(Graphics::kYUVToRGBKernelSSE2);
+	}
+
+	void test_yuv_avx2() {
+		compareAll(Graphics::kYUVToRGBKernelAVX2);
+	}
+
+	void test_yuv_neon() {
+		compareAll(Graphics::kYUVToRGBKernelNEON);
+	}
+};
@@ -5,8 +5,10 @@
 #
 ######################################################################
 
-TESTS        := $(srcdir)/test/common/*.h $(srcdir)/test/audio/*.h
-TEST_LIBS    := audio/libaudio.a common/libcommon.a
+TESTS        := $(srcdir)/test/common/*.h $(srcdir)/test/audio/*.h $(srcdir)/test/graphics/*.h $(srcdir)/test/video/*.h
+TEST_LIBS    := video/libvideo.a audio/libaudio.a graphics/libgraphics.a common/libcommon.a
+# The test OSystem, built on its own since it uses the host API
+TEST_SYSTEM  := $(srcdir)/test/system.cpp
 
 ifeq ($(ENABLE_WINTERMUTE), STATIC_PLUGIN)
 	TESTS += $(srcdir)/test/engines/wintermute/*.h
@@ -15,7 +17,7 @@ endif
 
 #
 TEST_FLAGS   := --runner=StdioPrinter --no-std --no-eh --include=$(srcdir)/test/cxxtest_mingw.h
-TEST_CFLAGS  := $(CFLAGS) -I$(srcdir)/test/cxxtest
+TEST_CFLAGS  := $(CFLAGS) -I$(srcdir)/test/cxxtest -DTEST_SRCDIR=\"$(srcdir)\"
 TEST_LDFLAGS := $(LDFLAGS) $(LIBS)
 TEST_CXXFLAGS := $(filter-out -Wglobal-constructors,$(CXXFLAGS))
 
@@ -36,14 +38,26 @@ endif
 
 test: test/runner
 	./test/runner
-test/runner: test/runner.cpp $(TEST_LIBS)
+test/runner: test/runner.cpp $(TEST_SYSTEM) $(TEST_LIBS)
 	$(QUIET_CXX)$(CXX) $(TEST_CXXFLAGS) $(CPPFLAGS) $(TEST_CFLAGS) -o $@ $+ $(TEST_LDFLAGS)
 test/runner.cpp: $(TESTS)
 	@mkdir -p test
 	$(srcdir)/test/cxxtest/cxxtestgen.py $(TEST_FLAGS) -o $@ $+
 
+#
+# Micro benchmarks. Use the 'bench' target to run them.
+#
+BENCH_SRCS   := $(wildcard $(srcdir)/test/benchmark/*.cpp)
+BENCH_LIBS   := $(TEST_LIBS)
+
+bench: test/bench
+	./test/bench
+test/bench: $(BENCH_SRCS) $(TEST_SYSTEM) $(BENCH_LIBS)
+	@mkdir -p test
+	$(QUIET_CXX)$(CXX) $(TEST_CXXFLAGS) $(CPPFLAGS) $(CFLAGS) -DBENCH_SRCDIR=\"$(srcdir)\" -DTEST_SRCDIR=\"$(srcdir)\" -o $@ $+ $(TEST_LDFLAGS)
+
 clean: clean-test
 clean-test:
-	-$(RM) test/runner.cpp test/runner
+	-$(RM) test/runner.cpp test/runner test/bench
 
-.PHONY: test clean-test
+.PHONY: test bench clean-test
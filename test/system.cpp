@@ -0,0 +1,190 @@
+// The test system is built on the host thread and clock API
+#define FORBIDDEN_SYMBOL_ALLOW_ALL
+
+#include "test/system.h"
+
+#include "common/memstream.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifdef POSIX
+#include <pthread.h>
+#include <sched.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+static uint32 getHostMillis() {
+	timeval now;
+	gettimeofday(&now, 0);
+	return (uint32)(now.tv_sec * 1000 + now.tv_usec / 1000);
+}
+#endif
+
+TestSystem::TestSystem() : _startMillis(0), _parallelJobCount(0) {
+	_timerManager = new TestTimerManager();
+#ifdef POSIX
+	_startMillis = getHostMillis();
+#endif
+}
+
+uint32 TestSystem::getMillis(bool skipRecord) {
+#ifdef POSIX
+	return getHostMillis() - _startMillis;
+#else
+	return 0;
+#endif
+}
+
+void TestSystem::delayMillis(uint msecs) {
+#ifdef POSIX
+	usleep(msecs * 1000);
+#endif
+}
+
+OSystem::MutexRef TestSystem::createMutex() {
+#ifdef POSIX
+	pthread_mutex_t *mutex = new pthread_mutex_t;
+	pthread_mutexattr_t attr;
+	pthread_mutexattr_init(&attr);
+	pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+	pthread_mutex_init(mutex, &attr);
+	pthread_mutexattr_destroy(&attr);
+	return (MutexRef)mutex;
+#else
+	return 0;
+#endif
+}
+
+void TestSystem::lockMutex(MutexRef mutex) {
+#ifdef POSIX
+	pthread_mutex_lock((pthread_mutex_t *)mutex);
+#endif
+}
+
+void TestSystem::unlockMutex(MutexRef mutex) {
+#ifdef POSIX
+	pthread_mutex_unlock((pthread_mutex_t *)mutex);
+#endif
+}
+
+void TestSystem::deleteMutex(MutexRef mutex) {
+#ifdef POSIX
+	pthread_mutex_destroy((pthread_mutex_t *)mutex);
+	delete (pthread_mutex_t *)mutex;
+#endif
+}
+
+#ifdef POSIX
+
+struct ParallelJobs {
+	OSystem::ParallelJobProc proc;
+	void *param;
+	uint count;
+	uint next;
+	pthread_mutex_t mutex;
+};
+
+static void runParallelJobsThread(void *param) {
+	ParallelJobs *jobs = (ParallelJobs *)param;
+
+	for (;;) {
+		pthread_mutex_lock(&jobs->mutex);
+		const uint index = jobs->next++;
+		pthread_mutex_unlock(&jobs->mutex);
+
+		if (index >= jobs->count)
+			return;
+		jobs->proc(jobs->param, index);
+	}
+}
+
+#endif
+
+void TestSystem::runParallelJobs(ParallelJobProc proc, void *param, uint count) {
+	_parallelJobCount += count;
+
+#ifdef POSIX
+	ParallelJobs jobs;
+	jobs.proc = proc;
+	jobs.param = param;
+	jobs.count = count;
+	jobs.next = 0;
+	pthread_mutex_init(&jobs.mutex, 0);
+
+	TestThread *threads[3];
+	for (int i = 0; i < 3; ++i)
+		threads[i] = new TestThread(runParallelJobsThread, &jobs);
+	runParallelJobsThread(&jobs);
+	for (int i = 0; i < 3; ++i)
+		delete threads[i];
+
+	pthread_mutex_destroy(&jobs.mutex);
+#else
+	OSystem::runParallelJobs(proc, param, count);
+#endif
+}
+
+Common::SeekableReadStream *openTestSourceFile(const char *path) {
+	const Common::String fullPath = Common::String(TEST_SRCDIR) + "/" + path;
+	FILE *file = fopen(fullPath.c_str(), "rb");
+	if (!file)
+		return 0;
+
+	byte *data = 0;
+	long size = -1;
+	if (!fseek(file, 0, SEEK_END) && (size = ftell(file)) > 0 && !fseek(file, 0, SEEK_SET)) {
+		data = (byte *)malloc(size);
+		if (data && fread(data, 1, size, file) != (size_t)size) {
+			free(data);
+			data = 0;
+		}
+	}
+	fclose(file);
+
+	if (!data)
+		return 0;
+	return new Common::MemoryReadStream(data, size, DisposeAfterUse::YES);
+}
+
+#ifdef POSIX
+
+// Held while a thread is started, so the new thread only runs once its
+// handle is stored
+static pthread_mutex_t s_startMutex = PTHREAD_MUTEX_INITIALIZER;
+
+TestThread::TestThread(Proc proc, void *param) : _proc(proc), _param(param) {
+	pthread_t *thread = new pthread_t;
+	pthread_mutex_lock(&s_startMutex);
+	_thread = thread;
+	pthread_create(thread, 0, run, this);
+	pthread_mutex_unlock(&s_startMutex);
+}
+
+TestThread::~TestThread() {
+	pthread_join(*(pthread_t *)_thread, 0);
+	delete (pthread_t *)_thread;
+}
+
+bool TestThread::isCurrent() const {
+	return pthread_equal(pthread_self(), *(pthread_t *)_thread);
+}
+
+void TestThread::yield() {
+	sched_yield();
+}
+
+void TestThread::sleep(uint microseconds) {
+	usleep(microseconds);
+}
+
+void *TestThread::run(void *param) {
+	TestThread *thread = (TestThread *)param;
+	pthread_mutex_lock(&s_startMutex);
+	pthread_mutex_unlock(&s_startMutex);
+
+	thread->_proc(thread->_param);
+	return 0;
+}
+
+#endif
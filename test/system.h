@@ -0,0 +1,160 @@
+#ifndef TEST_SYSTEM_H
+#define TEST_SYSTEM_H
+
+#include "common/system.h"
+#include "common/timer.h"
+
+/**
+ * A timer manager which calls its callback only when the test says so,
+ * through TestSystem::fireTimer(). It takes one callback at a time.
+ */
+class TestTimerManager : public Common::TimerManager {
+public:
+	TestTimerManager() : _proc(0), _refCon(0) {}
+
+	bool installTimerProc(TimerProc proc, int32 interval, void *refCon, const Common::String &id) {
+		_proc = proc;
+		_refCon = refCon;
+		return true;
+	}
+
+	void removeTimerProc(TimerProc proc) {
+		if (_proc == proc)
+			_proc = 0;
+	}
+
+	bool fire() {
+		if (!_proc)
+			return false;
+		_proc(_refCon);
+		return true;
+	}
+
+private:
+	TimerProc _proc;
+	void *_refCon;
+};
+
+/**
+ * Just enough of an OSystem for code which needs mutexes and a clock. On
+ * POSIX, the mutexes and the clock are real ones, so tests can use them
+ * from TestThreads. Elsewhere, the mutexes do nothing, which is fine for
+ * tests that run on a single thread.
+ *
+ * Suites install it as g_system in setUp() and restore the old one in
+ * tearDown().
+ *
+ * The host specific parts live in test/system.cpp, which is compiled on
+ * its own, so the forbidden symbol checks stay enabled for the tests.
+ */
+class TestSystem : public OSystem {
+public:
+	TestSystem();
+
+	uint32 getMillis(bool skipRecord = false);
+	void delayMillis(uint msecs);
+
+	MutexRef createMutex();
+	void lockMutex(MutexRef mutex);
+	void unlockMutex(MutexRef mutex);
+	void deleteMutex(MutexRef mutex);
+
+	/** On POSIX, this runs the jobs on four threads. */
+	void runParallelJobs(ParallelJobProc proc, void *param, uint count);
+
+	/** The number of jobs run through runParallelJobs(). */
+	uint getParallelJobCount() const { return _parallelJobCount; }
+
+	/**
+	 * Call the callback of the timer manager.
+	 *
+	 * @return false if there is none
+	 */
+	bool fireTimer() { return ((TestTimerManager *)_timerManager)->fire(); }
+
+	Graphics::PixelFormat getScreenFormat() const { return Graphics::PixelFormat::createFormatCLUT8(); }
+
+	// Not needed by the tests
+	const GraphicsMode *getSupportedGraphicsModes() const { return 0; }
+	int getDefaultGraphicsMode() const { return 0; }
+	bool setGraphicsMode(int mode) { return false; }
+	int getGraphicsMode() const { return 0; }
+	Common::List<Graphics::PixelFormat> getSupportedFormats() const { return Common::List<Graphics::PixelFormat>(); }
+	void initSize(uint width, uint height, const Graphics::PixelFormat *format) {}
+	int16 getHeight() { return 0; }
+	int16 getWidth() { return 0; }
+	PaletteManager *getPaletteManager() { return 0; }
+	void copyRectToScreen(const void *buf, int pitch, int x, int y, int w, int h) {}
+	Graphics::Surface *lockScreen() { return 0; }
+	void unlockScreen() {}
+	void fillScreen(uint32 col) {}
+	void updateScreen() {}
+	void setShakePos(int shakeOffset) {}
+	void showOverlay() {}
+	void hideOverlay() {}
+	Graphics::PixelFormat getOverlayFormat() const { return Graphics::PixelFormat(); }
+	void clearOverlay() {}
+	void grabOverlay(void *buf, int pitch) {}
+	void copyRectToOverlay(const void *buf, int pitch, int x, int y, int w, int h) {}
+	int16 getOverlayHeight() { return 0; }
+	int16 getOverlayWidth() { return 0; }
+	bool showMouse(bool visible) { return false; }
+	void warpMouse(int x, int y) {}
+	void setMouseCursor(const void *buf, uint w, uint h, int hotspotX, int hotspotY, uint32 keycolor, bool dontScale, const Graphics::PixelFormat *format) {}
+	void getTimeAndDate(TimeDate &t) const {}
+	Audio::Mixer *getMixer() { return 0; }
+	void quit() {}
+	void displayMessageOnOSD(const char *msg) {}
+	void displayActivityIconOnOSD(const Graphics::Surface *icon) {}
+	void logMessage(LogMessageType::Type type, const char *message) {}
+
+private:
+	uint32 _startMillis;
+	uint _parallelJobCount;
+};
+
+/**
+ * Open a file of the source tree, like one of the theme fonts, for tests
+ * which need real data. The path is relative to the top of the tree.
+ *
+ * @return the whole file in memory, or 0 if it can not be read
+ */
+Common::SeekableReadStream *openTestSourceFile(const char *path);
+
+#ifdef POSIX
+
+/**
+ * A host thread, for tests of code which is used from several threads,
+ * like the audio thread and the timer thread of the backends. Only POSIX
+ * tests have threads.
+ */
+class TestThread {
+public:
+	typedef void (*Proc)(void *param);
+
+	/** Start running proc(param) on a new thread. */
+	TestThread(Proc proc, void *param);
+
+	/** Wait for the thread to finish. */
+	~TestThread();
+
+	/** Whether this is the thread calling. */
+	bool isCurrent() const;
+
+	/** Let other threads run. */
+	static void yield();
+
+	/** Sleep for the given number of microseconds. */
+	static void sleep(uint microseconds);
+
+private:
+	static void *run(void *param);
+
+	Proc _proc;
+	void *_param;
+	void *_thread;
+};
+
+#endif
+
+#endif
@@ -0,0 +1,315 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/timer.h"
+#include "graphics/surface.h"
+#include "video/video_decoder.h"
+
+#include "test/system.h"
+
+#ifdef POSIX
+
+/**
+ * A TestSystem with a timer manager which runs its callbacks on a thread of
+ * its own, like the one of the SDL backend.
+ */
+class DecodeAheadTestSystem : public TestSystem {
+public:
+	class TimerManager : public Common::TimerManager {
+	public:
+		TimerManager(OSystem *system) : _system(system), _proc(0), _refCon(0), _interval(0), _quit(false) {
+			_mutex = _system->createMutex();
+			_thread = new TestThread(threadProc, this);
+		}
+
+		~TimerManager() {
+			_system->lockMutex(_mutex);
+			_quit = true;
+			_system->unlockMutex(_mutex);
+			delete _thread;
+			_system->deleteMutex(_mutex);
+		}
+
+		bool installTimerProc(TimerProc proc, int32 interval, void *refCon, const Common::String &id) {
+			_system->lockMutex(_mutex);
+			_proc = proc;
+			_interval = interval;
+			_refCon = refCon;
+			_system->unlockMutex(_mutex);
+			return true;
+		}
+
+		// Like DefaultTimerManager, this waits for a running callback
+		void removeTimerProc(TimerProc proc) {
+			_system->lockMutex(_mutex);
+			if (_proc == proc)
+				_proc = 0;
+			_system->unlockMutex(_mutex);
+		}
+
+		const TestThread *getThread() const { return _thread; }
+
+	private:
+		static void threadProc(void *param) {
+			TimerManager *manager = (TimerManager *)param;
+
+			for (;;) {
+				manager->_system->lockMutex(manager->_mutex);
+				if (manager->_quit) {
+					manager->_system->unlockMutex(manager->_mutex);
+					return;
+				}
+				if (manager->_proc)
+					manager->_proc(manager->_refCon);
+				const int32 interval = manager->_proc ? manager->_interval : 1000;
+				manager->_system->unlockMutex(manager->_mutex);
+
+				TestThread::sleep(interval);
+			}
+		}
+
+		// The mutex is not a Common::Mutex, which needs g_system, and
+		// this is created before the system is installed
+		OSystem *_system;
+		OSystem::MutexRef _mutex;
+		TestThread *_thread;
+		TimerProc _proc;
+		void *_refCon;
+		int32 _interval;
+		bool _quit;
+	};
+
+	DecodeAheadTestSystem() {
+		_timerManager = new TimerManager(this);
+	}
+
+	// The timer manager uses the mutexes of the system, which are gone by
+	// the time OSystem deletes it
+	~DecodeAheadTestSystem() {
+		delete _timerManager;
+		_timerManager = 0;
+	}
+
+	const TestThread *getTimerThread() const { return ((TimerManager *)_timerManager)->getThread(); }
+};
+
+/**
+ * A decoder whose frames contain their own number. Like SmackerDecoder, it
+ * repositions its stream after calling VideoDecoder::rewind(). Every access
+ * to the "stream" checks that no other thread is using it at the same time.
+ */
+class DecodeAheadTestDecoder : public Video::VideoDecoder {
+public:
+	enum {
+		kFrameCount = 24,
+		kSlowFrameDelay = 20
+	};
+
+	DecodeAheadTestDecoder(bool supportsDecodeAhead)
+		: _supportsDecodeAhead(supportsDecodeAhead), _streamInUse(false), _raceDetected(false),
+		  _framesDecodedOnTimer(0), _timerThread(((DecodeAheadTestSystem *)g_system)->getTimerThread()) {
+		addTrack(new TestVideoTrack(*this));
+	}
+
+	~DecodeAheadTestDecoder() {
+		close();
+	}
+
+	bool loadStream(Common::SeekableReadStream *stream) { return false; }
+
+	bool rewind() {
+		if (!VideoDecoder::rewind())
+			return false;
+
+		useStream();
+		return true;
+	}
+
+	bool hasRaceDetected() const { return _raceDetected; }
+	uint getFramesDecodedOnTimer() const { return _framesDecodedOnTimer; }
+
+protected:
+	bool supportsDecodeAhead() const { return _supportsDecodeAhead; }
+
+	void readNextPacket() {
+		useStream();
+	}
+
+private:
+	class TestVideoTrack : public FixedRateVideoTrack {
+	public:
+		TestVideoTrack(DecodeAheadTestDecoder &decoder) : _decoder(decoder), _curFrame(-1) {
+			_surface.create(4, 4, Graphics::PixelFormat::createFormatCLUT8());
+		}
+
+		~TestVideoTrack() {
+			_surface.free();
+		}
+
+		uint16 getWidth() const { return _surface.w; }
+		uint16 getHeight() const { return _surface.h; }
+		Graphics::PixelFormat getPixelFormat() const { return _surface.format; }
+		int getCurFrame() const { return _curFrame; }
+		int getFrameCount() const { return kFrameCount; }
+		bool isSeekable() const { return true; }
+
+		bool seek(const Audio::Timestamp &time) {
+			_curFrame = getFrameAtTime(time) - 1;
+			return true;
+		}
+
+		const Graphics::Surface *decodeNextFrame() {
+			_curFrame++;
+
+			if (_decoder._timerThread->isCurrent())
+				_decoder._framesDecodedOnTimer++;
+
+			// Some frames are expensive
+			if ((_curFrame % 4) == 3)
+				TestThread::sleep(kSlowFrameDelay * 1000);
+
+			_surface.fillRect(Common::Rect(_surface.w, _surface.h), _curFrame);
+			return &_surface;
+		}
+
+	protected:
+		Common::Rational getFrameRate() const { return 100; }
+
+	private:
+		DecodeAheadTestDecoder &_decoder;
+		Graphics::Surface _surface;
+		int _curFrame;
+	};
+
+	void useStream() {
+		if (_streamInUse)
+			_raceDetected = true;
+		_streamInUse = true;
+
+		// Give the other thread a chance to run into us
+		TestThread::sleep(500);
+
+		_streamInUse = false;
+	}
+
+	const bool _supportsDecodeAhead;
+	volatile bool _streamInUse;
+	volatile bool _raceDetected;
+	volatile uint _framesDecodedOnTimer;
+	const TestThread *const _timerThread;
+};
+
+#endif
+
+// The decoding ahead needs threads, which the tests only have on POSIX
+class DecodeAheadTestSuite : public CxxTest::TestSuite {
+#ifdef POSIX
+private:
+	OSystem *_oldSystem;
+	DecodeAheadTestSystem *_system;
+
+	// Returns the number stored in the frame, or -1 without a frame
+	static int frameNumber(const Graphics::Surface *frame) {
+		return frame ? *(const byte *)frame->getPixels() : -1;
+	}
+#endif
+
+public:
+	void setUp() {
+#ifdef POSIX
+		_oldSystem = g_system;
+		_system = new DecodeAheadTestSystem();
+		g_system = _system;
+#endif
+	}
+
+	void tearDown() {
+#ifdef POSIX
+		g_system = _oldSystem;
+		delete _system;
+#endif
+	}
+
+	void test_frames_in_order() {
+#ifdef POSIX
+		DecodeAheadTestDecoder decoder(true);
+		decoder.setDecodeAhead(4);
+		decoder.start();
+
+		for (int i = 0; i < DecodeAheadTestDecoder::kFrameCount; ++i) {
+			TS_ASSERT_EQUALS(frameNumber(decoder.decodeNextFrame()), i);
+			TS_ASSERT_EQUALS(decoder.getCurFrame(), i);
+
+			// Let the timer decode some frames
+			g_system->delayMillis(10);
+		}
+
+		TS_ASSERT(decoder.endOfVideo());
+		TS_ASSERT(!decoder.hasRaceDetected());
+		TS_ASSERT_LESS_THAN(0u, decoder.getFramesDecodedOnTimer());
+#endif
+	}
+
+	void test_rewind_and_seek() {
+#ifdef POSIX
+		DecodeAheadTestDecoder decoder(true);
+		decoder.setDecodeAhead(8);
+		decoder.start();
+
+		for (int pass = 0; pass < 3; ++pass) {
+			for (int i = 0; i < 6; ++i) {
+				TS_ASSERT_EQUALS(frameNumber(decoder.decodeNextFrame()), i);
+				g_system->delayMillis(5);
+			}
+
+			// The subclass uses its stream after VideoDecoder::rewind()
+			// returns, which must not race with the timer
+			TS_ASSERT(decoder.rewind());
+		}
+
+		TS_ASSERT(decoder.seek(Audio::Timestamp(150, 1000)));
+		for (int i = 15; i < 20; ++i) {
+			TS_ASSERT_EQUALS(frameNumber(decoder.decodeNextFrame()), i);
+			g_system->delayMillis(5);
+		}
+
+		decoder.stop();
+		TS_ASSERT(!decoder.hasRaceDetected());
+		TS_ASSERT_LESS_THAN(0u, decoder.getFramesDecodedOnTimer());
+#endif
+	}
+
+	void test_two_decoders() {
+#ifdef POSIX
+		DecodeAheadTestDecoder first(true), second(true);
+		first.setDecodeAhead(4);
+		second.setDecodeAhead(4);
+		first.start();
+		second.start();
+
+		for (int i = 0; i < DecodeAheadTestDecoder::kFrameCount; ++i) {
+			TS_ASSERT_EQUALS(frameNumber(first.decodeNextFrame()), i);
+			TS_ASSERT_EQUALS(frameNumber(second.decodeNextFrame()), i);
+			g_system->delayMillis(5);
+		}
+
+		TS_ASSERT(!first.hasRaceDetected());
+		TS_ASSERT(!second.hasRaceDetected());
+#endif
+	}
+
+	void test_opt_in() {
+#ifdef POSIX
+		// Decoders which do not support it are never decoded on the timer
+		DecodeAheadTestDecoder decoder(false);
+		decoder.setDecodeAhead(4);
+		decoder.start();
+
+		for (int i = 0; i < 8; ++i) {
+			TS_ASSERT_EQUALS(frameNumber(decoder.decodeNextFrame()), i);
+			g_system->delayMillis(5);
+		}
+
+		TS_ASSERT_EQUALS(decoder.getFramesDecodedOnTimer(), 0u);
+#endif
+	}
+};
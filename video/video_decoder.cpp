@@ -25,14 +25,48 @@
 #include "audio/audiostream.h"
 #include "audio/mixer.h" // for kMaxChannelVolume
 
+#include "common/config-manager.h"
+#include "common/debug.h"
 #include "common/rational.h"
 #include "common/file.h"
 #include "common/system.h"
+#include "common/timer.h"
 
 #include "graphics/palette.h"
+#include "graphics/surface.h"
 
 namespace Video {
 
+struct VideoDecoder::DecodedFrame {
+	Graphics::Surface surface;
+	bool hasSurface;
+	bool dirtyPalette;
+	byte palette[256 * 3];
+
+	// The state of the video track after decoding the frame
+	int curFrame;
+	uint32 nextFrameStartTime;
+	bool endOfTrack;
+};
+
+namespace {
+
+// A timer callback can only be installed once, so all decoders which decode
+// ahead share one. Both are only created and destroyed on the engine thread.
+Common::Array<VideoDecoder *> *s_decodeAheadDecoders = 0;
+Common::Mutex *s_decodeAheadMutex = 0;
+
+void copyFrame(Graphics::Surface &dst, const Graphics::Surface &src) {
+	// Keep the buffer of the frame we reuse if possible
+	if (dst.w != src.w || dst.h != src.h || dst.format != src.format)
+		dst.create(src.w, src.h, src.format);
+
+	for (int y = 0; y < src.h; ++y)
+		memcpy(dst.getBasePtr(0, y), src.getBasePtr(0, y), src.w * src.format.bytesPerPixel);
+}
+
+} // End of anonymous namespace
+
 VideoDecoder::VideoDecoder() {
 	_startTime = 0;
 	_dirtyPalette = false;
@@ -50,6 +84,18 @@ VideoDecoder::VideoDecoder() {
 	_mainAudioTrack = 0;
 	_canSetDither = true;
 
+	_decodeAheadFrames = 0;
+	if (ConfMan.hasKey("video_decode_ahead"))
+		_decodeAheadFrames = CLIP<int>(ConfMan.getInt("video_decode_ahead"), 0, kMaxDecodeAhead);
+	_decodeAheadActive = false;
+	_decodeAheadScheduled = false;
+	_decodeAheadTrack = 0;
+	_presentedFrame = 0;
+	_decodeAheadCurFrame = -1;
+	_decodeAheadNextFrameStartTime = 0;
+	_decodeAheadEndOfTrack = false;
+	_decodeAheadUnderruns = 0;
+
 	// Find the best format for output
 	_defaultHighColorFormat = g_system->getScreenFormat();
 
@@ -57,10 +103,17 @@ VideoDecoder::VideoDecoder() {
 		_defaultHighColorFormat = Graphics::PixelFormat(4, 8, 8, 8, 8, 8, 16, 24, 0);
 }
 
+VideoDecoder::~VideoDecoder() {
+	// Subclasses call close() themselves, this is only a safety net
+	stopDecodeAhead();
+}
+
 void VideoDecoder::close() {
 	if (isPlaying())
 		stop();
 
+	stopDecodeAhead();
+
 	for (TrackList::iterator it = _tracks.begin(); it != _tracks.end(); it++)
 		delete *it;
 
@@ -185,6 +238,11 @@ const Graphics::Surface *VideoDecoder::decodeNextFrame() {
 	_needsUpdate = false;
 	_canSetDither = false;
 
+	startDecodeAhead();
+
+	if (_decodeAheadActive)
+		return presentDecodedFrame();
+
 	readNextPacket();
 
 	// If we have no next video track at this point, there shouldn't be
@@ -210,6 +268,12 @@ bool VideoDecoder::setReverse(bool reverse) {
 	if (reverse && hasAudio())
 		return false;
 
+	// The tracks may be ahead of the presented frame
+	if (reverse && _decodeAheadActive)
+		return false;
+
+	Common::StackLock lock(_decodeAheadMutex);
+
 	// Attempt to make sure all the tracks are in the requested direction
 	for (TrackList::iterator it = _tracks.begin(); it != _tracks.end(); it++) {
 		if ((*it)->getTrackType() == Track::kTrackTypeVideo && ((VideoTrack *)*it)->isReversed() != reverse) {
@@ -230,6 +294,9 @@ const byte *VideoDecoder::getPalette() {
 }
 
 int VideoDecoder::getCurFrame() const {
+	if (_decodeAheadActive)
+		return _decodeAheadCurFrame;
+
 	int32 frame = -1;
 
 	for (TrackList::const_iterator it = _tracks.begin(); it != _tracks.end(); it++)
@@ -271,13 +338,18 @@ uint32 VideoDecoder::getTime() const {
 }
 
 uint32 VideoDecoder::getTimeToNextFrame() const {
-	if (endOfVideo() || _needsUpdate || !_nextVideoTrack)
+	if (endOfVideo() || _needsUpdate)
+		return 0;
+
+	// While decoding ahead, _nextVideoTrack belongs to the decoding
+	const VideoTrack *nextVideoTrack = _decodeAheadActive ? _decodeAheadTrack : _nextVideoTrack;
+	if (!nextVideoTrack || isVideoTrackEnded(nextVideoTrack))
 		return 0;
 
 	uint32 currentTime = getTime();
-	uint32 nextFrameStartTime = _nextVideoTrack->getNextFrameStartTime();
+	uint32 nextFrameStartTime = getVideoTrackNextFrameStartTime(nextVideoTrack);
 
-	if (_nextVideoTrack->isReversed()) {
+	if (nextVideoTrack->isReversed()) {
 		// For reversed videos, we need to handle the time difference the opposite way.
 		if (nextFrameStartTime >= currentTime)
 			return 0;
@@ -295,9 +367,11 @@ uint32 VideoDecoder::getTimeToNextFrame() const {
 bool VideoDecoder::endOfVideo() const {
 	for (TrackList::const_iterator it = _tracks.begin(); it != _tracks.end(); it++) {
 		const Track *track = *it;
+		const bool isVideo = track->getTrackType() == Track::kTrackTypeVideo;
 
-		bool videoEndTimeReached = _endTimeSet && track->getTrackType() == Track::kTrackTypeVideo && ((const VideoTrack *)track)->getNextFrameStartTime() >= (uint)_endTime.msecs();
-		bool endReached = track->endOfTrack() || (isPlaying() && videoEndTimeReached);
+		bool videoEndTimeReached = _endTimeSet && isVideo && getVideoTrackNextFrameStartTime((const VideoTrack *)track) >= (uint)_endTime.msecs();
+		bool trackEnded = isVideo ? isVideoTrackEnded((const VideoTrack *)track) : track->endOfTrack();
+		bool endReached = trackEnded || (isPlaying() && videoEndTimeReached);
 		if (!endReached)
 			return false;
 	}
@@ -320,6 +394,9 @@ bool VideoDecoder::rewind() {
 	if (!isRewindable())
 		return false;
 
+	// Frames decoded ahead are of no use anymore
+	stopDecodeAhead();
+
 	// Stop all tracks so they can be rewound
 	if (isPlaying())
 		stopAudio();
@@ -336,6 +413,9 @@ bool VideoDecoder::rewind() {
 	_startTime = g_system->getMillis();
 	resetPauseStartTime();
 	findNextVideoTrack();
+
+	// Decoding ahead starts again with the next frame, since subclasses may
+	// still reposition their stream after calling us
 	return true;
 }
 
@@ -354,6 +434,9 @@ bool VideoDecoder::seek(const Audio::Timestamp &time) {
 	if (!isSeekable())
 		return false;
 
+	// Frames decoded ahead are of no use anymore
+	stopDecodeAhead();
+
 	// Stop all tracks so they can be seeked
 	if (isPlaying())
 		stopAudio();
@@ -379,6 +462,8 @@ bool VideoDecoder::seek(const Audio::Timestamp &time) {
 	resetPauseStartTime();
 	findNextVideoTrack();
 	_needsUpdate = true;
+
+	// Decoding ahead starts again with the next frame, see rewind()
 	return true;
 }
 
@@ -420,6 +505,10 @@ void VideoDecoder::stop() {
 	if (!isPlaying())
 		return;
 
+	// Keep the frames decoded so far, since the tracks are already past
+	// them, but do not decode more until we play again
+	suspendDecodeAhead();
+
 	// Stop audio here so we don't have it affect getTime()
 	stopAudio();
 
@@ -479,6 +568,9 @@ void VideoDecoder::setRate(const Common::Rational &rate) {
 		_startTime -= (_lastTimeChange.msecs() / _playbackRate).toInt();
 
 	startAudio();
+
+	// Fill the queue before the first frame is requested
+	startDecodeAhead();
 }
 
 bool VideoDecoder::isPlaying() const {
@@ -523,6 +615,253 @@ bool VideoDecoder::setDitheringPalette(const byte *palette) {
 	return result;
 }
 
+void VideoDecoder::setDecodeAhead(uint frames) {
+	_decodeAheadFrames = MIN<uint>(frames, kMaxDecodeAhead);
+
+	// Frames which were already decoded ahead are still shown, and
+	// decodeNextFrame() decodes the following ones itself
+	if (!_decodeAheadFrames)
+		suspendDecodeAhead();
+}
+
+bool VideoDecoder::hasSingleForwardVideoTrack() const {
+	const VideoTrack *videoTrack = 0;
+
+	for (TrackList::const_iterator it = _tracks.begin(); it != _tracks.end(); it++) {
+		if ((*it)->getTrackType() == Track::kTrackTypeVideo) {
+			if (videoTrack)
+				return false;
+
+			videoTrack = (const VideoTrack *)*it;
+		}
+	}
+
+	return videoTrack && !videoTrack->isReversed();
+}
+
+void VideoDecoder::startDecodeAhead() {
+	if (!_decodeAheadFrames || !isPlaying())
+		return;
+
+	if (!_decodeAheadActive) {
+		if (!supportsDecodeAhead() || !hasSingleForwardVideoTrack())
+			return;
+
+		VideoTrack *track = 0;
+		for (TrackList::iterator it = _tracks.begin(); it != _tracks.end() && !track; it++)
+			if ((*it)->getTrackType() == Track::kTrackTypeVideo)
+				track = (VideoTrack *)*it;
+
+		// A dithering palette can still be set until the first frame is
+		// decoded, so wait for that
+		if (_canSetDither && track->canDither())
+			return;
+
+		_decodeAheadTrack = track;
+		_decodeAheadCurFrame = track->getCurFrame();
+		_decodeAheadNextFrameStartTime = track->getNextFrameStartTime();
+		_decodeAheadEndOfTrack = track->endOfTrack();
+		_decodeAheadUnderruns = 0;
+		_decodeAheadActive = true;
+		_canSetDither = false;
+	}
+
+	if (!_decodeAheadScheduled)
+		scheduleDecodeAhead();
+}
+
+void VideoDecoder::scheduleDecodeAhead() {
+	if (!s_decodeAheadMutex) {
+		s_decodeAheadMutex = new Common::Mutex();
+		s_decodeAheadDecoders = new Common::Array<VideoDecoder *>();
+		g_system->getTimerManager()->installTimerProc(decodeAheadProc, kDecodeAheadInterval, 0, "videoDecodeAhead");
+	}
+
+	Common::StackLock lock(*s_decodeAheadMutex);
+	s_decodeAheadDecoders->push_back(this);
+	_decodeAheadScheduled = true;
+}
+
+void VideoDecoder::suspendDecodeAhead() {
+	if (!_decodeAheadScheduled)
+		return;
+
+	// Our own mutex must not be held here, since the timer callback locks
+	// it while holding the shared one.
+	bool last;
+	{
+		// This waits for a running timer callback to finish
+		Common::StackLock lock(*s_decodeAheadMutex);
+
+		for (uint i = 0; i < s_decodeAheadDecoders->size(); ++i) {
+			if ((*s_decodeAheadDecoders)[i] == this) {
+				s_decodeAheadDecoders->remove_at(i);
+				break;
+			}
+		}
+
+		last = s_decodeAheadDecoders->empty();
+	}
+
+	_decodeAheadScheduled = false;
+
+	if (last) {
+		g_system->getTimerManager()->removeTimerProc(decodeAheadProc);
+
+		delete s_decodeAheadDecoders;
+		s_decodeAheadDecoders = 0;
+		delete s_decodeAheadMutex;
+		s_decodeAheadMutex = 0;
+	}
+}
+
+void VideoDecoder::stopDecodeAhead() {
+	suspendDecodeAhead();
+
+	if (_decodeAheadActive)
+		debug(2, "VideoDecoder: %d frames were not decoded ahead in time", _decodeAheadUnderruns);
+
+	while (!_decodedFrames.empty())
+		_freeFrames.push_back(_decodedFrames.pop());
+
+	if (_presentedFrame)
+		_freeFrames.push_back(_presentedFrame);
+	_presentedFrame = 0;
+
+	for (uint i = 0; i < _freeFrames.size(); ++i) {
+		_freeFrames[i]->surface.free();
+		delete _freeFrames[i];
+	}
+	_freeFrames.clear();
+
+	_decodeAheadActive = false;
+	_decodeAheadTrack = 0;
+}
+
+void VideoDecoder::decodeAheadProc(void *refCon) {
+	Common::StackLock lock(*s_decodeAheadMutex);
+
+	for (uint i = 0; i < s_decodeAheadDecoders->size(); ++i)
+		(*s_decodeAheadDecoders)[i]->decodeAhead();
+}
+
+void VideoDecoder::decodeAhead() {
+	Common::StackLock lock(_decodeAheadMutex);
+
+	uint queued;
+	{
+		Common::StackLock framesLock(_decodedFramesMutex);
+		queued = _decodedFrames.size();
+	}
+
+	// Only one frame per call, so that the other timer callbacks are not
+	// held up for too long. Once the video track ended, there is nothing
+	// left to decode.
+	if (queued < _decodeAheadFrames && _nextVideoTrack)
+		decodeFrameAhead();
+}
+
+bool VideoDecoder::decodeFrameAhead() {
+	// This is the synchronous decodeNextFrame(), but the frame and the state
+	// of the track after it are stored in the queue.
+	readNextPacket();
+
+	if (!_nextVideoTrack)
+		return false;
+
+	const Graphics::Surface *surface = _nextVideoTrack->decodeNextFrame();
+
+	DecodedFrame *frame = 0;
+	{
+		Common::StackLock lock(_decodedFramesMutex);
+		if (!_freeFrames.empty()) {
+			frame = _freeFrames.back();
+			_freeFrames.pop_back();
+		}
+	}
+
+	if (!frame)
+		frame = new DecodedFrame();
+
+	frame->hasSurface = (surface != 0);
+	if (surface)
+		copyFrame(frame->surface, *surface);
+
+	frame->dirtyPalette = _nextVideoTrack->hasDirtyPalette();
+	if (frame->dirtyPalette)
+		memcpy(frame->palette, _nextVideoTrack->getPalette(), sizeof(frame->palette));
+
+	frame->curFrame = _nextVideoTrack->getCurFrame();
+	frame->nextFrameStartTime = _nextVideoTrack->getNextFrameStartTime();
+	frame->endOfTrack = _nextVideoTrack->endOfTrack();
+
+	findNextVideoTrack();
+
+	Common::StackLock lock(_decodedFramesMutex);
+	_decodedFrames.push(frame);
+	return true;
+}
+
+VideoDecoder::DecodedFrame *VideoDecoder::popDecodedFrame() {
+	Common::StackLock lock(_decodedFramesMutex);
+	return _decodedFrames.empty() ? 0 : _decodedFrames.pop();
+}
+
+const Graphics::Surface *VideoDecoder::presentDecodedFrame() {
+	// The caller is done with the previous frame
+	if (_presentedFrame) {
+		Common::StackLock lock(_decodedFramesMutex);
+		_freeFrames.push_back(_presentedFrame);
+		_presentedFrame = 0;
+	}
+
+	DecodedFrame *frame = popDecodedFrame();
+	if (!frame) {
+		// The timer did not keep up, so we decode the frame ourselves,
+		// unless the timer finishes it while we wait for the lock
+		Common::StackLock lock(_decodeAheadMutex);
+
+		frame = popDecodedFrame();
+		if (!frame) {
+			if (_decodeAheadScheduled)
+				_decodeAheadUnderruns++;
+
+			if (decodeFrameAhead())
+				frame = popDecodedFrame();
+		}
+	}
+
+	if (!frame)
+		return 0;
+
+	_presentedFrame = frame;
+	_decodeAheadCurFrame = frame->curFrame;
+	_decodeAheadNextFrameStartTime = frame->nextFrameStartTime;
+	_decodeAheadEndOfTrack = frame->endOfTrack;
+
+	if (frame->dirtyPalette) {
+		memcpy(_decodeAheadPalette, frame->palette, sizeof(_decodeAheadPalette));
+		_palette = _decodeAheadPalette;
+		_dirtyPalette = true;
+	}
+
+	return frame->hasSurface ? &frame->surface : 0;
+}
+
+bool VideoDecoder::isVideoTrackEnded(const VideoTrack *track) const {
+	if (_decodeAheadActive && track == _decodeAheadTrack)
+		return _decodeAheadEndOfTrack;
+
+	return track->endOfTrack();
+}
+
+uint32 VideoDecoder::getVideoTrackNextFrameStartTime(const VideoTrack *track) const {
+	if (_decodeAheadActive && track == _decodeAheadTrack)
+		return _decodeAheadNextFrameStartTime;
+
+	return track->getNextFrameStartTime();
+}
+
 VideoDecoder::Track::Track() {
 	_paused = false;
 }
@@ -715,6 +1054,8 @@ bool VideoDecoder::StreamFileAudioTrack::loadFromFile(const Common::String &base
 }
 
 void VideoDecoder::addTrack(Track *track, bool isExternal) {
+	Common::StackLock lock(_decodeAheadMutex);
+
 	_tracks.push_back(track);
 
 	if (isExternal)
@@ -921,8 +1262,8 @@ bool VideoDecoder::hasFramesLeft() const {
 
 		const VideoTrack *track = (const VideoTrack *)*it;
 
-		bool videoEndTimeReached = _endTimeSet && track->getNextFrameStartTime() >= (uint)_endTime.msecs();
-		bool endReached = track->endOfTrack() || (isPlaying() && videoEndTimeReached);
+		bool videoEndTimeReached = _endTimeSet && getVideoTrackNextFrameStartTime(track) >= (uint)_endTime.msecs();
+		bool endReached = isVideoTrackEnded(track) || (isPlaying() && videoEndTimeReached);
 		if (!endReached)
 			return true;
 	}
@@ -939,6 +1280,11 @@ bool VideoDecoder::hasAudio() const {
 }
 
 void VideoDecoder::eraseTrack(Track *track) {
+	if (track == _decodeAheadTrack)
+		stopDecodeAhead();
+
+	Common::StackLock lock(_decodeAheadMutex);
+
 	for (uint idx = 0; idx < _externalTracks.size(); ++idx) {
 		if (_externalTracks[idx] == track)
 			_externalTracks.remove_at(idx);
@@ -26,6 +26,8 @@
 #include "audio/mixer.h"
 #include "audio/timestamp.h"	// TODO: Move this to common/ ?
 #include "common/array.h"
+#include "common/mutex.h"
+#include "common/queue.h"
 #include "common/rational.h"
 #include "common/str.h"
 #include "graphics/pixelformat.h"
@@ -52,7 +54,7 @@ namespace Video {
 class VideoDecoder {
 public:
 	VideoDecoder();
-	virtual ~VideoDecoder() {}
+	virtual ~VideoDecoder();
 
 	/////////////////////////////////////////
 	// Opening/Closing a Video
@@ -355,6 +357,25 @@ public:
 	 */
 	virtual const Graphics::Surface *decodeNextFrame();
 
+	/**
+	 * Decode frames ahead of their presentation time.
+	 *
+	 * While the video is playing, its frames are then decoded from a backend
+	 * timer callback into a queue of up to the given number of frames, and
+	 * decodeNextFrame() takes them from there. The audio tracks are played
+	 * as before. If the queue runs empty, decodeNextFrame() decodes the
+	 * frame itself.
+	 *
+	 * This only works for videos with a single video track played forward.
+	 * Once frames were decoded ahead, the video can not be reversed without
+	 * seeking first.
+	 *
+	 * The default is taken from the "video_decode_ahead" setting.
+	 *
+	 * @param frames The number of frames to decode ahead, 0 to disable it
+	 */
+	void setDecodeAhead(uint frames);
+
 	/**
 	 * Set the default high color format for videos that convert from YUV.
 	 *
@@ -926,6 +947,27 @@ protected:
 	 */
 	virtual AudioTrack *getAudioTrack(int index) { return 0; }
 
+	/**
+	 * Whether the frames can be decoded ahead, see setDecodeAhead().
+	 *
+	 * Decoding ahead runs readNextPacket() and the decodeNextFrame() of the
+	 * video track from the timer thread, which also serves all other timer
+	 * callbacks, so decoders have to opt in. A decoder may only do so if its
+	 * frames are cheap compared to the frame duration, and if it accesses
+	 * its stream and tracks only from those two methods, from seekIntern(),
+	 * or after calling VideoDecoder::rewind() or VideoDecoder::seek(). Any
+	 * other access must hold getDecodeAheadMutex().
+	 *
+	 * Even then, only videos with a single video track played forward are
+	 * decoded ahead.
+	 */
+	virtual bool supportsDecodeAhead() const { return false; }
+
+	/**
+	 * Get the mutex which is held while frames are decoded ahead.
+	 */
+	Common::Mutex &getDecodeAheadMutex() { return _decodeAheadMutex; }
+
 private:
 	// Tracks owned by this VideoDecoder
 	TrackList _tracks;
@@ -964,6 +1006,50 @@ private:
 	Audio::Mixer::SoundType _soundType;
 
 	AudioTrack *_mainAudioTrack;
+
+	// Decode ahead
+	enum {
+		kMaxDecodeAhead = 32,
+		/** Interval of the decode ahead timer in microseconds */
+		kDecodeAheadInterval = 5000
+	};
+
+	struct DecodedFrame;
+
+	uint _decodeAheadFrames;
+	// Frames are decoded ahead, and the tracks may be further than the
+	// presented frame below
+	bool _decodeAheadActive;
+	// The decoder is registered with the decode ahead timer
+	bool _decodeAheadScheduled;
+	VideoTrack *_decodeAheadTrack;
+	Common::Queue<DecodedFrame *> _decodedFrames;
+	Common::Array<DecodedFrame *> _freeFrames;
+	DecodedFrame *_presentedFrame;
+	byte _decodeAheadPalette[256 * 3];
+	// The state of the video track as of the presented frame
+	int _decodeAheadCurFrame;
+	uint32 _decodeAheadNextFrameStartTime;
+	bool _decodeAheadEndOfTrack;
+	uint32 _decodeAheadUnderruns;
+	// Held while decoding a frame ahead, guards the tracks
+	Common::Mutex _decodeAheadMutex;
+	// Guards the decoded and free frames, never held while decoding
+	Common::Mutex _decodedFramesMutex;
+
+	static void decodeAheadProc(void *refCon);
+	void decodeAhead();
+	bool decodeFrameAhead();
+	DecodedFrame *popDecodedFrame();
+	const Graphics::Surface *presentDecodedFrame();
+	void startDecodeAhead();
+	void scheduleDecodeAhead();
+	void suspendDecodeAhead();
+	void stopDecodeAhead();
+
+	bool hasSingleForwardVideoTrack() const;
+	bool isVideoTrackEnded(const VideoTrack *track) const;
+	uint32 getVideoTrackNextFrameStartTime(const VideoTrack *track) const;
 };
 
 } // End of namespace Video